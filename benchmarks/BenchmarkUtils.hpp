@@ -0,0 +1,251 @@
+/**
+ * @file BenchmarkUtils.hpp
+ * @brief Timing, statistics and report helpers shared by Re::Solve
+ * benchmarks.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <resolve/Common.hpp>
+#include <resolve/matrix/Coo.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/matrix/io.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+
+namespace ReSolve
+{
+  namespace benchmark
+  {
+    /// Robust summary of repeated measurements.
+    struct Statistics
+    {
+      real_type median{0.0};
+      real_type mad{0.0};   ///< median absolute deviation from the median
+      real_type min{0.0};
+      real_type max{0.0};
+      index_type count{0};
+    };
+
+    /// Median of values, the vector is reordered.
+    inline real_type median(std::vector<real_type>& values)
+    {
+      if (values.empty()) {
+        return 0.0;
+      }
+      std::sort(values.begin(), values.end());
+      const std::size_t mid = values.size() / 2;
+      return (values.size() % 2) ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+    }
+
+    /**
+     * @brief Percentile of values with linear interpolation between
+     * closest ranks.
+     *
+     * @param[in] values - sample, may be unsorted
+     * @param[in] p      - percentile in [0, 100]
+     */
+    inline real_type percentile(std::vector<real_type> values, real_type p)
+    {
+      if (values.empty()) {
+        return 0.0;
+      }
+      std::sort(values.begin(), values.end());
+      const real_type rank = std::min(std::max(p, 0.0), 100.0) / 100.0 * static_cast<real_type>(values.size() - 1);
+      const std::size_t lo = static_cast<std::size_t>(std::floor(rank));
+      const std::size_t hi = std::min(lo + 1, values.size() - 1);
+      return values[lo] + (rank - static_cast<real_type>(lo)) * (values[hi] - values[lo]);
+    }
+
+    /// Computes median, median absolute deviation and range of samples.
+    inline Statistics summarize(std::vector<real_type> samples)
+    {
+      Statistics stats;
+      if (samples.empty()) {
+        return stats;
+      }
+      stats.count  = static_cast<index_type>(samples.size());
+      stats.min    = *std::min_element(samples.begin(), samples.end());
+      stats.max    = *std::max_element(samples.begin(), samples.end());
+      stats.median = median(samples);
+      for (real_type& s : samples) {
+        s = std::abs(s - stats.median);
+      }
+      stats.mad = median(samples);
+      return stats;
+    }
+
+    /**
+     * @brief Measures time of one call of a kernel.
+     *
+     * The kernel is called once to warm up caches and lazily allocated
+     * data. Each sample then calls the kernel as many times as needed for
+     * the sample to last at least `min_time`, so short kernels are not
+     * dominated by clock resolution.
+     *
+     * @param[in] kernel      - callable without arguments
+     * @param[in] repetitions - number of samples
+     * @param[in] min_time    - minimum duration of a sample in seconds
+     *
+     * @return Statistics of time per kernel call in seconds
+     */
+    template <typename Kernel>
+    Statistics timeKernel(Kernel kernel, index_type repetitions, real_type min_time)
+    {
+      using clock = std::chrono::steady_clock;
+
+      clock::time_point start = clock::now();
+      kernel();
+      real_type first = std::chrono::duration<real_type>(clock::now() - start).count();
+
+      index_type calls = 1;
+      if (first < min_time) {
+        calls = static_cast<index_type>(std::min(min_time / std::max(first, 1e-9), 1e6));
+        calls = std::max(calls, static_cast<index_type>(1));
+      }
+
+      std::vector<real_type> samples;
+      for (index_type r = 0; r < repetitions; ++r) {
+        start = clock::now();
+        for (index_type c = 0; c < calls; ++c) {
+          kernel();
+        }
+        samples.push_back(std::chrono::duration<real_type>(clock::now() - start).count() / calls);
+      }
+      return summarize(samples);
+    }
+
+    /**
+     * @brief Measures memory bandwidth with STREAM triad a = b + s * c.
+     *
+     * Uses the same number of host threads as Re::Solve CPU kernels. Bytes
+     * are counted as in STREAM, i.e. without write-allocate traffic.
+     *
+     * @param[in] n           - length of each array
+     * @param[in] repetitions - number of samples
+     *
+     * @return Best bandwidth over samples in GB/s
+     */
+    inline real_type streamTriadBandwidth(index_type n, index_type repetitions)
+    {
+      std::vector<real_type> a(static_cast<std::size_t>(n), 0.0);
+      std::vector<real_type> b(static_cast<std::size_t>(n), 1.0);
+      std::vector<real_type> c(static_cast<std::size_t>(n), 2.0);
+      const real_type s = 3.0;
+      const int num_threads = threads::getNumThreads(n, 1 << 14);
+
+      auto triad = [&]() {
+        threads::parallelFor(num_threads, 0, n, [&](int, index_type lo, index_type hi) {
+          for (index_type i = lo; i < hi; ++i) {
+            a[i] = b[i] + s * c[i];
+          }
+        });
+      };
+      Statistics time = timeKernel(triad, repetitions, 0.0);
+      const real_type bytes = 3.0 * sizeof(real_type) * n;
+      return (time.min > 0.0) ? bytes / time.min * 1e-9 : 0.0;
+    }
+
+    /// Returns string as JSON string literal.
+    inline std::string jsonString(const std::string& s)
+    {
+      std::string out = "\"";
+      for (char c : s) {
+        if (c == '"' || c == '\\') {
+          out += '\\';
+          out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+          char code[8];
+          std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+          out += code;
+        } else {
+          out += c;
+        }
+      }
+      return out + "\"";
+    }
+
+    /// Writes statistics as JSON object.
+    inline void writeJson(std::ostream& out, const Statistics& stats)
+    {
+      out << "{\"median\": " << stats.median
+          << ", \"mad\": " << stats.mad
+          << ", \"min\": " << stats.min
+          << ", \"max\": " << stats.max
+          << ", \"count\": " << stats.count << "}";
+    }
+
+    /**
+     * @brief Reads matrix in Matrix Market format into CSR matrix on host.
+     *
+     * Symmetric matrices are expanded and stored as general matrices, so
+     * that all kernels see every stored nonzero.
+     *
+     * @return Pointer to new matrix, nullptr if the file cannot be read
+     */
+    inline matrix::Csr* readCsrMatrix(const std::string& filename)
+    {
+      std::ifstream file(filename);
+      if (!file.is_open()) {
+        return nullptr;
+      }
+      matrix::Coo* A_coo = io::readMatrixFromFile(file);
+      matrix::Csr A_sym(A_coo->getNumRows(),
+                        A_coo->getNumColumns(),
+                        A_coo->getNnz(),
+                        A_coo->symmetric(),
+                        A_coo->expanded());
+      A_sym.updateFromCoo(A_coo, memory::HOST);
+      delete A_coo;
+
+      const index_type n = A_sym.getNumRows();
+      index_type* rows = A_sym.getRowData(memory::HOST);
+      matrix::Csr* A = new matrix::Csr(n, A_sym.getNumColumns(), rows[n]);
+      A->allocateMatrixData(memory::HOST);
+      A->updateData(rows,
+                    A_sym.getColData(memory::HOST),
+                    A_sym.getValues(memory::HOST),
+                    memory::HOST,
+                    memory::HOST);
+      return A;
+    }
+
+    /**
+     * @brief Generates 5-point finite difference Laplacian on a
+     * `grid` x `grid` mesh with Dirichlet boundary.
+     */
+    inline matrix::Csr* generateLaplacian2D(index_type grid)
+    {
+      const index_type n = grid * grid;
+      std::vector<index_type> rows(1, 0);
+      std::vector<index_type> cols;
+      std::vector<real_type>  vals;
+      cols.reserve(5 * static_cast<std::size_t>(n));
+      vals.reserve(5 * static_cast<std::size_t>(n));
+      for (index_type i = 0; i < n; ++i) {
+        const index_type x = i % grid;
+        const index_type y = i / grid;
+        if (y > 0)        { cols.push_back(i - grid); vals.push_back(-1.0); }
+        if (x > 0)        { cols.push_back(i - 1);    vals.push_back(-1.0); }
+        cols.push_back(i); vals.push_back(4.0);
+        if (x < grid - 1) { cols.push_back(i + 1);    vals.push_back(-1.0); }
+        if (y < grid - 1) { cols.push_back(i + grid); vals.push_back(-1.0); }
+        rows.push_back(static_cast<index_type>(cols.size()));
+      }
+
+      matrix::Csr* A = new matrix::Csr(n, n, static_cast<index_type>(cols.size()));
+      A->allocateMatrixData(memory::HOST);
+      A->updateData(rows.data(), cols.data(), vals.data(), memory::HOST, memory::HOST);
+      return A;
+    }
+  } // namespace benchmark
+} // namespace ReSolve
@@ -0,0 +1,232 @@
+/**
+ * @file JsonReader.hpp
+ * @brief Minimal JSON reader for benchmark reports.
+ *
+ * Supports the subset of JSON written by Re::Solve benchmarks: objects,
+ * arrays, numbers, strings with simple escapes, booleans and null.
+ */
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ReSolve
+{
+  namespace benchmark
+  {
+    /// Parsed JSON value.
+    class JsonValue
+    {
+      public:
+        enum Type {null_value = 0, boolean, number, string, array, object};
+
+        Type type{null_value};
+        bool boolean_value{false};
+        double number_value{0.0};
+        std::string string_value;
+        std::vector<JsonValue> elements;                        ///< array elements
+        std::vector<std::pair<std::string, JsonValue> > members; ///< object members
+
+        /// Member with given key, nullptr if not an object or key not found.
+        const JsonValue* find(const std::string& key) const
+        {
+          for (const auto& member : members) {
+            if (member.first == key) {
+              return &member.second;
+            }
+          }
+          return nullptr;
+        }
+
+        /// Number member with given key, `fallback` if not found.
+        double getNumber(const std::string& key, double fallback = 0.0) const
+        {
+          const JsonValue* value = find(key);
+          return (value && value->type == number) ? value->number_value : fallback;
+        }
+
+        /// String member with given key, empty if not found.
+        std::string getString(const std::string& key) const
+        {
+          const JsonValue* value = find(key);
+          return (value && value->type == string) ? value->string_value : "";
+        }
+    };
+
+    /// Recursive descent parser over a string.
+    class JsonParser
+    {
+      public:
+        explicit JsonParser(const std::string& text) : text_(text)
+        {
+        }
+
+        /// Parses the whole text, returns false on syntax error.
+        bool parse(JsonValue& value)
+        {
+          pos_ = 0;
+          if (!parseValue(value)) {
+            return false;
+          }
+          skipSpace();
+          return pos_ == text_.size();
+        }
+
+      private:
+        void skipSpace()
+        {
+          while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+          }
+        }
+
+        bool consume(char c)
+        {
+          skipSpace();
+          if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+          }
+          return false;
+        }
+
+        bool parseLiteral(const char* literal)
+        {
+          const std::string s(literal);
+          if (text_.compare(pos_, s.size(), s) == 0) {
+            pos_ += s.size();
+            return true;
+          }
+          return false;
+        }
+
+        bool parseString(std::string& out)
+        {
+          if (!consume('"')) {
+            return false;
+          }
+          out.clear();
+          while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c == '\\') {
+              if (pos_ >= text_.size()) {
+                return false;
+              }
+              c = text_[pos_++];
+              switch (c) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                  // Only ASCII escapes are written by benchmarks.
+                  if (pos_ + 4 > text_.size()) {
+                    return false;
+                  }
+                  out += static_cast<char>(std::strtol(text_.substr(pos_, 4).c_str(), nullptr, 16));
+                  pos_ += 4;
+                  break;
+                default:
+                  out += c;
+              }
+            } else {
+              out += c;
+            }
+          }
+          return consume('"');
+        }
+
+        bool parseValue(JsonValue& value)
+        {
+          skipSpace();
+          if (pos_ >= text_.size()) {
+            return false;
+          }
+          const char c = text_[pos_];
+          if (c == '{') {
+            value.type = JsonValue::object;
+            ++pos_;
+            if (consume('}')) {
+              return true;
+            }
+            do {
+              std::pair<std::string, JsonValue> member;
+              if (!parseString(member.first) || !consume(':') || !parseValue(member.second)) {
+                return false;
+              }
+              value.members.push_back(member);
+            } while (consume(','));
+            return consume('}');
+          }
+          if (c == '[') {
+            value.type = JsonValue::array;
+            ++pos_;
+            if (consume(']')) {
+              return true;
+            }
+            do {
+              JsonValue element;
+              if (!parseValue(element)) {
+                return false;
+              }
+              value.elements.push_back(element);
+            } while (consume(','));
+            return consume(']');
+          }
+          if (c == '"') {
+            value.type = JsonValue::string;
+            return parseString(value.string_value);
+          }
+          if (parseLiteral("true")) {
+            value.type = JsonValue::boolean;
+            value.boolean_value = true;
+            return true;
+          }
+          if (parseLiteral("false")) {
+            value.type = JsonValue::boolean;
+            return true;
+          }
+          if (parseLiteral("null")) {
+            value.type = JsonValue::null_value;
+            return true;
+          }
+          const char* begin = text_.c_str() + pos_;
+          char* end = nullptr;
+          value.number_value = std::strtod(begin, &end);
+          if (end == begin) {
+            return false;
+          }
+          value.type = JsonValue::number;
+          pos_ += static_cast<std::size_t>(end - begin);
+          return true;
+        }
+
+        const std::string& text_;
+        std::size_t pos_{0};
+    };
+
+    /**
+     * @brief Reads JSON file.
+     *
+     * @return false if the file cannot be read or parsed
+     */
+    inline bool readJsonFile(const std::string& filename, JsonValue& value)
+    {
+      std::ifstream file(filename);
+      if (!file.is_open()) {
+        return false;
+      }
+      std::stringstream buffer;
+      buffer << file.rdbuf();
+      const std::string text = buffer.str();
+      JsonParser parser(text);
+      return parser.parse(value);
+    }
+  } // namespace benchmark
+} // namespace ReSolve
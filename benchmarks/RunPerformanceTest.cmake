@@ -0,0 +1,47 @@
+#[[
+
+@brief Runs a benchmark and compares its results with a stored baseline
+
+Required variables:
+  BENCHMARK - benchmark executable
+  ARGS      - benchmark arguments, separated by spaces
+  COMPARE   - perf_compare.exe executable
+  RESULT    - JSON file where results are written
+  BASELINE  - baseline JSON file
+Optional variables:
+  THRESHOLD    - relative slowdown treated as regression (default 0.1)
+  NOISE_FACTOR - number of standard deviations of noise (default 3)
+  UPDATE       - if true, results are stored as the new baseline
+
+If the baseline does not exist, results are stored as the baseline and the
+test passes.
+
+]]
+
+if(NOT DEFINED THRESHOLD)
+  set(THRESHOLD 0.1)
+endif()
+if(NOT DEFINED NOISE_FACTOR)
+  set(NOISE_FACTOR 3)
+endif()
+
+separate_arguments(benchmark_args UNIX_COMMAND "${ARGS}")
+execute_process(COMMAND ${BENCHMARK} ${benchmark_args} -o ${RESULT}
+                RESULT_VARIABLE benchmark_status)
+if(NOT benchmark_status EQUAL 0)
+  message(FATAL_ERROR "Benchmark ${BENCHMARK} failed with status ${benchmark_status}")
+endif()
+
+if(UPDATE OR NOT EXISTS ${BASELINE})
+  get_filename_component(baseline_dir ${BASELINE} DIRECTORY)
+  file(MAKE_DIRECTORY ${baseline_dir})
+  file(COPY_FILE ${RESULT} ${BASELINE})
+  message(STATUS "Stored results as baseline ${BASELINE}")
+  return()
+endif()
+
+execute_process(COMMAND ${COMPARE} -b ${BASELINE} -c ${RESULT} -t ${THRESHOLD} -k ${NOISE_FACTOR}
+                RESULT_VARIABLE compare_status)
+if(NOT compare_status EQUAL 0)
+  message(FATAL_ERROR "Performance regression with respect to ${BASELINE}")
+endif()
@@ -0,0 +1,548 @@
+/**
+ * @file kernelBenchmark.cpp
+ * @brief Microbenchmarks of Re::Solve host kernels with roofline report.
+ *
+ * Times sparse matrix kernels, vector kernels, Gram-Schmidt variants and
+ * random sketching methods on a synthetic 2D Laplacian and on matrices
+ * from the test data directory. Memory bandwidth of the machine is
+ * measured with STREAM triad, and each kernel is reported in GFLOP/s and
+ * GB/s together with the bandwidth-bound roofline for its arithmetic
+ * intensity.
+ *
+ * Work per kernel is estimated from the algorithm: bytes are the minimal
+ * (compulsory) memory traffic, assuming each array is read or written
+ * once.
+ *
+ * Usage: kernel_benchmark.exe [-n <grid size>] [-m <number of vectors>]
+ *                             [-r <repetitions>] [-t <min sample time [s]>]
+ *                             [-s <STREAM array size>] [-d <data directory>]
+ *                             [-k <kernel name filter>] [-o <JSON output file>]
+ */
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <resolve/GramSchmidt.hpp>
+#include <resolve/matrix/Coo.hpp>
+#include <resolve/matrix/Csc.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/matrix/MatrixHandler.hpp>
+#include <resolve/random/SketchingHandler.hpp>
+#include <resolve/utilities/params/CliOptions.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include <resolve/utilities/version/version.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/vector/VectorHandler.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+
+#include "BenchmarkUtils.hpp"
+
+using namespace ReSolve::constants;
+
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+using ReSolve::benchmark::Statistics;
+
+/// Measured kernel with estimated work per call.
+struct KernelResult
+{
+  std::string name;
+  std::string matrix;
+  index_type n;
+  index_type nnz;
+  Statistics time;
+  real_type flops;
+  real_type bytes;
+};
+
+/// Kernels to run and where to store results.
+struct BenchmarkSetup
+{
+  index_type repetitions;
+  real_type min_time;
+  std::string filter;
+  std::vector<KernelResult> results;
+};
+
+template <typename Kernel>
+static void run(BenchmarkSetup& setup,
+                const std::string& name,
+                const std::string& matrix,
+                index_type n,
+                index_type nnz,
+                real_type flops,
+                real_type bytes,
+                Kernel kernel);
+static void benchmarkMatrix(BenchmarkSetup& setup,
+                            ReSolve::MatrixHandler& matrix_handler,
+                            const std::string& label,
+                            ReSolve::matrix::Csr* A);
+static void benchmarkVectors(BenchmarkSetup& setup, ReSolve::VectorHandler& vector_handler, index_type n, index_type m);
+static void benchmarkGramSchmidt(BenchmarkSetup& setup, ReSolve::VectorHandler& vector_handler, index_type n, index_type m);
+static void benchmarkSketching(BenchmarkSetup& setup, index_type n, index_type m);
+static void fillVector(vector_type& x, real_type shift);
+static void writeReport(std::ostream& out, const BenchmarkSetup& setup, real_type stream_gbs);
+
+int main(int argc, char *argv[])
+{
+  ReSolve::CliOptions options(argc, argv);
+  ReSolve::CliOptions::Option* opt = nullptr;
+
+  opt = options.getParamFromKey("-n");
+  const index_type grid = opt ? atoi((*opt).second.c_str()) : 1000;
+
+  opt = options.getParamFromKey("-m");
+  const index_type m = opt ? atoi((*opt).second.c_str()) : 20;
+
+  opt = options.getParamFromKey("-s");
+  const index_type stream_size = opt ? atoi((*opt).second.c_str()) : 20000000;
+
+  opt = options.getParamFromKey("-d");
+  const std::string data_dir = opt ? (*opt).second : "";
+
+  opt = options.getParamFromKey("-o");
+  const std::string output_file = opt ? (*opt).second : "";
+
+  BenchmarkSetup setup;
+  opt = options.getParamFromKey("-r");
+  setup.repetitions = opt ? atoi((*opt).second.c_str()) : 10;
+  opt = options.getParamFromKey("-t");
+  setup.min_time = opt ? atof((*opt).second.c_str()) : 0.01;
+  opt = options.getParamFromKey("-k");
+  setup.filter = opt ? (*opt).second : "";
+
+  if (grid < 2 || m < 2 || setup.repetitions < 1 || stream_size < 1) {
+    std::cout << "Invalid benchmark parameters.\n";
+    return 1;
+  }
+
+  const real_type stream_gbs = ReSolve::benchmark::streamTriadBandwidth(stream_size, setup.repetitions);
+  std::cout << "Kernel benchmark: threads = " << ReSolve::threads::getNumThreads()
+            << ", repetitions = " << setup.repetitions
+            << ", STREAM triad = " << std::fixed << std::setprecision(2) << stream_gbs << " GB/s\n\n";
+
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  workspace.initializeHandles();
+  ReSolve::MatrixHandler matrix_handler(&workspace);
+  ReSolve::VectorHandler vector_handler(&workspace);
+
+  // Synthetic matrix, always available
+  ReSolve::matrix::Csr* A = ReSolve::benchmark::generateLaplacian2D(grid);
+  const index_type n = A->getNumRows();
+  benchmarkMatrix(setup, matrix_handler, "laplace2d_" + std::to_string(grid), A);
+  delete A;
+
+  // Power grid matrices from the test data, if present
+  if (!data_dir.empty()) {
+    const std::vector<std::string> names = {"ACTIVSg200", "ACTIVSg2000"};
+    for (const std::string& name : names) {
+      const std::string filename = data_dir + "/matrix_" + name + "_AC_10.mtx";
+      ReSolve::matrix::Csr* B = ReSolve::benchmark::readCsrMatrix(filename);
+      if (B == nullptr) {
+        std::cout << "Skipping " << name << ": cannot read " << filename << "\n";
+        continue;
+      }
+      benchmarkMatrix(setup, matrix_handler, name, B);
+      delete B;
+    }
+  }
+
+  benchmarkVectors(setup, vector_handler, n, m);
+  benchmarkGramSchmidt(setup, vector_handler, n, m);
+  benchmarkSketching(setup, n, m);
+
+  std::cout << "\n" << std::left << std::setw(24) << "kernel"
+            << std::setw(20) << "matrix"
+            << std::right << std::setw(14) << "time [s]"
+            << std::setw(12) << "GFLOP/s"
+            << std::setw(12) << "GB/s"
+            << std::setw(12) << "% STREAM" << "\n";
+  for (const KernelResult& r : setup.results) {
+    const real_type t = r.time.median;
+    std::cout << std::left << std::setw(24) << r.name
+              << std::setw(20) << r.matrix
+              << std::right << std::setw(14) << std::scientific << std::setprecision(4) << t
+              << std::fixed << std::setprecision(3)
+              << std::setw(12) << r.flops / t * 1e-9
+              << std::setw(12) << r.bytes / t * 1e-9
+              << std::setw(12) << std::setprecision(1) << 100.0 * r.bytes / t * 1e-9 / stream_gbs << "\n";
+  }
+
+  if (!output_file.empty()) {
+    std::ofstream out(output_file);
+    if (!out.is_open()) {
+      std::cout << "Cannot open output file " << output_file << "\n";
+      return 1;
+    }
+    writeReport(out, setup, stream_gbs);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Times kernel if its name matches the filter and stores result.
+ */
+template <typename Kernel>
+void run(BenchmarkSetup& setup,
+         const std::string& name,
+         const std::string& matrix,
+         index_type n,
+         index_type nnz,
+         real_type flops,
+         real_type bytes,
+         Kernel kernel)
+{
+  if (!setup.filter.empty() && name.find(setup.filter) == std::string::npos) {
+    return;
+  }
+  KernelResult result;
+  result.name   = name;
+  result.matrix = matrix;
+  result.n      = n;
+  result.nnz    = nnz;
+  result.flops  = flops;
+  result.bytes  = bytes;
+  result.time   = ReSolve::benchmark::timeKernel(kernel, setup.repetitions, setup.min_time);
+  setup.results.push_back(result);
+}
+
+/**
+ * @brief Benchmarks sparse matrix kernels: matrix-vector product, format
+ * conversions and infinity norm.
+ */
+void benchmarkMatrix(BenchmarkSetup& setup,
+                     ReSolve::MatrixHandler& matrix_handler,
+                     const std::string& label,
+                     ReSolve::matrix::Csr* A)
+{
+  using ReSolve::memory::HOST;
+  const index_type n   = A->getNumRows();
+  const index_type nnz = A->getNnz();
+  const real_type idx  = sizeof(index_type);
+  const real_type val  = sizeof(real_type);
+
+  index_type* rows = A->getRowData(HOST);
+  index_type* cols = A->getColData(HOST);
+  real_type*  vals = A->getValues(HOST);
+
+  vector_type x(n);
+  vector_type y(n);
+  x.allocate(HOST);
+  y.allocate(HOST);
+  fillVector(x, 0.0);
+  y.setToZero(HOST);
+  matrix_handler.setValuesChanged(true, HOST);
+
+  run(setup, "matvec_csr", label, n, nnz,
+      2.0 * nnz,
+      nnz * (val + idx) + (n + 1) * idx + 2.0 * n * val,
+      [&]() {
+        matrix_handler.matvec(A, &x, &y, &ONE, &ZERO, "csr", HOST);
+      });
+
+  // CSR arrays of A are CSC arrays of its transpose.
+  ReSolve::matrix::Csc At(n, n, nnz);
+  At.updateData(cols, rows, vals, HOST, HOST);
+  ReSolve::matrix::Csr B(n, n, nnz);
+  B.allocateMatrixData(HOST);
+  run(setup, "csc2csr", label, n, nnz,
+      0.0,
+      2.0 * (nnz * (val + idx) + (n + 1) * idx),
+      [&]() {
+        matrix_handler.csc2csr(&At, &B, HOST);
+      });
+
+  std::vector<index_type> coo_rows(static_cast<size_t>(nnz));
+  for (index_type i = 0; i < n; ++i) {
+    for (index_type j = rows[i]; j < rows[i + 1]; ++j) {
+      coo_rows[j] = i;
+    }
+  }
+  ReSolve::matrix::Coo A_coo(n, n, nnz);
+  A_coo.updateData(coo_rows.data(), cols, vals, HOST, HOST);
+  ReSolve::matrix::Csr C(n, n, nnz);
+  run(setup, "coo2csr", label, n, nnz,
+      0.0,
+      nnz * (2.0 * idx + val) + nnz * (val + idx) + (n + 1) * idx,
+      [&]() {
+        matrix_handler.coo2csr(&A_coo, &C, HOST);
+      });
+
+  real_type norm = 0.0;
+  run(setup, "matrixInfNorm", label, n, nnz,
+      static_cast<real_type>(nnz),
+      nnz * val + (n + 1) * idx,
+      [&]() {
+        matrix_handler.matrixInfNorm(A, &norm, HOST);
+      });
+}
+
+/**
+ * @brief Benchmarks all VectorHandler operations on vectors of size n and
+ * multivectors with m vectors.
+ */
+void benchmarkVectors(BenchmarkSetup& setup, ReSolve::VectorHandler& vector_handler, index_type n, index_type m)
+{
+  using ReSolve::memory::HOST;
+  const real_type val = sizeof(real_type);
+  const std::string label = "n=" + std::to_string(n);
+
+  vector_type x(n);
+  vector_type y(n);
+  vector_type V(n, m);
+  vector_type X(n, 2);
+  vector_type alpha(m);
+  vector_type res(m, 2);
+  x.allocate(HOST);
+  y.allocate(HOST);
+  V.allocate(HOST);
+  X.allocate(HOST);
+  alpha.allocate(HOST);
+  res.allocate(HOST);
+  fillVector(x, 0.0);
+  fillVector(y, 0.5);
+  fillVector(V, 0.25);
+  fillVector(X, 0.75);
+  alpha.setToConst(1e-3, HOST);
+
+  // Scaling factors keep values bounded over many repetitions.
+  const real_type a = 1e-8;
+  const real_type s = 1.0;
+
+  real_type result = 0.0;
+  run(setup, "dot", label, n, 0, 2.0 * n, 2.0 * n * val, [&]() {
+    result += vector_handler.dot(&x, &y, HOST);
+  });
+  run(setup, "axpy", label, n, 0, 2.0 * n, 3.0 * n * val, [&]() {
+    vector_handler.axpy(&a, &x, &y, HOST);
+  });
+  run(setup, "scal", label, n, 0, static_cast<real_type>(n), 2.0 * n * val, [&]() {
+    vector_handler.scal(&s, &y, HOST);
+  });
+  run(setup, "infNorm", label, n, 0, static_cast<real_type>(n), n * val, [&]() {
+    result += vector_handler.infNorm(&x, HOST);
+  });
+  run(setup, "massAxpy", label, n, 0, 2.0 * n * m, (n * m + 2.0 * n + m) * val, [&]() {
+    vector_handler.massAxpy(n, &alpha, m, &V, &y, HOST);
+  });
+  run(setup, "massDot2Vec", label, n, 0, 4.0 * n * m, (n * m + 2.0 * n + 2.0 * m) * val, [&]() {
+    vector_handler.massDot2Vec(n, &V, m, &X, &res, HOST);
+  });
+  run(setup, "gemv_T", label, n, 0, 2.0 * n * m, (n * m + n + m) * val, [&]() {
+    vector_handler.gemv('T', n, m, &ONE, &ZERO, &V, &x, &alpha, HOST);
+  });
+  alpha.setToConst(1e-3, HOST);
+  run(setup, "gemv_N", label, n, 0, 2.0 * n * m, (n * m + 2.0 * n + m) * val, [&]() {
+    vector_handler.gemv('N', n, m, &ONE, &ZERO, &V, &alpha, &y, HOST);
+  });
+
+  if (!std::isfinite(result)) {
+    std::cout << "Warning: non-finite result in vector kernels\n";
+  }
+}
+
+/**
+ * @brief Benchmarks Gram-Schmidt variants by orthogonalizing a basis of
+ * m + 1 vectors as in one restart cycle of FGMRES.
+ *
+ * After the first call the basis is already orthonormal, but the work done
+ * by each variant does not depend on the data.
+ */
+void benchmarkGramSchmidt(BenchmarkSetup& setup, ReSolve::VectorHandler& vector_handler, index_type n, index_type m)
+{
+  using ReSolve::memory::HOST;
+  const std::vector<std::pair<std::string, ReSolve::GramSchmidt::GSVariant> > variants = {
+    {"mgs",           ReSolve::GramSchmidt::mgs},
+    {"cgs1",          ReSolve::GramSchmidt::cgs1},
+    {"cgs2",          ReSolve::GramSchmidt::cgs2},
+    {"mgs_two_sync",  ReSolve::GramSchmidt::mgs_two_sync},
+    {"mgs_pm",        ReSolve::GramSchmidt::mgs_pm},
+    {"mgs_one_sync",  ReSolve::GramSchmidt::mgs_one_sync},
+    {"cgs2_two_sync", ReSolve::GramSchmidt::cgs2_two_sync},
+    {"rgs",           ReSolve::GramSchmidt::rgs},
+    {"dcgs2",         ReSolve::GramSchmidt::dcgs2}
+  };
+  const std::string label = "n=" + std::to_string(n) + ",m=" + std::to_string(m);
+
+  // Same model as iterative solver counters: one projection and one
+  // update pass over the previous basis vectors per step.
+  real_type flops = 0.0;
+  real_type bytes = 0.0;
+  for (index_type i = 0; i < m; ++i) {
+    flops += 4.0 * (i + 1) * n;
+    bytes += 2.0 * (i + 2) * n * sizeof(real_type);
+  }
+
+  vector_type V(n, m + 1);
+  V.allocate(HOST);
+  std::vector<real_type> H(static_cast<size_t>(m) * static_cast<size_t>(m + 1));
+
+  for (const auto& variant : variants) {
+    ReSolve::GramSchmidt GS(&vector_handler, variant.second);
+    GS.setup(n, m);
+
+    fillVector(V, 0.1);
+    vector_type v0(n);
+    v0.setData(V.getVectorData(0, HOST), HOST);
+    real_type t = 1.0 / std::sqrt(vector_handler.dot(&v0, &v0, HOST));
+    vector_handler.scal(&t, &v0, HOST);
+
+    run(setup, "gs_" + variant.first, label, n, 0, flops, bytes, [&]() {
+      for (index_type i = 0; i < m; ++i) {
+        GS.orthogonalize(n, &V, H.data(), i);
+      }
+      GS.completeDelayed(n, &V, H.data(), m - 1);
+    });
+  }
+}
+
+/**
+ * @brief Benchmarks sketching methods with sketch sizes chosen as in
+ * randomized FGMRES with restart m, one vector at a time and for the
+ * m + 1 vectors of a Krylov basis at once.
+ */
+void benchmarkSketching(BenchmarkSetup& setup, index_type n, index_type m)
+{
+  using ReSolve::memory::HOST;
+  using SketchingMethod = ReSolve::LinSolverIterativeRandFGMRES::SketchingMethod;
+  const std::vector<std::pair<std::string, SketchingMethod> > methods = {
+    {"cs",   ReSolve::LinSolverIterativeRandFGMRES::cs},
+    {"fwht", ReSolve::LinSolverIterativeRandFGMRES::fwht},
+    {"sse",  ReSolve::LinSolverIterativeRandFGMRES::sse},
+    {"srht", ReSolve::LinSolverIterativeRandFGMRES::srht}
+  };
+  const real_type val = sizeof(real_type);
+  const real_type idx = sizeof(index_type);
+  const real_type log_n = std::log(static_cast<real_type>(n));
+  const index_type N = static_cast<index_type>(std::pow(2.0, std::ceil(std::log2(static_cast<real_type>(n)))));
+  const real_type log2_N = std::log2(static_cast<real_type>(N));
+
+  vector_type x(n);
+  x.allocate(HOST);
+  fillVector(x, 0.0);
+
+  for (const auto& method : methods) {
+    ReSolve::SketchingHandler sketching(method.second, ReSolve::memory::NONE);
+    if (!sketching.isSupported()) {
+      continue;
+    }
+
+    index_type k = 0;
+    real_type flops = 0.0;
+    real_type bytes = 0.0;
+    switch (method.second) {
+      case ReSolve::LinSolverIterativeRandFGMRES::cs:
+        k = static_cast<index_type>(std::ceil(m * log_n));
+        flops = static_cast<real_type>(n);
+        bytes = n * (2.0 * val + idx);
+        break;
+      case ReSolve::LinSolverIterativeRandFGMRES::sse:
+        k = static_cast<index_type>(std::ceil(m * log_n));
+        flops = 2.0 * 8 * n;
+        bytes = n * val + 8.0 * n * (val + idx);
+        break;
+      default:
+        k = static_cast<index_type>(std::ceil(2.0 * m * log_n / std::log(static_cast<real_type>(m))));
+        flops = N * log2_N + n;
+        bytes = 2.0 * n * val + 2.0 * N * val;
+        break;
+    }
+    k = std::min(k, n);
+    bytes += k * (val + idx);
+
+    vector_type y(k);
+    y.allocate(HOST);
+    y.setToZero(HOST);
+    sketching.setup(n, k);
+
+    run(setup, "sketch_" + method.first, "n=" + std::to_string(n) + ",k=" + std::to_string(k), n, 0, flops, bytes, [&]() {
+      sketching.Theta(&x, &y);
+    });
+
+    // Whole Krylov basis of one restart cycle in one call. Sparse
+    // embeddings are read once per block rather than once per vector.
+    const index_type num_vecs = m + 1;
+    const real_type vec_bytes = (n + k) * val;
+    const bool is_sparse = (method.second == ReSolve::LinSolverIterativeRandFGMRES::cs) ||
+                           (method.second == ReSolve::LinSolverIterativeRandFGMRES::sse);
+    const real_type block_bytes = is_sparse ? (bytes + (num_vecs - 1) * vec_bytes) : (num_vecs * bytes);
+    vector_type X(n, num_vecs);
+    X.allocate(HOST);
+    fillVector(X, 0.0);
+    vector_type Y(k, num_vecs);
+    Y.allocate(HOST);
+    Y.setToZero(HOST);
+
+    const std::string block_label = "n=" + std::to_string(n) + ",k=" + std::to_string(k)
+                                  + ",vecs=" + std::to_string(num_vecs);
+    run(setup, "sketch_block_" + method.first, block_label, n, 0,
+        num_vecs * flops,
+        block_bytes,
+        [&]() {
+          sketching.Theta(&X, &Y, num_vecs);
+        });
+  }
+}
+
+/**
+ * @brief Fills all vectors in x with smooth nonzero values.
+ */
+void fillVector(vector_type& x, real_type shift)
+{
+  const index_type size = x.getSize() * x.getNumVectors();
+  real_type* data = x.getData(ReSolve::memory::HOST);
+  for (index_type i = 0; i < size; ++i) {
+    data[i] = std::sin(0.7 * static_cast<real_type>(i) + shift) + 0.1;
+  }
+  x.setDataUpdated(ReSolve::memory::HOST);
+}
+
+/**
+ * @brief Writes results as JSON.
+ *
+ * Roofline is the attainable performance min(peak, AI * bandwidth) with
+ * peak compute left out, i.e. AI * STREAM bandwidth.
+ */
+void writeReport(std::ostream& out, const BenchmarkSetup& setup, real_type stream_gbs)
+{
+  using ReSolve::benchmark::jsonString;
+  std::string version;
+  ReSolve::VersionGetVersionStr(version);
+
+  out << std::setprecision(9);
+  out << "{\n"
+      << "  \"benchmark\": \"kernel\",\n"
+      << "  \"version\": " << jsonString(version) << ",\n"
+      << "  \"num_threads\": " << ReSolve::threads::getNumThreads() << ",\n"
+      << "  \"repetitions\": " << setup.repetitions << ",\n"
+      << "  \"stream_triad_gbs\": " << stream_gbs << ",\n"
+      << "  \"results\": [";
+  for (size_t i = 0; i < setup.results.size(); ++i) {
+    const KernelResult& r = setup.results[i];
+    const real_type t = r.time.median;
+    const real_type gflops = (t > 0.0) ? r.flops / t * 1e-9 : 0.0;
+    const real_type gbs    = (t > 0.0) ? r.bytes / t * 1e-9 : 0.0;
+    const real_type ai     = (r.bytes > 0.0) ? r.flops / r.bytes : 0.0;
+    out << (i ? ",\n" : "\n")
+        << "    {\"name\": " << jsonString(r.name)
+        << ", \"matrix\": " << jsonString(r.matrix)
+        << ", \"n\": " << r.n
+        << ", \"nnz\": " << r.nnz
+        << ", \"flops\": " << r.flops
+        << ", \"bytes\": " << r.bytes
+        << ", \"time\": ";
+    ReSolve::benchmark::writeJson(out, r.time);
+    out << ", \"gflops\": " << gflops
+        << ", \"gbs\": " << gbs
+        << ", \"arithmetic_intensity\": " << ai
+        << ", \"roofline_gflops\": " << ai * stream_gbs
+        << ", \"bandwidth_efficiency\": " << ((stream_gbs > 0.0) ? gbs / stream_gbs : 0.0)
+        << "}";
+  }
+  out << "\n  ]\n}\n";
+}
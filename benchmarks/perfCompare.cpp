@@ -0,0 +1,206 @@
+/**
+ * @file perfCompare.cpp
+ * @brief Compares benchmark results with a baseline and reports
+ * performance regressions.
+ *
+ * Reads JSON reports of kernel_benchmark.exe or replay_benchmark.exe.
+ * Each measured quantity has a median and a median absolute deviation
+ * (MAD) over repetitions. A quantity regresses when its median increased
+ * by more than the relative threshold *and* the increase exceeds the noise
+ * level, i.e. `k` standard errors of the difference of medians. Standard
+ * error of a median of `n` samples is estimated as 1.253 sigma / sqrt(n),
+ * with sigma = 1.4826 MAD for normally distributed noise.
+ *
+ * Compared quantities:
+ *  - kernel benchmark: time of each kernel and matrix
+ *  - replay benchmark: time of the whole sequence, and median number of
+ *    iterations for each action
+ *
+ * Usage: perf_compare.exe -b <baseline JSON> -c <current JSON>
+ *                         [-t <relative threshold>] [-k <noise factor>]
+ *
+ * Returns 0 if there are no regressions, 1 otherwise.
+ */
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <resolve/Common.hpp>
+#include <resolve/utilities/params/CliOptions.hpp>
+
+#include "JsonReader.hpp"
+
+using real_type = ReSolve::real_type;
+using ReSolve::benchmark::JsonValue;
+
+/// Median and MAD of one measured quantity.
+struct Measurement
+{
+  real_type median;
+  real_type mad;
+  real_type count; ///< number of samples
+};
+
+static real_type standardError(const Measurement& m);
+
+using MeasurementMap = std::map<std::string, Measurement>;
+
+static bool extractMeasurements(const JsonValue& report, MeasurementMap& measurements);
+
+int main(int argc, char *argv[])
+{
+  ReSolve::CliOptions options(argc, argv);
+  ReSolve::CliOptions::Option* opt = nullptr;
+
+  opt = options.getParamFromKey("-b");
+  const std::string baseline_file = opt ? (*opt).second : "";
+  opt = options.getParamFromKey("-c");
+  const std::string current_file = opt ? (*opt).second : "";
+  opt = options.getParamFromKey("-t");
+  const real_type threshold = opt ? atof((*opt).second.c_str()) : 0.1;
+  opt = options.getParamFromKey("-k");
+  const real_type noise_factor = opt ? atof((*opt).second.c_str()) : 3.0;
+
+  if (baseline_file.empty() || current_file.empty()) {
+    std::cout << "Usage: " << argv[0] << " -b <baseline JSON> -c <current JSON> "
+              << "[-t <relative threshold>] [-k <noise factor>]\n";
+    return 1;
+  }
+
+  JsonValue baseline;
+  JsonValue current;
+  if (!ReSolve::benchmark::readJsonFile(baseline_file, baseline)) {
+    std::cout << "Cannot read baseline " << baseline_file << "\n";
+    return 1;
+  }
+  if (!ReSolve::benchmark::readJsonFile(current_file, current)) {
+    std::cout << "Cannot read results " << current_file << "\n";
+    return 1;
+  }
+  if (baseline.getString("benchmark") != current.getString("benchmark")) {
+    std::cout << "Baseline is for " << baseline.getString("benchmark")
+              << " benchmark, results are for " << current.getString("benchmark") << "\n";
+    return 1;
+  }
+
+  MeasurementMap base;
+  MeasurementMap curr;
+  if (!extractMeasurements(baseline, base) || !extractMeasurements(current, curr)) {
+    std::cout << "Unrecognized benchmark report format.\n";
+    return 1;
+  }
+
+  std::cout << "Comparing " << current_file << " with baseline " << baseline_file << "\n"
+            << "Threshold: " << 100.0 * threshold << " %, noise factor: " << noise_factor << "\n\n";
+  std::cout << std::left << std::setw(44) << "quantity"
+            << std::right << std::setw(14) << "baseline"
+            << std::setw(14) << "current"
+            << std::setw(10) << "change"
+            << "  verdict\n";
+
+  int num_regressions = 0;
+  for (const auto& entry : curr) {
+    const std::string& name = entry.first;
+    const Measurement& c = entry.second;
+    MeasurementMap::const_iterator it = base.find(name);
+    if (it == base.end()) {
+      std::cout << std::left << std::setw(44) << name << "  not in baseline\n";
+      continue;
+    }
+    const Measurement& b = it->second;
+    const real_type change = (b.median > 0.0) ? (c.median - b.median) / b.median : 0.0;
+    const real_type sigma  = std::sqrt(standardError(b) * standardError(b) + standardError(c) * standardError(c));
+    const real_type diff   = c.median - b.median;
+
+    std::string verdict = "ok";
+    if (change > threshold && diff > noise_factor * sigma) {
+      verdict = "REGRESSION";
+      ++num_regressions;
+    } else if (change < -threshold && -diff > noise_factor * sigma) {
+      verdict = "improved";
+    }
+    std::cout << std::left << std::setw(44) << name
+              << std::right << std::scientific << std::setprecision(4)
+              << std::setw(14) << b.median
+              << std::setw(14) << c.median
+              << std::fixed << std::setprecision(1)
+              << std::setw(9) << 100.0 * change << "%"
+              << "  " << verdict << "\n";
+  }
+  // A quantity that is no longer measured cannot be checked for regression
+  int num_missing = 0;
+  for (const auto& entry : base) {
+    if (curr.find(entry.first) == curr.end()) {
+      std::cout << std::left << std::setw(44) << entry.first << "  MISSING in results\n";
+      ++num_missing;
+    }
+  }
+
+  if (num_missing > 0) {
+    std::cout << "\n" << num_missing << " baseline quantities missing in results.\n";
+  }
+  if (num_regressions > 0) {
+    std::cout << "\n" << num_regressions << " performance regression(s) found.\n";
+  }
+  if (num_regressions > 0 || num_missing > 0) {
+    return 1;
+  }
+  std::cout << "\nNo performance regressions found.\n";
+  return 0;
+}
+
+/**
+ * @brief Collects measured quantities from a benchmark report.
+ *
+ * @return false if the report format is not recognized
+ */
+bool extractMeasurements(const JsonValue& report, MeasurementMap& measurements)
+{
+  const std::string benchmark = report.getString("benchmark");
+  if (benchmark == "kernel") {
+    const JsonValue* results = report.find("results");
+    if (results == nullptr || results->type != JsonValue::array) {
+      return false;
+    }
+    for (const JsonValue& result : results->elements) {
+      const JsonValue* time = result.find("time");
+      if (time == nullptr) {
+        return false;
+      }
+      const std::string name = result.getString("name") + "/" + result.getString("matrix");
+      measurements[name] = {time->getNumber("median"), time->getNumber("mad"), time->getNumber("count", 1.0)};
+    }
+    return true;
+  }
+
+  if (benchmark == "replay") {
+    const JsonValue* sequence = report.find("sequence_time");
+    const JsonValue* summary  = report.find("summary");
+    if (sequence == nullptr || summary == nullptr || summary->type != JsonValue::array) {
+      return false;
+    }
+    measurements["sequence_time"] = {sequence->getNumber("median"),
+                                     sequence->getNumber("mad"),
+                                     sequence->getNumber("count", 1.0)};
+    for (const JsonValue& action : summary->elements) {
+      const JsonValue* iterations = action.find("iterations");
+      if (iterations != nullptr) {
+        // Iteration counts are deterministic, so they have no noise.
+        measurements["iterations/" + action.getString("action")] = {iterations->getNumber("p50"), 0.0, 1.0};
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
+
+/// Standard error of the median estimated from MAD.
+real_type standardError(const Measurement& m)
+{
+  const real_type sigma = 1.4826 * m.mad;
+  return 1.253 * sigma / std::sqrt(std::max(m.count, static_cast<real_type>(1.0)));
+}
@@ -0,0 +1,632 @@
+/**
+ * @file replayBenchmark.cpp
+ * @brief Replays a sequence of linear systems through a configurable
+ * SystemSolver and records per-system timings and accuracy.
+ *
+ * The sequence is given by matrix and right-hand side files as produced
+ * by Newton iterations, e.g. matrix_ACTIVSg200_AC_10.mtx, ..., with
+ * matching rhs files. All systems must have the same sparsity pattern.
+ * Files are read before timing starts.
+ *
+ * For each system the driver records time of the setup step (factorization,
+ * refactorization or preconditioner setup), time of the solve, per-phase
+ * times of the system solver and of its Krylov solver, number of iterations, relative residual and norm of
+ * scaled residuals. Percentiles over systems and median/MAD of the whole
+ * sequence time over repetitions are reported, optionally as JSON. With
+ * `-history`, the JSON report also contains convergence history of the
+ * Krylov solver for each system. Randomized solvers sample sketches with a
+ * fixed seed, so that iteration counts are comparable between runs.
+ *
+ * Usage: replay_benchmark.exe -m <matrix file prefix> -b <rhs file prefix>
+ *                             -f <first id> [-l <last id>] [-w <id width>]
+ *                             [-backend cpu|cuda|hip]
+ *                             [-factor <method>] [-refactor <method>]
+ *                             [-solve <method>] [-precond <method>]
+ *                             [-ir <method>] [-gs <variant>]
+ *                             [-sketch <method>] [-seed <sketching seed>]
+ *                             [-precision double|single]
+ *                             [-tol <tolerance>] [-maxit <iterations>]
+ *                             [-restart <restart>] [-adaptive] [-history]
+ *                             [-r <repetitions>] [-o <JSON output file>]
+ *
+ * Example: replay_benchmark.exe -m data/matrix_ACTIVSg200_AC_
+ *            -b data/rhs_ACTIVSg200_AC_ -f 10 -l 11
+ *            -factor none -refactor none -solve fgmres -precond ilu0
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <resolve/ConvergenceHistory.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/SolverStats.hpp>
+#include <resolve/SystemSolver.hpp>
+#include <resolve/matrix/Coo.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/matrix/MatrixHandler.hpp>
+#include <resolve/matrix/io.hpp>
+#include <resolve/utilities/params/CliOptions.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include <resolve/utilities/version/version.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+
+#include "BenchmarkUtils.hpp"
+
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+using ReSolve::ConvergenceHistory;
+using ReSolve::SolverStats;
+
+/// SystemSolver configuration used for the replay.
+struct SolverConfig
+{
+  std::string backend;
+  std::string factor;
+  std::string refactor;
+  std::string solve;
+  std::string precond;
+  std::string ir;
+  std::string gs;
+  std::string sketch;
+  unsigned seed; ///< seed of sketching matrices of randomized solvers
+  std::string precision;
+  real_type tol;
+  index_type maxit;
+  index_type restart;
+  bool adaptive;
+  bool history; ///< record convergence history of the Krylov solver
+};
+
+/// Sequence of systems read from files.
+struct SystemSeries
+{
+  std::vector<std::string> ids;
+  std::vector<ReSolve::matrix::Coo*> matrices;
+  std::vector<real_type*> rhs;
+
+  ~SystemSeries()
+  {
+    for (ReSolve::matrix::Coo* A : matrices) {
+      delete A;
+    }
+    for (real_type* b : rhs) {
+      delete [] b;
+    }
+  }
+};
+
+/// Measurements for one solved system.
+struct SystemRecord
+{
+  std::string id;
+  index_type repetition;
+  std::string action; ///< how factors or preconditioner were obtained
+  int status;
+  real_type time_setup;
+  real_type time_solve;
+  real_type time_total;
+  real_type phases[SolverStats::NUM_PHASES];        ///< SystemSolver phase times
+  real_type krylov_phases[SolverStats::NUM_PHASES]; ///< Krylov solver phase times
+  index_type iterations;
+  real_type residual;
+  real_type scaled_residual;
+  std::vector<ConvergenceHistory::Record> history;
+};
+
+static int readSeries(const std::string& matrix_prefix,
+                      const std::string& rhs_prefix,
+                      index_type first,
+                      index_type last,
+                      index_type width,
+                      SystemSeries& series);
+template <class WorkspaceType>
+static int replay(const SolverConfig& config,
+                  const SystemSeries& series,
+                  index_type repetition,
+                  std::vector<SystemRecord>& records,
+                  real_type& sequence_time);
+static void printSummary(const std::vector<SystemRecord>& records);
+static void writeReport(std::ostream& out,
+                        const SolverConfig& config,
+                        index_type repetitions,
+                        const std::vector<real_type>& sequence_times,
+                        const std::vector<SystemRecord>& records);
+
+int main(int argc, char *argv[])
+{
+  ReSolve::CliOptions options(argc, argv);
+  ReSolve::CliOptions::Option* opt = nullptr;
+
+  opt = options.getParamFromKey("-m");
+  const std::string matrix_prefix = opt ? (*opt).second : "";
+  opt = options.getParamFromKey("-b");
+  const std::string rhs_prefix = opt ? (*opt).second : "";
+  opt = options.getParamFromKey("-f");
+  const index_type first = opt ? atoi((*opt).second.c_str()) : 0;
+  opt = options.getParamFromKey("-l");
+  const index_type last = opt ? atoi((*opt).second.c_str()) : first;
+  opt = options.getParamFromKey("-w");
+  const index_type width = opt ? atoi((*opt).second.c_str()) : 2;
+  opt = options.getParamFromKey("-r");
+  const index_type repetitions = opt ? atoi((*opt).second.c_str()) : 1;
+  opt = options.getParamFromKey("-o");
+  const std::string output_file = opt ? (*opt).second : "";
+
+  SolverConfig config;
+  opt = options.getParamFromKey("-backend");
+  config.backend = opt ? (*opt).second : "cpu";
+  opt = options.getParamFromKey("-factor");
+  config.factor = opt ? (*opt).second : "klu";
+  opt = options.getParamFromKey("-refactor");
+  config.refactor = opt ? (*opt).second : "klu";
+  opt = options.getParamFromKey("-solve");
+  config.solve = opt ? (*opt).second : "klu";
+  opt = options.getParamFromKey("-precond");
+  config.precond = opt ? (*opt).second : "none";
+  opt = options.getParamFromKey("-ir");
+  config.ir = opt ? (*opt).second : "none";
+  opt = options.getParamFromKey("-gs");
+  config.gs = opt ? (*opt).second : "cgs2";
+  opt = options.getParamFromKey("-sketch");
+  config.sketch = opt ? (*opt).second : "count";
+  opt = options.getParamFromKey("-seed");
+  config.seed = opt ? static_cast<unsigned>(atol((*opt).second.c_str())) : 12345u;
+  opt = options.getParamFromKey("-precision");
+  config.precision = opt ? (*opt).second : "double";
+  opt = options.getParamFromKey("-tol");
+  config.tol = opt ? atof((*opt).second.c_str()) : 1e-12;
+  opt = options.getParamFromKey("-maxit");
+  config.maxit = opt ? atoi((*opt).second.c_str()) : 200;
+  opt = options.getParamFromKey("-restart");
+  config.restart = opt ? atoi((*opt).second.c_str()) : 100;
+  config.adaptive = options.hasKey("-adaptive");
+  config.history = options.hasKey("-history");
+
+  if (matrix_prefix.empty() || rhs_prefix.empty() || last < first || repetitions < 1) {
+    std::cout << "Usage: " << argv[0] << " -m <matrix file prefix> -b <rhs file prefix> "
+              << "-f <first id> [-l <last id>] [options]\n";
+    return 1;
+  }
+
+  SystemSeries series;
+  if (readSeries(matrix_prefix, rhs_prefix, first, last, width, series) != 0) {
+    return 1;
+  }
+
+  std::vector<SystemRecord> records;
+  std::vector<real_type> sequence_times;
+  int status = 0;
+  for (index_type r = 0; r < repetitions; ++r) {
+    real_type sequence_time = 0.0;
+    if (config.backend == "cpu") {
+      status += replay<ReSolve::LinAlgWorkspaceCpu>(config, series, r, records, sequence_time);
+#ifdef RESOLVE_USE_CUDA
+    } else if (config.backend == "cuda") {
+      status += replay<ReSolve::LinAlgWorkspaceCUDA>(config, series, r, records, sequence_time);
+#endif
+#ifdef RESOLVE_USE_HIP
+    } else if (config.backend == "hip") {
+      status += replay<ReSolve::LinAlgWorkspaceHIP>(config, series, r, records, sequence_time);
+#endif
+    } else {
+      std::cout << "Backend " << config.backend << " is not available.\n";
+      return 1;
+    }
+    sequence_times.push_back(sequence_time);
+  }
+
+  printSummary(records);
+  const ReSolve::benchmark::Statistics sequence = ReSolve::benchmark::summarize(sequence_times);
+  std::cout << "\nSequence time [s]: median " << std::scientific << std::setprecision(4) << sequence.median
+            << ", MAD " << sequence.mad << " over " << repetitions << " repetition(s)\n";
+
+  if (!output_file.empty()) {
+    std::ofstream out(output_file);
+    if (!out.is_open()) {
+      std::cout << "Cannot open output file " << output_file << "\n";
+      return 1;
+    }
+    writeReport(out, config, repetitions, sequence_times, records);
+  }
+
+  if (status != 0) {
+    std::cout << "Some of the systems were not solved successfully.\n";
+  }
+  return (status == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Reads matrices and right-hand sides with ids first, ..., last.
+ *
+ * File names are prefix + id + ".mtx", with id padded with zeros to width.
+ */
+int readSeries(const std::string& matrix_prefix,
+               const std::string& rhs_prefix,
+               index_type first,
+               index_type last,
+               index_type width,
+               SystemSeries& series)
+{
+  for (index_type i = first; i <= last; ++i) {
+    std::ostringstream id;
+    id << std::setw(width) << std::setfill('0') << i;
+    const std::string matrix_file = matrix_prefix + id.str() + ".mtx";
+    const std::string rhs_file    = rhs_prefix + id.str() + ".mtx";
+
+    std::ifstream mat(matrix_file);
+    if (!mat.is_open()) {
+      std::cout << "Failed to open file " << matrix_file << "\n";
+      return 1;
+    }
+    std::ifstream rhs(rhs_file);
+    if (!rhs.is_open()) {
+      std::cout << "Failed to open file " << rhs_file << "\n";
+      return 1;
+    }
+    series.ids.push_back(id.str());
+    series.matrices.push_back(ReSolve::io::readMatrixFromFile(mat));
+    series.rhs.push_back(ReSolve::io::readRhsFromFile(rhs));
+
+    ReSolve::matrix::Coo* A  = series.matrices.back();
+    ReSolve::matrix::Coo* A0 = series.matrices.front();
+    if (A->getNumRows() != A0->getNumRows() || A->getNnz() != A0->getNnz()) {
+      std::cout << "Matrix " << matrix_file << " does not match the first matrix in the sequence.\n";
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Solves all systems in the series with a new SystemSolver.
+ *
+ * The first system is factorized. Subsequent systems are refactorized if a
+ * refactorization method is selected, or factorized again otherwise. Without
+ * factorization, the preconditioner (if any) is recomputed for each system
+ * before the Krylov solve. In adaptive mode, the refactorization policy of
+ * the solver decides what to do for each system.
+ *
+ * @return 0 if all systems were solved successfully, number of failures
+ * otherwise.
+ */
+template <class WorkspaceType>
+int replay(const SolverConfig& config,
+           const SystemSeries& series,
+           index_type repetition,
+           std::vector<SystemRecord>& records,
+           real_type& sequence_time)
+{
+  using clock = std::chrono::steady_clock;
+  using ReSolve::memory::HOST;
+
+  WorkspaceType workspace;
+  workspace.initializeHandles();
+  ReSolve::MatrixHandler matrix_handler(&workspace);
+  ReSolve::memory::MemorySpace memspace = HOST;
+  if (matrix_handler.getIsCudaEnabled() || matrix_handler.getIsHipEnabled()) {
+    memspace = ReSolve::memory::DEVICE;
+  }
+
+  ReSolve::SystemSolver solver(&workspace, config.factor, config.refactor, config.solve, config.precond, config.ir);
+  // Constructor does not report errors, so check the configuration is
+  // available in this build before using the solver.
+  if (solver.initialize() != 0) {
+    std::cout << "Solver configuration is not available in this build.\n";
+    return static_cast<int>(series.ids.size());
+  }
+  const bool is_krylov = (config.solve == "fgmres" || config.solve == "randgmres");
+  const bool has_iterative = is_krylov || (config.ir == "fgmres");
+  const bool has_factorization = (config.factor != "none");
+  const bool has_refactorization_setup = (config.refactor != "none" && config.refactor != "klu");
+  if (is_krylov || config.ir == "fgmres") {
+    solver.setGramSchmidtMethod(config.gs);
+  }
+  if (config.precond != "none") {
+    solver.setPreconditionerPrecision(config.precision);
+  }
+  if (has_iterative) {
+    solver.getIterativeSolver().setTol(config.tol);
+    solver.getIterativeSolver().setMaxit(config.maxit);
+    solver.getIterativeSolver().setRestart(config.restart);
+    if (config.history) {
+      ConvergenceHistory& history = solver.getIterativeSolver().getConvergenceHistory();
+      history.setCapacity(config.maxit);
+      history.setOrthogonalityTracking(true);
+    }
+  }
+  if (config.solve == "randgmres") {
+    solver.setSketchingSeed(config.seed);
+  }
+
+  ReSolve::matrix::Coo* A0 = series.matrices.front();
+  const index_type n = A0->getNumRows();
+  ReSolve::matrix::Csr A(n, A0->getNumColumns(), A0->getNnz(), A0->symmetric(), A0->expanded());
+  vector_type rhs(n);
+  vector_type x(n);
+  rhs.allocate(memspace);
+  x.allocate(memspace);
+
+  int failures = 0;
+  sequence_time = 0.0;
+  for (std::size_t i = 0; i < series.ids.size(); ++i) {
+    A.updateFromCoo(series.matrices[i], memspace);
+    rhs.update(series.rhs[i], HOST, memspace);
+    x.setToZero(memspace);
+
+    SystemRecord record;
+    record.id         = series.ids[i];
+    record.repetition = repetition;
+    record.iterations = 0;
+    const SolverStats before = solver.getStats();
+    const SolverStats krylov_before = has_iterative ? solver.getIterativeSolver().getStats() : SolverStats();
+
+    int status = 0;
+    clock::time_point start = clock::now();
+    status += solver.setMatrix(&A);
+    if (i == 0 && config.solve == "randgmres") {
+      status += solver.setSketchingMethod(config.sketch);
+    }
+
+    if (config.adaptive) {
+      record.action = "adaptive";
+    } else if (has_factorization) {
+      if (i == 0 || config.refactor == "none") {
+        record.action = "factorize";
+        if (i == 0) {
+          status += solver.analyze();
+        }
+        status += solver.factorize();
+        if (i == 0 && has_refactorization_setup) {
+          status += solver.refactorizationSetup();
+        }
+      } else {
+        record.action = "refactorize";
+        status += solver.refactorize();
+      }
+    } else if (config.precond != "none") {
+      record.action = "precondition";
+      status += solver.preconditionerSetup();
+    } else {
+      record.action = "solve";
+    }
+    clock::time_point setup_end = clock::now();
+
+    if (config.adaptive) {
+      status += solver.solveAdaptive(&rhs, &x);
+    } else {
+      status += solver.solve(&rhs, &x);
+      // On device, iterative refinement is done by solve().
+      if (memspace == HOST && config.ir == "fgmres" && has_refactorization_setup) {
+        status += solver.refine(&rhs, &x);
+      }
+    }
+    clock::time_point end = clock::now();
+
+    record.status     = status;
+    record.time_setup = std::chrono::duration<real_type>(setup_end - start).count();
+    record.time_solve = std::chrono::duration<real_type>(end - setup_end).count();
+    record.time_total = std::chrono::duration<real_type>(end - start).count();
+    for (int phase = 0; phase < SolverStats::NUM_PHASES; ++phase) {
+      const SolverStats::Phase p = static_cast<SolverStats::Phase>(phase);
+      record.phases[phase] = solver.getStats().getTime(p) - before.getTime(p);
+      record.krylov_phases[phase] = 0.0;
+      if (has_iterative) {
+        record.krylov_phases[phase] = solver.getIterativeSolver().getStats().getTime(p) - krylov_before.getTime(p);
+      }
+    }
+    if (has_iterative) {
+      record.iterations = solver.getIterativeSolver().getNumIter();
+      record.history    = solver.getIterativeSolver().getConvergenceHistory().getRecords();
+    }
+    record.residual        = solver.getResidualNorm(&rhs, &x);
+    record.scaled_residual = solver.getNormOfScaledResiduals(&rhs, &x);
+
+    if (status != 0 || !std::isfinite(record.residual)) {
+      ++failures;
+    }
+    sequence_time += record.time_total;
+    records.push_back(record);
+  }
+  return failures;
+}
+
+/// Values of one field of records with given action ("all" for every record).
+template <typename Field>
+static std::vector<real_type> collect(const std::vector<SystemRecord>& records, const std::string& action, Field field)
+{
+  std::vector<real_type> values;
+  for (const SystemRecord& r : records) {
+    if (action == "all" || r.action == action) {
+      values.push_back(static_cast<real_type>(field(r)));
+    }
+  }
+  return values;
+}
+
+/// Actions present in records, preceded by "all".
+static std::vector<std::string> getActions(const std::vector<SystemRecord>& records)
+{
+  std::vector<std::string> actions(1, "all");
+  for (const SystemRecord& r : records) {
+    if (std::find(actions.begin(), actions.end(), r.action) == actions.end()) {
+      actions.push_back(r.action);
+    }
+  }
+  return actions;
+}
+
+/**
+ * @brief Prints per-system results and percentiles of total time.
+ */
+void printSummary(const std::vector<SystemRecord>& records)
+{
+  using ReSolve::benchmark::percentile;
+
+  std::cout << std::left << std::setw(8) << "system"
+            << std::setw(6) << "rep"
+            << std::setw(14) << "action"
+            << std::right << std::setw(14) << "setup [s]"
+            << std::setw(14) << "solve [s]"
+            << std::setw(8) << "iter"
+            << std::setw(14) << "||r||/||b||"
+            << std::setw(8) << "status" << "\n";
+  for (const SystemRecord& r : records) {
+    std::cout << std::left << std::setw(8) << r.id
+              << std::setw(6) << r.repetition
+              << std::setw(14) << r.action
+              << std::right << std::scientific << std::setprecision(4)
+              << std::setw(14) << r.time_setup
+              << std::setw(14) << r.time_solve
+              << std::setw(8) << r.iterations
+              << std::setw(14) << r.residual
+              << std::setw(8) << r.status << "\n";
+  }
+
+  std::cout << "\n" << std::left << std::setw(14) << "action"
+            << std::right << std::setw(8) << "count"
+            << std::setw(14) << "p50 [s]"
+            << std::setw(14) << "p90 [s]"
+            << std::setw(14) << "p99 [s]"
+            << std::setw(14) << "max [s]"
+            << std::setw(10) << "p50 iter" << "\n";
+  for (const std::string& action : getActions(records)) {
+    std::vector<real_type> times = collect(records, action, [](const SystemRecord& r) { return r.time_total; });
+    std::vector<real_type> iters = collect(records, action, [](const SystemRecord& r) { return r.iterations; });
+    std::cout << std::left << std::setw(14) << action
+              << std::right << std::setw(8) << times.size()
+              << std::scientific << std::setprecision(4)
+              << std::setw(14) << percentile(times, 50.0)
+              << std::setw(14) << percentile(times, 90.0)
+              << std::setw(14) << percentile(times, 99.0)
+              << std::setw(14) << percentile(times, 100.0)
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << percentile(iters, 50.0) << "\n";
+  }
+}
+
+/// Writes percentiles of values as JSON object.
+static void writePercentiles(std::ostream& out, const std::vector<real_type>& values)
+{
+  using ReSolve::benchmark::percentile;
+  out << "{\"min\": " << percentile(values, 0.0)
+      << ", \"p50\": " << percentile(values, 50.0)
+      << ", \"p90\": " << percentile(values, 90.0)
+      << ", \"p99\": " << percentile(values, 99.0)
+      << ", \"max\": " << percentile(values, 100.0) << "}";
+}
+
+/**
+ * @brief Writes configuration, summary and per-system records as JSON.
+ */
+void writeReport(std::ostream& out,
+                 const SolverConfig& config,
+                 index_type repetitions,
+                 const std::vector<real_type>& sequence_times,
+                 const std::vector<SystemRecord>& records)
+{
+  using ReSolve::benchmark::jsonString;
+  std::string version;
+  ReSolve::VersionGetVersionStr(version);
+
+  out << std::setprecision(9);
+  out << "{\n"
+      << "  \"benchmark\": \"replay\",\n"
+      << "  \"version\": " << jsonString(version) << ",\n"
+      << "  \"num_threads\": " << ReSolve::threads::getNumThreads() << ",\n"
+      << "  \"config\": {"
+      << "\"backend\": " << jsonString(config.backend)
+      << ", \"factor\": " << jsonString(config.factor)
+      << ", \"refactor\": " << jsonString(config.refactor)
+      << ", \"solve\": " << jsonString(config.solve)
+      << ", \"precond\": " << jsonString(config.precond)
+      << ", \"ir\": " << jsonString(config.ir)
+      << ", \"gs\": " << jsonString(config.gs)
+      << ", \"sketch\": " << jsonString(config.sketch)
+      << ", \"seed\": " << config.seed
+      << ", \"precision\": " << jsonString(config.precision)
+      << ", \"tol\": " << config.tol
+      << ", \"maxit\": " << config.maxit
+      << ", \"restart\": " << config.restart
+      << ", \"adaptive\": " << (config.adaptive ? "true" : "false")
+      << ", \"history\": " << (config.history ? "true" : "false") << "},\n"
+      << "  \"repetitions\": " << repetitions << ",\n"
+      << "  \"sequence_time\": ";
+  ReSolve::benchmark::writeJson(out, ReSolve::benchmark::summarize(sequence_times));
+  out << ",\n  \"summary\": [";
+
+  const std::vector<std::string> actions = getActions(records);
+  for (std::size_t a = 0; a < actions.size(); ++a) {
+    const std::string& action = actions[a];
+    out << (a ? ",\n" : "\n")
+        << "    {\"action\": " << jsonString(action)
+        << ", \"count\": " << collect(records, action, [](const SystemRecord&) { return 1; }).size()
+        << ", \"time_total\": ";
+    writePercentiles(out, collect(records, action, [](const SystemRecord& r) { return r.time_total; }));
+    out << ", \"time_setup\": ";
+    writePercentiles(out, collect(records, action, [](const SystemRecord& r) { return r.time_setup; }));
+    out << ", \"time_solve\": ";
+    writePercentiles(out, collect(records, action, [](const SystemRecord& r) { return r.time_solve; }));
+    out << ", \"iterations\": ";
+    writePercentiles(out, collect(records, action, [](const SystemRecord& r) { return r.iterations; }));
+    out << ", \"residual\": ";
+    writePercentiles(out, collect(records, action, [](const SystemRecord& r) { return r.residual; }));
+    out << "}";
+  }
+  out << "\n  ],\n  \"systems\": [";
+
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    const SystemRecord& r = records[i];
+    out << (i ? ",\n" : "\n")
+        << "    {\"id\": " << jsonString(r.id)
+        << ", \"repetition\": " << r.repetition
+        << ", \"action\": " << jsonString(r.action)
+        << ", \"status\": " << r.status
+        << ", \"time_setup\": " << r.time_setup
+        << ", \"time_solve\": " << r.time_solve
+        << ", \"time_total\": " << r.time_total
+        << ", \"iterations\": " << r.iterations
+        << ", \"residual\": " << r.residual
+        << ", \"scaled_residual\": " << r.scaled_residual
+        << ", \"phases\": {";
+    for (int phase = 0; phase < SolverStats::NUM_PHASES; ++phase) {
+      out << (phase ? ", " : "")
+          << jsonString(SolverStats::getPhaseName(static_cast<SolverStats::Phase>(phase)))
+          << ": " << r.phases[phase];
+    }
+    out << "}, \"krylov_phases\": {";
+    for (int phase = 0; phase < SolverStats::NUM_PHASES; ++phase) {
+      out << (phase ? ", " : "")
+          << jsonString(SolverStats::getPhaseName(static_cast<SolverStats::Phase>(phase)))
+          << ": " << r.krylov_phases[phase];
+    }
+    out << "}";
+    if (!r.history.empty()) {
+      out << ", \"history\": [";
+      for (std::size_t k = 0; k < r.history.size(); ++k) {
+        const ConvergenceHistory::Record& h = r.history[k];
+        out << (k ? ",\n      " : "\n      ")
+            << "{\"iteration\": " << h.iteration
+            << ", \"cycle\": " << h.cycle
+            << ", \"residual\": " << h.residual_norm
+            << ", \"computed_residual\": " << h.computed_residual_norm
+            << ", \"orthogonality_loss\": " << h.orthogonality_loss
+            << ", \"end_of_cycle\": " << (h.end_of_cycle ? "true" : "false")
+            << ", \"time_precondition\": " << h.time_precondition
+            << ", \"time_matvec\": " << h.time_matvec
+            << ", \"time_orthogonalize\": " << h.time_orthogonalize
+            << ", \"time_sketch\": " << h.time_sketch << "}";
+      }
+      out << "]";
+    }
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+}
@@ -0,0 +1,189 @@
+/**
+ * @file r_GramSchmidtBenchmark.cpp
+ * @brief Compares Gram-Schmidt variants in terms of wall time and loss of
+ * orthogonality.
+ *
+ * Builds an Arnoldi basis for a 1D convection-diffusion operator with each
+ * orthogonalization variant available in ReSolve and reports time spent in
+ * orthogonalization and the loss of orthogonality || I - V^T V ||_F.
+ *
+ * Usage: gs_benchmark.exe [-n <vector size>] [-m <number of vectors>]
+ *                         [-r <number of repetitions>]
+ */
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/matrix/MatrixHandler.hpp>
+#include <resolve/vector/VectorHandler.hpp>
+#include <resolve/GramSchmidt.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+#include <resolve/utilities/params/CliOptions.hpp>
+
+using namespace ReSolve::constants;
+
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+
+static ReSolve::matrix::Csr* generateMatrix(const index_type n);
+static real_type lossOfOrthogonality(ReSolve::VectorHandler& vh, vector_type& V, index_type n, index_type m);
+
+int main(int argc, char *argv[])
+{
+  ReSolve::CliOptions options(argc, argv);
+  ReSolve::CliOptions::Option* opt = nullptr;
+
+  opt = options.getParamFromKey("-n");
+  const index_type n = opt ? atoi((*opt).second.c_str()) : 100000;
+
+  opt = options.getParamFromKey("-m");
+  const index_type m = opt ? atoi((*opt).second.c_str()) : 50;
+
+  opt = options.getParamFromKey("-r");
+  const index_type repeat = opt ? atoi((*opt).second.c_str()) : 3;
+
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  workspace.initializeHandles();
+  ReSolve::MatrixHandler matrix_handler(&workspace);
+  ReSolve::VectorHandler vector_handler(&workspace);
+
+  ReSolve::matrix::Csr* A = generateMatrix(n);
+
+  const std::vector<std::pair<std::string, ReSolve::GramSchmidt::GSVariant> > variants = {
+    {"mgs",           ReSolve::GramSchmidt::mgs},
+    {"cgs1",          ReSolve::GramSchmidt::cgs1},
+    {"cgs2",          ReSolve::GramSchmidt::cgs2},
+    {"mgs_two_sync",  ReSolve::GramSchmidt::mgs_two_sync},
+    {"mgs_pm",        ReSolve::GramSchmidt::mgs_pm},
+    {"mgs_one_sync",  ReSolve::GramSchmidt::mgs_one_sync},
+    {"cgs2_two_sync", ReSolve::GramSchmidt::cgs2_two_sync},
+    {"rgs",           ReSolve::GramSchmidt::rgs},
+    {"dcgs2",         ReSolve::GramSchmidt::dcgs2}
+  };
+
+  vector_type V(n, m + 1);
+  V.allocate(ReSolve::memory::HOST);
+  vector_type vec_v(n);
+  vector_type vec_w(n);
+  real_type* H = new real_type[m * (m + 1)];
+
+  std::cout << "Gram-Schmidt benchmark: n = " << n << ", m = " << m
+            << ", repetitions = " << repeat << "\n\n";
+  std::cout << std::left << std::setw(16) << "variant"
+            << std::right << std::setw(16) << "time [s]"
+            << std::setw(24) << "||I - V^T V||_F" << "\n";
+
+  for (const auto& variant : variants) {
+    ReSolve::GramSchmidt GS(&vector_handler, variant.second);
+    GS.setup(n, m);
+
+    double best_time = 0.0;
+    real_type loss = 0.0;
+    for (index_type r = 0; r < repeat; ++r) {
+      // Start from a normalized dense vector
+      V.setToZero(ReSolve::memory::HOST);
+      real_type* v0 = V.getVectorData(0, ReSolve::memory::HOST);
+      for (index_type i = 0; i < n; ++i) {
+        v0[i] = std::sin(0.7 * static_cast<real_type>(i)) + 0.1;
+      }
+      vec_v.setData(v0, ReSolve::memory::HOST);
+      real_type t = 1.0 / std::sqrt(vector_handler.dot(&vec_v, &vec_v, ReSolve::memory::HOST));
+      vector_handler.scal(&t, &vec_v, ReSolve::memory::HOST);
+
+      double elapsed = 0.0;
+      for (index_type i = 0; i < m; ++i) {
+        vec_v.setData(V.getVectorData(i, ReSolve::memory::HOST), ReSolve::memory::HOST);
+        vec_w.setData(V.getVectorData(i + 1, ReSolve::memory::HOST), ReSolve::memory::HOST);
+        matrix_handler.setValuesChanged(true, ReSolve::memory::HOST);
+        matrix_handler.matvec(A, &vec_v, &vec_w, &ONE, &ZERO, "csr", ReSolve::memory::HOST);
+
+        auto start = std::chrono::steady_clock::now();
+        GS.orthogonalize(n, &V, H, i);
+        if (i == m - 1) {
+          GS.completeDelayed(n, &V, H, i);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        elapsed += std::chrono::duration<double>(stop - start).count();
+      }
+      if (r == 0 || elapsed < best_time) {
+        best_time = elapsed;
+      }
+      loss = lossOfOrthogonality(vector_handler, V, n, m + 1);
+    }
+
+    std::cout << std::left << std::setw(16) << variant.first
+              << std::right << std::setw(16) << std::fixed << std::setprecision(6) << best_time
+              << std::setw(24) << std::scientific << std::setprecision(4) << loss << "\n";
+  }
+
+  delete [] H;
+  delete A;
+
+  return 0;
+}
+
+/**
+ * @brief Computes || I - V^T V ||_F for the first m vectors in V.
+ */
+real_type lossOfOrthogonality(ReSolve::VectorHandler& vh, vector_type& V, index_type n, index_type m)
+{
+  vector_type vec_x(n);
+  vector_type vec_y(m);
+  vec_y.allocate(ReSolve::memory::HOST);
+
+  real_type loss = 0.0;
+  for (index_type j = 0; j < m; ++j) {
+    vec_x.setData(V.getVectorData(j, ReSolve::memory::HOST), ReSolve::memory::HOST);
+    vh.gemv('T', n, m, &ONE, &ZERO, &V, &vec_x, &vec_y, ReSolve::memory::HOST);
+    const real_type* y = vec_y.getData(ReSolve::memory::HOST);
+    for (index_type i = 0; i < m; ++i) {
+      real_type e = (i == j) ? (1.0 - y[i]) : y[i];
+      loss += e * e;
+    }
+  }
+  return std::sqrt(loss);
+}
+
+/**
+ * @brief Generates 1D convection-diffusion matrix tridiag(-1 - c, 2, -1 + c).
+ */
+ReSolve::matrix::Csr* generateMatrix(const index_type n)
+{
+  const real_type c = 0.4;
+  const index_type nnz = 3 * n - 2;
+
+  ReSolve::matrix::Csr* A = new ReSolve::matrix::Csr(n, n, nnz);
+  A->allocateMatrixData(ReSolve::memory::HOST);
+
+  index_type* rowptr = A->getRowData(ReSolve::memory::HOST);
+  index_type* colidx = A->getColData(ReSolve::memory::HOST);
+  real_type*  val    = A->getValues(ReSolve::memory::HOST);
+
+  index_type k = 0;
+  rowptr[0] = 0;
+  for (index_type i = 0; i < n; ++i) {
+    if (i > 0) {
+      colidx[k] = i - 1;
+      val[k]    = -1.0 - c;
+      ++k;
+    }
+    colidx[k] = i;
+    val[k]    = 2.0;
+    ++k;
+    if (i < n - 1) {
+      colidx[k] = i + 1;
+      val[k]    = -1.0 + c;
+      ++k;
+    }
+    rowptr[i + 1] = k;
+  }
+  A->setUpdated(ReSolve::memory::HOST);
+
+  return A;
+}
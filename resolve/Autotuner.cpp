@@ -0,0 +1,413 @@
+/**
+ * @file Autotuner.cpp
+ * @brief Implementation of solver kernel autotuning.
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include <resolve/SymbolicCache.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include "SystemSolver.hpp"
+#include "Autotuner.hpp"
+
+namespace ReSolve
+{
+  using out = io::Logger;
+
+  namespace
+  {
+    /// All Gram-Schmidt variants; cached decisions store indices into this list
+    const std::vector<std::string> GS_VARIANTS = {"cgs2",
+                                                  "mgs",
+                                                  "mgs_two_sync",
+                                                  "mgs_pm",
+                                                  "cgs1",
+                                                  "mgs_one_sync",
+                                                  "cgs2_two_sync",
+                                                  "rgs",
+                                                  "dcgs2"};
+
+    index_type findVariant(const std::string& variant)
+    {
+      auto it = std::find(GS_VARIANTS.begin(), GS_VARIANTS.end(), variant);
+      return (it == GS_VARIANTS.end()) ? -1 : static_cast<index_type>(it - GS_VARIANTS.begin());
+    }
+
+    /// Mixes a string into the SymbolicCache hash, stable across runs so
+    /// that saved caches remain valid
+    std::uint64_t hashString(std::uint64_t hash, const std::string& s)
+    {
+      for (char c : s) {
+        hash = SymbolicCache::hashValue(hash, static_cast<unsigned char>(c));
+      }
+      return SymbolicCache::hashValue(hash, 0xff);
+    }
+  }
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] cache_capacity - maximum number of cached decisions
+   */
+  Autotuner::Autotuner(std::size_t cache_capacity)
+    : cache_(cache_capacity)
+  {
+  }
+
+  /**
+   * @brief Sets thread counts to try. Empty list selects powers of two up
+   * to the number of hardware threads.
+   *
+   * @return 0 if successful, 1 if any count is not positive
+   */
+  int Autotuner::setThreadCandidates(const std::vector<int>& num_threads)
+  {
+    for (int t : num_threads) {
+      if (t < 1) {
+        out::error() << "Autotuner: invalid number of threads " << t << ".\n";
+        return 1;
+      }
+    }
+    thread_candidates_ = num_threads;
+    return 0;
+  }
+
+  /**
+   * @brief Sets Gram-Schmidt variants to try.
+   *
+   * @return 0 if successful, 1 if any variant is not recognized
+   */
+  int Autotuner::setOrthogonalizationCandidates(const std::vector<std::string>& variants)
+  {
+    for (const std::string& variant : variants) {
+      if (findVariant(variant) < 0) {
+        out::error() << "Autotuner: Gram-Schmidt variant " << variant << " not recognized.\n";
+        return 1;
+      }
+    }
+    gs_candidates_ = variants;
+    return 0;
+  }
+
+  /**
+   * @brief Sets preconditioner precisions to try.
+   *
+   * @return 0 if successful, 1 if any precision is not "double" or "single"
+   */
+  int Autotuner::setPrecisionCandidates(const std::vector<std::string>& precisions)
+  {
+    for (const std::string& precision : precisions) {
+      if (precision != "double" && precision != "single") {
+        out::error() << "Autotuner: precision " << precision << " not recognized.\n";
+        return 1;
+      }
+    }
+    precision_candidates_ = precisions;
+    return 0;
+  }
+
+  /**
+   * @brief Sets number of timed solves per candidate; the fastest is used.
+   */
+  int Autotuner::setNumTrials(index_type num_trials)
+  {
+    if (num_trials < 1) {
+      out::error() << "Autotuner: number of trials must be positive.\n";
+      return 1;
+    }
+    num_trials_ = num_trials;
+    return 0;
+  }
+
+  /**
+   * @brief Sets how much larger than the residual of the starting
+   * configuration the residual of an accepted candidate may be.
+   */
+  int Autotuner::setMaxResidualGrowth(real_type growth)
+  {
+    if (!(growth >= 1.0)) {
+      out::error() << "Autotuner: residual growth must be at least 1.\n";
+      return 1;
+    }
+    max_residual_growth_ = growth;
+    return 0;
+  }
+
+  /// Sets minimum number of matrix nonzeros per thread for thread candidates.
+  void Autotuner::setMinNnzPerThread(index_type nnz)
+  {
+    min_nnz_per_thread_ = std::max(nnz, 0);
+  }
+
+  /**
+   * @brief Selects settings of the solver for matrix A and applies them.
+   *
+   * If a decision for the pattern of A and the solver configuration is
+   * cached, it is applied without trials. Otherwise each candidate is timed
+   * by setting up the preconditioner (if any) and solving with zero
+   * initial guess.
+   *
+   * @param[in,out] solver   - iterative solver, tuned settings are applied to it
+   * @param[in]     A        - system matrix
+   * @param[in]     rhs      - right-hand side for trial solves
+   * @param[out]    x        - work vector, holds a solution on return
+   * @param[in]     memspace - memory space of rhs and x used by the solver
+   *
+   * @pre setMatrix(A) was called on the solver.
+   *
+   * @return 0 if successful, 1 otherwise
+   */
+  int Autotuner::tune(SystemSolver& solver,
+                      matrix::Csr* A,
+                      vector_type* rhs,
+                      vector_type* x,
+                      memory::MemorySpace memspace)
+  {
+    std::string solve_method = solver.getSolveMethod();
+    if (solve_method != "fgmres" && solve_method != "randgmres") {
+      out::error() << "Autotuner: solve method " << solve_method << " is not iterative.\n";
+      return 1;
+    }
+    if (analyzer_.analyze(A) != 0) {
+      return 1;
+    }
+
+    index_type tag = getConfigurationTag(solver, memspace);
+    index_type n = A->getNumRows();
+    const index_type* rows = A->getRowData(memory::HOST);
+    const index_type* cols = A->getColData(memory::HOST);
+
+    SymbolicCache::Entry* entry = cache_.find(tag, n, rows, cols);
+    if (entry != nullptr && entry->ints.size() == 3 && entry->reals.size() == 1) {
+      index_type gs = entry->ints[1];
+      if (entry->ints[0] >= 1 && gs >= 0 && gs < static_cast<index_type>(GS_VARIANTS.size())) {
+        decision_.num_threads       = entry->ints[0];
+        decision_.orthogonalization = GS_VARIANTS[static_cast<std::size_t>(gs)];
+        decision_.precision         = (entry->ints[2] == 1) ? "single" : "double";
+        decision_.time              = entry->reals[0];
+        decision_.from_cache        = true;
+        return apply(solver);
+      }
+    }
+
+    // Start from the current configuration
+    Decision best;
+    best.num_threads       = threads::getNumThreads();
+    best.orthogonalization = solver.getOrthogonalizationMethod();
+    best.precision         = solver.getPreconditionerPrecision();
+    best.time = trial(solver, best, rhs, x, memspace, reference_residual_);
+    if (best.time < 0.0) {
+      out::error() << "Autotuner: solve with the initial configuration failed.\n";
+      decision_ = best;
+      apply(solver);
+      return 1;
+    }
+    decision_ = best;
+
+    for (int t : getThreadCandidates()) {
+      Decision candidate = decision_;
+      candidate.num_threads = t;
+      tryCandidate(solver, candidate, rhs, x, memspace);
+    }
+    for (const std::string& variant : gs_candidates_) {
+      Decision candidate = decision_;
+      candidate.orthogonalization = variant;
+      tryCandidate(solver, candidate, rhs, x, memspace);
+    }
+    if (solver.getPreconditionerMethod() == "ilu0" && memspace == memory::HOST) {
+      for (const std::string& precision : precision_candidates_) {
+        Decision candidate = decision_;
+        candidate.precision = precision;
+        tryCandidate(solver, candidate, rhs, x, memspace);
+      }
+    }
+
+    entry = cache_.insert(tag, n, rows, cols);
+    if (entry != nullptr) {
+      entry->ints  = {decision_.num_threads,
+                      findVariant(decision_.orthogonalization),
+                      (decision_.precision == "single") ? 1 : 0};
+      entry->reals = {decision_.time};
+    }
+
+    out::summary() << "Autotuner selected " << decision_.num_threads << " threads, "
+                   << decision_.orthogonalization << " orthogonalization, "
+                   << decision_.precision << " precision preconditioner ("
+                   << decision_.time << " s per solve)\n";
+    return apply(solver);
+  }
+
+  /**
+   * @brief Applies the latest decision to the solver.
+   *
+   * @note The preconditioner precision takes effect at the next call to
+   * preconditionerSetup().
+   */
+  int Autotuner::apply(SystemSolver& solver) const
+  {
+    int status = 0;
+    threads::setNumThreads(decision_.num_threads);
+    if (solver.getOrthogonalizationMethod() != decision_.orthogonalization) {
+      status += solver.setGramSchmidtMethod(decision_.orthogonalization);
+    }
+    if (solver.getPreconditionerPrecision() != decision_.precision) {
+      status += solver.setPreconditionerPrecision(decision_.precision);
+    }
+    return status;
+  }
+
+  const Autotuner::Decision& Autotuner::getDecision() const
+  {
+    return decision_;
+  }
+
+  /// Structure of the matrix passed to the latest tune() call.
+  const MatrixStructure& Autotuner::getStructure() const
+  {
+    return analyzer_.getStructure();
+  }
+
+  SymbolicCache& Autotuner::getCache()
+  {
+    return cache_;
+  }
+
+  /**
+   * @brief Times the fastest of num_trials_ solves with given settings.
+   *
+   * @param[out] residual - relative residual norm of the last solve
+   *
+   * @return time in seconds, negative if any solve failed
+   */
+  real_type Autotuner::trial(SystemSolver& solver,
+                             const Decision& candidate,
+                             vector_type* rhs,
+                             vector_type* x,
+                             memory::MemorySpace memspace,
+                             real_type& residual)
+  {
+    Decision previous = decision_;
+    decision_ = candidate;
+    int status = apply(solver);
+    decision_ = previous;
+    if (status != 0) {
+      return -1.0;
+    }
+
+    bool setup_preconditioner = (solver.getPreconditionerMethod() != "none");
+    real_type best_time = std::numeric_limits<real_type>::max();
+    for (index_type i = 0; i < num_trials_; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      if (setup_preconditioner) {
+        status += solver.preconditionerSetup();
+      }
+      x->setToZero(memspace);
+      x->setDataUpdated(memspace);
+      status += solver.solve(rhs, x);
+      std::chrono::duration<real_type> elapsed = std::chrono::steady_clock::now() - start;
+      if (status != 0) {
+        return -1.0;
+      }
+      best_time = std::min(best_time, elapsed.count());
+    }
+    residual = solver.getResidualNorm(rhs, x);
+    if (!std::isfinite(residual)) {
+      return -1.0;
+    }
+    return best_time;
+  }
+
+  /**
+   * @brief Replaces the current decision with the candidate if the
+   * candidate is faster and accurate enough.
+   *
+   * @post Settings of decision_ are applied to the solver.
+   *
+   * @return true if the candidate was accepted
+   */
+  bool Autotuner::tryCandidate(SystemSolver& solver,
+                               const Decision& candidate,
+                               vector_type* rhs,
+                               vector_type* x,
+                               memory::MemorySpace memspace)
+  {
+    if (candidate.num_threads       == decision_.num_threads &&
+        candidate.orthogonalization == decision_.orthogonalization &&
+        candidate.precision         == decision_.precision) {
+      return false;
+    }
+    real_type residual = 0.0;
+    real_type time = trial(solver, candidate, rhs, x, memspace, residual);
+    bool accepted = (time >= 0.0) &&
+                    (time < decision_.time) &&
+                    (residual <= max_residual_growth_ * reference_residual_);
+    out::misc() << "Autotuner: " << candidate.num_threads << " threads, "
+                << candidate.orthogonalization << ", "
+                << candidate.precision << ": time " << time
+                << " s, residual " << residual
+                << (accepted ? " (accepted)\n" : "\n");
+    if (accepted) {
+      decision_ = candidate;
+      decision_.time = time;
+    }
+    apply(solver);
+    return accepted;
+  }
+
+  /**
+   * @brief Cache tag identifying solver configuration and candidate sets,
+   * so decisions made under different settings are not mixed.
+   */
+  index_type Autotuner::getConfigurationTag(SystemSolver& solver,
+                                            memory::MemorySpace memspace) const
+  {
+    std::uint64_t hash = SymbolicCache::HASH_SEED;
+    hash = hashString(hash, solver.getSolveMethod());
+    hash = hashString(hash, solver.getPreconditionerMethod());
+    hash = hashString(hash, (memspace == memory::HOST) ? "host" : "device");
+    for (int t : getThreadCandidates()) {
+      hash = hashString(hash, std::to_string(t));
+    }
+    for (const std::string& variant : gs_candidates_) {
+      hash = hashString(hash, variant);
+    }
+    for (const std::string& precision : precision_candidates_) {
+      hash = hashString(hash, precision);
+    }
+    return static_cast<index_type>(hash & 0x7fffffff);
+  }
+
+  /**
+   * @brief Thread counts to try for the analyzed matrix.
+   *
+   * Counts leaving fewer than min_nnz_per_thread_ nonzeros per thread are
+   * dropped, since synchronization would then dominate the kernels.
+   */
+  std::vector<int> Autotuner::getThreadCandidates() const
+  {
+    std::vector<int> candidates = thread_candidates_;
+    if (candidates.empty()) {
+      int max_threads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+      for (int t = 1; t < max_threads; t *= 2) {
+        candidates.push_back(t);
+      }
+      candidates.push_back(max_threads);
+    }
+
+    const MatrixStructure& s = analyzer_.getStructure();
+    std::vector<int> pruned;
+    for (int t : candidates) {
+      if (t == 1 || static_cast<std::int64_t>(s.nnz) >= static_cast<std::int64_t>(t) * min_nnz_per_thread_) {
+        pruned.push_back(t);
+      }
+    }
+    return pruned;
+  }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file Autotuner.hpp
+ * @brief Selection of solver kernel settings by timed trials.
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "MatrixAnalyzer.hpp"
+#include "SymbolicCache.hpp"
+#include <resolve/MemoryUtils.hpp>
+
+namespace ReSolve
+{
+  class SystemSolver;
+
+  namespace vector
+  {
+    class Vector;
+  }
+
+  /**
+   * @brief Selects kernel settings of an iterative SystemSolver for a
+   * matrix from its structure and short timed trial solves.
+   *
+   * Tuned settings are the number of host threads, the Gram-Schmidt
+   * variant used to orthogonalize the Krylov basis and, for ILU0 on CPU,
+   * the precision of the preconditioner. Settings are tuned one at a time,
+   * starting from the solver's current configuration. Thread counts that
+   * leave too few nonzeros per thread are not tried. A candidate is only
+   * accepted if its solve succeeds with residual not much larger than the
+   * residual of the starting configuration.
+   *
+   * Decisions are cached by sparsity pattern and solver configuration, so
+   * matrices with the same pattern, e.g. in a sequence of Newton steps, are
+   * tuned only once. The cache can be saved to and loaded from a file.
+   *
+   * @note The number of host threads is a process-wide setting.
+   */
+  class Autotuner
+  {
+    public:
+      using vector_type = vector::Vector;
+
+      /// Settings selected for a matrix.
+      struct Decision
+      {
+        int num_threads{1};
+        std::string orthogonalization{"cgs2"};
+        std::string precision{"double"};
+        real_type time{0.0};     ///< seconds per trial solve, 0 if not measured
+        bool from_cache{false};  ///< decision was found in the cache
+      };
+
+      Autotuner(std::size_t cache_capacity = 16);
+      ~Autotuner() = default;
+
+      int setThreadCandidates(const std::vector<int>& num_threads);
+      int setOrthogonalizationCandidates(const std::vector<std::string>& variants);
+      int setPrecisionCandidates(const std::vector<std::string>& precisions);
+      int setNumTrials(index_type num_trials);
+      int setMaxResidualGrowth(real_type growth);
+      void setMinNnzPerThread(index_type nnz);
+
+      int tune(SystemSolver& solver,
+               matrix::Csr* A,
+               vector_type* rhs,
+               vector_type* x,
+               memory::MemorySpace memspace);
+      int apply(SystemSolver& solver) const;
+
+      const Decision& getDecision() const;
+      const MatrixStructure& getStructure() const;
+      SymbolicCache& getCache();
+
+    private:
+      real_type trial(SystemSolver& solver,
+                      const Decision& candidate,
+                      vector_type* rhs,
+                      vector_type* x,
+                      memory::MemorySpace memspace,
+                      real_type& residual);
+      bool tryCandidate(SystemSolver& solver,
+                        const Decision& candidate,
+                        vector_type* rhs,
+                        vector_type* x,
+                        memory::MemorySpace memspace);
+      index_type getConfigurationTag(SystemSolver& solver, memory::MemorySpace memspace) const;
+      std::vector<int> getThreadCandidates() const;
+
+      MatrixAnalyzer analyzer_;
+      SymbolicCache cache_;
+      Decision decision_;
+
+      std::vector<int> thread_candidates_;  ///< empty means powers of two up to hardware threads
+      std::vector<std::string> gs_candidates_{"cgs2",
+                                              "mgs",
+                                              "mgs_two_sync",
+                                              "mgs_pm",
+                                              "cgs2_two_sync",
+                                              "mgs_one_sync"};
+      std::vector<std::string> precision_candidates_{"double", "single"};
+      index_type num_trials_{3};
+      index_type min_nnz_per_thread_{8192};
+      real_type max_residual_growth_{10.0};
+      real_type reference_residual_{0.0};
+  };
+}
@@ -0,0 +1,384 @@
+/**
+ * @file BatchedSystemSolver.cpp
+ * @brief Implementation of solver for batches of systems with the same
+ * sparsity pattern.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include "BatchedSystemSolver.hpp"
+
+namespace ReSolve
+{
+  using out = io::Logger;
+
+  constexpr index_type BatchedSystemSolver::BATCH_BLOCK_SIZE;
+
+  BatchedSystemSolver::BatchedSystemSolver()
+  {
+  }
+
+  /**
+   * @brief Symbolic analysis of the sparsity pattern shared by the batch.
+   *
+   * Computes the pattern of LU factors of the permuted matrix and the
+   * schedule of elimination updates. Values of `A` are not used.
+   *
+   * @param[in] A - matrix in CSR format with the sparsity pattern
+   * @param[in] P - row permutation, row i of the factored matrix is row
+   *                P[i] of A; identity if nullptr
+   * @param[in] Q - column permutation, column j of the factored matrix is
+   *                column Q[j] of A; identity if nullptr
+   *
+   * @return int - 0 if successful, 1 otherwise
+   *
+   * @note KLU in ReSolve factors the transpose of a CSR matrix, so KLU
+   * permutations are passed as P = KLU Q ordering and Q = KLU P ordering.
+   */
+  int BatchedSystemSolver::analyze(matrix::Sparse* A,
+                                   const index_type* P,
+                                   const index_type* Q)
+  {
+    if (dynamic_cast<matrix::Csr*>(A) == nullptr) {
+      out::error() << "Batched solver requires matrix in CSR format.\n";
+      return 1;
+    }
+    if (A->getNumRows() != A->getNumColumns()) {
+      out::error() << "Batched solver requires a square matrix.\n";
+      return 1;
+    }
+
+    n_   = A->getNumRows();
+    nnz_ = A->getNnz();
+    const index_type* rp = A->getRowData(memory::HOST);
+    const index_type* ci = A->getColData(memory::HOST);
+
+    // Set permutations and check they are valid
+    row_perm_.resize(static_cast<size_t>(n_));
+    col_perm_.resize(static_cast<size_t>(n_));
+    std::vector<index_type> row_inv(static_cast<size_t>(n_), -1);
+    std::vector<index_type> col_inv(static_cast<size_t>(n_), -1);
+    for (index_type i = 0; i < n_; ++i) {
+      row_perm_[i] = (P == nullptr) ? i : P[i];
+      col_perm_[i] = (Q == nullptr) ? i : Q[i];
+      if (row_perm_[i] < 0 || row_perm_[i] >= n_ || row_inv[row_perm_[i]] != -1 ||
+          col_perm_[i] < 0 || col_perm_[i] >= n_ || col_inv[col_perm_[i]] != -1) {
+        out::error() << "Invalid permutation passed to batched solver.\n";
+        n_ = 0;
+        return 1;
+      }
+      row_inv[row_perm_[i]] = i;
+      col_inv[col_perm_[i]] = i;
+    }
+
+    // Symbolic factorization, row by row. Row i of LU is the union of row i
+    // of the permuted matrix and U parts of rows k < i for all k in row i.
+    lu_ptr_.assign(1, 0);
+    lu_idx_.clear();
+    diag_pos_.resize(static_cast<size_t>(n_));
+    for (index_type i = 0; i < n_; ++i) {
+      std::set<index_type> row;
+      const index_type r = row_perm_[i];
+      for (index_type p = rp[r]; p < rp[r + 1]; ++p) {
+        row.insert(col_inv[ci[p]]);
+      }
+      row.insert(i);
+      for (std::set<index_type>::iterator it = row.begin(); *it < i; ++it) {
+        const index_type k = *it;
+        row.insert(lu_idx_.begin() + diag_pos_[k] + 1, lu_idx_.begin() + lu_ptr_[k + 1]);
+      }
+      lu_idx_.insert(lu_idx_.end(), row.begin(), row.end());
+      lu_ptr_.push_back(static_cast<index_type>(lu_idx_.size()));
+      diag_pos_[i] = static_cast<index_type>(
+        std::lower_bound(lu_idx_.begin() + lu_ptr_[i], lu_idx_.end(), i) - lu_idx_.begin());
+    }
+    const index_type nnz_lu = lu_ptr_[n_];
+
+    // Map input values to factor positions and build elimination schedule
+    std::vector<index_type> position(static_cast<size_t>(n_), -1);
+    value_map_.resize(static_cast<size_t>(nnz_));
+    update_ptr_.assign(static_cast<size_t>(nnz_lu) + 1, 0);
+    update_target_.clear();
+    update_source_.clear();
+    for (index_type i = 0; i < n_; ++i) {
+      for (index_type p = lu_ptr_[i]; p < lu_ptr_[i + 1]; ++p) {
+        position[lu_idx_[p]] = p;
+      }
+
+      const index_type r = row_perm_[i];
+      for (index_type p = rp[r]; p < rp[r + 1]; ++p) {
+        value_map_[p] = position[col_inv[ci[p]]];
+      }
+
+      for (index_type p = lu_ptr_[i]; p < lu_ptr_[i + 1]; ++p) {
+        if (p < diag_pos_[i]) {
+          const index_type k = lu_idx_[p];
+          for (index_type q = diag_pos_[k] + 1; q < lu_ptr_[k + 1]; ++q) {
+            update_target_.push_back(position[lu_idx_[q]]);
+            update_source_.push_back(q);
+          }
+        }
+        update_ptr_[p + 1] = static_cast<index_type>(update_target_.size());
+      }
+
+      for (index_type p = lu_ptr_[i]; p < lu_ptr_[i + 1]; ++p) {
+        position[lu_idx_[p]] = -1;
+      }
+    }
+
+    // Values for the old pattern are no longer valid
+    batch_size_ = 0;
+    num_blocks_ = 0;
+    values_.clear();
+    status_.clear();
+
+    return 0;
+  }
+
+  /**
+   * @brief Numeric factorization of all systems in the batch.
+   *
+   * @param[in] batch_size - number of systems
+   * @param[in] values     - array of `batch_size` pointers to matrix values,
+   *                         each in the order of the CSR pattern passed to
+   *                         analyze()
+   *
+   * @return int - 0 if all systems are factorized, 1 otherwise
+   *
+   * @pre analyze() has been called.
+   * @post Status of each system is available from getStatus().
+   */
+  int BatchedSystemSolver::factorize(index_type batch_size, const real_type* const* values)
+  {
+    if (lu_ptr_.size() != static_cast<size_t>(n_) + 1 || n_ == 0) {
+      out::error() << "Batched factorization called before analysis.\n";
+      return 1;
+    }
+    if (batch_size < 0 || (batch_size > 0 && values == nullptr)) {
+      out::error() << "Invalid batch passed to batched factorization.\n";
+      return 1;
+    }
+
+    allocateBatch(batch_size);
+
+    const index_type W = BATCH_BLOCK_SIZE;
+    const size_t block_stride = static_cast<size_t>(lu_ptr_[n_]) * W;
+    threads::parallelRange(0, num_blocks_, 1,
+      [&](int, index_type lo, index_type hi) {
+        for (index_type block = lo; block < hi; ++block) {
+          // Interleave values of systems in the block, padding with identity
+          real_type* v = values_.data() + block * block_stride;
+          std::fill(v, v + block_stride, 0.0);
+          for (index_type lane = 0; lane < W; ++lane) {
+            const index_type system = block * W + lane;
+            if (system < batch_size_) {
+              const real_type* a = values[system];
+              for (index_type k = 0; k < nnz_; ++k) {
+                v[value_map_[k] * W + lane] = a[k];
+              }
+            } else {
+              for (index_type i = 0; i < n_; ++i) {
+                v[diag_pos_[i] * W + lane] = 1.0;
+              }
+            }
+          }
+          factorizeBlock(block);
+        }
+      });
+
+    index_type num_failed = getNumFailed();
+    if (num_failed > 0) {
+      out::error() << "Batched factorization failed for " << num_failed
+                   << " of " << batch_size_ << " systems.\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Solves all systems in the batch.
+   *
+   * @param[in]  rhs - array of `batch_size` pointers to right-hand sides
+   * @param[out] x   - array of `batch_size` pointers to solutions
+   *
+   * @return int - 0 if successful, 1 otherwise
+   *
+   * @pre factorize() has been called. Solutions of systems that failed to
+   * factorize are not finite.
+   */
+  int BatchedSystemSolver::solve(const real_type* const* rhs, real_type* const* x)
+  {
+    if (static_cast<index_type>(status_.size()) != batch_size_ || batch_size_ == 0) {
+      out::error() << "Batched solve called before factorization.\n";
+      return 1;
+    }
+
+    const size_t work_size = static_cast<size_t>(n_) * BATCH_BLOCK_SIZE;
+    const int num_threads = threads::getNumThreads(num_blocks_, 1);
+    std::vector<real_type> work(work_size * static_cast<size_t>(num_threads));
+
+    threads::parallelFor(num_threads, 0, num_blocks_,
+      [&](int tid, index_type lo, index_type hi) {
+        const index_type W = BATCH_BLOCK_SIZE;
+        real_type* y = work.data() + work_size * static_cast<size_t>(tid);
+        for (index_type block = lo; block < hi; ++block) {
+          // Gather permuted right-hand sides
+          std::fill(y, y + work_size, 0.0);
+          for (index_type lane = 0; lane < W; ++lane) {
+            const index_type system = block * W + lane;
+            if (system < batch_size_) {
+              for (index_type i = 0; i < n_; ++i) {
+                y[i * W + lane] = rhs[system][row_perm_[i]];
+              }
+            }
+          }
+
+          solveBlock(block, y);
+
+          // Scatter permuted solutions
+          for (index_type lane = 0; lane < W; ++lane) {
+            const index_type system = block * W + lane;
+            if (system < batch_size_) {
+              for (index_type j = 0; j < n_; ++j) {
+                x[system][col_perm_[j]] = y[j * W + lane];
+              }
+            }
+          }
+        }
+      });
+
+    return 0;
+  }
+
+  index_type BatchedSystemSolver::getBatchSize() const
+  {
+    return batch_size_;
+  }
+
+  index_type BatchedSystemSolver::getNumRows() const
+  {
+    return n_;
+  }
+
+  index_type BatchedSystemSolver::getNnz() const
+  {
+    return nnz_;
+  }
+
+  /**
+   * @brief Number of nonzeros in L and U factors, including fill-in and
+   * excluding the unit diagonal of L.
+   */
+  index_type BatchedSystemSolver::getNnzFactors() const
+  {
+    return lu_ptr_.empty() ? 0 : lu_ptr_.back();
+  }
+
+  /**
+   * @brief Returns 0 if the system was factorized, 1 if it has a zero pivot
+   * in the pivot order set at analysis.
+   */
+  int BatchedSystemSolver::getStatus(index_type system) const
+  {
+    if (system < 0 || system >= static_cast<index_type>(status_.size())) {
+      out::error() << "System " << system << " is not in the batch.\n";
+      return 1;
+    }
+    return status_[system];
+  }
+
+  index_type BatchedSystemSolver::getNumFailed() const
+  {
+    return static_cast<index_type>(std::count(status_.begin(), status_.end(), 1));
+  }
+
+  //
+  // Private methods
+  //
+
+  void BatchedSystemSolver::allocateBatch(index_type batch_size)
+  {
+    batch_size_ = batch_size;
+    num_blocks_ = (batch_size + BATCH_BLOCK_SIZE - 1) / BATCH_BLOCK_SIZE;
+    values_.resize(static_cast<size_t>(num_blocks_) * lu_ptr_[n_] * BATCH_BLOCK_SIZE);
+    status_.assign(static_cast<size_t>(batch_size), 0);
+  }
+
+  /**
+   * @brief Factorizes interleaved systems in a block in place.
+   */
+  void BatchedSystemSolver::factorizeBlock(index_type block)
+  {
+    const index_type W = BATCH_BLOCK_SIZE;
+    real_type* v = values_.data() + static_cast<size_t>(block) * lu_ptr_[n_] * W;
+
+    for (index_type i = 0; i < n_; ++i) {
+      for (index_type p = lu_ptr_[i]; p < diag_pos_[i]; ++p) {
+        real_type* l = v + p * W;
+        const real_type* pivot = v + diag_pos_[lu_idx_[p]] * W;
+        for (index_type b = 0; b < W; ++b) {
+          l[b] /= pivot[b];
+        }
+        for (index_type u = update_ptr_[p]; u < update_ptr_[p + 1]; ++u) {
+          real_type* target = v + update_target_[u] * W;
+          const real_type* source = v + update_source_[u] * W;
+          for (index_type b = 0; b < W; ++b) {
+            target[b] -= l[b] * source[b];
+          }
+        }
+      }
+    }
+
+    // Zero pivot in one system results in non-finite values only in that system
+    for (index_type b = 0; b < W && block * W + b < batch_size_; ++b) {
+      for (index_type i = 0; i < n_; ++i) {
+        const real_type pivot = v[diag_pos_[i] * W + b];
+        if (pivot == 0.0 || !std::isfinite(pivot)) {
+          status_[block * W + b] = 1;
+          break;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Forward and backward substitution for interleaved right-hand
+   * sides of a block, overwritten by solutions.
+   */
+  void BatchedSystemSolver::solveBlock(index_type block, real_type* y)
+  {
+    const index_type W = BATCH_BLOCK_SIZE;
+    const real_type* v = values_.data() + static_cast<size_t>(block) * lu_ptr_[n_] * W;
+
+    for (index_type i = 0; i < n_; ++i) {
+      real_type* yi = y + i * W;
+      for (index_type p = lu_ptr_[i]; p < diag_pos_[i]; ++p) {
+        const real_type* l  = v + p * W;
+        const real_type* yk = y + lu_idx_[p] * W;
+        for (index_type b = 0; b < W; ++b) {
+          yi[b] -= l[b] * yk[b];
+        }
+      }
+    }
+
+    for (index_type i = n_ - 1; i >= 0; --i) {
+      real_type* yi = y + i * W;
+      for (index_type p = diag_pos_[i] + 1; p < lu_ptr_[i + 1]; ++p) {
+        const real_type* u  = v + p * W;
+        const real_type* yj = y + lu_idx_[p] * W;
+        for (index_type b = 0; b < W; ++b) {
+          yi[b] -= u[b] * yj[b];
+        }
+      }
+      const real_type* pivot = v + diag_pos_[i] * W;
+      for (index_type b = 0; b < W; ++b) {
+        yi[b] /= pivot[b];
+      }
+    }
+  }
+} // namespace ReSolve
@@ -0,0 +1,91 @@
+/**
+ * @file BatchedSystemSolver.hpp
+ * @brief Solver for batches of small systems with the same sparsity pattern.
+ *
+ */
+#pragma once
+#include <vector>
+
+#include "Common.hpp"
+
+namespace ReSolve
+{
+  namespace matrix
+  {
+    class Sparse;
+  }
+
+  /**
+   * @brief Direct solver for many independent linear systems that share one
+   * sparsity pattern, such as systems in stochastic or contingency studies.
+   *
+   * Symbolic analysis is done once for the pattern: it computes the fill-in
+   * of LU factors for a fixed pivot order and a schedule of elimination
+   * updates. Numeric factorization and solves then execute the same
+   * schedule for every system in the batch.
+   *
+   * Values of the batch are stored interleaved in blocks of
+   * `BATCH_BLOCK_SIZE` systems, i.e. a value at a given position of the
+   * factors is stored contiguously for all systems in a block. Each step of
+   * the schedule is a fixed-length loop over the block, which the compiler
+   * can vectorize. Blocks are processed concurrently by host threads.
+   *
+   * Like refactorization solvers, the batched solver does not pivot. Pivot
+   * order is given at analysis, e.g. from a KLU factorization of one
+   * representative system. Systems with zero pivots in that order are
+   * reported by getStatus() and do not affect other systems in the batch.
+   */
+  class BatchedSystemSolver
+  {
+    public:
+      /// Number of systems interleaved in one storage block.
+      static constexpr index_type BATCH_BLOCK_SIZE = 8;
+
+      BatchedSystemSolver();
+      ~BatchedSystemSolver() = default;
+
+      int analyze(matrix::Sparse* A,
+                  const index_type* P = nullptr,
+                  const index_type* Q = nullptr);
+      int factorize(index_type batch_size, const real_type* const* values);
+      int solve(const real_type* const* rhs, real_type* const* x);
+
+      index_type getBatchSize() const;
+      index_type getNumRows() const;
+      index_type getNnz() const;
+      index_type getNnzFactors() const;
+      int getStatus(index_type system) const;
+      index_type getNumFailed() const;
+
+    private:
+      void allocateBatch(index_type batch_size);
+      void factorizeBlock(index_type block);
+      void solveBlock(index_type block, real_type* y);
+
+      // Pattern of the factored matrix
+      index_type n_{0};
+      index_type nnz_{0};                 ///< nonzeros in the input pattern
+      std::vector<index_type> row_perm_;  ///< row i of factored matrix is row row_perm_[i]
+      std::vector<index_type> col_perm_;  ///< column j of factored matrix is column col_perm_[j]
+      std::vector<index_type> value_map_; ///< factor position of each input value
+
+      // Combined L and U factors in CSR format, L has implicit unit diagonal
+      std::vector<index_type> lu_ptr_;
+      std::vector<index_type> lu_idx_;
+      std::vector<index_type> diag_pos_;
+
+      // Elimination schedule: entry lu_ptr_[i] <= p < diag_pos_[i] of row i
+      // is divided by its pivot and then updates positions
+      // update_target_[u] -= L(p) * lu(update_source_[u]),
+      // update_ptr_[p] <= u < update_ptr_[p + 1]
+      std::vector<index_type> update_ptr_;
+      std::vector<index_type> update_target_;
+      std::vector<index_type> update_source_;
+
+      // Batch values
+      index_type batch_size_{0};
+      index_type num_blocks_{0};
+      std::vector<real_type> values_; ///< [block][factor position][system in block]
+      std::vector<int> status_;       ///< 0 if system is factorized, 1 for zero pivot
+  };
+} // namespace ReSolve
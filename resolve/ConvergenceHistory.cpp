@@ -0,0 +1,155 @@
+/**
+ * @file ConvergenceHistory.cpp
+ * @brief Implementation of per-iteration convergence history.
+ *
+ */
+#include "ConvergenceHistory.hpp"
+
+namespace ReSolve
+{
+  ConvergenceHistory::ConvergenceHistory()
+  {
+  }
+
+  /**
+   * @brief Sets maximum number of stored iterations and allocates the
+   * buffer. Zero disables recording and releases the buffer.
+   *
+   * @param[in] capacity - maximum number of stored iterations
+   *
+   * @post History is empty.
+   */
+  void ConvergenceHistory::setCapacity(index_type capacity)
+  {
+    capacity_ = (capacity > 0) ? capacity : 0;
+    std::vector<Record>().swap(records_);
+    records_.reserve(static_cast<std::size_t>(capacity_));
+    clear();
+  }
+
+  index_type ConvergenceHistory::getCapacity() const
+  {
+    return capacity_;
+  }
+
+  /**
+   * @brief Enables measuring loss of orthogonality of the Krylov basis.
+   *
+   * This costs one additional inner product per iteration.
+   */
+  void ConvergenceHistory::setOrthogonalityTracking(bool track)
+  {
+    track_orthogonality_ = track;
+  }
+
+  bool ConvergenceHistory::getOrthogonalityTracking() const
+  {
+    return track_orthogonality_;
+  }
+
+  /// Removes all records, keeps the buffer.
+  void ConvergenceHistory::clear()
+  {
+    records_.clear();
+    num_dropped_ = 0;
+    last_stored_ = false;
+  }
+
+  /**
+   * @brief Marks the start of an iteration.
+   *
+   * @param[in] stats - counters of the solver
+   */
+  void ConvergenceHistory::startIteration(const SolverStats& stats)
+  {
+    if (capacity_ == 0) {
+      return;
+    }
+    time_precondition_  = stats.getTime(SolverStats::precondition);
+    time_matvec_        = stats.getTime(SolverStats::matvec);
+    time_orthogonalize_ = stats.getTime(SolverStats::orthogonalize);
+    time_sketch_        = stats.getTime(SolverStats::sketch);
+  }
+
+  /**
+   * @brief Records the iteration started by the last call to
+   * startIteration.
+   *
+   * @param[in] iteration          - iteration number, starting at 1
+   * @param[in] cycle              - restart cycle, starting at 0
+   * @param[in] cycle_iteration    - iteration within the cycle
+   * @param[in] residual_norm      - estimated residual norm
+   * @param[in] orthogonality_loss - measured loss, negative if not measured
+   * @param[in] stats              - counters of the solver
+   */
+  void ConvergenceHistory::addIteration(index_type iteration,
+                                        index_type cycle,
+                                        index_type cycle_iteration,
+                                        real_type residual_norm,
+                                        real_type orthogonality_loss,
+                                        const SolverStats& stats)
+  {
+    if (capacity_ == 0) {
+      return;
+    }
+    if (static_cast<index_type>(records_.size()) >= capacity_) {
+      num_dropped_++;
+      last_stored_ = false;
+      return;
+    }
+    Record record;
+    record.iteration          = iteration;
+    record.cycle              = cycle;
+    record.cycle_iteration    = cycle_iteration;
+    record.residual_norm      = residual_norm;
+    record.orthogonality_loss = orthogonality_loss;
+    record.time_precondition  = stats.getTime(SolverStats::precondition)  - time_precondition_;
+    record.time_matvec        = stats.getTime(SolverStats::matvec)        - time_matvec_;
+    record.time_orthogonalize = stats.getTime(SolverStats::orthogonalize) - time_orthogonalize_;
+    record.time_sketch        = stats.getTime(SolverStats::sketch)        - time_sketch_;
+    records_.push_back(record);
+    last_stored_ = true;
+  }
+
+  /**
+   * @brief Marks the latest iteration as the end of a restart cycle.
+   *
+   * @param[in] computed_residual_norm - residual norm computed after
+   * updating the solution
+   */
+  void ConvergenceHistory::endCycle(real_type computed_residual_norm)
+  {
+    if (!last_stored_) {
+      return;
+    }
+    records_.back().end_of_cycle = true;
+    records_.back().computed_residual_norm = computed_residual_norm;
+  }
+
+  /// Number of stored iterations.
+  index_type ConvergenceHistory::getSize() const
+  {
+    return static_cast<index_type>(records_.size());
+  }
+
+  /// Number of iterations not stored because the buffer was full.
+  index_type ConvergenceHistory::getNumDropped() const
+  {
+    return num_dropped_;
+  }
+
+  /**
+   * @brief Returns record of i-th stored iteration.
+   *
+   * @pre 0 <= i < getSize()
+   */
+  const ConvergenceHistory::Record& ConvergenceHistory::get(index_type i) const
+  {
+    return records_[static_cast<std::size_t>(i)];
+  }
+
+  const std::vector<ConvergenceHistory::Record>& ConvergenceHistory::getRecords() const
+  {
+    return records_;
+  }
+}
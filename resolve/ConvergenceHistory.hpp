@@ -0,0 +1,101 @@
+/**
+ * @file ConvergenceHistory.hpp
+ * @brief Per-iteration convergence history of Krylov solvers.
+ *
+ */
+#pragma once
+
+#include <vector>
+
+#include "Common.hpp"
+#include "SolverStats.hpp"
+
+namespace ReSolve
+{
+  /**
+   * @brief Structured record of each iteration of a Krylov solver.
+   *
+   * Recording is disabled by default. Setting a nonzero capacity allocates
+   * the buffer for records once, so iterations of a solve do not allocate
+   * memory. Iterations beyond the capacity are counted, but not stored.
+   * The history is cleared at the start of each solve.
+   *
+   * Phase times of an iteration are differences of the solver's
+   * SolverStats counters, so no additional clocks are read.
+   */
+  class ConvergenceHistory
+  {
+    public:
+      /// Data of one iteration.
+      struct Record
+      {
+        index_type iteration{0};       ///< iteration number, starting at 1
+        index_type cycle{0};           ///< restart cycle, starting at 0
+        index_type cycle_iteration{0}; ///< iteration within the cycle, starting at 0
+        real_type residual_norm{0.0};  ///< residual norm estimated by the Arnoldi process
+
+        /// Residual norm recomputed at the end of the cycle, negative if not computed
+        real_type computed_residual_norm{-1.0};
+
+        /// Absolute inner product of the newest basis vector with the first one (FGMRES) or, in
+        /// the sketched inner product, the largest one with any earlier one (randomized FGMRES);
+        /// negative if not measured
+        real_type orthogonality_loss{-1.0};
+
+        real_type time_precondition{0.0};  ///< seconds
+        real_type time_matvec{0.0};        ///< seconds
+        real_type time_orthogonalize{0.0}; ///< seconds
+        real_type time_sketch{0.0};        ///< seconds
+
+        bool end_of_cycle{false}; ///< last iteration before a restart or exit
+      };
+
+      ConvergenceHistory();
+      ~ConvergenceHistory() = default;
+
+      void setCapacity(index_type capacity);
+      index_type getCapacity() const;
+      void setOrthogonalityTracking(bool track);
+      bool getOrthogonalityTracking() const;
+
+      /// True if iterations are recorded.
+      bool isEnabled() const
+      {
+        return capacity_ > 0;
+      }
+
+      /// True if orthogonality loss should be measured in this iteration.
+      bool isTrackingOrthogonality() const
+      {
+        return track_orthogonality_ && capacity_ > 0;
+      }
+
+      void clear();
+      void startIteration(const SolverStats& stats);
+      void addIteration(index_type iteration,
+                        index_type cycle,
+                        index_type cycle_iteration,
+                        real_type residual_norm,
+                        real_type orthogonality_loss,
+                        const SolverStats& stats);
+      void endCycle(real_type computed_residual_norm);
+
+      index_type getSize() const;
+      index_type getNumDropped() const;
+      const Record& get(index_type i) const;
+      const std::vector<Record>& getRecords() const;
+
+    private:
+      std::vector<Record> records_;
+      index_type capacity_{0};
+      index_type num_dropped_{0};
+      bool track_orthogonality_{false};
+      bool last_stored_{false}; ///< whether the latest iteration was stored
+
+      // Phase times at the start of the current iteration
+      real_type time_precondition_{0.0};
+      real_type time_matvec_{0.0};
+      real_type time_orthogonalize_{0.0};
+      real_type time_sketch_{0.0};
+  };
+}
@@ -1,9 +1,11 @@
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 
 #include <resolve/utilities/logger/Logger.hpp>
 #include <resolve/vector/Vector.hpp>
+#include <resolve/random/SketchingHandler.hpp>
 #include "GramSchmidt.hpp"
 
 namespace ReSolve
@@ -85,6 +87,71 @@ namespace ReSolve
     return setup_complete_;
   }
 
+  /// Size of sketched vectors, nonzero only for the `rgs` variant.
+  index_type GramSchmidt::getSketchSize() const
+  {
+    return k_sketch_;
+  }
+
+  /**
+   * @brief Applies the sketching operator Theta used by randomized
+   * Gram-Schmidt, y = Theta x.
+   *
+   * Basis computed by the `rgs` variant is orthonormal in the sketched
+   * inner product <Theta x, Theta y>, which can be checked with this
+   * function.
+   *
+   * @param[in]  x - vector of size _n_
+   * @param[out] y - vector of size getSketchSize(), overwritten
+   *
+   * @pre setup() has been called for the `rgs` variant.
+   *
+   * @return 0 if successful, 1 if sketching is not set up.
+   */
+  int GramSchmidt::sketch(vector_type* x, vector_type* y)
+  {
+    if (sketching_handler_ == nullptr) {
+      out::error() << "Sketching is used only by randomized Gram-Schmidt.\n";
+      return 1;
+    }
+    y->setToZero(memspace_);
+    int status = sketching_handler_->Theta(x, y);
+    mem_.deviceSynchronize();
+    return status;
+  }
+
+  /**
+   * @brief Returns bytes held by orthogonalization workspaces, including
+   * the sketched basis of randomized Gram-Schmidt.
+   */
+  memory::MemoryUsage GramSchmidt::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    const vector_type* vectors[] = {vec_rv_, vec_Hcolumn_, vec_v_, vec_w_, vec_S_, vec_s_, vec_delayed_};
+    for (const vector_type* vec : vectors) {
+      if (vec != nullptr) {
+        usage += vec->getMemoryUsage();
+      }
+    }
+    std::size_t num_vecs = static_cast<std::size_t>(num_vecs_);
+    if (h_L_ != nullptr) {
+      usage.host_bytes += sizeof(real_type) * num_vecs * (num_vecs + 1);
+    }
+    if (h_Hraw_ != nullptr) {
+      usage.host_bytes += sizeof(real_type) * num_vecs * (num_vecs + 1);
+    }
+    const real_type* columns[] = {h_rv_, h_aux_, h_sdiag_};
+    for (const real_type* column : columns) {
+      if (column != nullptr) {
+        usage.host_bytes += sizeof(real_type) * (num_vecs + 1);
+      }
+    }
+    if (sketching_handler_ != nullptr) {
+      usage += sketching_handler_->getMemoryUsage();
+    }
+    return usage;
+  }
+
   int GramSchmidt::setup(index_type n, index_type restart)
   {
     if (setup_complete_) {
@@ -124,6 +191,39 @@ namespace ReSolve
     if(variant_ == mgs_pm) {
       h_aux_ = new real_type[num_vecs_ + 1]();
     }
+    if((variant_ == mgs_one_sync) || (variant_ == cgs2_two_sync)) {
+      h_L_  = new real_type[num_vecs_ * (num_vecs_ + 1)]();
+
+      vec_rv_ = new vector_type(num_vecs_ + 1, 2);
+      vec_rv_->allocate(memspace_);
+      vec_rv_->setToZero(memspace_);
+
+      vec_Hcolumn_ = new vector_type(num_vecs_ + 1);
+      vec_Hcolumn_->allocate(memspace_);
+      vec_Hcolumn_->setToZero(memspace_);
+    }
+    if(variant_ == cgs2_two_sync) {
+      h_aux_ = new real_type[num_vecs_ + 1]();
+    }
+    if(variant_ == rgs) {
+      setupSketching(n);
+    }
+    if(variant_ == dcgs2) {
+      h_Hraw_ = new real_type[num_vecs_ * (num_vecs_ + 1)]();
+      h_aux_  = new real_type[num_vecs_ + 1]();
+
+      vec_rv_ = new vector_type(num_vecs_ + 1, 2);
+      vec_rv_->allocate(memspace_);
+      vec_rv_->setToZero(memspace_);
+
+      vec_Hcolumn_ = new vector_type(num_vecs_ + 1);
+      vec_Hcolumn_->allocate(memspace_);
+      vec_Hcolumn_->setToZero(memspace_);
+
+      vec_delayed_ = new vector_type(num_vecs_ + 1);
+      vec_delayed_->allocate(memspace_);
+      vec_delayed_->setToZero(memspace_);
+    }
 
     return 0;
   }
@@ -355,6 +455,255 @@ namespace ReSolve
         }
         return 0;
         break;
+      case mgs_one_sync:
+        // Single fused reduction: [V(:,1:i+1) w]^T [V(:,i) w]
+        // provides the row i of the lower triangular matrix L, the
+        // projections V^T w, and w^T w needed for normalization.
+        vec_v_->setData(V->getVectorData(i, memspace_), memspace_);
+        vec_w_->setData(V->getVectorData(i + 1, memspace_), memspace_);
+        vec_rv_->setCurrentSize(i + 2);
+
+        vector_handler_->massDot2Vec(n, V, i + 2, vec_v_, vec_rv_, memspace_);
+        vec_rv_->setDataUpdated(memspace_);
+        vec_rv_->copyData(memspace_, memory::HOST);
+
+        vec_rv_->deepCopyVectorData(&h_L_[idxmap(i, 0, num_vecs_ + 1)], 0, memory::HOST);
+        h_rv_ = vec_rv_->getVectorData(1, memory::HOST);
+
+        // triangular solve (D + L) h = V^T w, where D is the diagonal of
+        // V^T V; basis vectors normalized without a reduction may not have
+        // exactly unit norm.
+        for(int j = 0; j <= i; ++j) {
+          H[ idxmap(i, j, num_vecs_ + 1) ] = h_rv_[j];
+          s = 0.0;
+          for(int k = 0; k < j; ++k) {
+            s += h_L_[ idxmap(j, k, num_vecs_ + 1) ] * H[ idxmap(i, k, num_vecs_ + 1) ];
+          } // for k
+          H[ idxmap(i, j, num_vecs_ + 1) ] -= s; 
+          H[ idxmap(i, j, num_vecs_ + 1) ] /= h_L_[ idxmap(j, j, num_vecs_ + 1) ];
+        }   // for j
+
+        vec_Hcolumn_->setCurrentSize(i + 1);
+        vec_Hcolumn_->update(&H[ idxmap(i, 0, num_vecs_ + 1)], memory::HOST, memspace_); 
+        vector_handler_->massAxpy(n, vec_Hcolumn_, i + 1, V, vec_w_, memspace_);
+
+        // normalize using the Pythagorean identity (no additional synch)
+        s = h_rv_[i + 1];
+        t = projectedNormSquared(i, &H[ idxmap(i, 0, num_vecs_ + 1) ], h_rv_, s);
+        if (t <= pythagorean_tol_ * s) {
+          // Severe cancellation, fall back to explicit norm computation
+          t = vector_handler_->dot(vec_w_, vec_w_, memspace_);
+        }
+        t = std::sqrt(t);
+        H[ idxmap(i, i + 1, num_vecs_ + 1) ] = t;
+        if(std::abs(t) > EPSILON) {
+          t = 1.0 / t;
+          vector_handler_->scal(&t, vec_w_, memspace_);  
+        } else {
+          assert(0 && "Gram-Schmidt failed, vector with ZERO norm\n");
+          return -1;
+        }
+        return 0;
+        break;
+
+      case cgs2_two_sync:
+        // Two-sync adaptation of CGS2; see dcgs2 for the one-sync variant
+        // with delayed reorthogonalization.
+        //
+        // First projection; the fused reduction also provides the row i
+        // of the Gram matrix V^T V used for normalization. Projections are
+        // scaled by the diagonal of V^T V since basis vectors normalized
+        // without a reduction may not have exactly unit norm.
+        vec_v_->setData(V->getVectorData(i, memspace_), memspace_);
+        vec_w_->setData(V->getVectorData(i + 1, memspace_), memspace_);
+        vec_rv_->setCurrentSize(i + 2);
+
+        vector_handler_->massDot2Vec(n, V, i + 2, vec_v_, vec_rv_, memspace_);
+        vec_rv_->setDataUpdated(memspace_);
+        vec_rv_->copyData(memspace_, memory::HOST);
+
+        vec_rv_->deepCopyVectorData(&h_L_[idxmap(i, 0, num_vecs_ + 1)], 0, memory::HOST);
+        h_rv_ = vec_rv_->getVectorData(1, memory::HOST);
+        for(int j = 0; j <= i; ++j) {
+          h_aux_[j] = h_rv_[j] / h_L_[ idxmap(j, j, num_vecs_ + 1) ];
+        }
+
+        vec_Hcolumn_->setCurrentSize(i + 1);
+        vec_Hcolumn_->update(h_aux_, memory::HOST, memspace_); 
+        vector_handler_->massAxpy(n, vec_Hcolumn_, i + 1, V, vec_w_, memspace_);
+
+        // Reorthogonalization fused with computing the norm of the
+        // first-pass vector: V(:,0:i+1)^T w gives both V^T w and w^T w,
+        // since w is stored in column i+1.
+        vec_Hcolumn_->setCurrentSize(i + 2);
+        vector_handler_->gemv('T', n, i + 2, &ONE, &ZERO, V, vec_w_, vec_Hcolumn_, memspace_);
+        mem_.deviceSynchronize();
+        vec_Hcolumn_->setDataUpdated(memspace_);
+        vec_Hcolumn_->deepCopyVectorData(h_rv_, 0, memory::HOST);
+        vec_Hcolumn_->setCurrentSize(i + 1);
+
+        for(int j = 0; j <= i; ++j) {
+          H[ idxmap(i, j, num_vecs_ + 1) ] = h_rv_[j] / h_L_[ idxmap(j, j, num_vecs_ + 1) ];
+        }
+        vec_Hcolumn_->update(&H[ idxmap(i, 0, num_vecs_ + 1)], memory::HOST, memspace_); 
+        vector_handler_->massAxpy(n, vec_Hcolumn_, i + 1, V, vec_w_, memspace_);
+
+        // normalize using the Pythagorean identity (no additional synch)
+        s = h_rv_[i + 1];
+        t = projectedNormSquared(i, &H[ idxmap(i, 0, num_vecs_ + 1) ], h_rv_, s);
+        if (t <= pythagorean_tol_ * s) {
+          // Severe cancellation, fall back to explicit norm computation
+          t = vector_handler_->dot(vec_w_, vec_w_, memspace_);
+        }
+
+        // add both pieces together
+        for(int j = 0; j <= i; ++j) {
+          H[ idxmap(i, j, num_vecs_ + 1)] += h_aux_[j];
+        }
+
+        t = std::sqrt(t);
+        H[ idxmap(i, i + 1, num_vecs_ + 1) ] = t;
+        if(std::abs(t) > EPSILON) {
+          t = 1.0 / t;
+          vector_handler_->scal(&t, vec_w_, memspace_);  
+        } else {
+          assert(0 && "Gram-Schmidt failed, vector with ZERO norm\n");
+          return -1;
+        }
+        return 0;
+        break;
+
+      case rgs:
+        // Sketch the first basis vector when Arnoldi process (re)starts
+        vec_s_->setCurrentSize(k_sketch_);
+        if (i == 0) {
+          vec_S_->setToZero(memspace_);
+          vec_v_->setData(V->getVectorData(0, memspace_), memspace_);
+          vec_s_->setData(vec_S_->getVectorData(0, memspace_), memspace_);
+          sketching_handler_->Theta(vec_v_, vec_s_);
+          h_sdiag_[0] = vector_handler_->dot(vec_s_, vec_s_, memspace_);
+        }
+
+        // s = Theta*w
+        vec_w_->setData(V->getVectorData(i + 1, memspace_), memspace_);
+        vec_s_->setData(vec_S_->getVectorData(i + 1, memspace_), memspace_);
+        sketching_handler_->Theta(vec_w_, vec_s_);
+        mem_.deviceSynchronize();
+
+        // Sketched least squares min ||S h - s|| solved by CGS2 on
+        // k-length vectors. Columns of S are orthogonal, but not
+        // necessarily of unit norm, hence the diagonal scaling.
+        for (int pass = 0; pass < 2; ++pass) {
+          vector_handler_->gemv('T', k_sketch_, i + 1, &ONE, &ZERO, vec_S_, vec_s_, vec_Hcolumn_, memspace_);
+          mem_.deviceSynchronize();
+          vec_Hcolumn_->setDataUpdated(memspace_);
+          vec_Hcolumn_->setCurrentSize(i + 1);
+          vec_Hcolumn_->deepCopyVectorData(h_aux_, 0, memory::HOST);
+          for (int j = 0; j <= i; ++j) {
+            h_aux_[j] /= h_sdiag_[j];
+            if (pass == 0) {
+              H[ idxmap(i, j, num_vecs_ + 1) ] = h_aux_[j];
+            } else {
+              H[ idxmap(i, j, num_vecs_ + 1) ] += h_aux_[j];
+            }
+          }
+          vec_Hcolumn_->update(h_aux_, memory::HOST, memspace_);
+          vector_handler_->gemv('N', k_sketch_, i + 1, &MINUSONE, &ONE, vec_S_, vec_Hcolumn_, vec_s_, memspace_);
+        }
+
+        // w = w - V*h (no reduction on n-length vectors)
+        vec_Hcolumn_->update(&H[ idxmap(i, 0, num_vecs_ + 1) ], memory::HOST, memspace_);
+        vector_handler_->gemv('N', n, i + 1, &MINUSONE, &ONE, V, vec_Hcolumn_, vec_w_, memspace_);
+        mem_.deviceSynchronize();
+
+        // Sketch the projected vector again, so that S = Theta*V holds to
+        // working precision even when the projection cancels most of w.
+        vec_s_->setToZero(memspace_);
+        sketching_handler_->Theta(vec_w_, vec_s_);
+        mem_.deviceSynchronize();
+
+        // normalize in the sketched norm
+        t = vector_handler_->dot(vec_s_, vec_s_, memspace_);
+        t = std::sqrt(t);
+        H[ idxmap(i, i + 1, num_vecs_ + 1) ] = t;
+        if(std::abs(t) > EPSILON) {
+          t = 1.0 / t;
+          vector_handler_->scal(&t, vec_w_, memspace_);
+          vector_handler_->scal(&t, vec_s_, memspace_);
+          h_sdiag_[i + 1] = 1.0;
+        } else {
+          assert(0 && "Gram-Schmidt failed, vector with ZERO norm\n");
+          return -1;
+        }
+        return 0;
+        break;
+
+      case dcgs2:
+        // Single fused reduction [V(:,0:i)]^T [V(:,i) w] provides the
+        // delayed reorthogonalization coefficients and norm of V(:,i), which
+        // was only projected once at the previous step, and projections of
+        // the new vector w.
+        vec_v_->setData(V->getVectorData(i, memspace_), memspace_);
+        vec_w_->setData(V->getVectorData(i + 1, memspace_), memspace_);
+        vec_rv_->setCurrentSize(i + 1);
+
+        vector_handler_->massDot2Vec(n, V, i + 1, vec_v_, vec_rv_, memspace_);
+        vec_rv_->setDataUpdated(memspace_);
+        vec_rv_->copyData(memspace_, memory::HOST);
+        h_rv_ = vec_rv_->getVectorData(1, memory::HOST);
+
+        if (i > 0) {
+          // Reorthogonalize and normalize V(:,i), completes column i-1 of H
+          if (reorthogonalizeDelayed(n, V, H, i, vec_rv_->getVectorData(0, memory::HOST)) != 0) {
+            return -1;
+          }
+        } else {
+          delayed_norm_ = 1.0;
+        }
+        t = delayed_norm_;
+
+        // w was computed from V(:,i) before it was reorthogonalized and
+        // normalized. Since V(:,i) = (u - V(:,0:i-1) s) / t and columns of
+        // H express A V(:,j) in the basis, the new vector is corrected as
+        // w := (w - V(:,0:i) g) / t with g = H(0:i, 0:i-1) s, where H is
+        // taken before Givens rotations. Projections of the corrected vector
+        // follow from the same reduction. The vector g is accumulated in
+        // column i of H.
+        for(int j = 0; j <= i; ++j) {
+          s = 0.0;
+          for(int k = std::max(j - 1, 0); k < i; ++k) {
+            s += h_Hraw_[ idxmap(k, j, num_vecs_ + 1) ] * h_aux_[k];
+          }
+          H[ idxmap(i, j, num_vecs_ + 1) ] = s;
+        }
+
+        // V(:,i)^T w from V(:,0:i)^T u and V(:,0:i)^T w
+        for(int k = 0; k < i; ++k) {
+          h_rv_[i] -= h_aux_[k] * h_rv_[k];
+        }
+        h_rv_[i] /= t;
+
+        for(int j = 0; j <= i; ++j) {
+          s = H[ idxmap(i, j, num_vecs_ + 1) ];
+          H[ idxmap(i, j, num_vecs_ + 1) ] = (h_rv_[j] - s) / t;
+          h_Hraw_[ idxmap(i, j, num_vecs_ + 1) ] = H[ idxmap(i, j, num_vecs_ + 1) ];
+          // coefficients of the fused update w := w / t - V(:,0:i) c
+          h_rv_[j] = s / t + H[ idxmap(i, j, num_vecs_ + 1) ];
+        }
+        // Norm of the new vector is known after the next reduction
+        H[ idxmap(i, i + 1, num_vecs_ + 1) ] = 0.0;
+        h_Hraw_[ idxmap(i, i + 1, num_vecs_ + 1) ] = 0.0;
+
+        if (i > 0) {
+          s = 1.0 / t;
+          vector_handler_->scal(&s, vec_w_, memspace_);
+        }
+        vec_Hcolumn_->setCurrentSize(i + 1);
+        vec_Hcolumn_->update(h_rv_, memory::HOST, memspace_);
+        vector_handler_->massAxpy(n, vec_Hcolumn_, i + 1, V, vec_w_, memspace_);
+        return 0;
+        break;
+
       default:
         assert(0 && "Iterative refinement failed, wrong orthogonalization.\n");
         return -1;
@@ -364,10 +713,219 @@ namespace ReSolve
     return 0;
   } // int orthogonalize()
 
+  /**
+   * @brief Whether the variant delays reorthogonalization of new basis
+   * vectors to the next step.
+   *
+   * After orthogonalize(n, V, H, i) of a delayed variant, V(:,0:i) and
+   * columns 0 to i-1 of H are final, while V(:,i+1) is projected only once
+   * and column i of H is incomplete. Step i+1 completes them, or
+   * completeDelayed() does so at the end of an Arnoldi cycle.
+   */
+  bool GramSchmidt::isDelayed() const
+  {
+    return variant_ == dcgs2;
+  }
+
+  /**
+   * @brief Completes basis vector i+1 and column i of H when the Arnoldi
+   * cycle ends after step i. Does nothing for variants that are not delayed.
+   *
+   * @param[in]     n - size of basis vectors
+   * @param[in,out] V - Krylov basis
+   * @param[in,out] H - Hessenberg matrix
+   * @param[in]     i - last step of the cycle
+   *
+   * @return 0 if successful, -1 if the basis vector has zero norm.
+   */
+  int GramSchmidt::completeDelayed(index_type n, vector_type* V, real_type* H, index_type i)
+  {
+    using namespace constants;
+    if (!isDelayed()) {
+      return 0;
+    }
+
+    // V(:,0:i+1)^T V(:,i+1), the last entry is the squared norm
+    vec_w_->setData(V->getVectorData(i + 1, memspace_), memspace_);
+    vec_Hcolumn_->setCurrentSize(i + 2);
+    vector_handler_->gemv('T', n, i + 2, &ONE, &ZERO, V, vec_w_, vec_Hcolumn_, memspace_);
+    mem_.deviceSynchronize();
+    vec_Hcolumn_->setDataUpdated(memspace_);
+    vec_Hcolumn_->deepCopyVectorData(h_aux_, 0, memory::HOST);
+
+    return reorthogonalizeDelayed(n, V, H, i + 1, h_aux_);
+  }
+
+  /**
+   * @brief Applies the correction of basis vector V(:,i) done by the last
+   * orthogonalize() call to the matching vector of another basis, i.e.
+   * Z(:,i) := (Z(:,i) - Z(:,0:i-1) s) / t. Does nothing for variants that
+   * are not delayed.
+   *
+   * Flexible GMRES uses this to keep A Z = V H exact for preconditioned
+   * vectors computed from the basis vector before its reorthogonalization.
+   *
+   * @param[in]     n - size of basis vectors
+   * @param[in,out] Z - basis with vectors matching columns of V
+   * @param[in]     i - step of the last orthogonalize() call
+   *
+   * @return 0 if successful.
+   */
+  int GramSchmidt::applyDelayedCorrection(index_type n, vector_type* Z, index_type i)
+  {
+    if (!isDelayed() || (i == 0)) {
+      return 0;
+    }
+    vec_v_->setData(Z->getVectorData(i, memspace_), memspace_);
+    vector_handler_->massAxpy(n, vec_delayed_, i, Z, vec_v_, memspace_);
+    real_type t = 1.0 / delayed_norm_;
+    vector_handler_->scal(&t, vec_v_, memspace_);
+    return 0;
+  }
+
 //
 // Private methods
 //
 
+  /**
+   * @brief Allocates data for randomized Gram-Schmidt.
+   * 
+   * Randomized Gram-Schmidt (Balabanov and Grigori, 2022) orthogonalizes
+   * basis vectors with respect to the sketched inner product
+   * <Theta x, Theta y>, so all reductions are performed on vectors of the
+   * sketch size k instead of n. Count sketch with k = restart*log(n) is
+   * used, the same as in randomized FGMRES.
+   * 
+   * @param[in] n - size of basis vectors
+   * 
+   * @pre `num_vecs_` is set.
+   */
+  int GramSchmidt::setupSketching(index_type n)
+  {
+    memory::DeviceType devtype = memory::NONE;
+    if (vector_handler_->getIsCudaEnabled()) {
+      devtype = memory::CUDADEVICE;
+    } else if (vector_handler_->getIsHipEnabled()) {
+      devtype = memory::HIPDEVICE;
+    }
+
+    k_sketch_ = n;
+    if (std::ceil(num_vecs_ * std::log(static_cast<real_type>(n))) < k_sketch_) {
+      k_sketch_ = static_cast<index_type>(std::ceil(num_vecs_ * std::log(static_cast<real_type>(n))));
+    }
+
+    sketching_handler_ = new SketchingHandler(LinSolverIterativeRandFGMRES::cs, devtype);
+    sketching_handler_->setup(n, k_sketch_);
+
+    vec_S_ = new vector_type(k_sketch_, num_vecs_ + 1);
+    vec_S_->allocate(memspace_);
+    vec_S_->setToZero(memspace_);
+    vec_s_ = new vector_type(k_sketch_);
+
+    vec_Hcolumn_ = new vector_type(num_vecs_ + 1);
+    vec_Hcolumn_->allocate(memspace_);
+    vec_Hcolumn_->setToZero(memspace_);
+
+    h_aux_   = new real_type[num_vecs_ + 1]();
+    h_sdiag_ = new real_type[num_vecs_ + 1]();
+
+    return 0;
+  }
+
+  /**
+   * @brief Squared norm of a vector after projection, computed without
+   * an additional global reduction.
+   * 
+   * For w' = w - V h, where r = V^T w, the Pythagorean identity gives
+   * ||w'||^2 = ||w||^2 - 2 h^T r + h^T G h, with Gram matrix G = V^T V.
+   * The lower triangle of G (including the diagonal) is stored row-wise
+   * in `h_L_`, so no assumption about orthonormality of V is made.
+   * 
+   * @param[in] i  - index of the last basis vector
+   * @param[in] h  - projection coefficients (size i + 1)
+   * @param[in] r  - inner products V^T w (size i + 1)
+   * @param[in] ww - squared norm of w
+   * @return real_type - squared norm of w'
+   * 
+   * @pre Rows 0 to i of `h_L_` contain V^T V entries.
+   */
+  real_type GramSchmidt::projectedNormSquared(index_type i,
+                                              const real_type* h,
+                                              const real_type* r,
+                                              real_type ww)
+  {
+    real_type hr  = 0.0;
+    real_type hGh = 0.0;
+    for (index_type j = 0; j <= i; ++j) {
+      hr += h[j] * r[j];
+      real_type s = 0.0;
+      for (index_type k = 0; k < j; ++k) {
+        s += h_L_[ idxmap(j, k, num_vecs_ + 1) ] * h[k];
+      }
+      hGh += h[j] * (2.0 * s + h_L_[ idxmap(j, j, num_vecs_ + 1) ] * h[j]);
+    }
+    return ww - 2.0 * hr + hGh;
+  }
+
+  /**
+   * @brief Delayed reorthogonalization and normalization of V(:,i), which
+   * was projected once when column i-1 of H was computed.
+   *
+   * Reorthogonalization coefficients s = V(:,0:i-1)^T V(:,i) are added to
+   * column i-1 of H and the norm of the reorthogonalized vector is obtained
+   * from the Pythagorean identity, which completes the column. Coefficients
+   * s are kept in `h_aux_` and `vec_delayed_`, and the norm in
+   * `delayed_norm_`.
+   *
+   * @param[in]     n - size of basis vectors
+   * @param[in,out] V - Krylov basis
+   * @param[in,out] H - Hessenberg matrix
+   * @param[in]     i - index of the delayed basis vector, i > 0
+   * @param[in]     r - V(:,0:i)^T V(:,i), size i + 1
+   *
+   * @return 0 if successful, -1 if the basis vector has zero norm.
+   */
+  int GramSchmidt::reorthogonalizeDelayed(index_type n,
+                                          vector_type* V,
+                                          real_type* H,
+                                          index_type i,
+                                          const real_type* r)
+  {
+    using namespace constants;
+
+    real_type t = r[i];
+    for (index_type k = 0; k < i; ++k) {
+      h_aux_[k] = r[k];
+      t -= r[k] * r[k];
+    }
+
+    vec_v_->setData(V->getVectorData(i, memspace_), memspace_);
+    vec_delayed_->setCurrentSize(i);
+    vec_delayed_->update(h_aux_, memory::HOST, memspace_);
+    vector_handler_->massAxpy(n, vec_delayed_, i, V, vec_v_, memspace_);
+    if (t <= pythagorean_tol_ * r[i]) {
+      // Severe cancellation, fall back to explicit norm computation
+      t = vector_handler_->dot(vec_v_, vec_v_, memspace_);
+    }
+    t = std::sqrt(t);
+    if (!(t > EPSILON)) {
+      assert(0 && "Gram-Schmidt failed, vector with ZERO norm\n");
+      return -1;
+    }
+    delayed_norm_ = t;
+    t = 1.0 / t;
+    vector_handler_->scal(&t, vec_v_, memspace_);
+
+    for (index_type k = 0; k < i; ++k) {
+      H[ idxmap(i - 1, k, num_vecs_ + 1) ] += h_aux_[k];
+      h_Hraw_[ idxmap(i - 1, k, num_vecs_ + 1) ] += h_aux_[k];
+    }
+    H[ idxmap(i - 1, i, num_vecs_ + 1) ] = delayed_norm_;
+    h_Hraw_[ idxmap(i - 1, i, num_vecs_ + 1) ] = delayed_norm_;
+
+    return 0;
+  }
+
   int GramSchmidt::freeGramSchmidtData()
   {
     if(variant_ == mgs_two_sync || variant_ == mgs_pm) {    
@@ -399,6 +957,53 @@ namespace ReSolve
       h_aux_ = nullptr;
     }
 
+    if (variant_ == mgs_one_sync || variant_ == cgs2_two_sync) {
+      delete [] h_L_;
+      h_L_ = nullptr;
+      h_rv_ = nullptr; // points to vec_rv_ data
+
+      delete vec_rv_;
+      vec_rv_ = nullptr;
+      delete vec_Hcolumn_;
+      vec_Hcolumn_ = nullptr;
+    }
+
+    if (variant_ == cgs2_two_sync) {
+      delete [] h_aux_;
+      h_aux_ = nullptr;
+    }
+
+    if (variant_ == rgs) {
+      delete [] h_aux_;
+      h_aux_ = nullptr;
+      delete [] h_sdiag_;
+      h_sdiag_ = nullptr;
+
+      delete vec_Hcolumn_;
+      vec_Hcolumn_ = nullptr;
+      delete vec_S_;
+      vec_S_ = nullptr;
+      delete vec_s_;
+      vec_s_ = nullptr;
+      delete sketching_handler_;
+      sketching_handler_ = nullptr;
+    }
+
+    if (variant_ == dcgs2) {
+      delete [] h_Hraw_;
+      h_Hraw_ = nullptr;
+      delete [] h_aux_;
+      h_aux_ = nullptr;
+      h_rv_ = nullptr; // points to vec_rv_ data
+
+      delete vec_rv_;
+      vec_rv_ = nullptr;
+      delete vec_Hcolumn_;
+      vec_Hcolumn_ = nullptr;
+      delete vec_delayed_;
+      vec_delayed_ = nullptr;
+    }
+
     delete vec_w_;
     vec_w_ = nullptr;
     delete vec_v_;
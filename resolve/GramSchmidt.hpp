@@ -2,10 +2,13 @@
 #include "Common.hpp"
 #include <resolve/vector/VectorHandler.hpp>
 #include <resolve/MemoryUtils.hpp>
+#include <resolve/utilities/memory/MemoryTracker.hpp>
 #include <iostream>
 #include <cassert>
 namespace ReSolve 
 {
+  class SketchingHandler;
+
   class GramSchmidt
   {
       using vector_type = vector::Vector;
@@ -14,7 +17,11 @@ namespace ReSolve
                       cgs2,
                       mgs_two_sync, 
                       mgs_pm,
-                      cgs1};
+                      cgs1,
+                      mgs_one_sync,  ///< MGS with one reduction per step
+                      cgs2_two_sync, ///< CGS2 with two reductions per step
+                      rgs,
+                      dcgs2};        ///< CGS2 with delayed reorthogonalization, one reduction per step
 
       GramSchmidt() = delete;
       GramSchmidt(VectorHandler* vh, GSVariant variant);
@@ -27,13 +34,34 @@ namespace ReSolve
       int orthogonalize(index_type n, vector_type* V, real_type* H, index_type i);
       bool isSetupComplete();
 
+      // Delayed variants complete basis vector i+1 at step i+1
+      bool isDelayed() const;
+      int completeDelayed(index_type n, vector_type* V, real_type* H, index_type i);
+      int applyDelayedCorrection(index_type n, vector_type* Z, index_type i);
+
+      memory::MemoryUsage getMemoryUsage() const;
+
+      // Sketching operator of randomized Gram-Schmidt
+      index_type getSketchSize() const;
+      int sketch(vector_type* x, vector_type* y);
+
     private:
       int freeGramSchmidtData();
+      int setupSketching(index_type n);
+      real_type projectedNormSquared(index_type i,
+                                     const real_type* h,
+                                     const real_type* r,
+                                     real_type ww);
+      int reorthogonalizeDelayed(index_type n,
+                                 vector_type* V,
+                                 real_type* H,
+                                 index_type i,
+                                 const real_type* r);
     
       GSVariant variant_{mgs};
       bool setup_complete_{false}; //to avoid double allocations and stuff
 
-      index_type num_vecs_; //the same as restart  
+      index_type num_vecs_{0}; //the same as restart  
       vector_type* vec_rv_{nullptr};
       vector_type* vec_Hcolumn_{nullptr};
 
@@ -42,8 +70,24 @@ namespace ReSolve
       real_type* h_aux_{nullptr};
       VectorHandler* vector_handler_{nullptr};
 
+      /// Relative threshold below which norm computed from Pythagorean
+      /// identity is considered inaccurate (one-sync variants only)
+      real_type pythagorean_tol_{1e-8};
+
       vector_type* vec_v_{nullptr}; // aux variable
       vector_type* vec_w_{nullptr}; // aux variable
+
+      // Randomized Gram-Schmidt data
+      SketchingHandler* sketching_handler_{nullptr}; ///< Sketching operator Theta
+      index_type k_sketch_{0};        ///< Size of the sketch
+      vector_type* vec_S_{nullptr};   ///< Sketched basis S = Theta*V
+      vector_type* vec_s_{nullptr};   ///< Aux variable for a column of S
+      real_type* h_sdiag_{nullptr};   ///< Squared sketched norms of basis vectors
+
+      // Delayed CGS2 data
+      real_type* h_Hraw_{nullptr};        ///< Columns of H before FGMRES applies Givens rotations
+      vector_type* vec_delayed_{nullptr}; ///< Delayed reorthogonalization coefficients
+      real_type delayed_norm_{1.0};       ///< Norm of the last delayed basis vector
     
       MemoryHandler mem_; ///< Device memory manager object
       memory::MemorySpace memspace_;
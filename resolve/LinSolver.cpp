@@ -23,6 +23,32 @@ namespace ReSolve
     return 1.0;
   }
 
+  /**
+   * @brief Returns call counts, times and work estimates of solver phases.
+   */
+  const SolverStats& LinSolver::getStats() const
+  {
+    return stats_;
+  }
+
+  /// Sets performance counters of the solver to zero.
+  void LinSolver::resetStats()
+  {
+    stats_.reset();
+  }
+
+  /**
+   * @brief Returns bytes of host and device memory held by the solver.
+   *
+   * Counts matrix factors, Krylov bases and workspaces the solver owns.
+   * The system matrix and right-hand side belong to the caller and are
+   * not included.
+   */
+  memory::MemoryUsage LinSolver::getMemoryUsage() const
+  {
+    return memory::MemoryUsage();
+  }
+
   //
   // Direct solver methods implementations
   //
@@ -68,6 +94,36 @@ namespace ReSolve
     return 1;
   }
 
+  /**
+   * @brief Computes selected solution entries for a sparse right-hand side.
+   * 
+   * Solvers implementing this method only touch parts of the factors
+   * reachable from the right-hand side nonzeros, which is much cheaper
+   * than the full solve when both right-hand side and the set of requested
+   * solution entries are small.
+   * 
+   * @param[in]  nnz_rhs - number of nonzeros in the right-hand side
+   * @param[in]  rhs_idx - indices of right-hand side nonzeros
+   * @param[in]  rhs_val - values of right-hand side nonzeros
+   * @param[in]  num_sol - number of requested solution entries
+   * @param[in]  sol_idx - indices of requested solution entries
+   * @param[out] sol_val - values of requested solution entries
+   * 
+   * @pre Matrix has been factorized.
+   * 
+   * @return int - 0 if successful, error code otherwise
+   */
+  int LinSolverDirect::solveSparse(index_type /* nnz_rhs */,
+                                   const index_type* /* rhs_idx */,
+                                   const real_type* /* rhs_val */,
+                                   index_type /* num_sol */,
+                                   const index_type* /* sol_idx */,
+                                   real_type* /* sol_val */)
+  {
+    out::error() << "Solver does not implement sparse right-hand side solve.\n";
+    return 1;
+  }
+
   matrix::Sparse* LinSolverDirect::getLFactor()
   {
     return nullptr;
@@ -145,6 +201,24 @@ namespace ReSolve
     return total_iters_;
   }
 
+  /**
+   * @brief Returns per-iteration records of the last solve.
+   */
+  const ConvergenceHistory& LinSolverIterative::getConvergenceHistory() const
+  {
+    return history_;
+  }
+
+  /**
+   * @brief Returns convergence history, e.g. to set its capacity.
+   *
+   * Recording is disabled until a nonzero capacity is set.
+   */
+  ConvergenceHistory& LinSolverIterative::getConvergenceHistory()
+  {
+    return history_;
+  }
+
 
   real_type  LinSolverIterative::getTol()
   {
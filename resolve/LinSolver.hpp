@@ -1,6 +1,9 @@
 #pragma once
 #include <string>
 #include "Common.hpp"
+#include "ConvergenceHistory.hpp"
+#include "SolverStats.hpp"
+#include <resolve/utilities/memory/MemoryTracker.hpp>
 
 namespace ReSolve 
 {
@@ -34,6 +37,11 @@ namespace ReSolve
       virtual ~LinSolver();
 
       real_type evaluateResidual();
+
+      const SolverStats& getStats() const;
+      void resetStats();
+
+      virtual memory::MemoryUsage getMemoryUsage() const;
         
     protected:  
       matrix::Sparse* A_{nullptr};
@@ -42,6 +50,8 @@ namespace ReSolve
 
       MatrixHandler* matrix_handler_{nullptr};
       VectorHandler* vector_handler_{nullptr};
+
+      SolverStats stats_; ///< per-phase performance counters
   };
 
   class LinSolverDirect : public LinSolver 
@@ -61,6 +71,12 @@ namespace ReSolve
       virtual int refactorize();
       virtual int solve(vector_type* rhs, vector_type* x) = 0;
       virtual int solve(vector_type* x) = 0;
+      virtual int solveSparse(index_type nnz_rhs,
+                              const index_type* rhs_idx,
+                              const real_type* rhs_val,
+                              index_type num_sol,
+                              const index_type* sol_idx,
+                              real_type* sol_val);
      
       virtual matrix::Sparse* getLFactor(); 
       virtual matrix::Sparse* getUFactor(); 
@@ -99,6 +115,9 @@ namespace ReSolve
       virtual real_type getInitResidualNorm() const;
       virtual index_type getNumIter() const;
 
+      const ConvergenceHistory& getConvergenceHistory() const;
+      ConvergenceHistory& getConvergenceHistory();
+
       virtual int setOrthogonalization(GramSchmidt* gs);
 
       real_type getTol();
@@ -117,6 +136,7 @@ namespace ReSolve
       real_type initial_residual_norm_;
       real_type final_residual_norm_;
       index_type total_iters_;
+      ConvergenceHistory history_; ///< per-iteration records of the last solve
 
       real_type tol_{1e-14};
       index_type maxit_{100};
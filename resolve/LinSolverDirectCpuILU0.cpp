@@ -5,17 +5,22 @@
  * 
  * 
  */
+#include <algorithm>
 #include <cassert>
 
 #include <resolve/vector/Vector.hpp>
 #include <resolve/matrix/Csr.hpp>
 #include <resolve/workspace/LinAlgWorkspace.hpp>
 #include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/Profiling.hpp>
+#include <resolve/SparseTriangularSolver.hpp>
 
 #include "LinSolverDirectCpuILU0.hpp"
 
 namespace ReSolve 
 {
+  using out = io::Logger;
+
   LinSolverDirectCpuILU0::LinSolverDirectCpuILU0(LinAlgWorkspaceCpu* /* workspace */)
     // : workspace_(workspace)
   {
@@ -27,15 +32,32 @@ namespace ReSolve
    * @todo Address how L and U factors are deleted (currently base class does that).
    */
   LinSolverDirectCpuILU0::~LinSolverDirectCpuILU0()
+  {
+    freeFactorData();
+    delete sparse_solver_;
+  }
+
+  /**
+   * @brief Frees factors and buffers sized by the sparsity pattern.
+   */
+  void LinSolverDirectCpuILU0::freeFactorData()
   {
     if (owns_factors_) {
       delete L_;
       delete U_;
-      L_ = nullptr;
-      U_ = nullptr;
+      owns_factors_ = false;
     }
+    L_ = nullptr;
+    U_ = nullptr;
     delete [] diagU_;
     delete [] idxmap_;
+    delete [] valsL32_;
+    delete [] valsU32_;
+    diagU_   = nullptr;
+    idxmap_  = nullptr;
+    valsL32_ = nullptr;
+    valsU32_ = nullptr;
+    factorized_single_ = false;
   }
 
   int LinSolverDirectCpuILU0::setup(matrix::Sparse* A,
@@ -96,6 +118,8 @@ namespace ReSolve
 
   int LinSolverDirectCpuILU0::analyze()
   {
+    RESOLVE_RANGE_SCOPE("CpuILU0::analyze");
+    SolverStats::Timer timer(stats_, SolverStats::analyze);
     using namespace memory;
     int error_sum = 0;
 
@@ -104,6 +128,9 @@ namespace ReSolve
     const index_type* colsA = A_->getColData(memory::HOST);
     const real_type*  valsA = A_->getValues(memory::HOST);
 
+    // Sparsity pattern may have changed, so free data from previous analysis
+    freeFactorData();
+
     // Alloacate row pointers
     index_type* rowsU = new index_type[N + 1]{0};
     index_type* rowsL = new index_type[N + 1]{0};
@@ -170,6 +197,10 @@ namespace ReSolve
     assert(lcount == nnzL);
     assert(ucount == nnzU);
 
+    // Factor pattern changes, so sparse solver needs to be set up again
+    delete sparse_solver_;
+    sparse_solver_ = nullptr;
+
     // Use hijacking constructor to create L and U factors
     L_ = new matrix::Csr(N, N, nnzL, false, true, &rowsL, &colsL, &valsL, memory::HOST, memory::HOST);
     U_ = new matrix::Csr(N, N, nnzU, false, true, &rowsU, &colsU, &valsU, memory::HOST, memory::HOST);
@@ -182,51 +213,57 @@ namespace ReSolve
     return error_sum;
   }
 
+  /**
+   * @brief Computes incomplete LU factors in place.
+   * 
+   * On entry, `L_` and `U_` hold values of the system matrix split into
+   * lower and upper triangular parts. On exit they hold the ILU0 factors.
+   * If the single precision mode is selected, the factorization is computed
+   * on single precision copies of the factor values, which are then kept
+   * for the triangular solves. Values in `L_` and `U_` are updated to the
+   * (rounded) single precision result so that the factors returned by
+   * getLFactor() and getUFactor() are consistent with the ones applied.
+   * 
+   * @return int - status code
+   */
   int LinSolverDirectCpuILU0::factorize()
   {
+    RESOLVE_RANGE_SCOPE("CpuILU0::factorize");
+    SolverStats::Timer timer(stats_, SolverStats::factorize);
     using namespace memory;
     int error_sum = 0;
 
-    index_type* rowsL = L_->getRowData(HOST);
-    index_type* colsL = L_->getColData(HOST);
+    const index_type* rowsL = L_->getRowData(HOST);
+    const index_type* colsL = L_->getColData(HOST);
     real_type* valsL = L_->getValues(HOST);
 
-    index_type* rowsU = U_->getRowData(HOST);
-    index_type* colsU = U_->getColData(HOST);
+    const index_type* rowsU = U_->getRowData(HOST);
+    const index_type* colsU = U_->getColData(HOST);
     real_type* valsU = U_->getValues(HOST);
 
-    index_type N = A_->getNumRows();
-
-    for (index_type u = 0; u < N; ++u)
-       idxmap_[u] = -1;
-
-    // Factorize (incompletely)
-    for (index_type i = 1; i < N; ++i) {
-      for (index_type v = rowsL[i]; v < rowsL[i+1]; ++v) {
-        index_type k = colsL[v];
-        for (index_type u = rowsU[k]; u < rowsU[k+1]; ++u) {
-           idxmap_[colsU[u]] = u;
-        }
-        valsL[v] /= valsU[rowsU[k]];
+    const index_type N = A_->getNumRows();
 
-        for (index_type w = v+1; w < rowsL[i+1]; ++w) {
-          index_type j =  idxmap_[colsL[w]];
-          if (j == -1)
-            continue;
-          valsL[w] -= valsL[v]*valsU[j];
-        }
+    if (use_single_precision_) {
+      const index_type nnzL = L_->getNnz();
+      const index_type nnzU = U_->getNnz();
+      if (valsL32_ == nullptr) {
+        valsL32_ = new float[nnzL];
+      }
+      if (valsU32_ == nullptr) {
+        valsU32_ = new float[nnzU];
+      }
+      std::copy(valsL, valsL + nnzL, valsL32_);
+      std::copy(valsU, valsU + nnzU, valsU32_);
 
-        for (index_type w = rowsU[i]; w < rowsU[i+1]; ++w) {
-          index_type j =  idxmap_[colsU[w]];
-          if (j == -1)
-            continue;
-          valsU[w] -= valsL[v]*valsU[j];
-        }
+      factorizeInPlace(N, rowsL, colsL, valsL32_, rowsU, colsU, valsU32_, idxmap_);
 
-        for (index_type u = 0; u < N; ++u)
-           idxmap_[u] = -1;
-      }
+      std::copy(valsL32_, valsL32_ + nnzL, valsL);
+      std::copy(valsU32_, valsU32_ + nnzU, valsU);
+    } else {
+      factorizeInPlace(N, rowsL, colsL, valsL, rowsU, colsU, valsU, idxmap_);
     }
+    // Solves apply factors in the precision they were computed in.
+    factorized_single_ = use_single_precision_;
 
     return error_sum;
   }
@@ -239,6 +276,11 @@ namespace ReSolve
    */
   int LinSolverDirectCpuILU0::solve(vector_type* rhs_vec)
   {
+    RESOLVE_RANGE_SCOPE("CpuILU0::solve");
+    SolverStats::Timer timer(stats_, SolverStats::solve);
+    const real_type nnz_factors = static_cast<real_type>(L_->getNnz() + U_->getNnz());
+    const real_type value_size  = factorized_single_ ? sizeof(float) : sizeof(real_type);
+    timer.addWork(2.0 * nnz_factors, nnz_factors * (value_size + sizeof(index_type)));
     using namespace memory;
     int error_sum = 0;
     assert(A_->getNumRows() == rhs_vec->getSize());
@@ -247,27 +289,10 @@ namespace ReSolve
 
     real_type* rhs = rhs_vec->getData(HOST);
 
-    index_type* rowsL = L_->getRowData(HOST);
-    index_type* colsL = L_->getColData(HOST);
-    real_type*  valsL = L_->getValues(HOST);
-
-    // Forward substitution
-    for (index_type i = 0; i < N; ++i) {
-      for (index_type j = rowsL[i]; j < rowsL[i+1]; ++j) {
-        rhs[i] -= valsL[j] * rhs[colsL[j]];
-      }
-    }
-
-    index_type* rowsU = U_->getRowData(HOST);
-    index_type* colsU = U_->getColData(HOST);
-    real_type*  valsU = U_->getValues(HOST);
-
-    // Backward substitution
-    for (index_type i = N - 1; i >= 0; --i) {
-      for (index_type j = rowsU[i] + 1; j < rowsU[i+1]; ++j) {
-        rhs[i] -= valsU[j] * rhs[colsU[j]];
-      }
-      rhs[i] /= valsU[rowsU[i]];
+    if (factorized_single_) {
+      triangularSolve(N, L_, valsL32_, U_, valsU32_, rhs);
+    } else {
+      triangularSolve(N, L_, L_->getValues(HOST), U_, U_->getValues(HOST), rhs);
     }
 
     return error_sum;
@@ -282,6 +307,11 @@ namespace ReSolve
    */
   int LinSolverDirectCpuILU0::solve(vector_type* rhs_vec, vector_type* x_vec)
   {
+    RESOLVE_RANGE_SCOPE("CpuILU0::solve");
+    SolverStats::Timer timer(stats_, SolverStats::solve);
+    const real_type nnz_factors = static_cast<real_type>(L_->getNnz() + U_->getNnz());
+    const real_type value_size  = factorized_single_ ? sizeof(float) : sizeof(real_type);
+    timer.addWork(2.0 * nnz_factors, nnz_factors * (value_size + sizeof(index_type)));
     using namespace memory;
     int error_sum = 0;
     assert(A_->getNumRows() == rhs_vec->getSize());
@@ -292,31 +322,44 @@ namespace ReSolve
     const real_type* rhs = rhs_vec->getData(HOST);
     real_type*       x   = x_vec->getData(HOST);
 
-    const index_type* rowsL = L_->getRowData(HOST);
-    const index_type* colsL = L_->getColData(HOST);
-    const real_type*  valsL = L_->getValues(HOST);
-
-    // Forward substitution
-    for (index_type i = 0; i < N; ++i) {
-      x[i] = rhs[i];
-      for (index_type j = rowsL[i]; j < rowsL[i+1]; ++j) {
-        x[i] -= valsL[j] * x[colsL[j]];
-      }
+    std::copy(rhs, rhs + N, x);
+    if (factorized_single_) {
+      triangularSolve(N, L_, valsL32_, U_, valsU32_, x);
+    } else {
+      triangularSolve(N, L_, L_->getValues(HOST), U_, U_->getValues(HOST), x);
     }
 
-    const index_type* rowsU = U_->getRowData(HOST);
-    const index_type* colsU = U_->getColData(HOST);
-    const real_type*  valsU = U_->getValues(HOST);
+    return error_sum;
+  }
 
-    // Backward substitution
-    for (index_type i = N - 1; i >= 0; --i) {
-      for (index_type j = rowsU[i] + 1; j < rowsU[i+1]; ++j) {
-        x[i] -= valsU[j] * x[colsU[j]];
+  /**
+   * @brief Computes selected solution entries for a sparse right-hand side.
+   * 
+   * The sparse solver is set up at the first call after the analysis and
+   * reads factor values in place, so it stays valid after `reset`.
+   * 
+   * @see LinSolverDirect::solveSparse
+   */
+  int LinSolverDirectCpuILU0::solveSparse(index_type nnz_rhs,
+                                          const index_type* rhs_idx,
+                                          const real_type* rhs_val,
+                                          index_type num_sol,
+                                          const index_type* sol_idx,
+                                          real_type* sol_val)
+  {
+    if (L_ == nullptr || U_ == nullptr) {
+      out::error() << "ILU0 factors are not available.\n";
+      return 1;
+    }
+    if (sparse_solver_ == nullptr) {
+      sparse_solver_ = new SparseLUSolver();
+      if (sparse_solver_->setup(L_, U_) != 0) {
+        delete sparse_solver_;
+        sparse_solver_ = nullptr;
+        return 1;
       }
-      x[i] /= valsU[rowsU[i]];
     }
-
-    return error_sum;
+    return sparse_solver_->solve(nnz_rhs, rhs_idx, rhs_val, num_sol, sol_idx, sol_val);
   }
 
   matrix::Sparse* LinSolverDirectCpuILU0::getLFactor()
@@ -329,6 +372,39 @@ namespace ReSolve
     return U_;
   }
 
+  /**
+   * @brief Returns bytes held by ILU0 factors, their single precision
+   * copies, and the diagonal and index mapping buffers.
+   */
+  memory::MemoryUsage LinSolverDirectCpuILU0::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (owns_factors_) {
+      if (L_ != nullptr) {
+        usage += L_->getMemoryUsage();
+      }
+      if (U_ != nullptr) {
+        usage += U_->getMemoryUsage();
+      }
+    }
+    if (A_ != nullptr) {
+      std::size_t n = static_cast<std::size_t>(A_->getNumRows());
+      if (diagU_ != nullptr) {
+        usage.host_bytes += sizeof(real_type) * n;
+      }
+      if (idxmap_ != nullptr) {
+        usage.host_bytes += sizeof(index_type) * n;
+      }
+    }
+    if (valsL32_ != nullptr) {
+      usage.host_bytes += sizeof(float) * static_cast<std::size_t>(L_->getNnz());
+    }
+    if (valsU32_ != nullptr) {
+      usage.host_bytes += sizeof(float) * static_cast<std::size_t>(U_->getNnz());
+    }
+    return usage;
+  }
+
   /**
    * @brief Sets approximation to zero on matrix diagonal.
    * 
@@ -345,4 +421,131 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Selects precision in which ILU0 factors are computed and applied.
+   * 
+   * In the single precision mode, factor values are stored as `float`, which
+   * halves the memory traffic of the triangular solves. The solution vector
+   * is still accumulated in double precision. The preconditioner is then only
+   * single precision accurate and should be used within a flexible Krylov
+   * solver (e.g. FGMRES), which recovers double precision accuracy.
+   * 
+   * @param[in] is_single - use single precision factors if true
+   * @return int - returns status code
+   * 
+   * @post New setting takes effect at the next call to factorize(). Until
+   * then, solves apply the factors in the precision they were computed in.
+   */
+  int LinSolverDirectCpuILU0::setSinglePrecision(bool is_single)
+  {
+    use_single_precision_ = is_single;
+    return 0;
+  }
+
+  //
+  // Private methods
+  //
+
+  /**
+   * @brief ILU0 factorization kernel for a given precision.
+   * 
+   * @tparam T - floating point type of factor values
+   * 
+   * @param[in]     N      - number of matrix rows
+   * @param[in]     rowsL  - row pointers of factor L
+   * @param[in]     colsL  - column indices of factor L
+   * @param[in,out] valsL  - values of factor L
+   * @param[in]     rowsU  - row pointers of factor U (diagonal first)
+   * @param[in]     colsU  - column indices of factor U
+   * @param[in,out] valsU  - values of factor U
+   * @param[out]    idxmap - work array of size N
+   */
+  template <typename T>
+  void LinSolverDirectCpuILU0::factorizeInPlace(index_type N,
+                                                const index_type* rowsL,
+                                                const index_type* colsL,
+                                                T* valsL,
+                                                const index_type* rowsU,
+                                                const index_type* colsU,
+                                                T* valsU,
+                                                index_type* idxmap)
+  {
+    for (index_type u = 0; u < N; ++u)
+       idxmap[u] = -1;
+
+    // Factorize (incompletely)
+    for (index_type i = 1; i < N; ++i) {
+      for (index_type v = rowsL[i]; v < rowsL[i+1]; ++v) {
+        index_type k = colsL[v];
+        for (index_type u = rowsU[k]; u < rowsU[k+1]; ++u) {
+           idxmap[colsU[u]] = u;
+        }
+        valsL[v] /= valsU[rowsU[k]];
+
+        for (index_type w = v+1; w < rowsL[i+1]; ++w) {
+          index_type j =  idxmap[colsL[w]];
+          if (j == -1)
+            continue;
+          valsL[w] -= valsL[v]*valsU[j];
+        }
+
+        for (index_type w = rowsU[i]; w < rowsU[i+1]; ++w) {
+          index_type j =  idxmap[colsU[w]];
+          if (j == -1)
+            continue;
+          valsU[w] -= valsL[v]*valsU[j];
+        }
+
+        // Only entries of row k of U were mapped; unmap just those.
+        for (index_type u = rowsU[k]; u < rowsU[k+1]; ++u) {
+           idxmap[colsU[u]] = -1;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Forward and backward substitution with factors of given precision.
+   * 
+   * @tparam T - floating point type of factor values
+   * 
+   * @param[in]     N     - number of matrix rows
+   * @param[in]     L     - factor L (provides sparsity pattern)
+   * @param[in]     valsL - values of factor L
+   * @param[in]     U     - factor U (provides sparsity pattern)
+   * @param[in]     valsU - values of factor U
+   * @param[in,out] x     - right-hand side on input, solution on output
+   */
+  template <typename T>
+  void LinSolverDirectCpuILU0::triangularSolve(index_type N,
+                                               matrix::Sparse* L,
+                                               const T* valsL,
+                                               matrix::Sparse* U,
+                                               const T* valsU,
+                                               real_type* x)
+  {
+    using namespace memory;
+
+    const index_type* rowsL = L->getRowData(HOST);
+    const index_type* colsL = L->getColData(HOST);
+
+    // Forward substitution
+    for (index_type i = 0; i < N; ++i) {
+      for (index_type j = rowsL[i]; j < rowsL[i+1]; ++j) {
+        x[i] -= valsL[j] * x[colsL[j]];
+      }
+    }
+
+    const index_type* rowsU = U->getRowData(HOST);
+    const index_type* colsU = U->getColData(HOST);
+
+    // Backward substitution
+    for (index_type i = N - 1; i >= 0; --i) {
+      for (index_type j = rowsU[i] + 1; j < rowsU[i+1]; ++j) {
+        x[i] -= valsU[j] * x[colsU[j]];
+      }
+      x[i] /= valsU[rowsU[i]];
+    }
+  }
+
 } // namespace resolve
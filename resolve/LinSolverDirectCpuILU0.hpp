@@ -27,6 +27,8 @@ namespace ReSolve
   // Forward declaration of CPU workspace
   class LinAlgWorkspaceCpu;
 
+  class SparseLUSolver;
+
   /**
    * @brief Incomplete LU factorization solver.
    * 
@@ -38,6 +40,10 @@ namespace ReSolve
    * 
    * Methods in this class perform all operations on raw matrix data.
    * 
+   * Optionally, the factors can be computed and applied in single precision
+   * (see setSinglePrecision), for use as a preconditioner within a flexible
+   * Krylov solver that recovers double precision accuracy.
+   * 
    */
   class LinSolverDirectCpuILU0 : public LinSolverDirect 
   {
@@ -60,13 +66,41 @@ namespace ReSolve
        
       int solve(vector_type* rhs, vector_type* x) override;
       int solve(vector_type* rhs) override; // the solution is returned IN RHS (rhs is overwritten)
+      int solveSparse(index_type nnz_rhs,
+                      const index_type* rhs_idx,
+                      const real_type* rhs_val,
+                      index_type num_sol,
+                      const index_type* sol_idx,
+                      real_type* sol_val) override;
 
       matrix::Sparse* getLFactor() override;
       matrix::Sparse* getUFactor() override;
 
+      memory::MemoryUsage getMemoryUsage() const override;
+
       int setZeroDiagonal(real_type z);
+      int setSinglePrecision(bool is_single);
 
     private:
+      void freeFactorData();
+
+      template <typename T>
+      static void factorizeInPlace(index_type N,
+                                   const index_type* rowsL,
+                                   const index_type* colsL,
+                                   T* valsL,
+                                   const index_type* rowsU,
+                                   const index_type* colsU,
+                                   T* valsU,
+                                   index_type* idxmap);
+      template <typename T>
+      static void triangularSolve(index_type N,
+                                  matrix::Sparse* L,
+                                  const T* valsL,
+                                  matrix::Sparse* U,
+                                  const T* valsU,
+                                  real_type* x);
+
       // MemoryHandler mem_; ///< Device memory manager object
       // LinAlgWorkspaceCpu* workspace_{nullptr};
 
@@ -75,6 +109,13 @@ namespace ReSolve
       index_type* idxmap_{nullptr}; ///< Mapping for matrix column indices
       bool owns_factors_{false};    ///< If the class owns L and U factors
 
+      bool use_single_precision_{false}; ///< Compute factors in single precision at next factorize()
+      bool factorized_single_{false};    ///< Current factors are in single precision
+      float* valsL32_{nullptr};          ///< Single precision values of factor L
+      float* valsU32_{nullptr};          ///< Single precision values of factor U
+
       real_type zero_diagonal_{1e-6}; ///< Approximation for zero diagonal
+
+      SparseLUSolver* sparse_solver_{nullptr}; ///< Solver for sparse right-hand sides
   };
 } // namespace ReSolve
@@ -0,0 +1,565 @@
+/**
+ * @file LinSolverDirectCpuRf.cpp
+ * @brief Implementation of level-scheduled LU refactorization solver on CPU.
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/matrix/Csc.hpp>
+#include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/Profiling.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include <resolve/SparseTriangularSolver.hpp>
+#include "LinSolverDirectCpuRf.hpp"
+
+namespace ReSolve
+{
+  using vector_type = vector::Vector;
+  using out = io::Logger;
+
+  LinSolverDirectCpuRf::LinSolverDirectCpuRf(LinAlgWorkspaceCpu* workspace)
+    : workspace_(workspace)
+  {
+  }
+
+  LinSolverDirectCpuRf::~LinSolverDirectCpuRf()
+  {
+    freeFactors();
+  }
+
+  /**
+   * @brief Sets up refactorization from KLU factors.
+   *
+   * @param[in] A - matrix to be refactorized (CSR)
+   * @param[in] L - lower triangular factor in CSC format with unit diagonal
+   * @param[in] U - upper triangular factor in CSC format
+   * @param[in] P - row permutation of the factored matrix
+   * @param[in] Q - column permutation of the factored matrix
+   *
+   * @pre L, U, P and Q are obtained from KLU factorization of A, so that
+   * B(P, Q) = L U, where B is the CSC matrix sharing arrays with CSR
+   * matrix A.
+   *
+   * @post Factors are copied, levels of the column dependency DAG are
+   * computed, and A is refactorized.
+   *
+   * @return int - 0 if successful, error code otherwise
+   */
+  int LinSolverDirectCpuRf::setup(matrix::Sparse* A,
+                                  matrix::Sparse* L,
+                                  matrix::Sparse* U,
+                                  index_type*     P,
+                                  index_type*     Q,
+                                  vector_type*  /* rhs */)
+  {
+    RESOLVE_RANGE_SCOPE("CpuRf::setup");
+    if (A == nullptr || L == nullptr || U == nullptr || P == nullptr || Q == nullptr) {
+      out::error() << "CpuRf setup requires matrix, L and U factors, and P and Q permutations.\n";
+      return 1;
+    }
+
+    freeFactors();
+    A_ = A;
+    n_ = A_->getNumRows();
+
+    P_    = new index_type[n_];
+    Q_    = new index_type[n_];
+    Pinv_ = new index_type[n_];
+    std::memcpy(P_, P, static_cast<size_t>(n_) * sizeof(index_type));
+    std::memcpy(Q_, Q, static_cast<size_t>(n_) * sizeof(index_type));
+    for (index_type i = 0; i < n_; ++i) {
+      Pinv_[P_[i]] = i;
+    }
+
+    if (copyFactors(L, U) != 0) {
+      freeFactors();
+      return 1;
+    }
+    computeLevels();
+
+    // Factor values are updated in place, so this needs to be done only once
+    sparse_solver_ = new SparseLUSolver();
+    if (sparse_solver_->setup(L_csc_, U_csc_, P_, Q_) != 0) {
+      freeFactors();
+      return 1;
+    }
+
+    return refactorize();
+  }
+
+  /**
+   * @brief Recomputes values of L and U factors for current values of A.
+   *
+   * @pre Values of A changed, but its sparsity pattern did not.
+   *
+   * @return int - 0 if successful, 1 if a zero pivot is encountered
+   */
+  int LinSolverDirectCpuRf::refactorize()
+  {
+    RESOLVE_RANGE_SCOPE("CpuRf::refactorize");
+    SolverStats::Timer timer(stats_, SolverStats::refactorize);
+    if (L_csc_ == nullptr) {
+      out::error() << "CpuRf refactorization is not set up.\n";
+      return 1;
+    }
+
+    bool has_parallel_stage = false;
+    index_type max_width = 0;
+    for (size_t s = 0; s < stage_parallel_.size(); ++s) {
+      if (stage_parallel_[s]) {
+        has_parallel_stage = true;
+        max_width = std::max(max_width, stage_ptr_[s + 1] - stage_ptr_[s]);
+      }
+    }
+
+    int num_threads = threads::getNumThreads(max_width, MIN_LEVEL_COLUMNS_PER_THREAD);
+    bool ok = true;
+    if (has_parallel_stage && num_threads > 1) {
+      ok = factorizeParallel(num_threads);
+    } else {
+      ok = factorizeSerial();
+    }
+
+    L_csc_->setUpdated(memory::HOST);
+    U_csc_->setUpdated(memory::HOST);
+
+    if (!ok) {
+      out::error() << "CpuRf refactorization encountered zero pivot.\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Solves the system using permuted triangular factors.
+   *
+   * Uses the same convention as KLU solve, i.e. the solution x satisfies
+   * B x = rhs, where B(P, Q) = L U.
+   *
+   * @param[in]  rhs - right-hand side vector
+   * @param[out] x   - solution vector
+   *
+   * @return int - 0 if successful, 1 otherwise
+   */
+  int LinSolverDirectCpuRf::solve(vector_type* rhs, vector_type* x)
+  {
+    RESOLVE_RANGE_SCOPE("CpuRf::solve");
+    if (L_csc_ == nullptr) {
+      out::error() << "CpuRf solve called before setup.\n";
+      return 1;
+    }
+    SolverStats::Timer timer(stats_, SolverStats::solve);
+    const real_type nnz_factors = static_cast<real_type>(L_csc_->getNnz() + U_csc_->getNnz());
+    timer.addWork(2.0 * nnz_factors, nnz_factors * (sizeof(real_type) + sizeof(index_type)));
+
+    const index_type* Lp = L_csc_->getColData(memory::HOST);
+    const index_type* Li = L_csc_->getRowData(memory::HOST);
+    const real_type*  Lx = L_csc_->getValues( memory::HOST);
+    const index_type* Up = U_csc_->getColData(memory::HOST);
+    const index_type* Ui = U_csc_->getRowData(memory::HOST);
+    const real_type*  Ux = U_csc_->getValues( memory::HOST);
+
+    const real_type* b = rhs->getData(memory::HOST);
+    real_type* y = work_.data();
+
+    for (index_type k = 0; k < n_; ++k) {
+      y[k] = b[P_[k]];
+    }
+
+    // Forward solve with unit lower triangular L; diagonal is first in each column
+    for (index_type j = 0; j < n_; ++j) {
+      const real_type yj = y[j];
+      if (yj != 0.0) {
+        for (index_type p = Lp[j] + 1; p < Lp[j + 1]; ++p) {
+          y[Li[p]] -= Lx[p] * yj;
+        }
+      }
+    }
+
+    // Backward solve with U; diagonal is last in each column
+    for (index_type j = n_ - 1; j >= 0; --j) {
+      const real_type yj = y[j] / Ux[Up[j + 1] - 1];
+      y[j] = yj;
+      if (yj != 0.0) {
+        for (index_type p = Up[j]; p < Up[j + 1] - 1; ++p) {
+          y[Ui[p]] -= Ux[p] * yj;
+        }
+      }
+    }
+
+    real_type* sol = x->getData(memory::HOST);
+    for (index_type k = 0; k < n_; ++k) {
+      sol[Q_[k]] = y[k];
+    }
+    std::fill(y, y + n_, 0.0);
+    x->setDataUpdated(memory::HOST);
+
+    return 0;
+  }
+
+  /**
+   * @brief Solves the system in place.
+   *
+   * @param[in,out] x - right-hand side on input, solution on output
+   *
+   * @return int - 0 if successful, 1 otherwise
+   */
+  int LinSolverDirectCpuRf::solve(vector_type* x)
+  {
+    vector_type rhs(x->getSize());
+    rhs.allocate(memory::HOST);
+    rhs.update(x->getData(memory::HOST), memory::HOST, memory::HOST);
+    return solve(&rhs, x);
+  }
+
+  /**
+   * @brief Computes selected solution entries for a sparse right-hand side.
+   *
+   * @see LinSolverDirect::solveSparse
+   */
+  int LinSolverDirectCpuRf::solveSparse(index_type nnz_rhs,
+                                        const index_type* rhs_idx,
+                                        const real_type* rhs_val,
+                                        index_type num_sol,
+                                        const index_type* sol_idx,
+                                        real_type* sol_val)
+  {
+    if (sparse_solver_ == nullptr) {
+      out::error() << "CpuRf solve called before setup.\n";
+      return 1;
+    }
+    return sparse_solver_->solve(nnz_rhs, rhs_idx, rhs_val, num_sol, sol_idx, sol_val);
+  }
+
+  matrix::Sparse* LinSolverDirectCpuRf::getLFactor()
+  {
+    return L_csc_;
+  }
+
+  matrix::Sparse* LinSolverDirectCpuRf::getUFactor()
+  {
+    return U_csc_;
+  }
+
+  /**
+   * @brief Returns bytes held by copies of the factors, permutations,
+   * level schedule and per-thread work vectors.
+   */
+  memory::MemoryUsage LinSolverDirectCpuRf::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (L_csc_ != nullptr) {
+      usage += L_csc_->getMemoryUsage();
+    }
+    if (U_csc_ != nullptr) {
+      usage += U_csc_->getMemoryUsage();
+    }
+    if (Pinv_ != nullptr) {
+      usage.host_bytes += 3 * sizeof(index_type) * static_cast<std::size_t>(n_);
+    }
+    usage.host_bytes += sizeof(index_type) * (level_cols_.capacity() + stage_ptr_.capacity());
+    usage.host_bytes += sizeof(char) * stage_parallel_.capacity();
+    usage.host_bytes += sizeof(real_type) * work_.capacity();
+    return usage;
+  }
+
+  index_type* LinSolverDirectCpuRf::getPOrdering()
+  {
+    return P_;
+  }
+
+  index_type* LinSolverDirectCpuRf::getQOrdering()
+  {
+    return Q_;
+  }
+
+  /**
+   * @brief Cheap reciprocal condition number estimate min |U_ii| / max |U_ii|.
+   *
+   * Same estimate as KLU computes for its factors. A drop of this value
+   * between refactorizations indicates pivot growth.
+   *
+   * @return real_type - the estimate, -1 if factors are not set up
+   */
+  real_type LinSolverDirectCpuRf::getMatrixConditionNumber()
+  {
+    if (U_csc_ == nullptr) {
+      return -1.0;
+    }
+
+    const index_type* Up = U_csc_->getColData(memory::HOST);
+    const real_type*  Ux = U_csc_->getValues( memory::HOST);
+    real_type umin = 0.0;
+    real_type umax = 0.0;
+    for (index_type j = 0; j < n_; ++j) {
+      // Diagonal is the last entry of each column
+      real_type u = std::abs(Ux[Up[j + 1] - 1]);
+      umin = (j == 0) ? u : std::min(umin, u);
+      umax = (j == 0) ? u : std::max(umax, u);
+    }
+    return (umax > 0.0) ? umin / umax : 0.0;
+  }
+
+  /// Number of levels in the column dependency DAG.
+  index_type LinSolverDirectCpuRf::getNumLevels() const
+  {
+    return num_levels_;
+  }
+
+  //
+  // Private methods
+  //
+
+  void LinSolverDirectCpuRf::freeFactors()
+  {
+    delete L_csc_;
+    delete U_csc_;
+    delete [] P_;
+    delete [] Q_;
+    delete [] Pinv_;
+    delete sparse_solver_;
+    sparse_solver_ = nullptr;
+    L_csc_ = nullptr;
+    U_csc_ = nullptr;
+    L_     = nullptr;
+    U_     = nullptr;
+    P_     = nullptr;
+    Q_     = nullptr;
+    Pinv_  = nullptr;
+    num_levels_ = 0;
+    level_cols_.clear();
+    stage_ptr_.clear();
+    stage_parallel_.clear();
+    work_.clear();
+  }
+
+  /**
+   * @brief Copies factors and sorts row indices within each column.
+   *
+   * After sorting, the diagonal element is the first entry of each column
+   * of L and the last entry of each column of U.
+   *
+   * @return int - 0 if successful, 1 if factors are missing diagonal elements
+   */
+  int LinSolverDirectCpuRf::copyFactors(matrix::Sparse* L, matrix::Sparse* U)
+  {
+    matrix::Sparse* factors[2] = {L, U};
+    matrix::Csc* copies[2] = {nullptr, nullptr};
+    std::vector<std::pair<index_type, real_type> > column;
+
+    for (int f = 0; f < 2; ++f) {
+      const index_type  nnz  = factors[f]->getNnz();
+      const index_type* colp = factors[f]->getColData(memory::HOST);
+      const index_type* rowi = factors[f]->getRowData(memory::HOST);
+      const real_type*  vals = factors[f]->getValues( memory::HOST);
+
+      copies[f] = new matrix::Csc(n_, n_, nnz);
+      copies[f]->allocateMatrixData(memory::HOST);
+      index_type* cp = copies[f]->getColData(memory::HOST);
+      index_type* ri = copies[f]->getRowData(memory::HOST);
+      real_type*  vx = copies[f]->getValues( memory::HOST);
+
+      for (index_type j = 0; j <= n_; ++j) {
+        cp[j] = colp[j];
+      }
+      for (index_type j = 0; j < n_; ++j) {
+        column.clear();
+        for (index_type p = colp[j]; p < colp[j + 1]; ++p) {
+          column.emplace_back(rowi[p], vals[p]);
+        }
+        std::sort(column.begin(), column.end(),
+                  [](const std::pair<index_type, real_type>& a,
+                     const std::pair<index_type, real_type>& b) { return a.first < b.first; });
+        for (size_t k = 0; k < column.size(); ++k) {
+          ri[colp[j] + static_cast<index_type>(k)] = column[k].first;
+          vx[colp[j] + static_cast<index_type>(k)] = column[k].second;
+        }
+      }
+    }
+
+    L_csc_ = copies[0];
+    U_csc_ = copies[1];
+    L_ = L_csc_;
+    U_ = U_csc_;
+
+    const index_type* Lp = L_csc_->getColData(memory::HOST);
+    const index_type* Li = L_csc_->getRowData(memory::HOST);
+    const index_type* Up = U_csc_->getColData(memory::HOST);
+    const index_type* Ui = U_csc_->getRowData(memory::HOST);
+    for (index_type j = 0; j < n_; ++j) {
+      if (Lp[j] == Lp[j + 1] || Li[Lp[j]] != j || Up[j] == Up[j + 1] || Ui[Up[j + 1] - 1] != j) {
+        out::error() << "CpuRf: factors are missing diagonal element in column " << j << ".\n";
+        return 1;
+      }
+    }
+
+    work_.assign(static_cast<size_t>(n_), 0.0);
+    return 0;
+  }
+
+  /**
+   * @brief Groups columns in levels of the column dependency DAG.
+   *
+   * Column j depends on all columns k for which U(k, j) is nonzero, k < j.
+   * The level of column j is one more than the largest level of columns it
+   * depends on. Consecutive levels with fewer columns than needed to keep
+   * threads busy are merged into a single stage processed by one thread.
+   */
+  void LinSolverDirectCpuRf::computeLevels()
+  {
+    const index_type* Up = U_csc_->getColData(memory::HOST);
+    const index_type* Ui = U_csc_->getRowData(memory::HOST);
+
+    std::vector<index_type> level(static_cast<size_t>(n_), 0);
+    num_levels_ = 0;
+    for (index_type j = 0; j < n_; ++j) {
+      index_type lev = 0;
+      for (index_type p = Up[j]; p < Up[j + 1] - 1; ++p) {
+        lev = std::max(lev, level[Ui[p]] + 1);
+      }
+      level[j] = lev;
+      num_levels_ = std::max(num_levels_, lev + 1);
+    }
+
+    // Bucket sort columns by level
+    std::vector<index_type> level_ptr(static_cast<size_t>(num_levels_) + 1, 0);
+    for (index_type j = 0; j < n_; ++j) {
+      level_ptr[level[j] + 1]++;
+    }
+    for (index_type l = 0; l < num_levels_; ++l) {
+      level_ptr[l + 1] += level_ptr[l];
+    }
+    level_cols_.assign(static_cast<size_t>(n_), 0);
+    std::vector<index_type> next(level_ptr.begin(), level_ptr.end() - 1);
+    for (index_type j = 0; j < n_; ++j) {
+      level_cols_[next[level[j]]++] = j;
+    }
+
+    // Merge runs of narrow levels into serial stages
+    const index_type min_width = 2 * MIN_LEVEL_COLUMNS_PER_THREAD;
+    stage_ptr_.assign(1, 0);
+    stage_parallel_.clear();
+    for (index_type l = 0; l < num_levels_; ++l) {
+      const bool wide = (level_ptr[l + 1] - level_ptr[l]) >= min_width;
+      if (wide || stage_parallel_.empty() || stage_parallel_.back()) {
+        stage_ptr_.push_back(level_ptr[l + 1]);
+        stage_parallel_.push_back(wide);
+      } else {
+        stage_ptr_.back() = level_ptr[l + 1];
+      }
+    }
+  }
+
+  /**
+   * @brief Computes column j of L and U factors (left-looking).
+   *
+   * @param[in]     j - column index in the factored matrix
+   * @param[in,out] x - dense work vector, all zeros on input and output
+   *
+   * @return bool - false if the pivot is zero
+   */
+  bool LinSolverDirectCpuRf::factorizeColumn(index_type j, real_type* x)
+  {
+    // CSR arrays of A are CSC arrays of the matrix factored by KLU
+    const index_type* Bp = A_->getRowData(memory::HOST);
+    const index_type* Bi = A_->getColData(memory::HOST);
+    const real_type*  Bx = A_->getValues( memory::HOST);
+
+    const index_type* Lp = L_csc_->getColData(memory::HOST);
+    const index_type* Li = L_csc_->getRowData(memory::HOST);
+    real_type*        Lx = L_csc_->getValues( memory::HOST);
+    const index_type* Up = U_csc_->getColData(memory::HOST);
+    const index_type* Ui = U_csc_->getRowData(memory::HOST);
+    real_type*        Ux = U_csc_->getValues( memory::HOST);
+
+    // Scatter permuted column of the matrix
+    const index_type col = Q_[j];
+    for (index_type p = Bp[col]; p < Bp[col + 1]; ++p) {
+      x[Pinv_[Bi[p]]] += Bx[p];
+    }
+
+    // Apply updates from columns k < j in increasing order
+    const index_type diag = Up[j + 1] - 1;
+    for (index_type q = Up[j]; q < diag; ++q) {
+      const index_type k = Ui[q];
+      const real_type ukj = x[k];
+      if (ukj != 0.0) {
+        for (index_type p = Lp[k] + 1; p < Lp[k + 1]; ++p) {
+          x[Li[p]] -= Lx[p] * ukj;
+        }
+      }
+    }
+
+    // Gather U and L columns and clear the work vector
+    for (index_type q = Up[j]; q <= diag; ++q) {
+      Ux[q] = x[Ui[q]];
+      x[Ui[q]] = 0.0;
+    }
+    const real_type pivot = Ux[diag];
+    Lx[Lp[j]] = 1.0;
+    for (index_type p = Lp[j] + 1; p < Lp[j + 1]; ++p) {
+      Lx[p] = x[Li[p]] / pivot;
+      x[Li[p]] = 0.0;
+    }
+
+    return pivot != 0.0;
+  }
+
+  bool LinSolverDirectCpuRf::factorizeSerial()
+  {
+    real_type* x = work_.data();
+    bool ok = true;
+    for (index_type j : level_cols_) {
+      ok = factorizeColumn(j, x) && ok;
+    }
+    return ok;
+  }
+
+  /**
+   * @brief Computes factors level by level using a team of threads.
+   *
+   * Columns in a parallel stage are distributed cyclically among threads.
+   * Serial stages are processed by thread 0. Threads synchronize at the
+   * end of each stage.
+   */
+  bool LinSolverDirectCpuRf::factorizeParallel(int num_threads)
+  {
+    const size_t nt = static_cast<size_t>(num_threads);
+    if (work_.size() < nt * static_cast<size_t>(n_)) {
+      work_.assign(nt * static_cast<size_t>(n_), 0.0);
+    }
+
+    threads::Barrier barrier(num_threads);
+    std::atomic<bool> ok(true);
+    const index_type num_stages = static_cast<index_type>(stage_parallel_.size());
+
+    threads::parallelFor(num_threads, 0, num_threads,
+      [&](int tid, index_type /* lo */, index_type /* hi */) {
+        real_type* x = work_.data() + static_cast<size_t>(tid) * static_cast<size_t>(n_);
+        bool thread_ok = true;
+        for (index_type s = 0; s < num_stages; ++s) {
+          if (stage_parallel_[s]) {
+            for (index_type c = stage_ptr_[s] + tid; c < stage_ptr_[s + 1]; c += num_threads) {
+              thread_ok = factorizeColumn(level_cols_[c], x) && thread_ok;
+            }
+          } else if (tid == 0) {
+            for (index_type c = stage_ptr_[s]; c < stage_ptr_[s + 1]; ++c) {
+              thread_ok = factorizeColumn(level_cols_[c], x) && thread_ok;
+            }
+          }
+          barrier.wait();
+        }
+        if (!thread_ok) {
+          ok = false;
+        }
+      });
+
+    return ok;
+  }
+} // namespace ReSolve
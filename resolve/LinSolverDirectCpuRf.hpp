@@ -0,0 +1,116 @@
+/**
+ * @file LinSolverDirectCpuRf.hpp
+ * @brief Declaration of level-scheduled LU refactorization solver on CPU.
+ *
+ */
+#pragma once
+#include <vector>
+
+#include "Common.hpp"
+#include "LinSolver.hpp"
+
+namespace ReSolve
+{
+  // Forward declaration of vector::Vector class
+  namespace vector
+  {
+    class Vector;
+  }
+
+  // Forward declaration of matrix::Sparse class
+  namespace matrix
+  {
+    class Sparse;
+    class Csc;
+  }
+
+  // Forward declaration of CPU workspace
+  class LinAlgWorkspaceCpu;
+
+  class SparseLUSolver;
+
+  /**
+   * @brief CPU counterpart of GLU and cusolverRf refactorization.
+   *
+   * The solver takes sparsity pattern of L and U factors and permutations
+   * P and Q computed once by KLU, and then recomputes numerical values of
+   * the factors for matrices with the same sparsity pattern without
+   * pivoting. Factors are stored in the same format as KLU returns them,
+   * so L and U are CSC matrices, L has unit diagonal stored explicitly,
+   * and `P`, `Q` are KLU row and column permutations of the factored matrix.
+   *
+   * Columns of the factors are computed with a left-looking algorithm.
+   * Column j depends on column k < j if and only if U(k, j) is nonzero, so
+   * columns are grouped in levels of the column dependency DAG at setup.
+   * Columns within a level are computed concurrently, levels are processed
+   * in order. Runs of levels too narrow to keep all threads busy are
+   * processed by a single thread to avoid paying synchronization cost for
+   * each of them.
+   *
+   * @note Factors are owned by this class. Factors obtained from `setup`
+   * input are copied and their row indices are sorted within each column.
+   */
+  class LinSolverDirectCpuRf : public LinSolverDirect
+  {
+    using vector_type = vector::Vector;
+
+    public:
+      LinSolverDirectCpuRf(LinAlgWorkspaceCpu* workspace = nullptr);
+      ~LinSolverDirectCpuRf();
+
+      int setup(matrix::Sparse* A,
+                matrix::Sparse* L,
+                matrix::Sparse* U,
+                index_type*     P,
+                index_type*     Q,
+                vector_type* rhs  = nullptr) override;
+      int refactorize() override;
+
+      int solve(vector_type* rhs, vector_type* x) override;
+      int solve(vector_type* x) override; // the solution is returned IN x (x is overwritten)
+      int solveSparse(index_type nnz_rhs,
+                      const index_type* rhs_idx,
+                      const real_type* rhs_val,
+                      index_type num_sol,
+                      const index_type* sol_idx,
+                      real_type* sol_val) override;
+
+      matrix::Sparse* getLFactor() override;
+      matrix::Sparse* getUFactor() override;
+      index_type* getPOrdering() override;
+      index_type* getQOrdering() override;
+
+      real_type getMatrixConditionNumber() override;
+
+      memory::MemoryUsage getMemoryUsage() const override;
+
+      index_type getNumLevels() const;
+
+    private:
+      void freeFactors();
+      int copyFactors(matrix::Sparse* L, matrix::Sparse* U);
+      void computeLevels();
+      bool factorizeColumn(index_type j, real_type* x);
+      bool factorizeSerial();
+      bool factorizeParallel(int num_threads);
+
+      /// Minimum number of columns per thread for a level to be processed concurrently.
+      static constexpr index_type MIN_LEVEL_COLUMNS_PER_THREAD = 4;
+
+      LinAlgWorkspaceCpu* workspace_{nullptr};
+
+      index_type n_{0};
+      matrix::Csc* L_csc_{nullptr}; ///< L factor, unit diagonal stored first in each column
+      matrix::Csc* U_csc_{nullptr}; ///< U factor, diagonal stored last in each column
+      index_type* Pinv_{nullptr};   ///< inverse of row permutation
+
+      index_type num_levels_{0};
+      std::vector<index_type> level_cols_;     ///< columns sorted by level
+      std::vector<index_type> stage_ptr_;      ///< ranges in `level_cols_` processed between synchronizations
+      std::vector<char>       stage_parallel_; ///< is stage a single level processed by all threads
+
+      std::vector<real_type> work_;            ///< dense work vectors, one per thread
+
+      SparseLUSolver* sparse_solver_{nullptr}; ///< solver for sparse right-hand sides
+  };
+}
@@ -1,7 +1,15 @@
 #include <cstring> // includes memcpy
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
 #include <resolve/vector/Vector.hpp>
 #include <resolve/matrix/Csc.hpp>
 #include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/Profiling.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include <resolve/SparseTriangularSolver.hpp>
+#include <resolve/SymbolicCache.hpp>
 #include "LinSolverDirectKLU.hpp"
 
 namespace ReSolve 
@@ -44,8 +52,10 @@ namespace ReSolve
       P_ = nullptr;
       Q_ = nullptr;
     }
-    klu_free_symbolic(&Symbolic_, &Common_);
     klu_free_numeric(&Numeric_, &Common_);
+    freeSymbolic();
+    freeBlocks();
+    delete sparse_solver_;
   }
 
   int LinSolverDirectKLU::setup(matrix::Sparse* A,
@@ -61,13 +71,19 @@ namespace ReSolve
 
   int LinSolverDirectKLU::analyze() 
   {
+    RESOLVE_RANGE_SCOPE("KLU::analyze");
+    SolverStats::Timer timer(stats_, SolverStats::analyze);
     // in case we called this function AGAIN 
-    if (Symbolic_ != nullptr) {
-      klu_free_symbolic(&Symbolic_, &Common_);
+    freeSymbolic();
+    if (symbolic_cache_ != nullptr) {
+      Symbolic_ = analyzeCached();
+    } else {
+      Symbolic_ = klu_analyze(A_->getNumRows(), A_->getRowData(memory::HOST), A_->getColData(memory::HOST), &Common_) ;
     }
-    Symbolic_ = klu_analyze(A_->getNumRows(), A_->getRowData(memory::HOST), A_->getColData(memory::HOST), &Common_) ;
 
     factors_extracted_ = false;
+    delete sparse_solver_;
+    sparse_solver_ = nullptr;
     
     if (L_ != nullptr) {
       delete L_; 
@@ -84,11 +100,22 @@ namespace ReSolve
                    << Common_.status << "\n";
       return 1;
     }
+
+    computeBlockStats();
+    if (btf_mode_ == btf_parallel) {
+      return analyzeBlocks();
+    }
     return 0;
   }
 
   int LinSolverDirectKLU::factorize() 
   {
+    RESOLVE_RANGE_SCOPE("KLU::factorize");
+    SolverStats::Timer timer(stats_, SolverStats::factorize);
+    if (btf_mode_ == btf_parallel) {
+      return factorizeBlocks(false);
+    }
+
     if (Numeric_ != nullptr) {
       klu_free_numeric(&Numeric_, &Common_);
     }
@@ -100,6 +127,8 @@ namespace ReSolve
                           &Common_);
 
     factors_extracted_ = false;
+    delete sparse_solver_;
+    sparse_solver_ = nullptr;
 
     if (L_ != nullptr) {
       delete L_; 
@@ -119,6 +148,12 @@ namespace ReSolve
 
   int  LinSolverDirectKLU::refactorize() 
   {
+    RESOLVE_RANGE_SCOPE("KLU::refactorize");
+    SolverStats::Timer timer(stats_, SolverStats::refactorize);
+    if (btf_mode_ == btf_parallel) {
+      return factorizeBlocks(true);
+    }
+
     int kluStatus = klu_refactor(A_->getRowData(memory::HOST),
                                  A_->getColData(memory::HOST),
                                  A_->getValues(memory::HOST),
@@ -127,6 +162,8 @@ namespace ReSolve
                                  &Common_);
 
     factors_extracted_ = false;
+    delete sparse_solver_;
+    sparse_solver_ = nullptr;
 
     if (L_ != nullptr) {
       delete L_; 
@@ -147,10 +184,20 @@ namespace ReSolve
 
   int LinSolverDirectKLU::solve(vector_type* rhs, vector_type* x) 
   {
+    RESOLVE_RANGE_SCOPE("KLU::solve");
+    SolverStats::Timer timer(stats_, SolverStats::solve);
+    if (Numeric_ != nullptr) {
+      const real_type nnz_factors = static_cast<real_type>(Numeric_->lnz + Numeric_->unz);
+      timer.addWork(2.0 * nnz_factors, nnz_factors * (sizeof(real_type) + sizeof(index_type)));
+    }
     //copy the vector
     x->update(rhs->getData(memory::HOST), memory::HOST, memory::HOST);
     x->setDataUpdated(memory::HOST);
 
+    if (btf_mode_ == btf_parallel) {
+      return solveBlocks(x);
+    }
+
     int kluStatus = klu_solve(Symbolic_, Numeric_, A_->getNumRows(), 1, x->getData(memory::HOST), &Common_);
 
     if (!kluStatus){
@@ -166,8 +213,47 @@ namespace ReSolve
     return 1;
   }
 
+  /**
+   * @brief Computes selected solution entries for a sparse right-hand side.
+   * 
+   * Factors are extracted from KLU at the first call after factorization
+   * or refactorization.
+   * 
+   * @see LinSolverDirect::solveSparse
+   */
+  int LinSolverDirectKLU::solveSparse(index_type nnz_rhs,
+                                      const index_type* rhs_idx,
+                                      const real_type* rhs_val,
+                                      index_type num_sol,
+                                      const index_type* sol_idx,
+                                      real_type* sol_val)
+  {
+    if (btf_mode_ != btf_none) {
+      out::error() << "Sparse right-hand side solve is not supported when KLU uses BTF.\n";
+      return 1;
+    }
+    if (Numeric_ == nullptr) {
+      out::error() << "KLU sparse solve called before factorization.\n";
+      return 1;
+    }
+    if (sparse_solver_ == nullptr) {
+      getLFactor();
+      sparse_solver_ = new SparseLUSolver();
+      if (sparse_solver_->setup(L_, U_, Numeric_->Pnum, Symbolic_->Q) != 0) {
+        delete sparse_solver_;
+        sparse_solver_ = nullptr;
+        return 1;
+      }
+    }
+    return sparse_solver_->solve(nnz_rhs, rhs_idx, rhs_val, num_sol, sol_idx, sol_val);
+  }
+
   matrix::Sparse* LinSolverDirectKLU::getLFactor()
   {
+    if (btf_mode_ != btf_none) {
+      out::error() << "L and U factors are not available when KLU uses BTF.\n";
+      return nullptr;
+    }
     if (!factors_extracted_) {
       const int nnzL = Numeric_->lnz;
       const int nnzU = Numeric_->unz;
@@ -204,6 +290,10 @@ namespace ReSolve
 
   matrix::Sparse* LinSolverDirectKLU::getUFactor()
   {
+    if (btf_mode_ != btf_none) {
+      out::error() << "L and U factors are not available when KLU uses BTF.\n";
+      return nullptr;
+    }
     if (!factors_extracted_) {
       const int nnzL = Numeric_->lnz;
       const int nnzU = Numeric_->unz;
@@ -240,6 +330,10 @@ namespace ReSolve
 
   index_type* LinSolverDirectKLU::getPOrdering()
   {
+    if (btf_mode_ != btf_none) {
+      out::error() << "Permutations are not available when KLU uses BTF.\n";
+      return nullptr;
+    }
     if (Numeric_ != nullptr) {
       P_ = new index_type[A_->getNumRows()];
       size_t nrows = static_cast<size_t>(A_->getNumRows());
@@ -253,6 +347,10 @@ namespace ReSolve
 
   index_type* LinSolverDirectKLU::getQOrdering()
   {
+    if (btf_mode_ != btf_none) {
+      out::error() << "Permutations are not available when KLU uses BTF.\n";
+      return nullptr;
+    }
     if (Numeric_ != nullptr) {
       Q_ = new index_type[A_->getNumRows()];
       size_t nrows = static_cast<size_t>(A_->getNumRows());
@@ -281,9 +379,573 @@ namespace ReSolve
     Common_.halt_if_singular = isHalt;
   }
 
+  /**
+   * @brief Cheap reciprocal condition number estimate min|U_ii|/max|U_ii|.
+   */
   real_type LinSolverDirectKLU::getMatrixConditionNumber()
   {
-    klu_rcond(Symbolic_, Numeric_, &Common_);
-    return Common_.rcond;
+    if (btf_mode_ != btf_parallel) {
+      klu_rcond(Symbolic_, Numeric_, &Common_);
+      return Common_.rcond;
+    }
+
+    real_type umin = 0.0;
+    real_type umax = 0.0;
+    bool first = true;
+    for (const Block& blk : blocks_) {
+      for (index_type i = 0; i < blk.size; ++i) {
+        real_type u = 0.0;
+        if (blk.size == 1) {
+          u = blk.values.empty() ? 0.0 : std::abs(blk.values[0]);
+        } else if (blk.numeric != nullptr) {
+          u = std::abs(static_cast<const real_type*>(blk.numeric->Udiag)[i]);
+        }
+        umin = first ? u : std::min(umin, u);
+        umax = first ? u : std::max(umax, u);
+        first = false;
+      }
+    }
+    return (umax > 0.0) ? (umin / umax) : 0.0;
+  }
+
+  /**
+   * @brief Selects whether to permute matrix to block triangular form.
+   * 
+   * @param[in] mode - `btf_none` (default), `btf_serial` or `btf_parallel`
+   * 
+   * @post The mode takes effect at the next call to `analyze`.
+   * 
+   * @return int - 0 if successful
+   */
+  int LinSolverDirectKLU::setBtfMode(BtfMode mode)
+  {
+    btf_mode_ = mode;
+    Common_.btf = (mode == btf_none) ? 0 : 1;
+    if (Symbolic_ != nullptr) {
+      out::warning() << "KLU BTF mode changed after analysis. "
+                     << "It will take effect after the next analysis.\n";
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Sets cache of symbolic analysis results.
+   *
+   * @param[in] cache - cache shared by solvers, or nullptr to disable caching
+   *
+   * @pre The cache outlives the solver or is unset before it is destroyed.
+   * @post The cache is used at the next call to `analyze`.
+   */
+  void LinSolverDirectKLU::setSymbolicCache(SymbolicCache* cache)
+  {
+    symbolic_cache_ = cache;
+  }
+
+  LinSolverDirectKLU::BtfMode LinSolverDirectKLU::getBtfMode() const
+  {
+    return btf_mode_;
+  }
+
+  /**
+   * @brief Block triangular form statistics from the last analysis.
+   * 
+   * Without BTF the whole matrix is reported as a single block.
+   */
+  const LinSolverDirectKLU::BlockStats& LinSolverDirectKLU::getBlockStats() const
+  {
+    return block_stats_;
+  }
+
+  /**
+   * @brief Returns bytes held by KLU symbolic and numeric objects,
+   * extracted factors, and BTF block data.
+   *
+   * KLU allocations are reported by KLU itself through `memusage` of
+   * its common objects.
+   */
+  memory::MemoryUsage LinSolverDirectKLU::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    usage.host_bytes += static_cast<std::size_t>(Common_.memusage);
+    if (factors_extracted_) {
+      if (L_ != nullptr) {
+        usage += L_->getMemoryUsage();
+      }
+      if (U_ != nullptr) {
+        usage += U_->getMemoryUsage();
+      }
+    }
+    if (A_ != nullptr) {
+      std::size_t n = static_cast<std::size_t>(A_->getNumRows());
+      if (P_ != nullptr) {
+        usage.host_bytes += sizeof(index_type) * n;
+      }
+      if (Q_ != nullptr) {
+        usage.host_bytes += sizeof(index_type) * n;
+      }
+    }
+    for (const Block& block : blocks_) {
+      usage.host_bytes += static_cast<std::size_t>(block.common.memusage);
+      usage.host_bytes += sizeof(index_type) * (block.colptr.capacity() + block.rowidx.capacity() + block.map.capacity());
+      usage.host_bytes += sizeof(real_type) * block.values.capacity();
+    }
+    usage.host_bytes += sizeof(index_type) * (block_order_.capacity() + off_colptr_.capacity()
+                                              + off_rowidx_.capacity() + off_map_.capacity());
+    usage.host_bytes += sizeof(real_type) * work_.capacity();
+    return usage;
+  }
+
+  //
+  // Private methods
+  //
+
+  void LinSolverDirectKLU::freeBlocks()
+  {
+    for (Block& blk : blocks_) {
+      if (blk.numeric != nullptr) {
+        klu_free_numeric(&blk.numeric, &blk.common);
+      }
+      if (blk.symbolic != nullptr) {
+        klu_free_symbolic(&blk.symbolic, &blk.common);
+      }
+    }
+    blocks_.clear();
+    block_order_.clear();
+    off_colptr_.clear();
+    off_rowidx_.clear();
+    off_map_.clear();
+    work_.clear();
+  }
+
+  /**
+   * @brief Releases symbolic analysis, unless it is owned by the cache.
+   */
+  void LinSolverDirectKLU::freeSymbolic()
+  {
+    if (symbolic_holder_) {
+      symbolic_holder_.reset();
+      Symbolic_ = nullptr;
+    } else if (Symbolic_ != nullptr) {
+      klu_free_symbolic(&Symbolic_, &Common_);
+    }
+  }
+
+  /**
+   * @brief Returns symbolic analysis from the cache, or analyzes the matrix
+   * and stores the result in the cache.
+   *
+   * Entries loaded from disk hold only orderings and block structure, from
+   * which the KLU symbolic object is reconstructed without running the
+   * fill-reducing ordering.
+   */
+  klu_symbolic* LinSolverDirectKLU::analyzeCached()
+  {
+    index_type  n  = A_->getNumRows();
+    index_type* Ap = A_->getRowData(memory::HOST);
+    index_type* Ai = A_->getColData(memory::HOST);
+    index_type tag = 2 * Common_.ordering + ((Common_.btf != 0) ? 1 : 0);
+
+    auto deleter = [](void* ptr) {
+      klu_symbolic* symbolic = static_cast<klu_symbolic*>(ptr);
+      klu_common common;
+      klu_defaults(&common);
+      klu_free_symbolic(&symbolic, &common);
+    };
+
+    SymbolicCache::Entry* entry = symbolic_cache_->find(tag, n, Ap, Ai);
+    if (entry != nullptr) {
+      if (!entry->object) {
+        klu_symbolic* restored = restoreSymbolic(entry->ints, entry->reals);
+        if (restored != nullptr) {
+          entry->object = std::shared_ptr<void>(restored, deleter);
+        }
+      }
+      if (entry->object) {
+        symbolic_holder_ = entry->object;
+        return static_cast<klu_symbolic*>(entry->object.get());
+      }
+      out::warning() << "Failed to restore cached KLU symbolic analysis, analyzing again.\n";
+      symbolic_cache_->remove(tag, n, Ap, Ai);
+    }
+
+    klu_symbolic* symbolic = klu_analyze(n, Ap, Ai, &Common_);
+    if (symbolic == nullptr) {
+      return nullptr;
+    }
+
+    entry = symbolic_cache_->insert(tag, n, Ap, Ai);
+    if (entry != nullptr) {
+      storeSymbolic(symbolic, entry->ints, entry->reals);
+      entry->object = std::shared_ptr<void>(symbolic, deleter);
+      symbolic_holder_ = entry->object;
+    }
+    return symbolic;
+  }
+
+  /**
+   * @brief Serializes orderings and block structure of KLU symbolic analysis.
+   */
+  void LinSolverDirectKLU::storeSymbolic(const klu_symbolic* symbolic,
+                                         std::vector<index_type>& ints,
+                                         std::vector<real_type>& reals) const
+  {
+    const index_type n = symbolic->n;
+    const index_type nblocks = symbolic->nblocks;
+
+    ints = {n,
+            symbolic->nz,
+            symbolic->nzoff,
+            nblocks,
+            symbolic->maxblock,
+            symbolic->ordering,
+            symbolic->do_btf,
+            symbolic->structural_rank};
+    ints.insert(ints.end(), symbolic->P, symbolic->P + n);
+    ints.insert(ints.end(), symbolic->Q, symbolic->Q + n);
+    ints.insert(ints.end(), symbolic->R, symbolic->R + nblocks + 1);
+
+    reals = {symbolic->symmetry,
+             symbolic->est_flops,
+             symbolic->lnz,
+             symbolic->unz};
+    reals.insert(reals.end(), symbolic->Lnz, symbolic->Lnz + nblocks);
+  }
+
+  /**
+   * @brief Reconstructs KLU symbolic analysis from serialized data.
+   *
+   * KLU allocates the symbolic object with the given orderings and no BTF,
+   * and the block structure is then restored from the serialized data.
+   * Orderings must be permutations and block boundaries must partition the
+   * matrix consistently with the stored sizes, otherwise the data is
+   * rejected.
+   *
+   * @return klu_symbolic* - symbolic analysis, nullptr if data is invalid
+   */
+  klu_symbolic* LinSolverDirectKLU::restoreSymbolic(const std::vector<index_type>& ints,
+                                                    const std::vector<real_type>& reals)
+  {
+    const size_t num_scalars = 8;
+    if (ints.size() < num_scalars || reals.size() < 4) {
+      return nullptr;
+    }
+    const index_type n = ints[0];
+    const index_type nblocks = ints[3];
+    if ((n != A_->getNumRows()) ||
+        (nblocks < 1) || (nblocks > n) ||
+        (ints.size() != num_scalars + 2 * static_cast<size_t>(n) + static_cast<size_t>(nblocks) + 1) ||
+        (reals.size() != 4 + static_cast<size_t>(nblocks))) {
+      return nullptr;
+    }
+
+    std::vector<index_type> P(ints.begin() + num_scalars, ints.begin() + num_scalars + n);
+    std::vector<index_type> Q(ints.begin() + num_scalars + n, ints.begin() + num_scalars + 2 * n);
+    const index_type* R = ints.data() + num_scalars + 2 * n;
+
+    // Cache entries may come from a file, so the data is checked before KLU
+    // indexes its arrays with it.
+    const index_type nz = ints[1];
+    const index_type nzoff = ints[2];
+    const index_type maxblock = ints[4];
+    const index_type do_btf = ints[6];
+    if ((nz != A_->getRowData(memory::HOST)[n]) ||
+        (nzoff < 0) || (nzoff > nz) ||
+        (do_btf != 0 && do_btf != 1) ||
+        (do_btf == 0 && nblocks != 1) ||
+        (R[0] != 0) || (R[nblocks] != n)) {
+      return nullptr;
+    }
+    index_type largest_block = 0;
+    for (index_type k = 0; k < nblocks; ++k) {
+      if (R[k + 1] <= R[k]) {
+        return nullptr;
+      }
+      largest_block = std::max(largest_block, R[k + 1] - R[k]);
+    }
+    if (maxblock != largest_block) {
+      return nullptr;
+    }
+    for (size_t i = 4; i < reals.size(); ++i) {
+      // Also rejects NaN
+      if (!(reals[i] >= 0.0)) {
+        return nullptr;
+      }
+    }
+    if (!isPermutation(P) || !isPermutation(Q)) {
+      return nullptr;
+    }
+
+    klu_common common = Common_;
+    common.btf = 0;
+    klu_symbolic* symbolic = klu_analyze_given(n,
+                                               A_->getRowData(memory::HOST),
+                                               A_->getColData(memory::HOST),
+                                               P.data(),
+                                               Q.data(),
+                                               &common);
+    if (symbolic == nullptr) {
+      return nullptr;
+    }
+
+    symbolic->nz              = nz;
+    symbolic->nzoff           = nzoff;
+    symbolic->nblocks         = nblocks;
+    symbolic->maxblock        = maxblock;
+    symbolic->ordering        = ints[5];
+    symbolic->do_btf          = do_btf;
+    symbolic->structural_rank = ints[7];
+    std::copy(R, R + nblocks + 1, symbolic->R);
+
+    symbolic->symmetry  = reals[0];
+    symbolic->est_flops = reals[1];
+    symbolic->lnz       = reals[2];
+    symbolic->unz       = reals[3];
+    std::copy(reals.begin() + 4, reals.end(), symbolic->Lnz);
+
+    return symbolic;
+  }
+
+  /**
+   * @brief Checks that the array holds each of 0, ..., size - 1 exactly once.
+   */
+  bool LinSolverDirectKLU::isPermutation(const std::vector<index_type>& perm)
+  {
+    const index_type n = static_cast<index_type>(perm.size());
+    std::vector<bool> seen(perm.size(), false);
+    for (index_type p : perm) {
+      if (p < 0 || p >= n || seen[p]) {
+        return false;
+      }
+      seen[p] = true;
+    }
+    return true;
+  }
+
+  void LinSolverDirectKLU::computeBlockStats()
+  {
+    const index_type* R = Symbolic_->R;
+    block_stats_.num_blocks     = Symbolic_->nblocks;
+    block_stats_.max_block_size = Symbolic_->maxblock;
+    block_stats_.num_offdiag    = Symbolic_->nzoff;
+    block_stats_.num_singletons = 0;
+    for (index_type b = 0; b < Symbolic_->nblocks; ++b) {
+      if (R[b + 1] - R[b] == 1) {
+        block_stats_.num_singletons++;
+      }
+    }
+
+    out::summary() << "KLU analysis: " << block_stats_.num_blocks << " diagonal blocks ("
+                   << block_stats_.num_singletons << " singletons), largest block "
+                   << block_stats_.max_block_size << ", "
+                   << block_stats_.num_offdiag << " off-diagonal nonzeros\n";
+  }
+
+  /**
+   * @brief Extracts diagonal blocks of the BTF permuted matrix and analyzes
+   * each of them as a separate KLU problem.
+   * 
+   * Ordering of the blocks computed by KLU at the analysis of the whole
+   * matrix is preserved.
+   * 
+   * @pre KLU analysis with BTF enabled has been performed.
+   */
+  int LinSolverDirectKLU::analyzeBlocks()
+  {
+    freeBlocks();
+
+    const index_type  n  = A_->getNumRows();
+    const index_type* Bp = A_->getRowData(memory::HOST);
+    const index_type* Bi = A_->getColData(memory::HOST);
+    const index_type* P  = Symbolic_->P;
+    const index_type* Q  = Symbolic_->Q;
+    const index_type* R  = Symbolic_->R;
+    const index_type  nblocks = Symbolic_->nblocks;
+
+    std::vector<index_type> Pinv(static_cast<size_t>(n));
+    for (index_type k = 0; k < n; ++k) {
+      Pinv[P[k]] = k;
+    }
+
+    blocks_.resize(static_cast<size_t>(nblocks));
+    off_colptr_.assign(static_cast<size_t>(n) + 1, 0);
+    int status = 0;
+    for (index_type b = 0; b < nblocks; ++b) {
+      Block& blk = blocks_[b];
+      blk.begin = R[b];
+      blk.size  = R[b + 1] - R[b];
+      blk.colptr.assign(static_cast<size_t>(blk.size) + 1, 0);
+      for (index_type j = R[b]; j < R[b + 1]; ++j) {
+        const index_type col = Q[j];
+        for (index_type p = Bp[col]; p < Bp[col + 1]; ++p) {
+          const index_type i = Pinv[Bi[p]];
+          if (i >= R[b + 1]) {
+            out::error() << "KLU: matrix is not in block upper triangular form.\n";
+            return 1;
+          }
+          if (i >= R[b]) {
+            blk.rowidx.push_back(i - R[b]);
+            blk.map.push_back(p);
+          } else {
+            off_rowidx_.push_back(i);
+            off_map_.push_back(p);
+          }
+        }
+        blk.colptr[j - R[b] + 1] = static_cast<index_type>(blk.rowidx.size());
+        off_colptr_[j + 1] = static_cast<index_type>(off_rowidx_.size());
+      }
+      blk.values.assign(blk.rowidx.size(), 0.0);
+
+      klu_defaults(&blk.common);
+      blk.common.btf   = 0;
+      blk.common.scale = Common_.scale;
+      blk.common.tol   = Common_.tol;
+      blk.common.halt_if_singular = Common_.halt_if_singular;
+
+      if (blk.size > 1) {
+        // Keep ordering computed for the whole matrix
+        blk.symbolic = klu_analyze_given(blk.size,
+                                         blk.colptr.data(),
+                                         blk.rowidx.data(),
+                                         nullptr,
+                                         nullptr,
+                                         &blk.common);
+        if (blk.symbolic == nullptr) {
+          out::error() << "KLU analysis of diagonal block " << b << " failed with status "
+                       << blk.common.status << "\n";
+          status = 1;
+        }
+      }
+    }
+
+    // Factorize largest blocks first for better load balance
+    block_order_.resize(static_cast<size_t>(nblocks));
+    std::iota(block_order_.begin(), block_order_.end(), 0);
+    std::stable_sort(block_order_.begin(), block_order_.end(),
+                     [this](index_type a, index_type b) { return blocks_[a].size > blocks_[b].size; });
+
+    work_.assign(static_cast<size_t>(n), 0.0);
+    return status;
+  }
+
+  /**
+   * @brief Factorizes diagonal blocks concurrently.
+   * 
+   * Threads take blocks in order of decreasing size from a shared counter.
+   * Each block has its own KLU settings and statistics object, so KLU calls
+   * for different blocks are independent.
+   * 
+   * @param[in] refactor - reuse pivoting of the existing block factors
+   * 
+   * @return int - 0 if successful, 1 if any block fails
+   */
+  int LinSolverDirectKLU::factorizeBlocks(bool refactor)
+  {
+    if (blocks_.empty()) {
+      out::error() << "KLU diagonal blocks are not available. Call analyze first.\n";
+      return 1;
+    }
+
+    const real_type* Bx = A_->getValues(memory::HOST);
+    const index_type nblocks = static_cast<index_type>(blocks_.size());
+
+    index_type num_large = 0;
+    for (const Block& blk : blocks_) {
+      if (blk.size > 1) {
+        num_large++;
+      }
+    }
+    // Singletons are cheap, so there is no point in more threads than large blocks
+    const int num_threads = threads::getNumThreads(std::max(num_large, static_cast<index_type>(1)), 1);
+
+    std::atomic<index_type> next(0);
+    std::atomic<int> failed(0);
+    threads::parallelFor(num_threads, 0, num_threads,
+      [&](int /* tid */, index_type /* lo */, index_type /* hi */) {
+        for (index_type k = next++; k < nblocks; k = next++) {
+          Block& blk = blocks_[block_order_[k]];
+          for (size_t q = 0; q < blk.values.size(); ++q) {
+            blk.values[q] = Bx[blk.map[q]];
+          }
+
+          if (blk.size == 1) {
+            if (blk.values.empty() || blk.values[0] == 0.0) {
+              failed++;
+            }
+            continue;
+          }
+          if (blk.symbolic == nullptr) {
+            failed++;
+            continue;
+          }
+
+          if (refactor && blk.numeric != nullptr) {
+            if (!klu_refactor(blk.colptr.data(), blk.rowidx.data(), blk.values.data(),
+                              blk.symbolic, blk.numeric, &blk.common)) {
+              failed++;
+            }
+          } else {
+            if (blk.numeric != nullptr) {
+              klu_free_numeric(&blk.numeric, &blk.common);
+            }
+            blk.numeric = klu_factor(blk.colptr.data(), blk.rowidx.data(), blk.values.data(),
+                                     blk.symbolic, &blk.common);
+            if (blk.numeric == nullptr) {
+              failed++;
+            }
+          }
+        }
+      });
+
+    if (failed > 0) {
+      out::error() << "KLU failed to factorize " << failed.load() << " diagonal block(s).\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Block back substitution with factored diagonal blocks.
+   * 
+   * @param[in,out] x - right-hand side on input, solution on output
+   */
+  int LinSolverDirectKLU::solveBlocks(vector_type* x)
+  {
+    const index_type  n  = A_->getNumRows();
+    const real_type*  Bx = A_->getValues(memory::HOST);
+    const index_type* P  = Symbolic_->P;
+    const index_type* Q  = Symbolic_->Q;
+    real_type* xd = x->getData(memory::HOST);
+    real_type* y  = work_.data();
+
+    for (index_type k = 0; k < n; ++k) {
+      y[k] = xd[P[k]];
+    }
+
+    int status = 0;
+    for (index_type b = static_cast<index_type>(blocks_.size()) - 1; b >= 0; --b) {
+      Block& blk = blocks_[b];
+      if (blk.size == 1) {
+        y[blk.begin] /= blk.values[0];
+      } else if (!klu_solve(blk.symbolic, blk.numeric, blk.size, 1, y + blk.begin, &blk.common)) {
+        status = 1;
+      }
+
+      // Eliminate solved block from the rows above it
+      for (index_type j = blk.begin; j < blk.begin + blk.size; ++j) {
+        const real_type yj = y[j];
+        if (yj != 0.0) {
+          for (index_type p = off_colptr_[j]; p < off_colptr_[j + 1]; ++p) {
+            y[off_rowidx_[p]] -= Bx[off_map_[p]] * yj;
+          }
+        }
+      }
+    }
+
+    for (index_type k = 0; k < n; ++k) {
+      xd[Q[k]] = y[k];
+    }
+    x->setDataUpdated(memory::HOST);
+
+    return status;
   }
 } // namespace ReSolve
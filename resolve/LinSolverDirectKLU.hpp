@@ -1,4 +1,7 @@
 #pragma once
+#include <memory>
+#include <vector>
+
 #include "klu.h"
 #include "Common.hpp"
 #include "LinSolver.hpp"
@@ -17,11 +20,48 @@ namespace ReSolve
     class Sparse;
   }
 
+  class SparseLUSolver;
+  class SymbolicCache;
+
+  /**
+   * @brief Wrapper for KLU direct solver.
+   * 
+   * By default KLU factors the whole matrix without block triangular form
+   * (BTF) permutation, so that L and U factors and permutations can be
+   * passed to a refactorization solver.
+   * 
+   * Optionally, the matrix can be permuted to block upper triangular form.
+   * In `btf_serial` mode KLU factors diagonal blocks one after another. In
+   * `btf_parallel` mode each diagonal block is factored as a separate KLU
+   * problem and blocks are factored concurrently on host threads, largest
+   * blocks first. Off-diagonal blocks are applied during block back
+   * substitution. Matrices that decompose into many small blocks and a few
+   * large ones benefit the most.
+   * 
+   * @note In BTF modes global L and U factors are not available, so the
+   * solver cannot be used to set up refactorization.
+   *
+   * If a symbolic cache is set, the results of `klu_analyze` are stored in
+   * the cache and reused when a matrix with the same sparsity pattern is
+   * analyzed with the same ordering and BTF settings.
+   */
   class LinSolverDirectKLU : public LinSolverDirect 
   {
     using vector_type = vector::Vector;
     
     public:
+      /// Block triangular form modes.
+      enum BtfMode {btf_none = 0, btf_serial, btf_parallel};
+
+      /// Statistics of block triangular form computed at analysis.
+      struct BlockStats
+      {
+        index_type num_blocks{0};      ///< number of diagonal blocks
+        index_type num_singletons{0};  ///< number of 1x1 diagonal blocks
+        index_type max_block_size{0};  ///< size of the largest diagonal block
+        index_type num_offdiag{0};     ///< nonzeros outside diagonal blocks
+      };
+
       LinSolverDirectKLU();
       ~LinSolverDirectKLU();
 
@@ -37,6 +77,12 @@ namespace ReSolve
       int refactorize() override;
       int solve(vector_type* rhs, vector_type* x) override;
       int solve(vector_type* x) override;
+      int solveSparse(index_type nnz_rhs,
+                      const index_type* rhs_idx,
+                      const real_type* rhs_val,
+                      index_type num_sol,
+                      const index_type* sol_idx,
+                      real_type* sol_val) override;
     
       matrix::Sparse* getLFactor() override; 
       matrix::Sparse* getUFactor() override; 
@@ -49,10 +95,61 @@ namespace ReSolve
 
       virtual real_type getMatrixConditionNumber() override;
 
+      memory::MemoryUsage getMemoryUsage() const override;
+
+      int setBtfMode(BtfMode mode);
+      BtfMode getBtfMode() const;
+      const BlockStats& getBlockStats() const;
+
+      void setSymbolicCache(SymbolicCache* cache);
+
     private:
+      /// Diagonal block factored as a separate KLU problem in `btf_parallel` mode.
+      struct Block
+      {
+        index_type begin{0};             ///< first row/column in permuted matrix
+        index_type size{0};              ///< number of rows/columns
+        std::vector<index_type> colptr;  ///< CSC column pointers of the block
+        std::vector<index_type> rowidx;  ///< CSC row indices of the block
+        std::vector<real_type>  values;  ///< CSC values of the block
+        std::vector<index_type> map;     ///< positions of block values in A
+        klu_common common;
+        klu_symbolic* symbolic{nullptr};
+        klu_numeric* numeric{nullptr};
+      };
+
+      void freeSymbolic();
+      klu_symbolic* analyzeCached();
+      klu_symbolic* restoreSymbolic(const std::vector<index_type>& ints,
+                                    const std::vector<real_type>& reals);
+      void storeSymbolic(const klu_symbolic* symbolic,
+                         std::vector<index_type>& ints,
+                         std::vector<real_type>& reals) const;
+      static bool isPermutation(const std::vector<index_type>& perm);
+
+      void freeBlocks();
+      void computeBlockStats();
+      int analyzeBlocks();
+      int factorizeBlocks(bool refactor);
+      int solveBlocks(vector_type* x);
+
       bool factors_extracted_{false};
       klu_common Common_; //settings
       klu_symbolic* Symbolic_{nullptr};
       klu_numeric* Numeric_{nullptr}; 
+
+      SymbolicCache* symbolic_cache_{nullptr};  ///< not owned
+      std::shared_ptr<void> symbolic_holder_;   ///< keeps `Symbolic_` alive if it is cached
+
+      BtfMode btf_mode_{btf_none};
+      BlockStats block_stats_;
+      std::vector<Block> blocks_;
+      std::vector<index_type> block_order_;  ///< block indices sorted by decreasing size
+      std::vector<index_type> off_colptr_;   ///< off-diagonal entries of permuted matrix (CSC)
+      std::vector<index_type> off_rowidx_;
+      std::vector<index_type> off_map_;      ///< positions of off-diagonal values in A
+      std::vector<real_type>  work_;
+
+      SparseLUSolver* sparse_solver_{nullptr}; ///< solver for sparse right-hand sides
   };
 }
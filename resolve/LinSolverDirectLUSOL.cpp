@@ -1,6 +1,8 @@
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <limits>
+#include <new>
 #include <algorithm>
 
 #include "LinSolverDirectLUSOL.hpp"
@@ -8,6 +10,8 @@
 
 #include <resolve/matrix/Csc.hpp>
 #include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/Profiling.hpp>
+#include <resolve/SymbolicCache.hpp>
 #include <resolve/vector/Vector.hpp>
 
 namespace ReSolve
@@ -87,6 +91,8 @@ namespace ReSolve
    * @brief Analysis function of LUISOL
    * 
    * At this time, only memory allocation and initialization is done here.
+   * The workspace is reused if the sparsity pattern of the matrix did not
+   * change since the last call.
    * 
    * @return int - 0 if successful, error code otherwise
    * 
@@ -98,23 +104,39 @@ namespace ReSolve
    */
   int LinSolverDirectLUSOL::analyze()
   {
-    // Brute force solution: If the solver workspace is already allocated, nuke it!
-    if (is_solver_data_allocated_) {
-      freeSolverData();
-      is_solver_data_allocated_ = false;
-    }
-
-    nelem_ = A_->getNnz();
-    m_ = A_->getNumRows();
-    n_ = A_->getNumColumns();
-
-    allocateSolverData();
-    is_solver_data_allocated_ = true;
+    RESOLVE_RANGE_SCOPE("LUSOL::analyze");
+    SolverStats::Timer timer(stats_, SolverStats::analyze);
+    index_type m = A_->getNumRows();
+    index_type n = A_->getNumColumns();
+    index_type nelem = A_->getNnz();
 
     real_type* a_in = A_->getValues(memory::HOST);
     index_type* indc_in = A_->getRowData(memory::HOST);
     index_type* indr_in = A_->getColData(memory::HOST);
 
+    // Workspace size learned in previous factorizations is kept only if
+    // the sparsity pattern did not change.
+    std::uint64_t pattern_hash = SymbolicCache::HASH_SEED;
+    pattern_hash = SymbolicCache::hashValue(pattern_hash, m);
+    pattern_hash = SymbolicCache::hashValue(pattern_hash, n);
+    pattern_hash = SymbolicCache::hashArray(pattern_hash, nelem, indc_in);
+    pattern_hash = SymbolicCache::hashArray(pattern_hash, nelem, indr_in);
+    bool same_pattern = is_solver_data_allocated_ &&
+                        (m == m_) && (n == n_) && (nelem == nelem_) &&
+                        (pattern_hash == pattern_hash_);
+
+    nelem_ = nelem;
+    m_ = m;
+    n_ = n;
+    pattern_hash_ = pattern_hash;
+
+    is_factorized_ = false;
+
+    index_type lena = same_pattern ? lena_ : initialWorkspaceSize();
+    if (allocateSolverData(lena) != 0) {
+      return -1;
+    }
+
     for (index_type i = 0; i < nelem_; i++) {
       a_[i] = a_in[i];
       indc_[i] = indc_in[i] + 1;
@@ -124,39 +146,81 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Computes LU factorization with LUSOL.
+   *
+   * If the workspace is too small for the factors, it is grown geometrically,
+   * but at least to the size LUSOL recommends, and the factorization is
+   * restarted. The grown workspace size is kept for subsequent
+   * factorizations of matrices with the same sparsity pattern.
+   *
+   * @return int - 0 if successful, LUSOL error code otherwise
+   *
+   * @pre ::analyze() has been called for the current matrix.
+   */
   int LinSolverDirectLUSOL::factorize()
   {
+    RESOLVE_RANGE_SCOPE("LUSOL::factorize");
+    SolverStats::Timer timer(stats_, SolverStats::factorize);
+    is_factorized_ = false;
     // NOTE: this is probably good enough as far as checking goes
     if (a_ == nullptr || indc_ == nullptr || indr_ == nullptr) {
       out::error() << "LUSOL workspace not allocated!\n";
       return -1;
     }
 
+    storeFactoredColumns();
+
     index_type inform = 0;
 
-    lu1fac(&m_,
-           &n_,
-           &nelem_,
-           &lena_,
-           luparm_,
-           parmlu_,
-           a_,
-           indc_,
-           indr_,
-           p_,
-           q_,
-           lenc_,
-           lenr_,
-           locc_,
-           locr_,
-           iploc_,
-           iqloc_,
-           ipinv_,
-           iqinv_,
-           w_,
-           &inform);
+    for (int attempt = 0; attempt < MAX_FACTORIZATION_ATTEMPTS; ++attempt) {
+      lu1fac(&m_,
+             &n_,
+             &nelem_,
+             &lena_,
+             luparm_,
+             parmlu_,
+             a_,
+             indc_,
+             indr_,
+             p_,
+             q_,
+             lenc_,
+             lenr_,
+             locc_,
+             locr_,
+             iploc_,
+             iqloc_,
+             ipinv_,
+             iqinv_,
+             w_,
+             &inform);
+
+      if (inform != 7) {
+        break;
+      }
+
+      // Insufficient storage, grow the workspace and start over.
+      std::int64_t lena = std::max(static_cast<std::int64_t>(luparm_[12]),
+                                   static_cast<std::int64_t>(LENA_GROWTH_FACTOR * lena_));
+      if (lena > std::numeric_limits<index_type>::max()) {
+        out::error() << "LUSOL workspace size exceeds index type range!\n";
+        break;
+      }
+      out::misc() << "LUSOL workspace of size " << lena_
+                  << " is insufficient, growing it to " << lena << "\n";
+      if (allocateSolverData(static_cast<index_type>(lena)) != 0) {
+        break;
+      }
+      loadFactoredColumns();
+    }
 
-    // TODO: consider handling inform = 7
+    if (inform == 7) {
+      out::error() << "LUSOL factorization failed due to insufficient storage!\n";
+    }
+
+    // Workspace may have been freed if it could not be grown.
+    is_factorized_ = (inform == 0) && is_solver_data_allocated_;
 
     return inform;
   }
@@ -170,9 +234,15 @@ namespace ReSolve
 
   int LinSolverDirectLUSOL::solve(vector_type* rhs, vector_type* x)
   {
+    RESOLVE_RANGE_SCOPE("LUSOL::solve");
+    SolverStats::Timer timer(stats_, SolverStats::solve);
     if (rhs->getSize() != m_ || x->getSize() != n_) {
       return -1;
     }
+    if (!is_factorized_) {
+      out::error() << "LinSolverDirectLUSOL::solve called without successful factorization!\n";
+      return -1;
+    }
 
     index_type mode = 5;
     index_type inform = 0;
@@ -220,6 +290,30 @@ namespace ReSolve
     return nullptr;
   }
 
+  /**
+   * @brief Returns bytes held by the LUSOL workspace arena, the copy of
+   * factored columns, and column update buffers.
+   */
+  memory::MemoryUsage LinSolverDirectLUSOL::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (arena_ != nullptr) {
+      usage.host_bytes += arena_size_ + ARENA_ALIGNMENT;
+    }
+    usage.host_bytes += sizeof(index_type) * (col_ptr_.capacity() + row_idx_.capacity());
+    usage.host_bytes += sizeof(real_type) * (col_val_.capacity() + update_work_.capacity());
+    for (const auto& column : replaced_columns_) {
+      usage.host_bytes += sizeof(index_type) + sizeof(real_type) * column.second.capacity();
+    }
+    if (L_ != nullptr) {
+      usage += L_->getMemoryUsage();
+    }
+    if (U_ != nullptr) {
+      usage += U_->getMemoryUsage();
+    }
+    return usage;
+  }
+
   index_type* LinSolverDirectLUSOL::getPOrdering()
   {
     out::error() << "LinSolverDirect::getPOrdering() called on "
@@ -259,95 +353,396 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Updates the factorization when column `j` of the factored
+   * matrix is replaced by `column`.
+   *
+   * The factors are updated in place with the Bartels-Golub update
+   * implemented in LUSOL's `lu8rpc`, which is much cheaper than
+   * refactorizing the matrix when only a few columns change.
+   *
+   * @param[in] j      - 0-based index of the column to replace
+   * @param[in] column - new column of size m, stored on the host
+   *
+   * @return 0 if successful, 1 if the updated matrix is singular, 2 if the
+   * update appears unstable, error code otherwise
+   *
+   * @pre The matrix has been factorized with ::factorize().
+   * @pre 0 <= j < n
+   * @post The factors are those of the matrix with the replaced column. If
+   * the update fails for lack of storage (error code 7), the factors are
+   * invalid and the matrix has to be factorized again.
+   */
+  int LinSolverDirectLUSOL::replaceColumn(index_type j, vector_type* column)
+  {
+    if (!is_factorized_ || col_ptr_.empty()) {
+      out::error() << "LinSolverDirectLUSOL::replaceColumn called before factorization!\n";
+      return -1;
+    }
+    if (j < 0 || j >= n_) {
+      out::error() << "LinSolverDirectLUSOL::replaceColumn: column index "
+                   << j << " is out of range [0, " << n_ << ")!\n";
+      return -1;
+    }
+    if (column->getSize() != m_) {
+      out::error() << "LinSolverDirectLUSOL::replaceColumn: column size "
+                   << column->getSize() << " does not match number of rows "
+                   << m_ << "!\n";
+      return -1;
+    }
+
+    real_type* column_data = column->getData(memory::HOST);
+    update_work_.assign(column_data, column_data + m_);
+
+    index_type mode1 = 1;
+    index_type mode2 = 1;
+    index_type jrep = j + 1;
+    index_type inform = 0;
+    real_type diag = 0.0;
+    real_type vnorm = 0.0;
+
+    lu8rpc(&mode1,
+           &mode2,
+           &m_,
+           &n_,
+           &jrep,
+           update_work_.data(),
+           w_,
+           &lena_,
+           luparm_,
+           parmlu_,
+           a_,
+           indc_,
+           indr_,
+           p_,
+           q_,
+           lenc_,
+           lenr_,
+           locc_,
+           locr_,
+           &inform,
+           &diag,
+           &vnorm);
+
+    switch (inform) {
+      case 0:
+      case 1:
+        break;
+      case -1:
+        out::warning() << "LUSOL column replacement made the matrix singular\n";
+        break;
+      case 2:
+        out::warning() << "LUSOL column replacement appears unstable, "
+                       << "diag = " << diag << ", vnorm = " << vnorm << "\n";
+        break;
+      case 7:
+        out::error() << "Insufficient storage for LUSOL column replacement, "
+                     << "the matrix has to be factorized again!\n";
+        is_factorized_ = false;
+        return inform;
+      default:
+        out::error() << "LUSOL column replacement failed with inform = " << inform << "\n";
+        is_factorized_ = false;
+        return inform;
+    }
+
+    replaced_columns_[j].assign(column_data, column_data + m_);
+    num_updates_++;
+
+    if (inform == -1) {
+      return 1;
+    }
+    return inform == 2 ? 2 : 0;
+  }
+
+  /**
+   * @brief Updates the factorization of A to that of A + alpha * u * v^T.
+   *
+   * Each column j with v[j] != 0 is replaced by A(:, j) + alpha * v[j] * u,
+   * so the cost is proportional to the number of nonzeros in v. This suits
+   * localized changes such as a branch outage in a network model, where
+   * only the columns of the buses at the ends of the branch change.
+   *
+   * Every nonzero of v costs one ::replaceColumn(), i.e. a dense column
+   * extraction of size m plus a Bartels-Golub update, and adds to the
+   * factor fill-in. For a v with more than a few nonzeros, factorizing
+   * A + alpha * u * v^T again is cheaper and more stable.
+   *
+   * @param[in] alpha - scaling of the update
+   * @param[in] u     - vector of size m, stored on the host
+   * @param[in] v     - vector of size n, stored on the host
+   *
+   * @return 0 if successful, nonzero status of the first column replacement
+   * that was not successful otherwise, see ::replaceColumn()
+   *
+   * @pre The matrix has been factorized with ::factorize().
+   */
+  int LinSolverDirectLUSOL::updateRankOne(real_type alpha, vector_type* u, vector_type* v)
+  {
+    if (u->getSize() != m_ || v->getSize() != n_) {
+      out::error() << "LinSolverDirectLUSOL::updateRankOne: vector sizes do not "
+                   << "match the matrix size!\n";
+      return -1;
+    }
+    if (!is_factorized_ || col_ptr_.empty()) {
+      out::error() << "LinSolverDirectLUSOL::updateRankOne called before factorization!\n";
+      return -1;
+    }
+
+    const real_type* u_data = u->getData(memory::HOST);
+    const real_type* v_data = v->getData(memory::HOST);
+
+    vector_type column(m_);
+    column.allocate(memory::HOST);
+    real_type* column_data = column.getData(memory::HOST);
+
+    int status = 0;
+    for (index_type j = 0; j < n_; ++j) {
+      if (v_data[j] == 0.0) {
+        continue;
+      }
+      getCurrentColumn(j, column_data);
+      real_type scale = alpha * v_data[j];
+      for (index_type i = 0; i < m_; ++i) {
+        column_data[i] += scale * u_data[i];
+      }
+      column.setDataUpdated(memory::HOST);
+      status = replaceColumn(j, &column);
+      if (status != 0) {
+        break;
+      }
+    }
+
+    return status;
+  }
+
+  /**
+   * @brief Returns number of column replacements applied since the last
+   * factorization.
+   */
+  index_type LinSolverDirectLUSOL::getNumUpdates() const
+  {
+    return num_updates_;
+  }
+
+  /**
+   * @brief Sets initial size of LUSOL workspace arrays.
+   *
+   * Overrides the heuristic used when a matrix with a new sparsity pattern
+   * is analyzed. The workspace is still grown if it turns out too small.
+   *
+   * @param[in] lena - initial size of `a_`, `indc_` and `indr_`, 0 to use
+   *                   the heuristic
+   */
+  void LinSolverDirectLUSOL::setInitialWorkspaceSize(index_type lena)
+  {
+    lena_hint_ = lena;
+  }
+
+  /**
+   * @brief Returns current size of LUSOL workspace arrays.
+   */
+  index_type LinSolverDirectLUSOL::getWorkspaceSize() const
+  {
+    return lena_;
+  }
+
   //
   // Private Methods
   //
 
-  int LinSolverDirectLUSOL::allocateSolverData()
+  /**
+   * @brief Copies the matrix passed to LUSOL into CSC storage before it is
+   * overwritten by the factors.
+   */
+  void LinSolverDirectLUSOL::storeFactoredColumns()
   {
-    // NOTE: determines a hopefully "good enough" size for a_, indc_, indr_.
-    //       see lena_'s documentation for more details
-    if (nelem_ >= parmlu_[7] * m_ * n_) {
-      lena_ = m_ * n_;
-    } else {
-      lena_ = std::min(5 * nelem_, 2 * m_ * n_);
-    }
+    col_ptr_.assign(n_ + 1, 0);
+    row_idx_.resize(nelem_);
+    col_val_.resize(nelem_);
 
-    a_ = new real_type[lena_];
-    indc_ = new index_type[lena_];
-    indr_ = new index_type[lena_];
-    mem_.setZeroArrayOnHost(a_, lena_);
-    mem_.setZeroArrayOnHost(indc_, lena_);
-    mem_.setZeroArrayOnHost(indr_, lena_);
+    for (index_type k = 0; k < nelem_; ++k) {
+      col_ptr_[indr_[k]]++;
+    }
+    for (index_type j = 0; j < n_; ++j) {
+      col_ptr_[j + 1] += col_ptr_[j];
+    }
+    for (index_type k = nelem_ - 1; k >= 0; --k) {
+      index_type j = indr_[k] - 1;
+      index_type pos = --col_ptr_[j + 1];
+      row_idx_[pos] = indc_[k] - 1;
+      col_val_[pos] = a_[k];
+    }
+    // Shift pointers back, col_ptr_[j + 1] now holds the start of column j.
+    for (index_type j = 0; j < n_; ++j) {
+      col_ptr_[j] = col_ptr_[j + 1];
+    }
+    col_ptr_[n_] = nelem_;
 
+    replaced_columns_.clear();
+    num_updates_ = 0;
+  }
 
-    p_ = new index_type[m_];
-    mem_.setZeroArrayOnHost(p_, m_);
+  /**
+   * @brief Restores LUSOL input from the stored copy of the factored matrix.
+   */
+  void LinSolverDirectLUSOL::loadFactoredColumns()
+  {
+    for (index_type j = 0; j < n_; ++j) {
+      for (index_type k = col_ptr_[j]; k < col_ptr_[j + 1]; ++k) {
+        a_[k] = col_val_[k];
+        indc_[k] = row_idx_[k] + 1;
+        indr_[k] = j + 1;
+      }
+    }
+  }
 
-    q_ = new index_type[n_];
-    mem_.setZeroArrayOnHost(q_, n_);
+  /**
+   * @brief Writes dense column `j` of the matrix the current factors
+   * correspond to into `column`.
+   */
+  void LinSolverDirectLUSOL::getCurrentColumn(index_type j, real_type* column)
+  {
+    auto replaced = replaced_columns_.find(j);
+    if (replaced != replaced_columns_.end()) {
+      std::copy(replaced->second.begin(), replaced->second.end(), column);
+      return;
+    }
 
-    lenc_ = new index_type[n_];
-    mem_.setZeroArrayOnHost(lenc_, n_);
+    std::fill(column, column + m_, 0.0);
+    for (index_type k = col_ptr_[j]; k < col_ptr_[j + 1]; ++k) {
+      column[row_idx_[k]] = col_val_[k];
+    }
+  }
 
-    lenr_ = new index_type[m_];
-    mem_.setZeroArrayOnHost(lenr_, m_);
+  /**
+   * @brief Heuristic initial size of `a_`, `indc_` and `indr_`.
+   *
+   * See `lena_` documentation for details.
+   */
+  index_type LinSolverDirectLUSOL::initialWorkspaceSize() const
+  {
+    std::int64_t dense_size = static_cast<std::int64_t>(m_) * static_cast<std::int64_t>(n_);
+    std::int64_t lena = 0;
+    if (lena_hint_ > 0) {
+      lena = lena_hint_;
+    } else if (nelem_ >= parmlu_[7] * static_cast<real_type>(dense_size)) {
+      lena = dense_size;
+    } else {
+      lena = std::min(5 * static_cast<std::int64_t>(nelem_), 2 * dense_size);
+    }
 
-    locc_ = new index_type[n_];
-    mem_.setZeroArrayOnHost(locc_, n_);
+    // LUSOL requires at least this much to store the input matrix.
+    std::int64_t minlen = static_cast<std::int64_t>(nelem_) + 2 * (m_ + n_);
+    lena = std::max(lena, minlen);
 
-    locr_ = new index_type[m_];
-    mem_.setZeroArrayOnHost(locr_, m_);
+    return static_cast<index_type>(std::min(lena,
+      static_cast<std::int64_t>(std::numeric_limits<index_type>::max())));
+  }
 
-    iploc_ = new index_type[n_];
-    mem_.setZeroArrayOnHost(iploc_, n_);
+  /**
+   * @brief Allocates LUSOL work arrays in a single arena.
+   *
+   * Each array starts at an `ARENA_ALIGNMENT` byte boundary. If the arena
+   * already has the requested size, it is reused and only cleared.
+   *
+   * @param[in] lena - size of `a_`, `indc_` and `indr_`
+   *
+   * @return 0 if successful, -1 otherwise
+   */
+  int LinSolverDirectLUSOL::allocateSolverData(index_type lena)
+  {
+    bool reuse = is_solver_data_allocated_ &&
+                 (lena == lena_) && (m_ == arena_m_) && (n_ == arena_n_);
 
-    iqloc_ = new index_type[m_];
-    mem_.setZeroArrayOnHost(iqloc_, m_);
+    if (!reuse) {
+      freeSolverData();
 
-    ipinv_ = new index_type[m_];
-    mem_.setZeroArrayOnHost(ipinv_, m_);
+      std::size_t real_size = sizeof(real_type);
+      std::size_t index_size = sizeof(index_type);
+      std::size_t lena_s = static_cast<std::size_t>(lena);
+      std::size_t m = static_cast<std::size_t>(m_);
+      std::size_t n = static_cast<std::size_t>(n_);
+
+      // a_, w_, indc_, indr_, five arrays of size m and five of size n
+      arena_size_ = alignedSize(lena_s * real_size)
+                  + alignedSize(n * real_size)
+                  + 2 * alignedSize(lena_s * index_size)
+                  + 5 * alignedSize(m * index_size)
+                  + 5 * alignedSize(n * index_size);
+
+      arena_ = new (std::nothrow) char[arena_size_ + ARENA_ALIGNMENT];
+      if (arena_ == nullptr) {
+        out::error() << "Failed to allocate LUSOL workspace of "
+                     << arena_size_ << " bytes!\n";
+        arena_size_ = 0;
+        return -1;
+      }
+
+      std::uintptr_t base = reinterpret_cast<std::uintptr_t>(arena_);
+      char* ptr = reinterpret_cast<char*>((base + ARENA_ALIGNMENT - 1) & ~(static_cast<std::uintptr_t>(ARENA_ALIGNMENT) - 1));
+      arena_begin_ = ptr;
+
+      a_     = carve<real_type>(ptr, lena_s);
+      w_     = carve<real_type>(ptr, n);
+      indc_  = carve<index_type>(ptr, lena_s);
+      indr_  = carve<index_type>(ptr, lena_s);
+      p_     = carve<index_type>(ptr, m);
+      lenr_  = carve<index_type>(ptr, m);
+      locr_  = carve<index_type>(ptr, m);
+      iqloc_ = carve<index_type>(ptr, m);
+      ipinv_ = carve<index_type>(ptr, m);
+      q_     = carve<index_type>(ptr, n);
+      lenc_  = carve<index_type>(ptr, n);
+      locc_  = carve<index_type>(ptr, n);
+      iploc_ = carve<index_type>(ptr, n);
+      iqinv_ = carve<index_type>(ptr, n);
+
+      lena_ = lena;
+      arena_m_ = m_;
+      arena_n_ = n_;
+      is_solver_data_allocated_ = true;
+    }
 
-    iqinv_ = new index_type[n_];
-    mem_.setZeroArrayOnHost(iqinv_, n_);
+    mem_.setZeroArrayOnHost(arena_begin_, arena_size_);
 
-    w_ = new real_type[n_];
-    mem_.setZeroArrayOnHost(w_, n_);
-  
     return 0;
   }
 
   int LinSolverDirectLUSOL::freeSolverData()
   {
-    delete[] a_;
-    delete[] indc_;
-    delete[] indr_;
-    delete[] p_;
-    delete[] q_;
-    delete[] lenc_;
-    delete[] lenr_;
-    delete[] locc_;
-    delete[] locr_;
-    delete[] iploc_;
-    delete[] iqloc_;
-    delete[] ipinv_;
-    delete[] iqinv_;
-    delete[] w_;
-    a_     = nullptr; 
-    indc_  = nullptr; 
-    indr_  = nullptr; 
-    p_     = nullptr; 
-    q_     = nullptr; 
-    lenc_  = nullptr; 
+    delete[] arena_;
+    arena_       = nullptr;
+    arena_begin_ = nullptr;
+    arena_size_  = 0;
+    arena_m_     = 0;
+    arena_n_     = 0;
+    is_solver_data_allocated_ = false;
+    is_factorized_ = false;
+
+    a_     = nullptr;
+    indc_  = nullptr;
+    indr_  = nullptr;
+    p_     = nullptr;
+    q_     = nullptr;
+    lenc_  = nullptr;
     lenr_  = nullptr;
     locc_  = nullptr;
-    locr_  = nullptr; 
+    locr_  = nullptr;
     iploc_ = nullptr;
-    iqloc_ = nullptr; 
-    ipinv_ = nullptr; 
+    iqloc_ = nullptr;
+    ipinv_ = nullptr;
     iqinv_ = nullptr;
     w_     = nullptr;
 
     return 0;
   }
+
+  /**
+   * @brief Rounds `bytes` up to a multiple of `ARENA_ALIGNMENT`.
+   */
+  std::size_t LinSolverDirectLUSOL::alignedSize(std::size_t bytes)
+  {
+    return (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+  }
 } // namespace ReSolve
@@ -4,8 +4,11 @@
 #include <resolve/LinSolver.hpp>
 #include <resolve/MemoryUtils.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace ReSolve
 {
@@ -51,16 +54,73 @@ namespace ReSolve
 
       virtual real_type getMatrixConditionNumber() override;
 
+      memory::MemoryUsage getMemoryUsage() const override;
+
+      int replaceColumn(index_type j, vector_type* column);
+      int updateRankOne(real_type alpha, vector_type* u, vector_type* v);
+      index_type getNumUpdates() const;
+
+      void setInitialWorkspaceSize(index_type lena);
+      index_type getWorkspaceSize() const;
+
     private:
-      int allocateSolverData();
+      index_type initialWorkspaceSize() const;
+      int allocateSolverData(index_type lena);
       int freeSolverData();
+      void storeFactoredColumns();
+      void loadFactoredColumns();
+      void getCurrentColumn(index_type j, real_type* column);
+
+      static std::size_t alignedSize(std::size_t bytes);
+
+      /// @brief Returns aligned array of `count` elements at `ptr` and
+      ///        advances `ptr` past it
+      template <typename T>
+      static T* carve(char*& ptr, std::size_t count)
+      {
+        T* array = reinterpret_cast<T*>(ptr);
+        ptr += alignedSize(count * sizeof(T));
+        return array;
+      }
+
+      /// Alignment in bytes of each work array within the arena.
+      static constexpr std::size_t ARENA_ALIGNMENT = 64;
+
+      /// Growth factor of `lena_` when LUSOL reports insufficient storage.
+      static constexpr index_type LENA_GROWTH_FACTOR = 2;
+
+      /// Maximum number of factorization attempts with growing workspace.
+      static constexpr int MAX_FACTORIZATION_ATTEMPTS = 8;
 
       bool is_solver_data_allocated_{false};
 
+      /// @brief Factors in the workspace are valid and can be used by ::solve()
+      bool is_factorized_{false};
+
       MemoryHandler mem_;
 
+      /// @brief Single allocation holding all LUSOL work arrays below
+      char* arena_ = nullptr;
+
+      /// @brief First aligned byte of `arena_`
+      char* arena_begin_ = nullptr;
+
+      /// @brief Size of the aligned part of `arena_` in bytes
+      std::size_t arena_size_ = 0;
+
+      /// @brief Matrix dimensions the arena was allocated for
+      index_type arena_m_ = 0;
+      index_type arena_n_ = 0;
+
+      /// @brief User provided initial `lena_`, heuristic is used if zero
+      index_type lena_hint_ = 0;
+
+      /// @brief Hash of the sparsity pattern of the analyzed matrix
+      std::uint64_t pattern_hash_ = 0;
+
       //NOTE: a_, indc_, and indr_ may need to be passed along to the GPU at some
-      //      point in the future, so they are manually managed
+      //      point in the future, so they are manually managed. All arrays
+      //      below point into `arena_`
 
       /// @brief Storage used for the matrices
       ///
@@ -112,7 +172,9 @@ namespace ReSolve
       /// buffer may be insufficient, in which case a call to a LUSOL subroutine
       /// utilizing it will return with inform set to 7, and the intended behavior of
       /// the callee is that they should resize `a_`, `indc_`, and `indr_` to at least
-      /// the value specified in `luparm_[12]`
+      /// the value specified in `luparm_[12]`. ::factorize() does so automatically,
+      /// growing `lena_` by at least `LENA_GROWTH_FACTOR`, and the grown size is
+      /// kept while the sparsity pattern of the matrix does not change
       index_type lena_ = 0;
 
       /// @brief The number of rows in the input matrix, A
@@ -175,5 +237,22 @@ namespace ReSolve
       /// When solving a linear system `A*w_ = v_`, `w_` contains the solution. It is not
       /// important what `w_` contains prior to this.
       real_type* w_ = nullptr;
+
+      /// @brief Number of column replacements applied since the last factorization
+      index_type num_updates_ = 0;
+
+      /// @brief Columns of the factored matrix in CSC format
+      ///
+      /// LUSOL overwrites its input with the factors, so a copy of the factored
+      /// matrix is kept to be able to form new columns in rank-1 updates.
+      std::vector<index_type> col_ptr_;
+      std::vector<index_type> row_idx_;
+      std::vector<real_type> col_val_;
+
+      /// @brief Dense copies of columns replaced since the last factorization
+      std::unordered_map<index_type, std::vector<real_type>> replaced_columns_;
+
+      /// @brief Work vector of size `m_` overwritten by the update routine
+      std::vector<real_type> update_work_;
   };
 }
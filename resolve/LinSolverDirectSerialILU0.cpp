@@ -236,4 +236,23 @@ namespace ReSolve
     //for (int ii=0; ii<10; ++ii) printf("(LU)^{-1}y[%d] = %16.16f \n ", ii,  x->getData(ReSolve::memory::HOST)[ii]); 
    return error_sum;
   }
+
+  /// Returns bytes held by ILU0 factors and auxiliary arrays.
+  memory::MemoryUsage LinSolverDirectSerialILU0::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (owns_factors_) {
+      if (L_ != nullptr) {
+        usage += L_->getMemoryUsage();
+      }
+      if (U_ != nullptr) {
+        usage += U_->getMemoryUsage();
+      }
+    }
+    if ((A_ != nullptr) && (h_ILU_vals_ != nullptr)) {
+      usage.host_bytes += sizeof(real_type) * static_cast<std::size_t>(A_->getNnzExpanded());
+      usage.host_bytes += sizeof(real_type) * static_cast<std::size_t>(A_->getNumRows());
+    }
+    return usage;
+  }
 } // namespace resolve
@@ -37,6 +37,8 @@ namespace ReSolve
        
       int solve(vector_type* rhs, vector_type* x);
       int solve(vector_type* rhs);// the solutuon is returned IN RHS (rhs is overwritten)
+
+      memory::MemoryUsage getMemoryUsage() const override;
     
 
     private:
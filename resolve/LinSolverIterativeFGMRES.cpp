@@ -10,6 +10,7 @@
 #include <iomanip>
 
 #include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/Profiling.hpp>
 #include <resolve/matrix/MatrixHandler.hpp>
 #include "LinSolverIterativeFGMRES.hpp"
 
@@ -100,7 +101,17 @@ namespace ReSolve
 
   int  LinSolverIterativeFGMRES::solve(vector_type* rhs, vector_type* x)
   {
+    RESOLVE_RANGE_SCOPE("FGMRES::solve");
     using namespace constants;
+    SolverStats::Timer solve_timer(stats_, SolverStats::solve);
+    history_.clear();
+
+    // Work estimates for CSR matrix-vector product: read matrix, x and y
+    const real_type nnz = static_cast<real_type>(A_->getNnz());
+    const real_type matvec_flops = 2.0 * nnz;
+    const real_type matvec_bytes = nnz * (sizeof(real_type) + sizeof(index_type))
+                                 + (n_ + 1) * sizeof(index_type)
+                                 + 2.0 * n_ * sizeof(real_type);
 
     //io::Logger::setVerbosity(io::Logger::EVERYTHING);
     
@@ -108,6 +119,7 @@ namespace ReSolve
     int notconv = 1; 
     int i  = 0;
     int it = 0;
+    index_type cycle = -1;
     int j  = 0;
     int k  = 0;
     int k1 = 0;
@@ -118,22 +130,27 @@ namespace ReSolve
     real_type tolrel;
     vector_type* vec_v = new vector_type(n_);
     vector_type* vec_z = new vector_type(n_);
+    const bool delayed = GS_->isDelayed();
     //V[0] = b-A*x_0
     //debug
     vec_Z_->setToZero(memspace_);
     vec_V_->setToZero(memspace_);
 
     rhs->deepCopyVectorData(vec_V_->getData(memspace_), 0, memspace_);  
-    matrix_handler_->matvec(A_, x, vec_V_, &MINUSONE, &ONE, "csr", memspace_); 
+    {
+      SolverStats::Timer timer(stats_, SolverStats::matvec);
+      timer.addWork(matvec_flops, matvec_bytes);
+      matrix_handler_->matvec(A_, x, vec_V_, &MINUSONE, &ONE, "csr", memspace_);
+    }
     rnorm = 0.0;
     bnorm = vector_handler_->dot(rhs, rhs, memspace_);
     rnorm = vector_handler_->dot(vec_V_, vec_V_, memspace_);
     //rnorm = ||V_1||
     rnorm = std::sqrt(rnorm);
     bnorm = std::sqrt(bnorm);
-    io::Logger::misc() << "it 0: norm of residual "
-                       << std::scientific << std::setprecision(16) 
-                       << rnorm << " Norm of rhs: " << bnorm << "\n";
+    RESOLVE_LOG_MISC << "it 0: norm of residual "
+                     << std::scientific << std::setprecision(16) 
+                     << rnorm << " Norm of rhs: " << bnorm << "\n";
     initial_residual_norm_ = rnorm;
     while(outer_flag) {
       // check if maybe residual is already small enough?
@@ -170,10 +187,13 @@ namespace ReSolve
       h_rs_[0] = rnorm;
       i = -1;
       notconv = 1;
+      cycle++;
 
       while((notconv) && (it < maxit_)) {
         i++;
         it++;
+        RESOLVE_RANGE_SCOPE("FGMRES::iteration");
+        history_.startIteration(stats_);
 
         // Z_i = (LU)^{-1}*V_i
         vec_v->setData( vec_V_->getVectorData(i, memspace_), memspace_);
@@ -182,57 +202,77 @@ namespace ReSolve
         } else {
           vec_z->setData( vec_Z_->getVectorData(0, memspace_), memspace_);
         }
+        RESOLVE_RANGE_PUSH("FGMRES::precondition");
         this->precV(vec_v, vec_z);
+        RESOLVE_RANGE_POP("FGMRES::precondition");
         mem_.deviceSynchronize();
 
         // V_{i+1}=A*Z_i
 
         vec_v->setData( vec_V_->getVectorData(i + 1, memspace_), memspace_);
 
-        matrix_handler_->matvec(A_, vec_z, vec_v, &ONE, &ZERO,"csr", memspace_); 
+        {
+          SolverStats::Timer timer(stats_, SolverStats::matvec);
+          timer.addWork(matvec_flops, matvec_bytes);
+          matrix_handler_->matvec(A_, vec_z, vec_v, &ONE, &ZERO,"csr", memspace_);
+        }
 
         // orthogonalize V[i+1], form a column of h_H_
 
-        GS_->orthogonalize(n_, vec_V_, h_H_, i);
-        if (i != 0) {
-          for (index_type k = 1; k <= i; k++) {
-            k1 = k - 1;
-            t = h_H_[i * (restart_ + 1) + k1];
-            h_H_[i * (restart_ + 1) + k1] = h_c_[k1] * t + h_s_[k1] * h_H_[i * (restart_ + 1) + k];
-            h_H_[i * (restart_ + 1) + k] = -h_s_[k1] * t + h_c_[k1] * h_H_[i * (restart_ + 1) + k];
+        {
+          // Estimate for one projection pass over i + 1 basis vectors
+          SolverStats::Timer timer(stats_, SolverStats::orthogonalize);
+          timer.addWork(4.0 * (i + 1) * n_, 2.0 * (i + 2) * n_ * sizeof(real_type));
+          RESOLVE_RANGE_PUSH("FGMRES::orthogonalize");
+          GS_->orthogonalize(n_, vec_V_, h_H_, i);
+          RESOLVE_RANGE_POP("FGMRES::orthogonalize");
+        }
+        if (delayed) {
+          // Column i of H is completed at the next step, so rotations and
+          // residual estimate lag one iteration behind.
+          if (flexible_) {
+            GS_->applyDelayedCorrection(n_, vec_Z_, i);
           }
-        } // if i!=0
-        real_type Hii = h_H_[i * (restart_ + 1) + i];
-        real_type Hii1 = h_H_[(i) * (restart_ + 1) + i + 1];
-        real_type gam = std::sqrt(Hii * Hii + Hii1 * Hii1);
-
-        if(std::abs(gam - ZERO) <= EPSILON) {
-          gam = EPSMAC;
+          if (i > 0) {
+            applyGivensRotation(i - 1);
+          }
+        } else {
+          applyGivensRotation(i);
         }
 
-        /* next Given's rotation */
-        h_c_[i] = Hii / gam;
-        h_s_[i] = Hii1 / gam;
-        h_rs_[i + 1] = -h_s_[i] * h_rs_[i];
-        h_rs_[i] = h_c_[i] * h_rs_[i];
-
-        h_H_[(i) * (restart_ + 1) + (i)]     = h_c_[i] * Hii  + h_s_[i] * Hii1;
-        h_H_[(i) * (restart_ + 1) + (i + 1)] = h_c_[i] * Hii1 - h_s_[i] * Hii;
-
         // residual norm estimate
-        rnorm = std::abs(h_rs_[i + 1]);
-        io::Logger::misc() << "it: " << it << " --> norm of the residual "
-                           << std::scientific << std::setprecision(16)
-                           << rnorm << "\n";
+        rnorm = std::abs(h_rs_[delayed ? i : i + 1]);
+        RESOLVE_LOG_MISC << "it: " << it << " --> norm of the residual "
+                         << std::scientific << std::setprecision(16)
+                         << rnorm << "\n";
+        if (history_.isEnabled()) {
+          real_type loss = -1.0;
+          if (history_.isTrackingOrthogonality() && (!delayed || i > 0)) {
+            // New basis vector should be orthogonal to the first one
+            if (delayed) {
+              vec_v->setData(vec_V_->getVectorData(i, memspace_), memspace_);
+            }
+            loss = std::abs(vector_handler_->dot(vec_V_, vec_v, memspace_));
+          }
+          history_.addIteration(it, cycle, i, rnorm, loss, stats_);
+        }
         // check convergence
         if (i + 1 >= restart_ || rnorm <= tolrel || it >= maxit_) {
           notconv = 0;
         }
       } // inner while
 
-      io::Logger::misc() << "End of cycle, ESTIMATED norm of residual "
-                         << std::scientific << std::setprecision(16)
-                         << rnorm << "\n";
+      if (delayed) {
+        SolverStats::Timer timer(stats_, SolverStats::orthogonalize);
+        timer.addWork(4.0 * (i + 1) * n_, 2.0 * (i + 2) * n_ * sizeof(real_type));
+        GS_->completeDelayed(n_, vec_V_, h_H_, i);
+        applyGivensRotation(i);
+        rnorm = std::abs(h_rs_[i + 1]);
+      }
+
+      RESOLVE_LOG_MISC << "End of cycle, ESTIMATED norm of residual "
+                       << std::scientific << std::setprecision(16)
+                       << rnorm << "\n";
       // solve tri system
       h_rs_[i] = h_rs_[i] / h_H_[i * (restart_ + 1) + i];
       for(int ii = 2; ii <= i + 1; ii++) {
@@ -274,17 +314,22 @@ namespace ReSolve
       }
 
       rhs->deepCopyVectorData(vec_V_->getData(memspace_), 0, memspace_);  
-      matrix_handler_->matvec(A_, x, vec_V_, &MINUSONE, &ONE,"csr", memspace_); 
+      {
+        SolverStats::Timer timer(stats_, SolverStats::matvec);
+        timer.addWork(matvec_flops, matvec_bytes);
+        matrix_handler_->matvec(A_, x, vec_V_, &MINUSONE, &ONE,"csr", memspace_);
+      }
       rnorm = vector_handler_->dot(vec_V_, vec_V_, memspace_);
       // rnorm = ||V_1||
       rnorm = std::sqrt(rnorm);
+      history_.endCycle(rnorm);
 
       if(!outer_flag) {
         final_residual_norm_ = rnorm;
         total_iters_ = it;
-        io::Logger::misc() << "End of cycle, COMPUTED norm of residual "
-                           << std::scientific << std::setprecision(16)
-                           << rnorm << "\n";
+        RESOLVE_LOG_MISC << "End of cycle, COMPUTED norm of residual "
+                         << std::scientific << std::setprecision(16)
+                         << rnorm << "\n";
       }
     } // outer while
     return 0;
@@ -383,6 +428,29 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Returns bytes held by the Krylov basis, Hessenberg matrix and
+   * Givens rotations.
+   *
+   * The Gram-Schmidt object and the preconditioner are not owned by the
+   * solver and are not included.
+   */
+  memory::MemoryUsage LinSolverIterativeFGMRES::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (vec_V_ != nullptr) {
+      usage += vec_V_->getMemoryUsage();
+    }
+    if (vec_Z_ != nullptr) {
+      usage += vec_Z_->getMemoryUsage();
+    }
+    if (h_H_ != nullptr) {
+      std::size_t restart = static_cast<std::size_t>(restart_);
+      usage.host_bytes += sizeof(real_type) * (restart * (restart + 1) + 2 * restart + (restart + 1));
+    }
+    return usage;
+  }
+
   //
   // Private methods
   //
@@ -425,8 +493,48 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Applies previous Givens rotations to column i of the Hessenberg
+   * matrix, then computes and applies the rotation eliminating its
+   * subdiagonal entry.
+   *
+   * @post h_rs_[i + 1] holds residual norm estimate after i + 1 columns.
+   */
+  void LinSolverIterativeFGMRES::applyGivensRotation(index_type i)
+  {
+    using namespace constants;
+    real_type t = 0.0;
+    index_type k1 = 0;
+
+    if (i != 0) {
+      for (index_type k = 1; k <= i; k++) {
+        k1 = k - 1;
+        t = h_H_[i * (restart_ + 1) + k1];
+        h_H_[i * (restart_ + 1) + k1] = h_c_[k1] * t + h_s_[k1] * h_H_[i * (restart_ + 1) + k];
+        h_H_[i * (restart_ + 1) + k] = -h_s_[k1] * t + h_c_[k1] * h_H_[i * (restart_ + 1) + k];
+      }
+    } // if i!=0
+    real_type Hii = h_H_[i * (restart_ + 1) + i];
+    real_type Hii1 = h_H_[(i) * (restart_ + 1) + i + 1];
+    real_type gam = std::sqrt(Hii * Hii + Hii1 * Hii1);
+
+    if(std::abs(gam - ZERO) <= EPSILON) {
+      gam = EPSMAC;
+    }
+
+    /* next Given's rotation */
+    h_c_[i] = Hii / gam;
+    h_s_[i] = Hii1 / gam;
+    h_rs_[i + 1] = -h_s_[i] * h_rs_[i];
+    h_rs_[i] = h_c_[i] * h_rs_[i];
+
+    h_H_[(i) * (restart_ + 1) + (i)]     = h_c_[i] * Hii  + h_s_[i] * Hii1;
+    h_H_[(i) * (restart_ + 1) + (i + 1)] = h_c_[i] * Hii1 - h_s_[i] * Hii;
+  }
+
   void LinSolverIterativeFGMRES::precV(vector_type* rhs, vector_type* x)
   { 
+    SolverStats::Timer timer(stats_, SolverStats::precondition);
     LU_solver_->solve(rhs, x);
   }
 
@@ -49,11 +49,14 @@ namespace ReSolve
       int setRestart(index_type restart) override;
       int setFlexible(bool is_flexible) override;
 
+      memory::MemoryUsage getMemoryUsage() const override;
+
     private:
       int allocateSolverData();
       int freeSolverData();
       void setMemorySpace();
       void precV(vector_type* rhs, vector_type* x); ///< Apply preconditioner
+      void applyGivensRotation(index_type i);
 
       memory::MemorySpace memspace_;
 
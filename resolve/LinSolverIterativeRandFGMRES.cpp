@@ -4,6 +4,7 @@
  * @brief Implementation of LinSolverIterativeRandFGMRES class.
  * 
  */
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <cmath>
@@ -11,6 +12,7 @@
 #include <cstring>
 
 #include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/Profiling.hpp>
 #include <resolve/matrix/Sparse.hpp>
 #include <resolve/vector/Vector.hpp>
 #include <resolve/GramSchmidt.hpp>
@@ -128,7 +130,24 @@ namespace ReSolve
 
   int  LinSolverIterativeRandFGMRES::solve(vector_type* rhs, vector_type* x)
   {
+    RESOLVE_RANGE_SCOPE("RandFGMRES::solve");
     using namespace constants;
+    SolverStats::Timer solve_timer(stats_, SolverStats::solve);
+    history_.clear();
+
+    if (GS_->isDelayed()) {
+      // Sketched basis is orthogonalized, but the Krylov basis is formed
+      // from final columns of H at each step.
+      out::error() << "Delayed Gram-Schmidt variants are not supported by randomized FGMRES.\n";
+      return 1;
+    }
+
+    // Work estimates for CSR matrix-vector product: read matrix, x and y
+    const real_type nnz = static_cast<real_type>(A_->getNnz());
+    const real_type matvec_flops = 2.0 * nnz;
+    const real_type matvec_bytes = nnz * (sizeof(real_type) + sizeof(index_type))
+                                 + (n_ + 1) * sizeof(index_type)
+                                 + 2.0 * n_ * sizeof(real_type);
 
     // io::Logger::setVerbosity(io::Logger::EVERYTHING);
 
@@ -136,6 +155,7 @@ namespace ReSolve
     int notconv = 1; 
     index_type i = 0;
     int it = 0;
+    index_type cycle = -1;
     int j;
     int k;
     int k1;
@@ -152,14 +172,25 @@ namespace ReSolve
     //debug
     vec_Z_->setToZero(memspace_);
     vec_V_->setToZero(memspace_);
+    if ((sketching_method_ == cs) || (sketching_method_ == sse)) {
+      // Sparse sketches accumulate into the output
+      vec_S_->setToZero(memspace_);
+    }
 
     rhs->deepCopyVectorData(vec_V_->getData(memspace_), 0, memspace_);  
-    matrix_handler_->matvec(A_, x, vec_V_, &MINUSONE, &ONE, "csr", memspace_); 
+    {
+      SolverStats::Timer timer(stats_, SolverStats::matvec);
+      timer.addWork(matvec_flops, matvec_bytes);
+      matrix_handler_->matvec(A_, x, vec_V_, &MINUSONE, &ONE, "csr", memspace_);
+    }
 
     vec_v->setData(vec_V_->getVectorData(0, memspace_), memspace_);
     vec_s->setData(vec_S_->getVectorData(0, memspace_), memspace_);
 
-    sketching_handler_->Theta(vec_v, vec_s);
+    {
+      SolverStats::Timer timer(stats_, SolverStats::sketch);
+      sketching_handler_->Theta(vec_v, vec_s);
+    }
 
     if (sketching_method_ == fwht) {
       vector_handler_->scal(&one_over_k_, vec_s, memspace_);
@@ -171,9 +202,9 @@ namespace ReSolve
     rnorm = vector_handler_->dot(vec_s, vec_s, memspace_);
     rnorm = std::sqrt(rnorm); // rnorm = ||V_1||
     bnorm = std::sqrt(bnorm);
-    io::Logger::misc() << "it 0: norm of residual "
-                       << std::scientific << std::setprecision(16) 
-                       << rnorm << " Norm of rhs: " << bnorm << "\n";
+    RESOLVE_LOG_MISC << "it 0: norm of residual "
+                     << std::scientific << std::setprecision(16) 
+                     << rnorm << " Norm of rhs: " << bnorm << "\n";
     initial_residual_norm_ = rnorm;
     while(outer_flag) {
       // check if maybe residual is already small enough?
@@ -209,10 +240,13 @@ namespace ReSolve
       h_rs_[0] = rnorm;
       i = -1;
       notconv = 1;
+      cycle++;
 
       while((notconv) && (it < maxit_)) {
         i++;
         it++;
+        RESOLVE_RANGE_SCOPE("RandFGMRES::iteration");
+        history_.startIteration(stats_);
 
         // Z_i = (LU)^{-1}*V_i
         vec_v->setData(vec_V_->getVectorData(i, memspace_), memspace_);
@@ -221,24 +255,40 @@ namespace ReSolve
         } else {
           vec_z->setData(vec_Z_->getVectorData(0, memspace_), memspace_);
         }
+        RESOLVE_RANGE_PUSH("RandFGMRES::precondition");
         this->precV(vec_v, vec_z);
+        RESOLVE_RANGE_POP("RandFGMRES::precondition");
 
         mem_.deviceSynchronize();
 
         // V_{i+1}=A*Z_i
         vec_v->setData(vec_V_->getVectorData(i + 1, memspace_), memspace_);
 
-        matrix_handler_->matvec(A_, vec_z, vec_v, &ONE, &ZERO, "csr", memspace_); 
+        {
+          SolverStats::Timer timer(stats_, SolverStats::matvec);
+          timer.addWork(matvec_flops, matvec_bytes);
+          matrix_handler_->matvec(A_, vec_z, vec_v, &ONE, &ZERO, "csr", memspace_);
+        }
 
         // orthogonalize V[i+1], form a column of h_H_
         // this is where it differs from normal solver GS
         vec_s->setData(vec_S_->getVectorData(i + 1, memspace_), memspace_);
-        sketching_handler_->Theta(vec_v, vec_s); 
+        {
+          SolverStats::Timer timer(stats_, SolverStats::sketch);
+          sketching_handler_->Theta(vec_v, vec_s);
+        }
         if (sketching_method_ == fwht) {
           vector_handler_->scal(&one_over_k_, vec_s, memspace_);
         }
         mem_.deviceSynchronize();
-        GS_->orthogonalize(k_rand_, vec_S_, h_H_, i);
+        {
+          // Estimate for one projection pass over i + 1 basis vectors
+          SolverStats::Timer timer(stats_, SolverStats::orthogonalize);
+          timer.addWork(4.0 * (i + 1) * k_rand_, 2.0 * (i + 2) * k_rand_ * sizeof(real_type));
+          RESOLVE_RANGE_PUSH("RandFGMRES::orthogonalize");
+          GS_->orthogonalize(k_rand_, vec_S_, h_H_, i);
+          RESOLVE_RANGE_POP("RandFGMRES::orthogonalize");
+        }
         // now post-process
         if (memspace_ == memory::DEVICE) {
           mem_.copyArrayHostToDevice(d_aux_, &h_H_[i * (restart_ + 1)], i + 2);
@@ -285,18 +335,25 @@ namespace ReSolve
         // residual norm estimate
         rnorm = std::abs(h_rs_[i + 1]);
 
-        io::Logger::misc() << "it: "<< it << " --> norm of the residual "
-                           << std::scientific << std::setprecision(16)
-                           << rnorm << "\n";
+        RESOLVE_LOG_MISC << "it: "<< it << " --> norm of the residual "
+                         << std::scientific << std::setprecision(16)
+                         << rnorm << "\n";
+        if (history_.isEnabled()) {
+          real_type loss = -1.0;
+          if (history_.isTrackingOrthogonality()) {
+            loss = sketchedOrthogonalityLoss(i + 1);
+          }
+          history_.addIteration(it, cycle, i, rnorm, loss, stats_);
+        }
         // check convergence
         if (i + 1 >= restart_ || rnorm <= tolrel || it >= maxit_) {
           notconv = 0;
         }
       } // inner while
 
-      io::Logger::misc() << "End of cycle, ESTIMATED norm of residual "
-                         << std::scientific << std::setprecision(16)
-                         << rnorm << "\n";
+      RESOLVE_LOG_MISC << "End of cycle, ESTIMATED norm of residual "
+                       << std::scientific << std::setprecision(16)
+                       << rnorm << "\n";
       // solve tri system
       h_rs_[i] = h_rs_[i] / h_H_[i * (restart_ + 1) + i];
       for (int ii = 2; ii <= i + 1; ii++) {
@@ -337,17 +394,24 @@ namespace ReSolve
       }
 
       rhs->deepCopyVectorData(vec_V_->getData(memspace_), 0, memspace_);  
-      matrix_handler_->matvec(A_, x, vec_V_, &MINUSONE, &ONE,"csr", memspace_); 
+      {
+        SolverStats::Timer timer(stats_, SolverStats::matvec);
+        timer.addWork(matvec_flops, matvec_bytes);
+        matrix_handler_->matvec(A_, x, vec_V_, &MINUSONE, &ONE,"csr", memspace_);
+      }
       if (outer_flag) {
 
         sketching_handler_->reset();
 
-        if (sketching_method_ == cs) {
+        if ((sketching_method_ == cs) || (sketching_method_ == sse)) {
           vec_S_->setToZero(memspace_);
         }
         vec_v->setData(vec_V_->getVectorData(0, memspace_), memspace_);
         vec_s->setData(vec_S_->getVectorData(0, memspace_), memspace_);
-        sketching_handler_->Theta(vec_v, vec_s);
+        {
+          SolverStats::Timer timer(stats_, SolverStats::sketch);
+          sketching_handler_->Theta(vec_v, vec_s);
+        }
         if (sketching_method_ == fwht) {
           vector_handler_->scal(&one_over_k_, vec_s, memspace_);
         }
@@ -362,13 +426,15 @@ namespace ReSolve
         // rnorm = ||V_0||
         rnorm = std::sqrt(rnorm);
 
-        io::Logger::misc() << "End of cycle, COMPUTED norm of residual "
-                           << std::scientific << std::setprecision(16)
-                           << rnorm << "\n";
+        RESOLVE_LOG_MISC << "End of cycle, COMPUTED norm of residual "
+                         << std::scientific << std::setprecision(16)
+                         << rnorm << "\n";
 
         final_residual_norm_ = rnorm;
         total_iters_ = it;
       }
+      // Sketched residual norm on restart, true residual norm on exit
+      history_.endCycle(rnorm);
     } // outer while
     return 0;
   }
@@ -397,6 +463,22 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Sets seed of the random number generator used to sample the
+   * sketching matrix, so that results are reproducible.
+   *
+   * By default the generator is seeded nondeterministically, so that
+   * each solver instance samples a different sketching matrix.
+   *
+   * @post Takes effect when sketching is set up, i.e. at the next call to
+   * setup() or setSketchingMethod().
+   */
+  void LinSolverIterativeRandFGMRES::setSketchingSeed(unsigned seed)
+  {
+    sketching_seed_ = seed;
+    has_sketching_seed_ = true;
+  }
+
   /**
    * @brief Set sketching method based on input string.
    * 
@@ -502,6 +584,43 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Returns bytes held by Krylov and sketched bases, Hessenberg
+   * matrix, Givens rotations and sketching data.
+   *
+   * The Gram-Schmidt object and the preconditioner are not owned by the
+   * solver and are not included.
+   */
+  memory::MemoryUsage LinSolverIterativeRandFGMRES::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (vec_V_ != nullptr) {
+      usage += vec_V_->getMemoryUsage();
+    }
+    if (vec_Z_ != nullptr) {
+      usage += vec_Z_->getMemoryUsage();
+    }
+    if (vec_S_ != nullptr) {
+      usage += vec_S_->getMemoryUsage();
+    }
+    if (vec_SV_ != nullptr) {
+      usage += vec_SV_->getMemoryUsage();
+    }
+    if (h_H_ != nullptr) {
+      std::size_t restart = static_cast<std::size_t>(restart_);
+      usage.host_bytes += sizeof(real_type) * (restart * (restart + 1) + 2 * restart + (restart + 1));
+      if (memspace_ == memory::DEVICE) {
+        usage.device_bytes += sizeof(real_type) * (restart + 1);
+      } else {
+        usage.host_bytes   += sizeof(real_type) * (restart + 1);
+      }
+    }
+    if (sketching_handler_ != nullptr) {
+      usage += sketching_handler_->getMemoryUsage();
+    }
+    return usage;
+  }
+
   //
   // Private methods
   //
@@ -572,11 +691,18 @@ namespace ReSolve
         // set k and n 
         break;
       case fwht:
+      case srht:
         if (std::ceil(2.0 * restart_ * std::log(n_) / std::log(restart_)) < k_rand_) {
           k_rand_ = static_cast<index_type>(std::ceil(2.0 * restart_ * std::log(n_) / std::log(restart_)));
         }
         sketching_handler_ = new SketchingHandler(sketching_method_, device_type_);
         break;
+      case sse:
+        if (std::ceil(restart_ * std::log(n_)) < k_rand_) {
+          k_rand_ = static_cast<index_type>(std::ceil(restart_ * std::log(static_cast<real_type>(n_))));
+        }
+        sketching_handler_ = new SketchingHandler(sketching_method_, device_type_);
+        break;
       default:
         io::Logger::warning() << "Wrong sketching method, setting to default (CountSketch)\n"; 
         sketching_method_ = cs;
@@ -587,13 +713,28 @@ namespace ReSolve
         break;
     }
 
+    if (!sketching_handler_->isSupported()) {
+      io::Logger::warning() << "Sketching method " << sketching_method_
+                            << " not available on this device, using CountSketch\n";
+      delete sketching_handler_;
+      sketching_method_ = cs;
+      k_rand_ = n_;
+      if (std::ceil(restart_ * std::log(n_)) < k_rand_) {
+        k_rand_ = static_cast<index_type>(std::ceil(restart_ * std::log(n_)));
+      }
+      sketching_handler_ = new SketchingHandler(cs, device_type_);
+    }
+
     one_over_k_ = 1.0 / std::sqrt((real_type) k_rand_);
     vec_S_ = new vector_type(k_rand_, restart_ + 1);
     vec_S_->allocate(memspace_);      
-    if (sketching_method_ == cs) {
+    if ((sketching_method_ == cs) || (sketching_method_ == sse)) {
       vec_S_->setToZero(memspace_);
     }
 
+    if (has_sketching_seed_) {
+      sketching_handler_->setSeed(sketching_seed_);
+    }
     sketching_handler_->setup(n_, k_rand_);
     return 0;
   }
@@ -601,16 +742,61 @@ namespace ReSolve
   int LinSolverIterativeRandFGMRES::freeSketchingData()
   {
     delete vec_S_;
+    delete vec_SV_;
     delete sketching_handler_;
 
     vec_S_ = nullptr;
+    vec_SV_ = nullptr;
     sketching_handler_ = nullptr;
 
     return 0;
   }
 
+  /**
+   * @brief Measures orthogonality of the Krylov basis in the sketched
+   * inner product.
+   * 
+   * Basis vectors V(:, 0:j) are sketched again in a single pass over the
+   * block, so the check sees the basis actually built rather than the
+   * sketches updated by Gram-Schmidt.
+   * 
+   * @param[in] j - index of the newest basis vector
+   * 
+   * @return Largest absolute sketched inner product of basis vector _j_
+   * with the previous ones.
+   */
+  real_type LinSolverIterativeRandFGMRES::sketchedOrthogonalityLoss(index_type j)
+  {
+    if (vec_SV_ == nullptr) {
+      vec_SV_ = new vector_type(k_rand_, restart_ + 1);
+      vec_SV_->allocate(memspace_);
+    }
+    if ((sketching_method_ == cs) || (sketching_method_ == sse)) {
+      // Sparse sketches accumulate into the output
+      vec_SV_->setToZero(memspace_);
+    }
+    {
+      SolverStats::Timer timer(stats_, SolverStats::sketch);
+      sketching_handler_->Theta(vec_V_, vec_SV_, j + 1);
+    }
+    mem_.deviceSynchronize();
+
+    // FWHT sketches are scaled after the transform
+    const real_type scale = (sketching_method_ == fwht) ? one_over_k_ * one_over_k_ : 1.0;
+    vector_type s_new(k_rand_);
+    vector_type s_old(k_rand_);
+    s_new.setData(vec_SV_->getVectorData(j, memspace_), memspace_);
+    real_type loss = 0.0;
+    for (index_type l = 0; l < j; ++l) {
+      s_old.setData(vec_SV_->getVectorData(l, memspace_), memspace_);
+      loss = std::max(loss, scale * std::abs(vector_handler_->dot(&s_old, &s_new, memspace_)));
+    }
+    return loss;
+  }
+
   void LinSolverIterativeRandFGMRES::precV(vector_type* rhs, vector_type* x)
   { 
+    SolverStats::Timer timer(stats_, SolverStats::precondition);
     LU_solver_->solve(rhs, x);
   }
 
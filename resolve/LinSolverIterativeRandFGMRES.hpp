@@ -38,7 +38,9 @@ namespace ReSolve
 
     public:
       enum SketchingMethod {cs = 0, // count sketch 
-                            fwht};  // fast Walsh-Hadamard transform
+                            fwht,   // fast Walsh-Hadamard transform
+                            sse,    // sparse sign embedding (CPU only)
+                            srht};  // subsampled randomized Hadamard transform (CPU only)
     
       LinSolverIterativeRandFGMRES(MatrixHandler* matrix_handler,
                                    VectorHandler* vector_handler);
@@ -68,8 +70,11 @@ namespace ReSolve
       int setRestart(index_type restart) override;
       int setFlexible(bool is_flexible) override;
 
+      memory::MemoryUsage getMemoryUsage() const override;
+
       index_type getKrand();
       int setSketchingMethod(SketchingMethod method);
+      void setSketchingSeed(unsigned seed);
 
     private:
       int allocateSolverData();
@@ -78,6 +83,7 @@ namespace ReSolve
       int freeSketchingData();
       void setMemorySpace();
       void precV(vector_type* rhs, vector_type* x); ///< Apply preconditioner
+      real_type sketchedOrthogonalityLoss(index_type j);
 
       memory::MemorySpace memspace_;
 
@@ -85,6 +91,7 @@ namespace ReSolve
       vector_type* vec_Z_{nullptr};
       // for performing Gram-Schmidt
       vector_type* vec_S_{nullptr}; ///< this is where sketched vectors are stored
+      vector_type* vec_SV_{nullptr}; ///< sketch of the Krylov basis for orthogonality checks
 
       real_type* h_H_{nullptr};
       real_type* h_c_{nullptr};
@@ -104,5 +111,7 @@ namespace ReSolve
       memory::DeviceType device_type_{memory::NONE};
       bool is_solver_set_{false};
       bool is_sketching_set_{false};
+      bool has_sketching_seed_{false};
+      unsigned sketching_seed_{0}; ///< fixed seed for reproducible sketches
   };
 } // namespace ReSolve
@@ -0,0 +1,313 @@
+/**
+ * @file MatrixAnalyzer.cpp
+ * @brief Implementation of sparse matrix structure analysis.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/utilities/logger/Logger.hpp>
+#include "SymbolicCache.hpp"
+#include "MatrixAnalyzer.hpp"
+
+namespace ReSolve
+{
+  using out = io::Logger;
+
+  namespace
+  {
+    /// Block sizes tried when looking for dense block structure
+    const index_type BLOCK_SIZES[] = {2, 3, 4, 6, 8};
+
+    /// Minimum fraction of stored entries in blocks to report block structure
+    const real_type MIN_BLOCK_FILL = 0.9;
+
+    /// Histogram bin of a row length: 0 for empty rows, k for [2^(k-1), 2^k)
+    std::size_t histogramBin(index_type length)
+    {
+      std::size_t bin = 0;
+      while (length > 0) {
+        length >>= 1;
+        bin++;
+      }
+      return bin;
+    }
+  }
+
+  /**
+   * @brief Computes structural properties of a CSR matrix.
+   *
+   * @param[in] A - matrix in CSR format, host data is used
+   *
+   * @return 0 if successful, 1 otherwise
+   *
+   * @post getStructure() returns properties of A. Symmetry and level sets
+   * are only computed for square matrices.
+   */
+  int MatrixAnalyzer::analyze(matrix::Csr* A)
+  {
+    structure_ = MatrixStructure();
+    if (A == nullptr) {
+      out::error() << "MatrixAnalyzer: matrix is not set.\n";
+      return 1;
+    }
+
+    index_type n = A->getNumRows();
+    index_type m = A->getNumColumns();
+    const index_type* rows = A->getRowData(memory::HOST);
+    const index_type* cols = A->getColData(memory::HOST);
+    const real_type*  vals = A->getValues(memory::HOST);
+    if (n > 0 && (rows == nullptr || cols == nullptr)) {
+      out::error() << "MatrixAnalyzer: matrix has no data on the host.\n";
+      return 1;
+    }
+
+    structure_.num_rows     = n;
+    structure_.num_columns  = m;
+    structure_.nnz          = (n > 0) ? rows[n] : 0;
+    structure_.pattern_hash = SymbolicCache::hashPattern(0, n, rows, cols);
+
+    analyzeRows(n, rows, cols);
+    analyzeBlocks(n, m, rows, cols);
+    if (n == m) {
+      analyzeSymmetry(n, rows, cols, vals);
+      analyzeLevels(n, rows, cols);
+    }
+    return 0;
+  }
+
+  const MatrixStructure& MatrixAnalyzer::getStructure() const
+  {
+    return structure_;
+  }
+
+  /**
+   * @brief Writes a human readable summary of the last analysis.
+   *
+   * @param[out] out - output stream
+   */
+  void MatrixAnalyzer::print(std::ostream& out) const
+  {
+    const MatrixStructure& s = structure_;
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::setprecision(4);
+    out << "Matrix " << s.num_rows << " x " << s.num_columns
+        << ", nnz " << s.nnz
+        << ", pattern hash 0x" << std::hex << s.pattern_hash << std::dec << "\n";
+    out << "  row length        : min " << s.min_row_length
+        << ", max " << s.max_row_length
+        << ", mean " << s.mean_row_length
+        << ", stddev " << s.row_length_stddev << "\n";
+    out << "  row length bins   :";
+    for (std::size_t k = 0; k < s.row_length_histogram.size(); ++k) {
+      if (k == 0) {
+        out << " [0] " << s.row_length_histogram[k];
+      } else {
+        out << " [" << (1 << (k - 1)) << ", " << (1 << k) << ") " << s.row_length_histogram[k];
+      }
+    }
+    out << "\n";
+    out << "  bandwidth         : lower " << s.lower_bandwidth
+        << ", upper " << s.upper_bandwidth
+        << ", profile " << s.profile << "\n";
+    out << "  block structure   : " << s.block_size << " x " << s.block_size
+        << ", fill " << s.block_fill << "\n";
+    out << "  symmetry          : pattern " << s.pattern_symmetry
+        << ", structural " << (s.structurally_symmetric ? "yes" : "no")
+        << ", numerical " << (s.numerically_symmetric ? "yes" : "no")
+        << ", missing diagonals " << s.num_zero_diagonal << "\n";
+    out << "  level sets        : lower " << s.lower_levels
+        << " (" << s.getLowerParallelism() << " rows/level)"
+        << ", upper " << s.upper_levels
+        << " (" << s.getUpperParallelism() << " rows/level)\n";
+    out.flags(flags);
+  }
+
+  /// Row length statistics, bandwidth, profile and missing diagonals.
+  void MatrixAnalyzer::analyzeRows(index_type n, const index_type* rows, const index_type* cols)
+  {
+    MatrixStructure& s = structure_;
+    if (n == 0) {
+      return;
+    }
+    s.min_row_length = std::numeric_limits<index_type>::max();
+    real_type sum_squares = 0.0;
+    for (index_type i = 0; i < n; ++i) {
+      index_type length = rows[i + 1] - rows[i];
+      s.min_row_length = std::min(s.min_row_length, length);
+      s.max_row_length = std::max(s.max_row_length, length);
+      sum_squares += static_cast<real_type>(length) * length;
+
+      std::size_t bin = histogramBin(length);
+      if (bin >= s.row_length_histogram.size()) {
+        s.row_length_histogram.resize(bin + 1, 0);
+      }
+      s.row_length_histogram[bin]++;
+
+      index_type first = i;
+      bool has_diagonal = false;
+      for (index_type k = rows[i]; k < rows[i + 1]; ++k) {
+        index_type j = cols[k];
+        s.lower_bandwidth = std::max(s.lower_bandwidth, i - j);
+        s.upper_bandwidth = std::max(s.upper_bandwidth, j - i);
+        first = std::min(first, j);
+        has_diagonal = has_diagonal || (j == i);
+      }
+      s.profile += i - first;
+      if (!has_diagonal) {
+        s.num_zero_diagonal++;
+      }
+    }
+    s.mean_row_length   = static_cast<real_type>(s.nnz) / n;
+    real_type variance  = sum_squares / n - s.mean_row_length * s.mean_row_length;
+    s.row_length_stddev = std::sqrt(std::max(variance, 0.0));
+  }
+
+  /**
+   * @brief Finds the largest block size for which aligned dense blocks
+   * covering the pattern are at least MIN_BLOCK_FILL full.
+   */
+  void MatrixAnalyzer::analyzeBlocks(index_type n,
+                                     index_type m,
+                                     const index_type* rows,
+                                     const index_type* cols)
+  {
+    MatrixStructure& s = structure_;
+    if (s.nnz == 0) {
+      return;
+    }
+    std::vector<index_type> stamp;
+    for (index_type b : BLOCK_SIZES) {
+      if (b > n || b > m) {
+        break;
+      }
+      index_type num_block_rows    = (n + b - 1) / b;
+      index_type num_block_columns = (m + b - 1) / b;
+      stamp.assign(static_cast<std::size_t>(num_block_columns), -1);
+
+      std::int64_t num_blocks = 0;
+      for (index_type bi = 0; bi < num_block_rows; ++bi) {
+        index_type row_end = std::min(n, (bi + 1) * b);
+        for (index_type i = bi * b; i < row_end; ++i) {
+          for (index_type k = rows[i]; k < rows[i + 1]; ++k) {
+            index_type bj = cols[k] / b;
+            if (stamp[bj] != bi) {
+              stamp[bj] = bi;
+              num_blocks++;
+            }
+          }
+        }
+      }
+      real_type fill = static_cast<real_type>(s.nnz) / (static_cast<real_type>(num_blocks) * b * b);
+      if (fill >= MIN_BLOCK_FILL) {
+        s.block_size = b;
+        s.block_fill = fill;
+      }
+    }
+  }
+
+  /**
+   * @brief Matches each off-diagonal nonzero A(i, j) with A(j, i) using
+   * the transposed pattern.
+   */
+  void MatrixAnalyzer::analyzeSymmetry(index_type n,
+                                       const index_type* rows,
+                                       const index_type* cols,
+                                       const real_type* vals)
+  {
+    MatrixStructure& s = structure_;
+
+    // Transpose pattern and values
+    std::vector<index_type> t_rows(static_cast<std::size_t>(n) + 1, 0);
+    std::vector<index_type> t_cols(static_cast<std::size_t>(s.nnz));
+    std::vector<real_type>  t_vals(static_cast<std::size_t>(s.nnz));
+    for (index_type k = 0; k < s.nnz; ++k) {
+      t_rows[cols[k] + 1]++;
+    }
+    for (index_type i = 0; i < n; ++i) {
+      t_rows[i + 1] += t_rows[i];
+    }
+    std::vector<index_type> next(t_rows.begin(), t_rows.end() - 1);
+    for (index_type i = 0; i < n; ++i) {
+      for (index_type k = rows[i]; k < rows[i + 1]; ++k) {
+        index_type pos = next[cols[k]]++;
+        t_cols[pos] = i;
+        t_vals[pos] = (vals != nullptr) ? vals[k] : 0.0;
+      }
+    }
+
+    // Row i of the transpose holds A(j, i) for all j
+    std::vector<index_type> marker(static_cast<std::size_t>(n), -1);
+    std::vector<real_type>  value(static_cast<std::size_t>(n), 0.0);
+    std::int64_t num_off_diagonal = 0;
+    std::int64_t num_matched = 0;
+    bool numerically_symmetric = (vals != nullptr);
+    for (index_type i = 0; i < n; ++i) {
+      for (index_type k = rows[i]; k < rows[i + 1]; ++k) {
+        marker[cols[k]] = i;
+        value[cols[k]]  = (vals != nullptr) ? vals[k] : 0.0;
+      }
+      for (index_type k = t_rows[i]; k < t_rows[i + 1]; ++k) {
+        index_type j = t_cols[k];
+        if (j == i) {
+          continue;
+        }
+        num_off_diagonal++;
+        if (marker[j] != i) {
+          numerically_symmetric = false;
+          continue;
+        }
+        num_matched++;
+        real_type a_ij = value[j];
+        real_type a_ji = t_vals[k];
+        real_type scale = std::max(std::abs(a_ij), std::abs(a_ji));
+        if (std::abs(a_ij - a_ji) > 8 * std::numeric_limits<real_type>::epsilon() * scale) {
+          numerically_symmetric = false;
+        }
+      }
+    }
+    s.pattern_symmetry = (num_off_diagonal > 0)
+                         ? static_cast<real_type>(num_matched) / num_off_diagonal
+                         : 1.0;
+    s.structurally_symmetric = (num_matched == num_off_diagonal);
+    s.numerically_symmetric  = s.structurally_symmetric && numerically_symmetric;
+  }
+
+  /**
+   * @brief Computes the number of level sets of forward substitution with
+   * the lower part and backward substitution with the upper part.
+   *
+   * Level of row i is one more than the largest level of rows it depends on.
+   */
+  void MatrixAnalyzer::analyzeLevels(index_type n, const index_type* rows, const index_type* cols)
+  {
+    MatrixStructure& s = structure_;
+    std::vector<index_type> level(static_cast<std::size_t>(n), 0);
+
+    for (index_type i = 0; i < n; ++i) {
+      index_type depth = 0;
+      for (index_type k = rows[i]; k < rows[i + 1]; ++k) {
+        if (cols[k] < i) {
+          depth = std::max(depth, level[cols[k]]);
+        }
+      }
+      level[i] = depth + 1;
+      s.lower_levels = std::max(s.lower_levels, level[i]);
+    }
+
+    for (index_type i = n - 1; i >= 0; --i) {
+      index_type depth = 0;
+      for (index_type k = rows[i]; k < rows[i + 1]; ++k) {
+        if (cols[k] > i) {
+          depth = std::max(depth, level[cols[k]]);
+        }
+      }
+      level[i] = depth + 1;
+      s.upper_levels = std::max(s.upper_levels, level[i]);
+    }
+  }
+}
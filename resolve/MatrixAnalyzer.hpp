@@ -0,0 +1,99 @@
+/**
+ * @file MatrixAnalyzer.hpp
+ * @brief Structural properties of sparse matrices.
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "Common.hpp"
+
+namespace ReSolve
+{
+  // Forward declaration of matrix::Csr class
+  namespace matrix
+  {
+    class Csr;
+  }
+
+  /// Structural properties of a CSR matrix computed by MatrixAnalyzer.
+  struct MatrixStructure
+  {
+    index_type num_rows{0};
+    index_type num_columns{0};
+    index_type nnz{0};
+    std::uint64_t pattern_hash{0};
+
+    // Row lengths
+    index_type min_row_length{0};
+    index_type max_row_length{0};
+    real_type mean_row_length{0.0};
+    real_type row_length_stddev{0.0};
+    /// Number of empty rows in bin 0 and rows with length in [2^(k-1), 2^k) in bin k
+    std::vector<index_type> row_length_histogram;
+
+    // Distance of nonzeros from the diagonal
+    index_type lower_bandwidth{0}; ///< max i - j over nonzeros A(i, j)
+    index_type upper_bandwidth{0}; ///< max j - i over nonzeros A(i, j)
+    std::int64_t profile{0};       ///< sum over rows of distance from first nonzero to diagonal
+
+    // Dense blocks
+    index_type block_size{1};  ///< largest block size with block_fill of at least 0.9
+    real_type block_fill{1.0}; ///< fraction of stored entries in aligned block_size blocks
+
+    // Symmetry
+    real_type pattern_symmetry{0.0}; ///< fraction of off-diagonal nonzeros A(i, j) with nonzero A(j, i)
+    bool structurally_symmetric{false};
+    bool numerically_symmetric{false};
+    index_type num_zero_diagonal{0}; ///< number of rows without stored diagonal
+
+    // Level sets of triangular solves with lower and upper part of the pattern
+    index_type lower_levels{0};
+    index_type upper_levels{0};
+
+    /// Average number of rows per level of the lower triangular solve.
+    real_type getLowerParallelism() const
+    {
+      return (lower_levels > 0) ? static_cast<real_type>(num_rows) / lower_levels : 0.0;
+    }
+
+    /// Average number of rows per level of the upper triangular solve.
+    real_type getUpperParallelism() const
+    {
+      return (upper_levels > 0) ? static_cast<real_type>(num_rows) / upper_levels : 0.0;
+    }
+  };
+
+  /**
+   * @brief Computes row length statistics, bandwidth and profile, dense
+   * block structure, symmetry and level-set depth of a CSR matrix.
+   *
+   * All quantities are computed from host data in time proportional to
+   * the number of nonzeros. Level sets are those of the triangular solves
+   * with the strictly lower and strictly upper part of the pattern, which
+   * bound the parallelism of level-scheduled ILU0 and triangular solves.
+   */
+  class MatrixAnalyzer
+  {
+    public:
+      MatrixAnalyzer() = default;
+      ~MatrixAnalyzer() = default;
+
+      int analyze(matrix::Csr* A);
+      const MatrixStructure& getStructure() const;
+      void print(std::ostream& out) const;
+
+    private:
+      void analyzeRows(index_type n, const index_type* rows, const index_type* cols);
+      void analyzeBlocks(index_type n, index_type m, const index_type* rows, const index_type* cols);
+      void analyzeSymmetry(index_type n,
+                           const index_type* rows,
+                           const index_type* cols,
+                           const real_type* vals);
+      void analyzeLevels(index_type n, const index_type* rows, const index_type* cols);
+
+      MatrixStructure structure_;
+  };
+}
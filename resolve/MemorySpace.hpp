@@ -0,0 +1,16 @@
+/**
+ * @file MemorySpace.hpp
+ * @brief Memory space, copy direction and device type identifiers.
+ *
+ */
+#pragma once
+
+namespace ReSolve
+{
+  namespace memory
+  {
+    enum MemorySpace{HOST = 0, DEVICE};
+    enum MemoryDirection{HOST_TO_HOST = 0, HOST_TO_DEVICE, DEVICE_TO_HOST, DEVICE_TO_DEVICE};
+    enum DeviceType{NONE = 0, CUDADEVICE, HIPDEVICE};
+  }
+}
@@ -1,18 +1,9 @@
 #pragma once
 
 #include <resolve/resolve_defs.hpp>
+#include <resolve/MemorySpace.hpp>
 #include <cstring> // <- declares `memcpy`
 
-namespace ReSolve
-{
-  namespace memory
-  {
-    enum MemorySpace{HOST = 0, DEVICE};
-    enum MemoryDirection{HOST_TO_HOST = 0, HOST_TO_DEVICE, DEVICE_TO_HOST, DEVICE_TO_DEVICE};
-    enum DeviceType{NONE = 0, CUDADEVICE, HIPDEVICE};
-  }
-}
-
 namespace ReSolve
 {
   /**
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <resolve/utilities/memory/MemoryTracker.hpp>
 
 namespace ReSolve
 {
@@ -27,6 +28,7 @@ namespace ReSolve
     template <class Policy>
     int MemoryUtils<Policy>::deleteOnDevice(void* v)
     {
+      memory::MemoryTracker::removeDeviceArray(v);
       return Policy::deleteOnDevice(v);
     }
     
@@ -34,14 +36,22 @@ namespace ReSolve
     template <typename I, typename T>
     int MemoryUtils<Policy>::allocateArrayOnDevice(T** v, I n)
     {
-      return Policy::template allocateArrayOnDevice<I, T>(v, n);
+      int status = Policy::template allocateArrayOnDevice<I, T>(v, n);
+      if (status == 0) {
+        memory::MemoryTracker::addDeviceArray(*v, sizeof(T) * static_cast<std::size_t>(n));
+      }
+      return status;
     }
     
     template <class Policy>
     template <typename I, typename T>
     int MemoryUtils<Policy>::allocateBufferOnDevice(T** v, I n)
     {
-      return Policy::template allocateBufferOnDevice<I, T>(v, n);
+      int status = Policy::template allocateBufferOnDevice<I, T>(v, n);
+      if (status == 0) {
+        memory::MemoryTracker::addDeviceArray(*v, static_cast<std::size_t>(n));
+      }
+      return status;
     }
     
     template <class Policy>
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <resolve/resolve_defs.hpp>
+
 #ifdef RESOLVE_USE_PROFILING
 
 #ifdef RESOLVE_USE_HIP
@@ -7,12 +9,47 @@
 #define RESOLVE_RANGE_PUSH(x) roctxRangePush(x)
 #define RESOLVE_RANGE_POP(x) 	roctxRangePop(); \
 	                            roctxMarkA(x)
+#else
+// Host tracer, see resolve/utilities/trace/Tracer.hpp
+#include <resolve/utilities/trace/Tracer.hpp>
+#define RESOLVE_RANGE_PUSH(x) ::ReSolve::trace::Tracer::begin(x)
+#define RESOLVE_RANGE_POP(x)  ::ReSolve::trace::Tracer::end(x)
 #endif
 
+namespace ReSolve
+{
+  namespace trace
+  {
+    /// Range that ends when the object goes out of scope.
+    class ScopedRange
+    {
+      public:
+        explicit ScopedRange(const char* name) : name_(name)
+        {
+          RESOLVE_RANGE_PUSH(name_);
+        }
+
+        ~ScopedRange()
+        {
+          RESOLVE_RANGE_POP(name_);
+        }
+
+      private:
+        const char* name_;
+    };
+  } // namespace trace
+} // namespace ReSolve
+
+#define RESOLVE_RANGE_CONCAT_(a, b) a##b
+#define RESOLVE_RANGE_CONCAT(a, b) RESOLVE_RANGE_CONCAT_(a, b)
+#define RESOLVE_RANGE_SCOPE(x) \
+  ::ReSolve::trace::ScopedRange RESOLVE_RANGE_CONCAT(resolve_range_, __LINE__)(x)
+
 #else
 
 // Not using profiling
 #define RESOLVE_RANGE_PUSH(x)
 #define RESOLVE_RANGE_POP(x)
+#define RESOLVE_RANGE_SCOPE(x)
 
 #endif // RESOLVE_USE_PROFILING
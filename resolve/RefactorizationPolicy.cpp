@@ -0,0 +1,223 @@
+/**
+ * @file RefactorizationPolicy.cpp
+ * @brief Implementation of policy deciding how to update factors.
+ *
+ */
+#include "RefactorizationPolicy.hpp"
+
+namespace ReSolve
+{
+  RefactorizationPolicy::RefactorizationPolicy()
+  {
+  }
+
+  /**
+   * @brief Sets tolerance for scaled residual norm of an accepted solution.
+   */
+  void RefactorizationPolicy::setResidualTolerance(real_type tol)
+  {
+    residual_tol_ = tol;
+  }
+
+  /**
+   * @brief Sets number of Krylov iterations above which reused factors are
+   * replaced by refactorization.
+   */
+  void RefactorizationPolicy::setMaxIterations(index_type max_iter)
+  {
+    max_iter_ = max_iter;
+  }
+
+  /**
+   * @brief Sets allowed decrease of reciprocal condition number estimate,
+   * relative to the last full factorization, before the matrix is
+   * factorized with pivoting again.
+   */
+  void RefactorizationPolicy::setConditionGrowthLimit(real_type limit)
+  {
+    rcond_growth_limit_ = limit;
+  }
+
+  /**
+   * @brief Sets maximum number of consecutive systems solved with reused
+   * factors.
+   */
+  void RefactorizationPolicy::setMaxReuses(index_type max_reuses)
+  {
+    max_reuses_ = max_reuses;
+  }
+
+  /**
+   * @brief Enables or disables reuse of factors, which requires a Krylov
+   * solver preconditioned with the factors.
+   */
+  void RefactorizationPolicy::setReuseAllowed(bool allowed)
+  {
+    reuse_allowed_ = allowed;
+  }
+
+  /**
+   * @brief Enables or disables comparison of reuse and refactorization
+   * times. When disabled, factors are reused until the iteration or reuse
+   * limit is exceeded.
+   */
+  void RefactorizationPolicy::setCostModelEnabled(bool enabled)
+  {
+    use_cost_model_ = enabled;
+  }
+
+  real_type RefactorizationPolicy::getResidualTolerance() const
+  {
+    return residual_tol_;
+  }
+
+  index_type RefactorizationPolicy::getMaxIterations() const
+  {
+    return max_iter_;
+  }
+
+  real_type RefactorizationPolicy::getConditionGrowthLimit() const
+  {
+    return rcond_growth_limit_;
+  }
+
+  index_type RefactorizationPolicy::getMaxReuses() const
+  {
+    return max_reuses_;
+  }
+
+  bool RefactorizationPolicy::isReuseAllowed() const
+  {
+    return reuse_allowed_;
+  }
+
+  bool RefactorizationPolicy::isCostModelEnabled() const
+  {
+    return use_cost_model_;
+  }
+
+  /**
+   * @brief Returns action to take for the next system.
+   *
+   * If the last step failed, the returned action is stronger than the one
+   * taken in that step, so the step can be repeated.
+   */
+  RefactorizationPolicy::Action RefactorizationPolicy::nextAction() const
+  {
+    if (!has_factors_ || needs_factorization_) {
+      return factorize;
+    }
+
+    if (escalate_) {
+      return (last_action_ == reuse) ? refactorize : factorize;
+    }
+
+    if (reuse_allowed_ &&
+        (num_consecutive_reuses_ < max_reuses_) &&
+        (last_num_iter_ <= max_iter_)) {
+      // Keep reusing factors while it is cheaper than refactorization
+      bool is_cost_known = (last_reuse_time_ >= 0.0) && (refactor_time_ >= 0.0);
+      real_type direct_solve_time = (direct_solve_time_ > 0.0) ? direct_solve_time_ : 0.0;
+      if (!use_cost_model_ || !is_cost_known || (last_reuse_time_ <= refactor_time_ + direct_solve_time)) {
+        return reuse;
+      }
+    }
+
+    return refactorize;
+  }
+
+  /**
+   * @brief Records outcome of a step.
+   *
+   * @param[in] action     - action taken in the step
+   * @param[in] residual   - scaled residual norm of the computed solution
+   * @param[in] num_iter   - number of Krylov iterations, 0 for direct solve
+   * @param[in] rcond      - reciprocal condition number estimate of the new
+   *                         factors, negative if not available
+   * @param[in] setup_time - time to compute factors in seconds
+   * @param[in] solve_time - time to solve the system in seconds
+   *
+   * @return true if the solution is accepted, false if the step should be
+   * repeated with the action returned by nextAction()
+   */
+  bool RefactorizationPolicy::update(Action action,
+                                     real_type residual,
+                                     index_type num_iter,
+                                     real_type rcond,
+                                     real_type setup_time,
+                                     real_type solve_time)
+  {
+    if (escalate_) {
+      stats_.num_escalations++;
+    }
+
+    switch (action) {
+      case factorize:
+        stats_.num_factorizations++;
+        has_factors_ = true;
+        needs_factorization_ = false;
+        reference_rcond_ = rcond;
+        num_consecutive_reuses_ = 0;
+        last_num_iter_ = 0;
+        average(direct_solve_time_, solve_time);
+        break;
+      case refactorize:
+        stats_.num_refactorizations++;
+        num_consecutive_reuses_ = 0;
+        last_num_iter_ = 0;
+        average(refactor_time_, setup_time);
+        average(direct_solve_time_, solve_time);
+        if ((rcond > 0.0) && (reference_rcond_ > 0.0) &&
+            (rcond * rcond_growth_limit_ < reference_rcond_)) {
+          needs_factorization_ = true;
+        }
+        break;
+      case reuse:
+        stats_.num_reuses++;
+        num_consecutive_reuses_++;
+        last_num_iter_ = num_iter;
+        last_reuse_time_ = solve_time;
+        break;
+    }
+
+    // Comparison fails for NaN residual as well
+    bool accepted = (residual <= residual_tol_);
+    escalate_ = !accepted;
+    last_action_ = action;
+
+    return accepted;
+  }
+
+  /**
+   * @brief Forgets factors and timing history. Parameters and statistics
+   * are kept.
+   */
+  void RefactorizationPolicy::reset()
+  {
+    has_factors_ = false;
+    escalate_ = false;
+    needs_factorization_ = false;
+    last_action_ = factorize;
+    num_consecutive_reuses_ = 0;
+    last_num_iter_ = 0;
+    reference_rcond_ = -1.0;
+    refactor_time_ = -1.0;
+    direct_solve_time_ = -1.0;
+    last_reuse_time_ = -1.0;
+  }
+
+  const RefactorizationPolicy::Statistics& RefactorizationPolicy::getStatistics() const
+  {
+    return stats_;
+  }
+
+  //
+  // Private methods
+  //
+
+  /// Exponential moving average with weight 1/2, initialized by the first value.
+  void RefactorizationPolicy::average(real_type& avg, real_type value)
+  {
+    avg = (avg < 0.0) ? value : 0.5 * (avg + value);
+  }
+}
@@ -0,0 +1,101 @@
+/**
+ * @file RefactorizationPolicy.hpp
+ * @brief Policy deciding how to update factors in a sequence of systems.
+ *
+ */
+#pragma once
+
+#include "Common.hpp"
+
+namespace ReSolve
+{
+  /**
+   * @brief Chooses between full factorization, numerical refactorization and
+   * reuse of existing factors for each system in a sequence of systems with
+   * the same sparsity pattern, such as linear systems in Newton iterations.
+   *
+   * The policy is updated after each solve with the observed quality of the
+   * solution and the cost of the step:
+   *  - Scaled residual norm above tolerance means the step failed, and the
+   *    next action escalates: reuse -> refactorization -> factorization.
+   *  - Reciprocal condition number estimate, e.g. min |U_ii| / max |U_ii|,
+   *    dropping by more than the growth limit relative to the last full
+   *    factorization means refactorization without pivoting has become
+   *    unstable, so the next action is full factorization.
+   *  - Reused factors are kept while the Krylov solver converges within the
+   *    iteration limit, the number of consecutive reuses is within its limit,
+   *    and the time of the last reuse solve does not exceed the time of
+   *    refactorization followed by a direct solve. With the cost model
+   *    disabled, reused factors are kept regardless of measured times.
+   */
+  class RefactorizationPolicy
+  {
+    public:
+      /// Ways to obtain factors for the next system.
+      enum Action {factorize = 0, refactorize, reuse};
+
+      /// Number of times each action has been taken.
+      struct Statistics
+      {
+        index_type num_factorizations{0};
+        index_type num_refactorizations{0};
+        index_type num_reuses{0};
+        index_type num_escalations{0};  ///< steps repeated with a stronger action
+      };
+
+      RefactorizationPolicy();
+      ~RefactorizationPolicy() = default;
+
+      void setResidualTolerance(real_type tol);
+      void setMaxIterations(index_type max_iter);
+      void setConditionGrowthLimit(real_type limit);
+      void setMaxReuses(index_type max_reuses);
+      void setReuseAllowed(bool allowed);
+      void setCostModelEnabled(bool enabled);
+
+      real_type getResidualTolerance() const;
+      index_type getMaxIterations() const;
+      real_type getConditionGrowthLimit() const;
+      index_type getMaxReuses() const;
+      bool isReuseAllowed() const;
+      bool isCostModelEnabled() const;
+
+      Action nextAction() const;
+      bool update(Action action,
+                  real_type residual,
+                  index_type num_iter,
+                  real_type rcond,
+                  real_type setup_time,
+                  real_type solve_time);
+      void reset();
+
+      const Statistics& getStatistics() const;
+
+    private:
+      static void average(real_type& avg, real_type value);
+
+      // Parameters
+      real_type  residual_tol_{1e-10};
+      index_type max_iter_{20};
+      real_type  rcond_growth_limit_{1e3};
+      index_type max_reuses_{10};
+      bool       reuse_allowed_{false};
+      bool       use_cost_model_{true};
+
+      // State
+      bool has_factors_{false};
+      bool escalate_{false};         ///< last step failed
+      bool needs_factorization_{false};
+      Action last_action_{factorize};
+      index_type num_consecutive_reuses_{0};
+      index_type last_num_iter_{0};
+      real_type reference_rcond_{-1.0}; ///< rcond at the last full factorization
+
+      // Cost model, exponential moving averages of measured times
+      real_type refactor_time_{-1.0};
+      real_type direct_solve_time_{-1.0};
+      real_type last_reuse_time_{-1.0};
+
+      Statistics stats_;
+  };
+}
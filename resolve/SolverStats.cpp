@@ -0,0 +1,119 @@
+/**
+ * @file SolverStats.cpp
+ * @brief Implementation of per-phase performance counters.
+ *
+ */
+#include "SolverStats.hpp"
+
+namespace ReSolve
+{
+  /**
+   * @brief Starts timing a call of `phase`.
+   *
+   * @param[in] stats - counters to update when the timer is destroyed
+   * @param[in] phase - measured phase
+   */
+  SolverStats::Timer::Timer(SolverStats& stats, Phase phase)
+    : stats_(stats),
+      phase_(phase),
+      start_(std::chrono::steady_clock::now())
+  {
+  }
+
+  SolverStats::Timer::~Timer()
+  {
+    std::chrono::duration<real_type> elapsed = std::chrono::steady_clock::now() - start_;
+    stats_.add(phase_, elapsed.count(), flops_, bytes_);
+  }
+
+  /**
+   * @brief Adds estimated work to the measured call.
+   *
+   * @param[in] flops - floating point operations
+   * @param[in] bytes - bytes moved to or from memory
+   */
+  void SolverStats::Timer::addWork(real_type flops, real_type bytes)
+  {
+    flops_ += flops;
+    bytes_ += bytes;
+  }
+
+  SolverStats::SolverStats()
+  {
+  }
+
+  /**
+   * @brief Records one call of a phase.
+   *
+   * @param[in] phase - phase of the solver
+   * @param[in] time  - time of the call in seconds
+   * @param[in] flops - estimated floating point operations
+   * @param[in] bytes - estimated bytes moved to or from memory
+   */
+  void SolverStats::add(Phase phase, real_type time, real_type flops, real_type bytes)
+  {
+    Counters& counters = counters_[phase];
+    counters.num_calls++;
+    counters.time  += time;
+    counters.flops += flops;
+    counters.bytes += bytes;
+  }
+
+  /// Sets all counters to zero.
+  void SolverStats::reset()
+  {
+    for (Counters& counters : counters_) {
+      counters = Counters();
+    }
+  }
+
+  const SolverStats::Counters& SolverStats::get(Phase phase) const
+  {
+    return counters_[phase];
+  }
+
+  std::uint64_t SolverStats::getNumCalls(Phase phase) const
+  {
+    return counters_[phase].num_calls;
+  }
+
+  real_type SolverStats::getTime(Phase phase) const
+  {
+    return counters_[phase].time;
+  }
+
+  real_type SolverStats::getFlops(Phase phase) const
+  {
+    return counters_[phase].flops;
+  }
+
+  real_type SolverStats::getBytes(Phase phase) const
+  {
+    return counters_[phase].bytes;
+  }
+
+  /// Name of the phase, e.g. for exporting counters.
+  const char* SolverStats::getPhaseName(Phase phase)
+  {
+    switch (phase) {
+      case analyze:
+        return "analyze";
+      case factorize:
+        return "factorize";
+      case refactorize:
+        return "refactorize";
+      case solve:
+        return "solve";
+      case precondition:
+        return "precondition";
+      case matvec:
+        return "matvec";
+      case orthogonalize:
+        return "orthogonalize";
+      case sketch:
+        return "sketch";
+      default:
+        return "unknown";
+    }
+  }
+}
@@ -0,0 +1,87 @@
+/**
+ * @file SolverStats.hpp
+ * @brief Per-phase performance counters of linear solvers.
+ *
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "Common.hpp"
+
+namespace ReSolve
+{
+  /**
+   * @brief Call counts, times and work estimates for phases of a solver.
+   *
+   * Times are measured with a monotonic clock and are inclusive, e.g. the
+   * solve time of an iterative solver includes time of its matrix-vector
+   * products. Counters of a SystemSolver and of the solvers it owns are
+   * kept separately, so they should not be summed.
+   *
+   * Floating point operation and byte counts are estimates of the work
+   * needed by the algorithm, not measurements. They are zero for phases
+   * where the solver cannot estimate them cheaply.
+   */
+  class SolverStats
+  {
+    public:
+      /// Solver phases with separate counters.
+      enum Phase {analyze = 0,
+                  factorize,
+                  refactorize,
+                  solve,
+                  precondition,
+                  matvec,
+                  orthogonalize,
+                  sketch,
+                  NUM_PHASES};
+
+      /// Counters of one phase.
+      struct Counters
+      {
+        std::uint64_t num_calls{0};
+        real_type time{0.0};  ///< seconds
+        real_type flops{0.0}; ///< estimated floating point operations
+        real_type bytes{0.0}; ///< estimated bytes moved to or from memory
+      };
+
+      /**
+       * @brief Measures one call of a phase from construction until the
+       * timer goes out of scope.
+       */
+      class Timer
+      {
+        public:
+          Timer(SolverStats& stats, Phase phase);
+          ~Timer();
+
+          void addWork(real_type flops, real_type bytes);
+
+        private:
+          SolverStats& stats_;
+          Phase phase_;
+          std::chrono::steady_clock::time_point start_;
+          real_type flops_{0.0};
+          real_type bytes_{0.0};
+      };
+
+      SolverStats();
+      ~SolverStats() = default;
+
+      void add(Phase phase, real_type time, real_type flops = 0.0, real_type bytes = 0.0);
+      void reset();
+
+      const Counters& get(Phase phase) const;
+      std::uint64_t getNumCalls(Phase phase) const;
+      real_type getTime(Phase phase) const;
+      real_type getFlops(Phase phase) const;
+      real_type getBytes(Phase phase) const;
+
+      static const char* getPhaseName(Phase phase);
+
+    private:
+      Counters counters_[NUM_PHASES];
+  };
+}
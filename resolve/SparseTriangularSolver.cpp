@@ -0,0 +1,403 @@
+/**
+ * @file SparseTriangularSolver.cpp
+ * @brief Implementation of triangular solves with sparse right-hand sides.
+ *
+ */
+#include <algorithm>
+
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/matrix/Csc.hpp>
+#include <resolve/utilities/logger/Logger.hpp>
+#include "SparseTriangularSolver.hpp"
+
+namespace ReSolve
+{
+  using out = io::Logger;
+
+  /**
+   * @brief Sets factor data and allocates work arrays.
+   *
+   * @param[in] n             - size of the triangular matrix
+   * @param[in] ptr           - column pointers (CSC) or row pointers (CSR)
+   * @param[in] idx           - row indices (CSC) or column indices (CSR)
+   * @param[in] vals          - factor values
+   * @param[in] storage       - `csc` or `csr`
+   * @param[in] unit_diagonal - if true, diagonal is one and stored diagonal
+   *                            elements, if any, are ignored
+   *
+   * @pre Row or column indices need not be sorted.
+   *
+   * @return int - 0 if successful, 1 if a nonunit factor misses diagonal
+   */
+  int SparseTriangularSolver::setup(index_type n,
+                                    const index_type* ptr,
+                                    const index_type* idx,
+                                    const real_type* vals,
+                                    StorageType storage,
+                                    bool unit_diagonal)
+  {
+    n_ = n;
+    unit_diagonal_ = unit_diagonal;
+    values_ = vals;
+    value_map_.clear();
+    rowptr_own_.clear();
+    colidx_own_.clear();
+
+    if (storage == csc) {
+      colptr_ = ptr;
+      rowidx_ = idx;
+      rowptr_ = nullptr;
+      colidx_ = nullptr;
+    } else {
+      // Transpose pattern and keep track of where the values are
+      const index_type nnz = ptr[n];
+      colptr_own_.assign(static_cast<size_t>(n) + 1, 0);
+      rowidx_own_.resize(static_cast<size_t>(nnz));
+      value_map_.resize(static_cast<size_t>(nnz));
+      for (index_type p = 0; p < nnz; ++p) {
+        colptr_own_[idx[p] + 1]++;
+      }
+      for (index_type j = 0; j < n; ++j) {
+        colptr_own_[j + 1] += colptr_own_[j];
+      }
+      std::vector<index_type> next(colptr_own_.begin(), colptr_own_.end() - 1);
+      for (index_type i = 0; i < n; ++i) {
+        for (index_type p = ptr[i]; p < ptr[i + 1]; ++p) {
+          const index_type q = next[idx[p]]++;
+          rowidx_own_[q] = i;
+          value_map_[q]  = p;
+        }
+      }
+      colptr_ = colptr_own_.data();
+      rowidx_ = rowidx_own_.data();
+      rowptr_ = ptr;
+      colidx_ = idx;
+    }
+
+    diag_.assign(static_cast<size_t>(n), -1);
+    for (index_type j = 0; j < n; ++j) {
+      for (index_type p = colptr_[j]; p < colptr_[j + 1]; ++p) {
+        if (rowidx_[p] == j) {
+          diag_[j] = p;
+        }
+      }
+      if (!unit_diagonal_ && diag_[j] < 0) {
+        out::error() << "SparseTriangularSolver: missing diagonal element in column " << j << "\n";
+        return 1;
+      }
+    }
+
+    visited_.assign(static_cast<size_t>(n), 0);
+    required_.assign(static_cast<size_t>(n), 0);
+    stack_.resize(static_cast<size_t>(n));
+    pos_.resize(static_cast<size_t>(n));
+    order_.resize(static_cast<size_t>(n));
+    visit_stamp_ = 0;
+    required_stamp_ = 0;
+    use_required_ = false;
+
+    return 0;
+  }
+
+  /**
+   * @brief Marks solution entries needed by the caller.
+   *
+   * Entry x[i] depends on x[j] if T(i, j) is nonzero, so the required set
+   * is closed under this relation. Subsequent solves compute only required
+   * entries of the solution.
+   *
+   * @param[in] num - number of requested entries
+   * @param[in] idx - indices of requested entries
+   *
+   * @return index_type - number of entries in the closed required set
+   */
+  index_type SparseTriangularSolver::markRequired(index_type num, const index_type* idx)
+  {
+    if (rowptr_ == nullptr) {
+      buildRowPattern();
+    }
+
+    if (++required_stamp_ == 0) {
+      std::fill(required_.begin(), required_.end(), 0);
+      required_stamp_ = 1;
+    }
+    required_list_.clear();
+    for (index_type k = 0; k < num; ++k) {
+      if (required_[idx[k]] != required_stamp_) {
+        required_[idx[k]] = required_stamp_;
+        required_list_.push_back(idx[k]);
+      }
+    }
+    for (size_t k = 0; k < required_list_.size(); ++k) {
+      const index_type i = required_list_[k];
+      for (index_type p = rowptr_[i]; p < rowptr_[i + 1]; ++p) {
+        const index_type j = colidx_[p];
+        if (required_[j] != required_stamp_) {
+          required_[j] = required_stamp_;
+          required_list_.push_back(j);
+        }
+      }
+    }
+    use_required_ = true;
+
+    return static_cast<index_type>(required_list_.size());
+  }
+
+  /// Compute all reachable solution entries in subsequent solves.
+  void SparseTriangularSolver::clearRequired()
+  {
+    use_required_ = false;
+    required_list_.clear();
+  }
+
+  /// Entries marked by the last call to markRequired.
+  const std::vector<index_type>& SparseTriangularSolver::getRequired() const
+  {
+    return required_list_;
+  }
+
+  /**
+   * @brief Solves T x = b in place.
+   *
+   * @param[in]     nnz     - number of nonzeros in b
+   * @param[in,out] pattern - on input indices of nonzeros in b, on output
+   *                          indices of computed entries of x in the order
+   *                          they were computed; must have capacity n
+   * @param[in,out] x       - dense vector holding b on input and x on output
+   *
+   * @pre x is zero outside of the input pattern.
+   * @post Only entries of x listed in the output pattern are modified.
+   *
+   * @return index_type - number of entries in the output pattern
+   */
+  index_type SparseTriangularSolver::solve(index_type nnz, index_type* pattern, real_type* x)
+  {
+    const index_type top = reach(nnz, pattern);
+
+    for (index_type k = top; k < n_; ++k) {
+      const index_type j = order_[k];
+      if (!unit_diagonal_) {
+        const index_type d = diag_[j];
+        x[j] /= value_map_.empty() ? values_[d] : values_[value_map_[d]];
+      }
+      const real_type xj = x[j];
+      if (xj == 0.0) {
+        continue;
+      }
+      for (index_type p = colptr_[j]; p < colptr_[j + 1]; ++p) {
+        const index_type i = rowidx_[p];
+        // Entries outside of the required set are not reached, so they
+        // must not be touched to keep x zero outside of the pattern.
+        if (i != j && isRequired(i)) {
+          x[i] -= (value_map_.empty() ? values_[p] : values_[value_map_[p]]) * xj;
+        }
+      }
+    }
+
+    std::copy(order_.begin() + top, order_.end(), pattern);
+    return n_ - top;
+  }
+
+  //
+  // Private methods
+  //
+
+  void SparseTriangularSolver::buildRowPattern()
+  {
+    const index_type nnz = colptr_[n_];
+    rowptr_own_.assign(static_cast<size_t>(n_) + 1, 0);
+    colidx_own_.resize(static_cast<size_t>(nnz));
+    for (index_type p = 0; p < nnz; ++p) {
+      rowptr_own_[rowidx_[p] + 1]++;
+    }
+    for (index_type i = 0; i < n_; ++i) {
+      rowptr_own_[i + 1] += rowptr_own_[i];
+    }
+    std::vector<index_type> next(rowptr_own_.begin(), rowptr_own_.end() - 1);
+    for (index_type j = 0; j < n_; ++j) {
+      for (index_type p = colptr_[j]; p < colptr_[j + 1]; ++p) {
+        colidx_own_[next[rowidx_[p]]++] = j;
+      }
+    }
+    rowptr_ = rowptr_own_.data();
+    colidx_ = colidx_own_.data();
+  }
+
+  bool SparseTriangularSolver::isRequired(index_type j) const
+  {
+    return !use_required_ || (required_[j] == required_stamp_);
+  }
+
+  /**
+   * @brief Depth-first search from the right-hand side pattern.
+   *
+   * Reached nodes are stored in `order_[top:n)` in topological order.
+   *
+   * @return index_type - start of the reached set in `order_`
+   */
+  index_type SparseTriangularSolver::reach(index_type nnz, const index_type* pattern)
+  {
+    if (++visit_stamp_ == 0) {
+      std::fill(visited_.begin(), visited_.end(), 0);
+      visit_stamp_ = 1;
+    }
+
+    index_type top = n_;
+    for (index_type k = 0; k < nnz; ++k) {
+      const index_type root = pattern[k];
+      if (visited_[root] == visit_stamp_ || !isRequired(root)) {
+        continue;
+      }
+      index_type head = 0;
+      stack_[0] = root;
+      while (head >= 0) {
+        const index_type j = stack_[head];
+        if (visited_[j] != visit_stamp_) {
+          visited_[j] = visit_stamp_;
+          pos_[j] = colptr_[j];
+        }
+        bool done = true;
+        for (index_type p = pos_[j]; p < colptr_[j + 1]; ++p) {
+          const index_type i = rowidx_[p];
+          if (i == j || visited_[i] == visit_stamp_ || !isRequired(i)) {
+            continue;
+          }
+          pos_[j] = p + 1;
+          stack_[++head] = i;
+          done = false;
+          break;
+        }
+        if (done) {
+          --head;
+          order_[--top] = j;
+        }
+      }
+    }
+    return top;
+  }
+
+  //
+  // Sparse LU solver
+  //
+
+  /**
+   * @brief Sets up triangular solvers for factors L and U.
+   *
+   * @param[in] L - unit lower triangular factor in CSC or CSR format
+   * @param[in] U - upper triangular factor in CSC or CSR format
+   * @param[in] P - row permutation (optional)
+   * @param[in] Q - column permutation (optional)
+   *
+   * @return int - 0 if successful, 1 otherwise
+   */
+  int SparseLUSolver::setup(matrix::Sparse* L,
+                            matrix::Sparse* U,
+                            const index_type* P,
+                            const index_type* Q)
+  {
+    if (L == nullptr || U == nullptr) {
+      out::error() << "SparseLUSolver: factors are not available.\n";
+      return 1;
+    }
+
+    n_ = L->getNumRows();
+    int status = 0;
+    matrix::Sparse* factors[2] = {L, U};
+    SparseTriangularSolver* solvers[2] = {&lower_, &upper_};
+    for (int f = 0; f < 2; ++f) {
+      if (dynamic_cast<matrix::Csc*>(factors[f]) != nullptr) {
+        status += solvers[f]->setup(n_,
+                                    factors[f]->getColData(memory::HOST),
+                                    factors[f]->getRowData(memory::HOST),
+                                    factors[f]->getValues( memory::HOST),
+                                    SparseTriangularSolver::csc,
+                                    f == 0);
+      } else if (dynamic_cast<matrix::Csr*>(factors[f]) != nullptr) {
+        status += solvers[f]->setup(n_,
+                                    factors[f]->getRowData(memory::HOST),
+                                    factors[f]->getColData(memory::HOST),
+                                    factors[f]->getValues( memory::HOST),
+                                    SparseTriangularSolver::csr,
+                                    f == 0);
+      } else {
+        out::error() << "SparseLUSolver: factors must be in CSC or CSR format.\n";
+        return 1;
+      }
+    }
+
+    Pinv_.resize(static_cast<size_t>(n_));
+    Qinv_.resize(static_cast<size_t>(n_));
+    for (index_type k = 0; k < n_; ++k) {
+      Pinv_[P ? P[k] : k] = k;
+      Qinv_[Q ? Q[k] : k] = k;
+    }
+
+    pattern_.resize(static_cast<size_t>(n_));
+    pattern_lower_.resize(static_cast<size_t>(n_));
+    work_.assign(static_cast<size_t>(n_), 0.0);
+
+    return status;
+  }
+
+  /**
+   * @brief Computes selected entries of solution for a sparse right-hand side.
+   *
+   * @param[in]  nnz_rhs - number of nonzeros in the right-hand side
+   * @param[in]  rhs_idx - indices of right-hand side nonzeros
+   * @param[in]  rhs_val - values of right-hand side nonzeros
+   * @param[in]  num_sol - number of requested solution entries
+   * @param[in]  sol_idx - indices of requested solution entries
+   * @param[out] sol_val - values of requested solution entries
+   *
+   * @return int - 0 if successful
+   */
+  int SparseLUSolver::solve(index_type nnz_rhs,
+                            const index_type* rhs_idx,
+                            const real_type* rhs_val,
+                            index_type num_sol,
+                            const index_type* sol_idx,
+                            real_type* sol_val)
+  {
+    if (nnz_rhs > n_) {
+      out::error() << "SparseLUSolver: right-hand side has more than n nonzeros.\n";
+      return 1;
+    }
+
+    real_type* y = work_.data();
+    for (index_type k = 0; k < nnz_rhs; ++k) {
+      const index_type i = Pinv_[rhs_idx[k]];
+      y[i] += rhs_val[k];
+      pattern_[k] = i;
+    }
+
+    // Only entries contributing to the requested solution entries are needed
+    seeds_.resize(static_cast<size_t>(num_sol));
+    for (index_type k = 0; k < num_sol; ++k) {
+      seeds_[k] = Qinv_[sol_idx[k]];
+    }
+    upper_.markRequired(num_sol, seeds_.data());
+    const std::vector<index_type>& required = upper_.getRequired();
+    lower_.markRequired(static_cast<index_type>(required.size()), required.data());
+
+    const index_type nnz_lower = lower_.solve(nnz_rhs, pattern_.data(), y);
+    std::copy(pattern_.begin(), pattern_.begin() + nnz_lower, pattern_lower_.begin());
+    const index_type nnz_upper = upper_.solve(nnz_lower, pattern_.data(), y);
+
+    for (index_type k = 0; k < num_sol; ++k) {
+      sol_val[k] = y[seeds_[k]];
+    }
+
+    // Restore the work vector to zero
+    for (index_type k = 0; k < nnz_rhs; ++k) {
+      y[Pinv_[rhs_idx[k]]] = 0.0;
+    }
+    for (index_type k = 0; k < nnz_lower; ++k) {
+      y[pattern_lower_[k]] = 0.0;
+    }
+    for (index_type k = 0; k < nnz_upper; ++k) {
+      y[pattern_[k]] = 0.0;
+    }
+
+    return 0;
+  }
+}
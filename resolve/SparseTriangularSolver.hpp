@@ -0,0 +1,129 @@
+/**
+ * @file SparseTriangularSolver.hpp
+ * @brief Triangular solves with sparse right-hand sides on CPU.
+ *
+ */
+#pragma once
+#include <vector>
+
+#include "Common.hpp"
+
+namespace ReSolve
+{
+  // Forward declaration of matrix::Sparse class
+  namespace matrix
+  {
+    class Sparse;
+  }
+
+  /**
+   * @brief Gilbert-Peierls triangular solve with a sparse right-hand side.
+   *
+   * Nonzero pattern of the solution of T x = b is the set of nodes
+   * reachable from the nonzero pattern of b in the graph of T, where there
+   * is an edge j -> i for each nonzero T(i, j), i != j. The solver finds
+   * the reachable set by depth-first search and processes only reached
+   * columns in topological order, so the cost is proportional to the
+   * number of floating point operations, not to the size of T.
+   *
+   * Optionally, a set of required solution entries can be marked. Then only
+   * columns that contribute to the required entries are processed.
+   *
+   * Factor data is not copied. Values are read at each solve, so the
+   * factor values can be updated in place without calling setup again.
+   */
+  class SparseTriangularSolver
+  {
+    public:
+      enum StorageType {csc = 0, csr};
+
+      SparseTriangularSolver() = default;
+      ~SparseTriangularSolver() = default;
+
+      int setup(index_type n,
+                const index_type* ptr,
+                const index_type* idx,
+                const real_type* vals,
+                StorageType storage,
+                bool unit_diagonal);
+
+      index_type markRequired(index_type num, const index_type* idx);
+      void clearRequired();
+      const std::vector<index_type>& getRequired() const;
+
+      index_type solve(index_type nnz, index_type* pattern, real_type* x);
+
+    private:
+      void buildRowPattern();
+      bool isRequired(index_type j) const;
+      index_type reach(index_type nnz, const index_type* pattern);
+
+      index_type n_{0};
+      bool unit_diagonal_{false};
+
+      // Column view of the factor used in the solve
+      const index_type* colptr_{nullptr};
+      const index_type* rowidx_{nullptr};
+      const real_type*  values_{nullptr};
+      std::vector<index_type> colptr_own_;  ///< transposed pattern if factor is in CSR
+      std::vector<index_type> rowidx_own_;
+      std::vector<index_type> value_map_;   ///< positions of column view values in `values_`
+      std::vector<index_type> diag_;        ///< position of diagonal element in each column
+
+      // Row view of the factor pattern used to find required entries
+      const index_type* rowptr_{nullptr};
+      const index_type* colidx_{nullptr};
+      std::vector<index_type> rowptr_own_;
+      std::vector<index_type> colidx_own_;
+
+      // Work arrays
+      std::vector<index_type> visited_;     ///< visit stamps
+      std::vector<index_type> required_;    ///< required entry stamps
+      std::vector<index_type> required_list_;
+      std::vector<index_type> stack_;
+      std::vector<index_type> pos_;
+      std::vector<index_type> order_;
+      index_type visit_stamp_{0};
+      index_type required_stamp_{0};
+      bool use_required_{false};
+  };
+
+  /**
+   * @brief Solves L U y = P b, x(Q) = y with sparse b, returning selected
+   * entries of x.
+   *
+   * Permutations follow KLU convention, i.e. row k of the factored matrix
+   * is row P[k] of the system matrix and x[Q[k]] = y[k]. Null permutations
+   * are treated as identity. Factor L is assumed to have unit diagonal,
+   * whether it is stored or not.
+   */
+  class SparseLUSolver
+  {
+    public:
+      SparseLUSolver() = default;
+      ~SparseLUSolver() = default;
+
+      int setup(matrix::Sparse* L,
+                matrix::Sparse* U,
+                const index_type* P = nullptr,
+                const index_type* Q = nullptr);
+
+      int solve(index_type nnz_rhs,
+                const index_type* rhs_idx,
+                const real_type* rhs_val,
+                index_type num_sol,
+                const index_type* sol_idx,
+                real_type* sol_val);
+
+    private:
+      index_type n_{0};
+      SparseTriangularSolver lower_;
+      SparseTriangularSolver upper_;
+      std::vector<index_type> Pinv_;
+      std::vector<index_type> Qinv_;
+      std::vector<index_type> pattern_;
+      std::vector<index_type> pattern_lower_;
+      std::vector<index_type> seeds_;
+      std::vector<real_type>  work_;
+  };
+}
@@ -0,0 +1,413 @@
+/**
+ * @file SymbolicCache.cpp
+ * @brief Implementation of cache of symbolic analysis results.
+ *
+ */
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <resolve/utilities/logger/Logger.hpp>
+#include "SymbolicCache.hpp"
+
+namespace ReSolve
+{
+  using out = io::Logger;
+
+  namespace
+  {
+    const char CACHE_FILE_MAGIC[4] = {'R', 'S', 'S', 'C'};
+    const std::uint32_t CACHE_FILE_VERSION = 1;
+
+    template <typename T>
+    void writeValue(std::ofstream& file, T value)
+    {
+      file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value)
+    {
+      file.read(reinterpret_cast<char*>(&value), sizeof(T));
+      return static_cast<bool>(file);
+    }
+
+    template <typename T>
+    void writeArray(std::ofstream& file, const std::vector<T>& array)
+    {
+      writeValue(file, static_cast<std::uint64_t>(array.size()));
+      file.write(reinterpret_cast<const char*>(array.data()),
+                 static_cast<std::streamsize>(array.size() * sizeof(T)));
+    }
+
+    template <typename T>
+    bool readArray(std::ifstream& file, std::vector<T>& array)
+    {
+      std::uint64_t size = 0;
+      if (!readValue(file, size)) {
+        return false;
+      }
+      array.resize(static_cast<std::size_t>(size));
+      file.read(reinterpret_cast<char*>(array.data()),
+                static_cast<std::streamsize>(array.size() * sizeof(T)));
+      return static_cast<bool>(file);
+    }
+  }
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] capacity - maximum number of cached entries
+   */
+  SymbolicCache::SymbolicCache(std::size_t capacity)
+    : capacity_(capacity)
+  {
+  }
+
+  /**
+   * @brief Sets maximum number of cached entries, evicting least recently
+   * used entries if there are more.
+   */
+  void SymbolicCache::setCapacity(std::size_t capacity)
+  {
+    capacity_ = capacity;
+    while (entries_.size() > capacity_) {
+      evict();
+    }
+  }
+
+  std::size_t SymbolicCache::getCapacity() const
+  {
+    return capacity_;
+  }
+
+  std::size_t SymbolicCache::size() const
+  {
+    return entries_.size();
+  }
+
+  /**
+   * @brief Removes all entries. Counters are not reset.
+   */
+  void SymbolicCache::clear()
+  {
+    index_.clear();
+    entries_.clear();
+  }
+
+  /**
+   * @brief Looks up an entry for the sparsity pattern and marks it as most
+   * recently used.
+   *
+   * @param[in] tag - solver specific tag
+   * @param[in] n   - number of rows (CSR) or columns (CSC)
+   * @param[in] ptr - row or column pointers, size n + 1
+   * @param[in] idx - column or row indices, size ptr[n]
+   *
+   * @return Entry* - cached entry, or nullptr if there is none
+   */
+  SymbolicCache::Entry* SymbolicCache::find(index_type tag,
+                                            index_type n,
+                                            const index_type* ptr,
+                                            const index_type* idx)
+  {
+    std::uint64_t hash = hashPattern(tag, n, ptr, idx);
+    EntryList::iterator it = findEntry(hash, tag, n, ptr, idx);
+    if (it == entries_.end()) {
+      num_misses_++;
+      return nullptr;
+    }
+
+    num_hits_++;
+    entries_.splice(entries_.begin(), entries_, it);
+    return &entries_.front();
+  }
+
+  /**
+   * @brief Creates an entry for the sparsity pattern as most recently used.
+   *
+   * An existing entry for the same pattern and tag is replaced. If the cache
+   * is full, the least recently used entry is evicted.
+   *
+   * @param[in] tag - solver specific tag
+   * @param[in] n   - number of rows (CSR) or columns (CSC)
+   * @param[in] ptr - row or column pointers, size n + 1
+   * @param[in] idx - column or row indices, size ptr[n]
+   *
+   * @return Entry* - new entry with empty payload, or nullptr if the cache
+   * capacity is zero
+   */
+  SymbolicCache::Entry* SymbolicCache::insert(index_type tag,
+                                              index_type n,
+                                              const index_type* ptr,
+                                              const index_type* idx)
+  {
+    if (capacity_ == 0) {
+      return nullptr;
+    }
+
+    std::uint64_t hash = hashPattern(tag, n, ptr, idx);
+    EntryList::iterator it = findEntry(hash, tag, n, ptr, idx);
+    if (it != entries_.end()) {
+      erase(it);
+    }
+    while (entries_.size() >= capacity_) {
+      evict();
+    }
+
+    entries_.emplace_front();
+    Entry& entry = entries_.front();
+    entry.hash = hash;
+    entry.tag = tag;
+    entry.n = n;
+    entry.ptr.assign(ptr, ptr + n + 1);
+    entry.idx.assign(idx, idx + ptr[n]);
+    index_.emplace(hash, entries_.begin());
+
+    return &entry;
+  }
+
+  /**
+   * @brief Removes the entry for the sparsity pattern, e.g. when its payload
+   * turns out to be invalid.
+   *
+   * @param[in] tag - solver specific tag
+   * @param[in] n   - number of rows (CSR) or columns (CSC)
+   * @param[in] ptr - row or column pointers, size n + 1
+   * @param[in] idx - column or row indices, size ptr[n]
+   *
+   * @return bool - true if an entry was removed
+   */
+  bool SymbolicCache::remove(index_type tag,
+                             index_type n,
+                             const index_type* ptr,
+                             const index_type* idx)
+  {
+    std::uint64_t hash = hashPattern(tag, n, ptr, idx);
+    EntryList::iterator it = findEntry(hash, tag, n, ptr, idx);
+    if (it == entries_.end()) {
+      return false;
+    }
+    erase(it);
+    return true;
+  }
+
+  std::size_t SymbolicCache::getNumHits() const
+  {
+    return num_hits_;
+  }
+
+  std::size_t SymbolicCache::getNumMisses() const
+  {
+    return num_misses_;
+  }
+
+  std::size_t SymbolicCache::getNumEvictions() const
+  {
+    return num_evictions_;
+  }
+
+  void SymbolicCache::resetCounters()
+  {
+    num_hits_ = 0;
+    num_misses_ = 0;
+    num_evictions_ = 0;
+  }
+
+  /**
+   * @brief Writes patterns and payloads of all entries to a binary file.
+   *
+   * The file is only meant to be read on a machine with the same data type
+   * sizes and byte order. In-memory solver objects are not saved.
+   *
+   * @return int - 0 if successful, 1 otherwise
+   */
+  int SymbolicCache::save(const std::string& filename) const
+  {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+      out::error() << "Cannot open symbolic cache file " << filename << " for writing\n";
+      return 1;
+    }
+
+    file.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+    writeValue(file, CACHE_FILE_VERSION);
+    writeValue(file, static_cast<std::uint32_t>(sizeof(index_type)));
+    writeValue(file, static_cast<std::uint32_t>(sizeof(real_type)));
+    writeValue(file, static_cast<std::uint64_t>(entries_.size()));
+
+    for (const Entry& entry : entries_) {
+      writeValue(file, entry.tag);
+      writeValue(file, entry.n);
+      writeArray(file, entry.ptr);
+      writeArray(file, entry.idx);
+      writeArray(file, entry.ints);
+      writeArray(file, entry.reals);
+    }
+
+    if (!file) {
+      out::error() << "Failed writing symbolic cache file " << filename << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Adds entries saved in a file to the cache.
+   *
+   * Entries keep their order of use from the time they were saved. Loaded
+   * entries are less recently used than entries already in the cache.
+   *
+   * @return int - 0 if successful, 1 otherwise
+   */
+  int SymbolicCache::load(const std::string& filename)
+  {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+      out::error() << "Cannot open symbolic cache file " << filename << "\n";
+      return 1;
+    }
+
+    char magic[sizeof(CACHE_FILE_MAGIC)];
+    std::uint32_t version = 0;
+    std::uint32_t index_size = 0;
+    std::uint32_t real_size = 0;
+    std::uint64_t num_entries = 0;
+    file.read(magic, sizeof(magic));
+    if (!file ||
+        std::memcmp(magic, CACHE_FILE_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(file, version) || (version != CACHE_FILE_VERSION) ||
+        !readValue(file, index_size) || (index_size != sizeof(index_type)) ||
+        !readValue(file, real_size) || (real_size != sizeof(real_type)) ||
+        !readValue(file, num_entries)) {
+      out::error() << "File " << filename << " is not a compatible symbolic cache file\n";
+      return 1;
+    }
+
+    EntryList loaded;
+    for (std::uint64_t i = 0; i < num_entries; ++i) {
+      Entry entry;
+      bool ok = readValue(file, entry.tag) &&
+                readValue(file, entry.n) &&
+                readArray(file, entry.ptr) &&
+                readArray(file, entry.idx) &&
+                readArray(file, entry.ints) &&
+                readArray(file, entry.reals);
+      ok = ok && (entry.n >= 0) &&
+           (entry.ptr.size() == static_cast<std::size_t>(entry.n) + 1) &&
+           (entry.idx.size() == static_cast<std::size_t>(entry.ptr.back()));
+      if (!ok) {
+        out::error() << "Corrupted symbolic cache file " << filename << "\n";
+        return 1;
+      }
+      loaded.push_back(std::move(entry));
+    }
+
+    for (Entry& entry : loaded) {
+      if (entries_.size() >= capacity_) {
+        break;
+      }
+      std::uint64_t hash = hashPattern(entry.tag, entry.n, entry.ptr.data(), entry.idx.data());
+      entry.hash = hash;
+      if (findEntry(hash, entry.tag, entry.n, entry.ptr.data(), entry.idx.data()) != entries_.end()) {
+        continue;
+      }
+      entries_.push_back(std::move(entry));
+      index_.emplace(hash, std::prev(entries_.end()));
+    }
+
+    return 0;
+  }
+
+  /**
+   * @brief FNV-1a hash of a sparsity pattern and a solver tag.
+   */
+  std::uint64_t SymbolicCache::hashPattern(index_type tag,
+                                           index_type n,
+                                           const index_type* ptr,
+                                           const index_type* idx)
+  {
+    std::uint64_t hash = HASH_SEED;
+    hash = hashValue(hash, tag);
+    hash = hashValue(hash, n);
+    hash = hashArray(hash, n + 1, ptr);
+    hash = hashArray(hash, ptr[n], idx);
+    return hash;
+  }
+
+  constexpr std::uint64_t SymbolicCache::HASH_SEED;
+
+  /**
+   * @brief Mixes one value into an FNV-1a hash.
+   *
+   * The hash does not depend on the platform or the run, so it can be
+   * used in keys that are saved to disk. Start from ::HASH_SEED.
+   *
+   * @param[in] hash  - hash computed so far
+   * @param[in] value - value to mix in
+   *
+   * @return Updated hash.
+   */
+  std::uint64_t SymbolicCache::hashValue(std::uint64_t hash, index_type value)
+  {
+    hash ^= static_cast<std::uint64_t>(static_cast<std::uint32_t>(value));
+    hash *= 1099511628211ULL;
+    return hash;
+  }
+
+  /// Mixes `count` values into an FNV-1a hash, see ::hashValue().
+  std::uint64_t SymbolicCache::hashArray(std::uint64_t hash,
+                                         index_type count,
+                                         const index_type* values)
+  {
+    for (index_type i = 0; i < count; ++i) {
+      hash = hashValue(hash, values[i]);
+    }
+    return hash;
+  }
+
+  //
+  // Private methods
+  //
+
+  SymbolicCache::EntryList::iterator SymbolicCache::findEntry(std::uint64_t hash,
+                                                              index_type tag,
+                                                              index_type n,
+                                                              const index_type* ptr,
+                                                              const index_type* idx)
+  {
+    auto range = index_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      const Entry& entry = *(it->second);
+      if ((entry.tag == tag) &&
+          (entry.n == n) &&
+          std::equal(entry.ptr.begin(), entry.ptr.end(), ptr) &&
+          std::equal(entry.idx.begin(), entry.idx.end(), idx)) {
+        return it->second;
+      }
+    }
+    return entries_.end();
+  }
+
+  void SymbolicCache::erase(EntryList::iterator it)
+  {
+    auto range = index_.equal_range(it->hash);
+    for (auto map_it = range.first; map_it != range.second; ++map_it) {
+      if (map_it->second == it) {
+        index_.erase(map_it);
+        break;
+      }
+    }
+    entries_.erase(it);
+  }
+
+  void SymbolicCache::evict()
+  {
+    if (entries_.empty()) {
+      return;
+    }
+    erase(std::prev(entries_.end()));
+    num_evictions_++;
+  }
+}
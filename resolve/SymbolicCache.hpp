@@ -0,0 +1,108 @@
+/**
+ * @file SymbolicCache.hpp
+ * @brief Cache of symbolic analysis results keyed by sparsity pattern.
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common.hpp"
+
+namespace ReSolve
+{
+  /**
+   * @brief Least recently used cache of symbolic analysis results.
+   *
+   * Entries are keyed by a hash of matrix sparsity pattern `(n, ptr, idx)`
+   * and a solver specific tag, which distinguishes analyses done with
+   * different solver settings. The pattern is stored with each entry and
+   * compared on lookup, so hash collisions cannot return a wrong entry.
+   *
+   * Each entry holds a persistent payload, i.e. integer and real arrays from
+   * which the solver can reconstruct its symbolic analysis, and optionally
+   * the solver's in-memory symbolic object. Only payloads are saved to disk,
+   * so entries loaded from a file have no in-memory object until the solver
+   * reconstructs it.
+   */
+  class SymbolicCache
+  {
+    public:
+      struct Entry
+      {
+        std::uint64_t hash{0};
+        index_type tag{0};
+        index_type n{0};
+        std::vector<index_type> ptr;   ///< pattern row or column pointers
+        std::vector<index_type> idx;   ///< pattern column or row indices
+        std::vector<index_type> ints;  ///< persistent integer payload
+        std::vector<real_type>  reals; ///< persistent real payload
+        std::shared_ptr<void>   object;  ///< solver symbolic object, not persistent
+      };
+
+      SymbolicCache(std::size_t capacity = 8);
+      ~SymbolicCache() = default;
+
+      void setCapacity(std::size_t capacity);
+      std::size_t getCapacity() const;
+      std::size_t size() const;
+      void clear();
+
+      Entry* find(index_type tag,
+                  index_type n,
+                  const index_type* ptr,
+                  const index_type* idx);
+      Entry* insert(index_type tag,
+                    index_type n,
+                    const index_type* ptr,
+                    const index_type* idx);
+      bool remove(index_type tag,
+                  index_type n,
+                  const index_type* ptr,
+                  const index_type* idx);
+
+      std::size_t getNumHits() const;
+      std::size_t getNumMisses() const;
+      std::size_t getNumEvictions() const;
+      void resetCounters();
+
+      int save(const std::string& filename) const;
+      int load(const std::string& filename);
+
+      static std::uint64_t hashPattern(index_type tag,
+                                       index_type n,
+                                       const index_type* ptr,
+                                       const index_type* idx);
+
+      /// FNV-1a offset basis, the initial value for hashValue()
+      static constexpr std::uint64_t HASH_SEED = 14695981039346656037ULL;
+      static std::uint64_t hashValue(std::uint64_t hash, index_type value);
+      static std::uint64_t hashArray(std::uint64_t hash,
+                                     index_type count,
+                                     const index_type* values);
+
+    private:
+      using EntryList = std::list<Entry>;
+
+      EntryList::iterator findEntry(std::uint64_t hash,
+                                    index_type tag,
+                                    index_type n,
+                                    const index_type* ptr,
+                                    const index_type* idx);
+      void erase(EntryList::iterator it);
+      void evict();
+
+      std::size_t capacity_{8};
+      EntryList entries_; ///< most recently used entry first
+      std::unordered_multimap<std::uint64_t, EntryList::iterator> index_;
+
+      std::size_t num_hits_{0};
+      std::size_t num_misses_{0};
+      std::size_t num_evictions_{0};
+  };
+}
@@ -1,5 +1,7 @@
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <limits>
 
 #include <resolve/matrix/Csr.hpp>
 #include <resolve/matrix/Csc.hpp>
@@ -7,7 +9,9 @@
 #include <resolve/LinSolverIterativeFGMRES.hpp>
 #include <resolve/LinSolverDirectSerialILU0.hpp>
 #include <resolve/LinSolverDirectCpuILU0.hpp>
+#include <resolve/LinSolverDirectCpuRf.hpp>
 #include <resolve/GramSchmidt.hpp>
+#include <resolve/SymbolicCache.hpp>
 #include <resolve/workspace/LinAlgWorkspaceCpu.hpp>
 
 #ifdef RESOLVE_USE_KLU
@@ -35,6 +39,7 @@
 
 // Utilities
 #include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/Profiling.hpp>
 
 #include "SystemSolver.hpp"
 
@@ -161,12 +166,18 @@ namespace ReSolve
 
     delete matrixHandler_;
     delete vectorHandler_;
+    delete symbolicCache_;
   }
 
   int SystemSolver::setMatrix(matrix::Sparse* A)
   {
+    MemoryHighWaterMarkGuard guard(*this);
     int status = 0;
     A_ = A;
+    isAnalyzed_ = false;
+    isLUPreconditionerSetup_ = false;
+    policy_.reset();
+    delete resVector_;
     resVector_ = new vector_type(A->getNumRows());
     if (memspace_ == "cpu") {
       resVector_->allocate(memory::HOST);
@@ -207,6 +218,8 @@ namespace ReSolve
       delete refactorizationSolver_;
       refactorizationSolver_ = nullptr;
     }
+    isRefactorizationSetup_ = false;
+    isLUPreconditionerSetup_ = false;
     if (preconditioner_) {
       delete preconditioner_;
       preconditioner_ = nullptr;
@@ -237,6 +250,8 @@ namespace ReSolve
       // do nothing
     } else if (refactorizationMethod_ == "klu") {
       // do nothing for now, KLU is the only factorization solver available
+    } else if (refactorizationMethod_ == "cpurf") {
+      refactorizationSolver_ = new ReSolve::LinSolverDirectCpuRf(workspaceCpu_);
 #ifdef RESOLVE_USE_CUDA
     } else if (refactorizationMethod_ == "glu") {
       refactorizationSolver_ = new ReSolve::LinSolverDirectCuSolverGLU(workspaceCuda_);
@@ -294,6 +309,10 @@ namespace ReSolve
         sketch = LinSolverIterativeRandFGMRES::cs;
       } else if (sketching_method_ == "fwht") {
         sketch = LinSolverIterativeRandFGMRES::fwht;
+      } else if (sketching_method_ == "sparse_sign") {
+        sketch = LinSolverIterativeRandFGMRES::sse;
+      } else if (sketching_method_ == "srht") {
+        sketch = LinSolverIterativeRandFGMRES::srht;
       } else {
         out::warning() << "Sketching method " << sketching_method_ << " not recognized!\n"
                        << "Using default.\n";
@@ -318,20 +337,31 @@ namespace ReSolve
 
   int SystemSolver::analyze()
   {
+    RESOLVE_RANGE_SCOPE("SystemSolver::analyze");
+    SolverStats::Timer timer(stats_, SolverStats::analyze);
+    MemoryHighWaterMarkGuard guard(*this);
     if (A_ == nullptr) {
       out::error() << "System matrix not set!\n";
       return 1;
     }
 
     if (factorizationMethod_ == "klu") {
+#ifdef RESOLVE_USE_KLU
+      static_cast<LinSolverDirectKLU*>(factorizationSolver_)->setSymbolicCache(symbolicCache_);
+#endif
       factorizationSolver_->setup(A_);
-      return factorizationSolver_->analyze();
+      int status = factorizationSolver_->analyze();
+      isAnalyzed_ = (status == 0);
+      return status;
     } 
     return 1;  
   }
 
   int SystemSolver::factorize()
   {
+    RESOLVE_RANGE_SCOPE("SystemSolver::factorize");
+    SolverStats::Timer timer(stats_, SolverStats::factorize);
+    MemoryHighWaterMarkGuard guard(*this);
     if (factorizationMethod_ == "klu") {
       return factorizationSolver_->factorize();
     } 
@@ -340,13 +370,17 @@ namespace ReSolve
 
   int SystemSolver::refactorize()
   {
+    RESOLVE_RANGE_SCOPE("SystemSolver::refactorize");
+    SolverStats::Timer timer(stats_, SolverStats::refactorize);
+    MemoryHighWaterMarkGuard guard(*this);
     if (refactorizationMethod_ == "klu") {
       return factorizationSolver_->refactorize();
     }
 
     if (refactorizationMethod_ == "glu" || 
         refactorizationMethod_ == "cusolverrf" || 
-        refactorizationMethod_ == "rocsolverrf") {
+        refactorizationMethod_ == "rocsolverrf" ||
+        refactorizationMethod_ == "cpurf") {
       return refactorizationSolver_->refactorize();
     }
 
@@ -372,6 +406,8 @@ namespace ReSolve
    */
   int SystemSolver::refactorizationSetup()
   {
+    RESOLVE_RANGE_SCOPE("SystemSolver::refactorizationSetup");
+    MemoryHighWaterMarkGuard guard(*this);
     int status = 0;
     // Get factors and permutation vectors
     L_ = factorizationSolver_->getLFactor();
@@ -384,6 +420,11 @@ namespace ReSolve
       status += 1;
     }
 
+    if (refactorizationMethod_ == "cpurf") {
+      status += refactorizationSolver_->setup(A_, L_, U_, P_, Q_);
+      isRefactorizationSetup_ = (status == 0);
+    }
+
 #ifdef RESOLVE_USE_CUDA
     if (refactorizationMethod_ == "glu") {
       isSolveOnDevice_ = true;
@@ -417,9 +458,7 @@ namespace ReSolve
 #endif
 
     if (irMethod_ == "fgmres") {
-      gs_->setup(A_->getNumRows(), iterativeSolver_->getRestart()); 
-      status += iterativeSolver_->setup(A_);
-      status += iterativeSolver_->setupPreconditioner("LU", refactorizationSolver_);
+      status += setupLUPreconditioner(refactorizationSolver_);
     }
 
     return status;
@@ -440,6 +479,9 @@ namespace ReSolve
    */
   int SystemSolver::solve(vector_type* rhs, vector_type* x)
   {
+    RESOLVE_RANGE_SCOPE("SystemSolver::solve");
+    MemoryHighWaterMarkGuard guard(*this);
+    SolverStats::Timer timer(stats_, SolverStats::solve);
     int status = 0;
 
     // Use Krylov solver if selected
@@ -461,6 +503,14 @@ namespace ReSolve
       }
     } 
 
+    if (solveMethod_ == "cpurf") {
+      if (isRefactorizationSetup_) {
+        status += refactorizationSolver_->solve(rhs, x);
+      } else {
+        status += factorizationSolver_->solve(rhs, x);
+      }
+    }
+
     if (irMethod_ == "fgmres") {
       if (isSolveOnDevice_) {
         status += refine(rhs, x);
@@ -469,10 +519,111 @@ namespace ReSolve
     return status;
   }
 
+  /**
+   * @brief Solves the system, letting the refactorization policy decide
+   * how to obtain factors for the current matrix values.
+   *
+   * Depending on the policy, the matrix is factorized with pivoting, the
+   * factors are recomputed by the refactorization solver, or factors of a
+   * previous matrix are reused as a preconditioner for the Krylov solver.
+   * If the scaled residual of the solution is above the policy tolerance,
+   * the step is repeated with a stronger action, up to full factorization.
+   *
+   * @param[in]  rhs - Right-hand-side vector of the system
+   * @param[out] x   - Solution vector (will be overwritten)
+   * @return int - 0 if successful, error code otherwise
+   *
+   * @pre Matrix is set with setMatrix(). Subsequent calls are for matrices
+   * with the same sparsity pattern and updated values.
+   * @note Reuse of factors requires "fgmres" iterative refinement.
+   *
+   * @see setStaleFactorPreconditioning
+   */
+  int SystemSolver::solveAdaptive(vector_type* rhs, vector_type* x)
+  {
+    RESOLVE_RANGE_SCOPE("SystemSolver::solveAdaptive");
+    using clock  = std::chrono::steady_clock;
+    using Policy = RefactorizationPolicy;
+
+    if (A_ == nullptr) {
+      out::error() << "System matrix not set!\n";
+      return 1;
+    }
+
+    policy_.setReuseAllowed(canReuseFactors());
+    Policy::Action action = policy_.nextAction();
+
+    int status = 0;
+    for (;;) {
+      clock::time_point start = clock::now();
+      status = 0;
+      if (action == Policy::factorize) {
+        if (!isAnalyzed_) {
+          status += analyze();
+        }
+        status += factorize();
+        if (refactorizationMethod_ != "klu" && refactorizationMethod_ != "none") {
+          status += refactorizationSetup();
+        } else if (refactorizationMethod_ == "klu" && irMethod_ == "fgmres") {
+          // KLU factors precondition FGMRES directly
+          status += setupLUPreconditioner(factorizationSolver_);
+        }
+      } else if (action == Policy::refactorize) {
+        status += refactorize();
+      }
+      clock::time_point factored = clock::now();
+
+      index_type num_iter = 0;
+      if (action == Policy::reuse) {
+        SolverStats::Timer timer(stats_, SolverStats::solve);
+        x->setToZero(isSolveOnDevice_ ? memory::DEVICE : memory::HOST);
+        status += refine(rhs, x);
+        num_iter = iterativeSolver_->getNumIter();
+      } else {
+        status += solve(rhs, x);
+      }
+      clock::time_point solved = clock::now();
+
+      // Step that failed is never accepted
+      real_type residual = std::numeric_limits<real_type>::infinity();
+      real_type rcond = -1.0;
+      if (status == 0) {
+        residual = getNormOfScaledResiduals(rhs, x);
+        rcond = getFactorsConditionNumber(action);
+      }
+      bool accepted = policy_.update(action,
+                                     residual,
+                                     num_iter,
+                                     rcond,
+                                     std::chrono::duration<real_type>(factored - start).count(),
+                                     std::chrono::duration<real_type>(solved - factored).count());
+      if (accepted || action == Policy::factorize) {
+        break;
+      }
+
+      action = policy_.nextAction();
+      out::misc() << "Scaled residual " << residual << " not accepted, "
+                  << "repeating the solve with a stronger factor update.\n";
+    }
+
+    return status;
+  }
+
   int SystemSolver::preconditionerSetup()
   {
+    RESOLVE_RANGE_SCOPE("SystemSolver::preconditionerSetup");
+    MemoryHighWaterMarkGuard guard(*this);
+    SolverStats::Timer timer(stats_, SolverStats::factorize);
     int status = 0;
     if (precondition_method_ == "ilu0") {
+      if (memspace_ == "cpu") {
+        auto* ilu = dynamic_cast<LinSolverDirectCpuILU0*>(preconditioner_);
+        if (ilu == nullptr) {
+          out::error() << "ILU0 preconditioner on CPU is not available.\n";
+          return 1;
+        }
+        ilu->setSinglePrecision(precondition_precision_ == "single");
+      }
       status += preconditioner_->setup(A_);
       if (memspace_ != "cpu") {
         isSolveOnDevice_ = true;
@@ -485,6 +636,8 @@ namespace ReSolve
 
   int SystemSolver::refine(vector_type* rhs, vector_type* x)
   {
+    RESOLVE_RANGE_SCOPE("SystemSolver::refine");
+    MemoryHighWaterMarkGuard guard(*this);
     int status = 0;
 
     status += iterativeSolver_->resetMatrix(A_);
@@ -508,6 +661,97 @@ namespace ReSolve
     return *iterativeSolver_;
   }
 
+  /**
+   * @brief Returns policy used by solveAdaptive(), e.g. to set its
+   * parameters or to get statistics of actions taken.
+   */
+  RefactorizationPolicy& SystemSolver::getRefactorizationPolicy()
+  {
+    return policy_;
+  }
+
+  /**
+   * @brief Returns performance counters of system level phases.
+   *
+   * Analysis, factorization (including preconditioner setup),
+   * refactorization and solves are counted here. Counters of matrix-vector
+   * products, preconditioner applications and orthogonalization are kept
+   * by the solvers doing them, e.g. getIterativeSolver().getStats().
+   */
+  const SolverStats& SystemSolver::getStats() const
+  {
+    return stats_;
+  }
+
+  /// Sets performance counters of the system solver and its solvers to zero.
+  void SystemSolver::resetStats()
+  {
+    stats_.reset();
+    if (factorizationSolver_ != nullptr) {
+      factorizationSolver_->resetStats();
+    }
+    if (refactorizationSolver_ != nullptr) {
+      refactorizationSolver_->resetStats();
+    }
+    if (iterativeSolver_ != nullptr) {
+      iterativeSolver_->resetStats();
+    }
+    if (preconditioner_ != nullptr) {
+      preconditioner_->resetStats();
+    }
+  }
+
+  /**
+   * @brief Returns bytes of host and device memory held by the system
+   * solver and the solvers it owns.
+   *
+   * Includes factors, refactorization data, Krylov bases, orthogonalization
+   * and sketching workspaces, preconditioner factors and the residual
+   * vector. The system matrix is owned by the caller and is not included.
+   * Process-wide totals are available from memory::MemoryTracker.
+   */
+  memory::MemoryUsage SystemSolver::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (resVector_ != nullptr) {
+      usage += resVector_->getMemoryUsage();
+    }
+    if (factorizationSolver_ != nullptr) {
+      usage += factorizationSolver_->getMemoryUsage();
+    }
+    if ((refactorizationSolver_ != nullptr) && (refactorizationSolver_ != factorizationSolver_)) {
+      usage += refactorizationSolver_->getMemoryUsage();
+    }
+    if (iterativeSolver_ != nullptr) {
+      usage += iterativeSolver_->getMemoryUsage();
+    }
+    if (gs_ != nullptr) {
+      usage += gs_->getMemoryUsage();
+    }
+    if (preconditioner_ != nullptr) {
+      usage += preconditioner_->getMemoryUsage();
+    }
+    return usage;
+  }
+
+  /**
+   * @brief Returns the largest footprint reported by getMemoryUsage() at
+   * the end of any solver phase since construction or the last reset.
+   *
+   * Temporaries released within a phase are not seen here; use
+   * memory::MemoryTracker::getHighWaterMark() for process-wide peaks.
+   */
+  memory::MemoryUsage SystemSolver::getMemoryHighWaterMark() const
+  {
+    return memoryHighWaterMark_;
+  }
+
+  /// Resets memory high-water mark to the current footprint.
+  void SystemSolver::resetMemoryHighWaterMark()
+  {
+    memoryHighWaterMark_ = getMemoryUsage();
+  }
+
   void SystemSolver::setFactorizationMethod(std::string method)
   {
     factorizationMethod_ = method;
@@ -530,10 +774,13 @@ namespace ReSolve
       delete refactorizationSolver_;
       refactorizationSolver_ = nullptr;
     }
+    isRefactorizationSetup_ = false;
 
     // Create refactorization solver
     if (refactorizationMethod_ == "klu") {
       // do nothing for now
+    } else if (refactorizationMethod_ == "cpurf") {
+      refactorizationSolver_ = new ReSolve::LinSolverDirectCpuRf(workspaceCpu_);
 #ifdef RESOLVE_USE_CUDA
     } else if (refactorizationMethod_ == "glu") {
       refactorizationSolver_ = new ReSolve::LinSolverDirectCuSolverGLU(workspaceCuda_);
@@ -571,6 +818,10 @@ namespace ReSolve
         sketch = LinSolverIterativeRandFGMRES::cs;
       } else if (sketching_method_ == "fwht") {
         sketch = LinSolverIterativeRandFGMRES::fwht;
+      } else if (sketching_method_ == "sparse_sign") {
+        sketch = LinSolverIterativeRandFGMRES::sse;
+      } else if (sketching_method_ == "srht") {
+        sketch = LinSolverIterativeRandFGMRES::srht;
       } else {
         out::warning() << "Sketching method " << sketching_method_ << " not recognized!\n"
                        << "Using default.\n";
@@ -723,6 +974,56 @@ namespace ReSolve
     return factorizationMethod_;
   }
 
+  const std::string SystemSolver::getRefactorizationMethod() const
+  {
+    return refactorizationMethod_;
+  }
+
+  const std::string SystemSolver::getSolveMethod() const
+  {
+    return solveMethod_;
+  }
+
+  const std::string SystemSolver::getRefinementMethod() const
+  {
+    return irMethod_;
+  }
+
+  const std::string SystemSolver::getOrthogonalizationMethod() const
+  {
+    return gsMethod_;
+  }
+
+  const std::string SystemSolver::getPreconditionerMethod() const
+  {
+    return precondition_method_;
+  }
+
+  const std::string SystemSolver::getPreconditionerPrecision() const
+  {
+    return precondition_precision_;
+  }
+
+  /**
+   * @brief Sets seed for sampling the sketching matrix of randomized solver,
+   * which makes its results reproducible.
+   *
+   * @param[in] seed - seed of the solver's random number generator
+   * @return int - 0 if successful, 1 if the solver is not randomized
+   *
+   * @post Takes effect at the next call to setMatrix().
+   */
+  int SystemSolver::setSketchingSeed(unsigned seed)
+  {
+    if (solveMethod_ != "randgmres" || iterativeSolver_ == nullptr) {
+      out::warning() << "Trying to set sketching seed for a solver that is not randomized.\n";
+      return 1;
+    }
+    auto* sol = dynamic_cast<LinSolverIterativeRandFGMRES*>(iterativeSolver_);
+    sol->setSketchingSeed(seed);
+    return 0;
+  }
+
   /**
    * @brief Select sketching method for randomized solvers
    * 
@@ -746,6 +1047,10 @@ namespace ReSolve
       tmp = LinSolverIterativeRandFGMRES::cs;
     } else if (sketching_method == "fwht") {
       tmp = LinSolverIterativeRandFGMRES::fwht;
+    } else if (sketching_method == "sparse_sign") {
+      tmp = LinSolverIterativeRandFGMRES::sse;
+    } else if (sketching_method == "srht") {
+      tmp = LinSolverIterativeRandFGMRES::srht;
     } else {
       out::warning() << "Sketching method " << sketching_method << " not recognized!\n"
                      << "Using default (count sketch).\n";
@@ -764,10 +1069,173 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Select precision in which the preconditioner is computed and applied.
+   * 
+   * Single precision preconditioner reduces memory traffic in triangular
+   * solves, while the flexible Krylov solver using it recovers double
+   * precision accuracy of the solution (mixed precision mode).
+   * 
+   * @param[in] precision - "double" (default) or "single"
+   * @return int - 0 if successful, 1 otherwise
+   * 
+   * @pre Must be called before preconditionerSetup().
+   * @note Single precision is currently supported only for ILU0 on CPU.
+   */
+  int SystemSolver::setPreconditionerPrecision(std::string precision)
+  {
+    if (precision != "double" && precision != "single") {
+      out::error() << "Precision " << precision << " not recognized.\n";
+      return 1;
+    }
+
+    if (precision == "single" && memspace_ != "cpu") {
+      out::warning() << "Single precision preconditioner is supported only on CPU. "
+                     << "Using double precision ...\n";
+      precondition_precision_ = "double";
+      return 1;
+    }
+
+    precondition_precision_ = precision;
+    return 0;
+  }
+
+  /**
+   * @brief Enables stale-factor preconditioning in solveAdaptive().
+   *
+   * In this mode the last LU factors, from KLU or from the refactorization
+   * solver, are kept as a fixed FGMRES preconditioner for subsequent
+   * matrices with the same sparsity pattern. Factors are recomputed only
+   * after a solve needs more than `max_iterations` FGMRES iterations, or
+   * when the solution is not accurate enough. Measured times are not used
+   * to decide, so cheap Krylov iterations replace expensive factorizations
+   * for as long as the stale factors remain a good preconditioner.
+   *
+   * @param[in] enable         - true to enable, false to return to the
+   *                             adaptive cost-based policy
+   * @param[in] max_iterations - FGMRES iteration count that triggers
+   *                             refactorization
+   * @return int - 0 if successful, 1 if iterative refinement is not "fgmres"
+   *
+   * @pre Solver was created with "fgmres" iterative refinement.
+   */
+  int SystemSolver::setStaleFactorPreconditioning(bool enable, index_type max_iterations)
+  {
+    if (enable && irMethod_ != "fgmres") {
+      out::error() << "Stale-factor preconditioning requires fgmres "
+                   << "iterative refinement.\n";
+      return 1;
+    }
+
+    if (enable) {
+      policy_.setCostModelEnabled(false);
+      policy_.setMaxReuses(std::numeric_limits<index_type>::max());
+      policy_.setMaxIterations(max_iterations);
+    } else {
+      RefactorizationPolicy defaults;
+      policy_.setCostModelEnabled(true);
+      policy_.setMaxReuses(defaults.getMaxReuses());
+      policy_.setMaxIterations(defaults.getMaxIterations());
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Sets number of sparsity patterns whose symbolic analysis is kept.
+   *
+   * When the cache is enabled, analyze() reuses the fill-reducing ordering
+   * computed for a previously analyzed matrix with the same sparsity
+   * pattern instead of computing it again. This pays off when the solver
+   * cycles between a few matrix structures, e.g. network topologies.
+   *
+   * @param[in] capacity - maximum number of cached patterns, 0 disables the
+   *                       cache (default)
+   * @return int - 0 if successful
+   *
+   * @post Takes effect at the next call to analyze().
+   */
+  int SystemSolver::setSymbolicCacheCapacity(std::size_t capacity)
+  {
+    if (capacity == 0) {
+#ifdef RESOLVE_USE_KLU
+      if (factorizationMethod_ == "klu" && factorizationSolver_ != nullptr) {
+        static_cast<LinSolverDirectKLU*>(factorizationSolver_)->setSymbolicCache(nullptr);
+      }
+#endif
+      delete symbolicCache_;
+      symbolicCache_ = nullptr;
+      return 0;
+    }
+
+    if (symbolicCache_ == nullptr) {
+      symbolicCache_ = new SymbolicCache(capacity);
+    } else {
+      symbolicCache_->setCapacity(capacity);
+    }
+    return 0;
+  }
+
+  /**
+   * @brief Returns symbolic analysis cache, e.g. to query hit and miss
+   * counts or to save it to and load it from disk.
+   *
+   * @return SymbolicCache* - the cache, nullptr if it is disabled
+   */
+  SymbolicCache* SystemSolver::getSymbolicCache()
+  {
+    return symbolicCache_;
+  }
+
   //
   // Private methods
   //
 
+  /**
+   * @brief Sets up FGMRES refinement for the current matrix, preconditioned
+   * with the LU factors held by `lu_solver`.
+   *
+   * The solver object is wired as the preconditioner, so the preconditioner
+   * always applies the most recently computed factors, which may be factors
+   * of an earlier matrix in the sequence.
+   */
+  int SystemSolver::setupLUPreconditioner(LinSolverDirect* lu_solver)
+  {
+    int status = 0;
+    gs_->setup(A_->getNumRows(), iterativeSolver_->getRestart()); 
+    status += iterativeSolver_->setup(A_);
+    status += iterativeSolver_->setupPreconditioner("LU", lu_solver);
+    isLUPreconditionerSetup_ = (status == 0) && (lu_solver != nullptr);
+    return status;
+  }
+
+  void SystemSolver::updateMemoryHighWaterMark()
+  {
+    memoryHighWaterMark_.updateMax(getMemoryUsage());
+  }
+
+  bool SystemSolver::canReuseFactors() const
+  {
+    if (irMethod_ != "fgmres" || iterativeSolver_ == nullptr) {
+      return false;
+    }
+    return isLUPreconditionerSetup_;
+  }
+
+  /**
+   * @brief Returns reciprocal condition number estimate of factors computed
+   * by the action, or -1 if the solver does not provide it.
+   */
+  real_type SystemSolver::getFactorsConditionNumber(RefactorizationPolicy::Action action)
+  {
+    if (action == RefactorizationPolicy::factorize || refactorizationMethod_ == "klu") {
+      return factorizationSolver_->getMatrixConditionNumber();
+    }
+    if (action == RefactorizationPolicy::refactorize && refactorizationMethod_ == "cpurf") {
+      return refactorizationSolver_->getMatrixConditionNumber();
+    }
+    return -1.0;
+  }
+
   int SystemSolver::setGramSchmidtMethod(std::string variant)
   {
     // Map string input to the Gram-Schmidt variant enum
@@ -782,11 +1250,21 @@ namespace ReSolve
       gs_variant = GramSchmidt::mgs_pm;
     } else if (variant == "cgs1") {
       gs_variant = GramSchmidt::cgs1;
+    } else if (variant == "mgs_one_sync") {
+      gs_variant = GramSchmidt::mgs_one_sync;
+    } else if (variant == "cgs2_two_sync") {
+      gs_variant = GramSchmidt::cgs2_two_sync;
+    } else if (variant == "rgs") {
+      gs_variant = GramSchmidt::rgs;
+    } else if (variant == "dcgs2") {
+      gs_variant = GramSchmidt::dcgs2;
     } else {
       out::warning() << "Gram-Schmidt variant " << variant << " not recognized.\n";
       out::warning() << "Using default cgs2 Gram-Schmidt variant.\n";
       gs_variant = GramSchmidt::cgs2;
+      variant = "cgs2";
     }
+    gsMethod_ = variant;
 
     if (gs_) {
       gs_->setVariant(gs_variant);
@@ -1,4 +1,10 @@
 //this is to solve the system, can call different linear solvers if necessary
+#include <cstddef>
+
+#include <resolve/RefactorizationPolicy.hpp>
+#include <resolve/SolverStats.hpp>
+#include <resolve/utilities/memory/MemoryTracker.hpp>
+
 namespace ReSolve
 {
   class LinSolverDirectKLU;
@@ -10,6 +16,7 @@ namespace ReSolve
   class LinAlgWorkspaceCpu;
   class MatrixHandler;
   class VectorHandler;
+  class SymbolicCache;
 
   namespace vector
   {
@@ -21,6 +28,16 @@ namespace ReSolve
     class Sparse;
   }
 
+  /**
+   * @brief Configurable linear solver combining factorization,
+   * refactorization, iterative refinement and Krylov solvers.
+   *
+   * Instances do not share mutable state, so independent solvers may run
+   * concurrently on different threads, each with its own workspace. Only
+   * the logger and the number of host threads are process-wide; both are
+   * safe to use concurrently. A single instance must not be used by
+   * several threads at the same time.
+   */
   class SystemSolver
   {
     public:
@@ -60,6 +77,7 @@ namespace ReSolve
       int preconditionerSetup();
       int solve(vector_type*  rhs, vector_type* x); // for direct and iterative
       int refine(vector_type* rhs, vector_type* x); // for iterative refinement
+      int solveAdaptive(vector_type* rhs, vector_type* x); // policy selects factor update
 
       // we update the matrix once it changed
       int updateMatrix(std::string format, int* ia, int* ja, double* a);
@@ -67,6 +85,12 @@ namespace ReSolve
       LinSolverDirect& getFactorizationSolver();
       LinSolverDirect& getRefactorizationSolver();
       LinSolverIterative& getIterativeSolver();
+      RefactorizationPolicy& getRefactorizationPolicy();
+      const SolverStats& getStats() const;
+      void resetStats();
+      memory::MemoryUsage getMemoryUsage() const;
+      memory::MemoryUsage getMemoryHighWaterMark() const;
+      void resetMemoryHighWaterMark();
 
       real_type getVectorNorm(vector_type* rhs);
       real_type getResidualNorm(vector_type* rhs, vector_type* x);
@@ -78,6 +102,8 @@ namespace ReSolve
       const std::string getSolveMethod() const;
       const std::string getRefinementMethod() const;
       const std::string getOrthogonalizationMethod() const;
+      const std::string getPreconditionerMethod() const;
+      const std::string getPreconditionerPrecision() const;
 
       // Set solver parameters
       void setFactorizationMethod(std::string method);
@@ -85,9 +111,35 @@ namespace ReSolve
       int setSolveMethod(std::string method);
       void setRefinementMethod(std::string method, std::string gs = "cgs2");
       int setSketchingMethod(std::string method);
+      int setSketchingSeed(unsigned seed);
       int setGramSchmidtMethod(std::string gs_method);
+      int setPreconditionerPrecision(std::string precision);
+      int setStaleFactorPreconditioning(bool enable, index_type max_iterations = 20);
+      int setSymbolicCacheCapacity(std::size_t capacity);
+      SymbolicCache* getSymbolicCache();
 
     private:
+      /// Updates memory high-water mark when a solver phase returns.
+      class MemoryHighWaterMarkGuard
+      {
+        public:
+          explicit MemoryHighWaterMarkGuard(SystemSolver& solver) : solver_(solver)
+          {
+          }
+
+          ~MemoryHighWaterMarkGuard()
+          {
+            solver_.updateMemoryHighWaterMark();
+          }
+
+        private:
+          SystemSolver& solver_;
+      };
+
+      int setupLUPreconditioner(LinSolverDirect* lu_solver);
+      void updateMemoryHighWaterMark();
+      bool canReuseFactors() const;
+      real_type getFactorsConditionNumber(RefactorizationPolicy::Action action);
 
       LinSolverDirect* factorizationSolver_{nullptr};
       LinSolverDirect* refactorizationSolver_{nullptr};
@@ -103,7 +155,16 @@ namespace ReSolve
       MatrixHandler* matrixHandler_{nullptr};
       VectorHandler* vectorHandler_{nullptr};
 
+      SymbolicCache* symbolicCache_{nullptr}; ///< symbolic analyses of recent sparsity patterns
+
       bool isSolveOnDevice_{false};
+      bool isRefactorizationSetup_{false}; ///< CPU refactorization solver has factors
+      bool isAnalyzed_{false};             ///< symbolic analysis done for current matrix
+      bool isLUPreconditionerSetup_{false}; ///< FGMRES is preconditioned with LU factors
+
+      RefactorizationPolicy policy_;
+      SolverStats stats_; ///< system level phases, owned solvers keep their own
+      memory::MemoryUsage memoryHighWaterMark_; ///< largest footprint seen at the end of a phase
 
       matrix_type* L_{nullptr};
       matrix_type* U_{nullptr};
@@ -120,6 +181,7 @@ namespace ReSolve
       std::string refactorizationMethod_{"none"};
       std::string solveMethod_{"none"};
       std::string precondition_method_{"none"};
+      std::string precondition_precision_{"double"};
       std::string irMethod_{"none"};
       std::string gsMethod_{"cgs2"};
       std::string sketching_method_{"count"}; ///< @todo move this to LinSolverIterative class
@@ -6250,7 +6250,7 @@ Colj:     do lc = lc1, lc2
                      lena, luparm, parmlu,           &
                      a, indc, indr, p, q,            &
                      lenc, lenr, locc, locr,         &
-                     inform, diag, vnorm )
+                     inform, diag, vnorm ) bind(C)
 
     integer(ip),   intent(in)    :: mode1, mode2, m, n, jrep, lena
     integer(ip),   intent(inout) :: luparm(30), &
@@ -45,4 +45,27 @@ extern "C" {
               ReSolve::index_type* locc,
               ReSolve::index_type* locr,
               ReSolve::index_type* inform);
+
+  void lu8rpc(ReSolve::index_type* mode1,
+              ReSolve::index_type* mode2,
+              ReSolve::index_type* m,
+              ReSolve::index_type* n,
+              ReSolve::index_type* jrep,
+              ReSolve::real_type* v,
+              ReSolve::real_type* w,
+              ReSolve::index_type* lena,
+              ReSolve::index_type* luparm,
+              ReSolve::real_type* parmlu,
+              ReSolve::real_type* a,
+              ReSolve::index_type* indc,
+              ReSolve::index_type* indr,
+              ReSolve::index_type* p,
+              ReSolve::index_type* q,
+              ReSolve::index_type* lenc,
+              ReSolve::index_type* lenr,
+              ReSolve::index_type* locc,
+              ReSolve::index_type* locr,
+              ReSolve::index_type* inform,
+              ReSolve::real_type* diag,
+              ReSolve::real_type* vnorm);
 }
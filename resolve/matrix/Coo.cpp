@@ -98,10 +98,12 @@ namespace ReSolve
         this->h_row_data_ = new index_type[nnz_current];
         this->h_col_data_ = new index_type[nnz_current];
         owns_cpu_data_ = true;
+        updateMemoryUsage();
       }
       if (h_val_data_ == nullptr) {
         this->h_val_data_ = new real_type[nnz_current];
         owns_cpu_vals_ = true;
+        updateMemoryUsage();
       }
     }
 
@@ -175,6 +177,7 @@ namespace ReSolve
       std::fill(h_val_data_, h_val_data_ + nnz_current, 0.0);  
       owns_cpu_data_ = true;
       owns_cpu_vals_ = true;
+      updateMemoryUsage();
       return 0;
     }
 
@@ -208,10 +211,12 @@ namespace ReSolve
             h_row_data_ = new index_type[nnz_current];      
             h_col_data_ = new index_type[nnz_current];      
             owns_cpu_data_ = true;
+            updateMemoryUsage();
           }
           if (h_val_data_ == nullptr) {
             h_val_data_ = new real_type[nnz_current];      
             owns_cpu_vals_ = true;
+            updateMemoryUsage();
           }
           mem_.copyArrayDeviceToHost(h_row_data_, d_row_data_, nnz_current);
           mem_.copyArrayDeviceToHost(h_col_data_, d_col_data_, nnz_current);
@@ -258,4 +263,10 @@ namespace ReSolve
           << h_val_data_[i] << "\n";
     }
   }
+
+  index_type matrix::Coo::getNumIndices() const
+  {
+    index_type nnz_current = is_expanded_ ? nnz_expanded_ : nnz_;
+    return 2 * nnz_current;
+  }
 } // namespace ReSolve
@@ -97,10 +97,12 @@ namespace ReSolve
         this->h_col_data_ = new index_type[m_ + 1];
         this->h_row_data_ = new index_type[nnz_current];
         owns_cpu_data_ = true;
+        updateMemoryUsage();
       } 
       if (h_val_data_ == nullptr) {
         this->h_val_data_ = new real_type[nnz_current];
         owns_cpu_vals_ = true;
+        updateMemoryUsage();
       }
     }
 
@@ -180,6 +182,7 @@ namespace ReSolve
       std::fill(h_val_data_, h_val_data_ + nnz_current, 0.0);  
       owns_cpu_data_ = true;
       owns_cpu_vals_ = true;
+      updateMemoryUsage();
       return 0;
     }
 
@@ -213,10 +216,12 @@ namespace ReSolve
             h_col_data_ = new index_type[m_ + 1];      
             h_row_data_ = new index_type[nnz_current];      
             owns_cpu_data_ = true;
+            updateMemoryUsage();
           }
           if (h_val_data_ == nullptr) {
             h_val_data_ = new real_type[nnz_current];      
             owns_cpu_vals_ = true;
+            updateMemoryUsage();
           }
           mem_.copyArrayDeviceToHost(h_col_data_, d_col_data_,      m_ + 1);
           mem_.copyArrayDeviceToHost(h_row_data_, d_row_data_, nnz_current);
@@ -265,4 +270,10 @@ namespace ReSolve
       }
     }
   }
+
+  index_type matrix::Csc::getNumIndices() const
+  {
+    index_type nnz_current = is_expanded_ ? nnz_expanded_ : nnz_;
+    return (m_ + 1) + nnz_current;
+  }
 } // namespace ReSolve
@@ -36,6 +36,9 @@ namespace ReSolve { namespace matrix {
       virtual void print(std::ostream& file_out = std::cout);
 
       virtual int copyData(memory::MemorySpace memspaceOut);
+
+    protected:
+      virtual index_type getNumIndices() const;
   };
 
 }} // namespace ReSolve::matrix
@@ -80,6 +80,7 @@ namespace ReSolve
         h_val_data_ = *vals;
         h_data_updated_ = true;
         owns_cpu_data_  = true;
+        updateMemoryUsage();
         // Set device data to null
         if (d_row_data_ || d_col_data_ || d_val_data_) {
           out::error() << "Device data unexpectedly allocated. "
@@ -115,6 +116,7 @@ namespace ReSolve
         h_val_data_ = *vals;
         h_data_updated_ = true;
         owns_cpu_data_  = true;
+        updateMemoryUsage();
         copyData(memspaceDst);
 
         // Hijack data from the source
@@ -218,10 +220,12 @@ namespace ReSolve
         this->h_row_data_ = new index_type[n_ + 1];
         this->h_col_data_ = new index_type[nnz_current];
         owns_cpu_data_ = true;
+        updateMemoryUsage();
       } 
       if (h_val_data_ == nullptr) {
         this->h_val_data_ = new real_type[nnz_current];
         owns_cpu_vals_ = true;
+        updateMemoryUsage();
       }
     }
 
@@ -297,6 +301,7 @@ namespace ReSolve
       std::fill(h_val_data_, h_val_data_ + nnz_current, 0.0);  
       owns_cpu_data_ = true;
       owns_cpu_vals_ = true;
+      updateMemoryUsage();
       return 0;   
     }
 
@@ -331,10 +336,12 @@ namespace ReSolve
             h_row_data_ = new index_type[n_ + 1];
             h_col_data_ = new index_type[nnz_current];      
             owns_cpu_data_ = true;
+            updateMemoryUsage();
           }
           if (h_val_data_ == nullptr) {
             h_val_data_ = new real_type[nnz_current];      
             owns_cpu_vals_ = true;
+            updateMemoryUsage();
           }
           mem_.copyArrayDeviceToHost(h_row_data_, d_row_data_,      n_ + 1);
           mem_.copyArrayDeviceToHost(h_col_data_, d_col_data_, nnz_current);
@@ -394,5 +401,11 @@ namespace ReSolve
       }
     }
   }
+
+  index_type matrix::Csr::getNumIndices() const
+  {
+    index_type nnz_current = is_expanded_ ? nnz_expanded_ : nnz_;
+    return (n_ + 1) + nnz_current;
+  }
 } // namespace ReSolve 
 
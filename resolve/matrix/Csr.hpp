@@ -49,6 +49,8 @@ namespace ReSolve { namespace matrix {
 
       int updateFromCoo(matrix::Coo* mat, memory::MemorySpace memspaceOut);
 
+    protected:
+      virtual index_type getNumIndices() const;
   };
 
 }} // namespace ReSolve::matrix
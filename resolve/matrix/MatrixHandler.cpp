@@ -7,6 +7,7 @@
 #include <resolve/matrix/Csr.hpp>
 #include <resolve/workspace/LinAlgWorkspace.hpp>
 #include <resolve/matrix/Utilities.hpp>
+#include <resolve/Profiling.hpp>
 #include "MatrixHandler.hpp"
 #include "MatrixHandlerCpu.hpp"
 
@@ -139,6 +140,7 @@ namespace ReSolve {
                             std::string matrixFormat, 
                             memory::MemorySpace memspace)
   {
+    RESOLVE_RANGE_SCOPE("MatrixHandler::matvec");
     using namespace ReSolve::memory;
     switch (memspace) {
       case HOST:
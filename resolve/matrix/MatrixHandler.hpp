@@ -38,6 +38,11 @@ namespace ReSolve {
    * multiple matrix operation implementations running on CUDA and HIP devices
    * as well as on CPU.
    * 
+   * A handler is not thread-safe; it keeps state, e.g. whether matrix
+   * values changed, and uses its workspace buffers. Independent handlers
+   * with separate workspaces can be used concurrently from different
+   * threads.
+   * 
    * @author Kasia Swirydowicz <kasia.swirydowicz@pnnl.gov>
    * @author Slaven Peles <peless@ornl.gov>
    */
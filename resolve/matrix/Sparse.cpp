@@ -321,6 +321,9 @@ namespace ReSolve {
           delete [] h_val_data_;
           h_val_data_ = nullptr;
         }
+        // No owned host data is left
+        memory::MemoryTracker::deallocate(memory::HOST, host_bytes_);
+        host_bytes_ = 0;
         return 0;
       case DEVICE:
         if (owns_gpu_data_) {
@@ -369,6 +372,7 @@ namespace ReSolve {
       if (h_val_data_ == nullptr) {
         this->h_val_data_ = new real_type[nnz_current];
         owns_cpu_vals_ = true;
+        updateMemoryUsage();
       }
     }
 
@@ -445,5 +449,46 @@ namespace ReSolve {
     return 0;
   }
 
+  /**
+   * @brief Bytes of host and device data owned by the matrix.
+   */
+  memory::MemoryUsage matrix::Sparse::getMemoryUsage() const
+  {
+    index_type nnz_current = is_expanded_ ? nnz_expanded_ : nnz_;
+    std::size_t index_bytes = sizeof(index_type) * static_cast<std::size_t>(getNumIndices());
+    std::size_t value_bytes = sizeof(real_type)  * static_cast<std::size_t>(nnz_current);
+
+    memory::MemoryUsage usage;
+    if (owns_cpu_data_ && h_row_data_ != nullptr) {
+      usage.host_bytes += index_bytes;
+    }
+    if (owns_cpu_vals_ && h_val_data_ != nullptr) {
+      usage.host_bytes += value_bytes;
+    }
+    if (owns_gpu_data_ && d_row_data_ != nullptr) {
+      usage.device_bytes += index_bytes;
+    }
+    if (owns_gpu_vals_ && d_val_data_ != nullptr) {
+      usage.device_bytes += value_bytes;
+    }
+    return usage;
+  }
+
+  /**
+   * @brief Reports change of owned host data to the MemoryTracker.
+   *
+   * Device data is counted by the memory handler.
+   */
+  void matrix::Sparse::updateMemoryUsage()
+  {
+    std::size_t bytes = getMemoryUsage().host_bytes;
+    if (bytes > host_bytes_) {
+      memory::MemoryTracker::allocate(memory::HOST, bytes - host_bytes_);
+    } else {
+      memory::MemoryTracker::deallocate(memory::HOST, host_bytes_ - bytes);
+    }
+    host_bytes_ = bytes;
+  }
+
 } // namespace ReSolve
 
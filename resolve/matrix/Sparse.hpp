@@ -6,6 +6,7 @@
 #include <tuple>
 #include <resolve/Common.hpp>
 #include <resolve/MemoryUtils.hpp>
+#include <resolve/utilities/memory/MemoryTracker.hpp>
 
 namespace ReSolve { namespace matrix {
   /**
@@ -65,8 +66,14 @@ namespace ReSolve { namespace matrix {
       
       //set new values just sets the pointer, use caution.   
       virtual int setNewValues(real_type* new_vals, memory::MemorySpace memspace);
+
+      memory::MemoryUsage getMemoryUsage() const;
     
     protected:
+      /// Total length of row and column index arrays
+      virtual index_type getNumIndices() const = 0;
+      void updateMemoryUsage();
+
       //size
       index_type n_{0}; ///< number of rows
       index_type m_{0}; ///< number of columns
@@ -96,6 +103,7 @@ namespace ReSolve { namespace matrix {
 
       bool owns_gpu_data_{false}; ///< for row/col data
       bool owns_gpu_vals_{false}; ///< for values
+      std::size_t host_bytes_{0}; ///< owned HOST bytes reported to MemoryTracker
 
       MemoryHandler mem_; ///< Device memory manager object
   };
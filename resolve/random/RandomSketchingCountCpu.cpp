@@ -6,6 +6,7 @@
  * 
  */
 #include <resolve/vector/Vector.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
 #include <resolve/random/cpuSketchingKernels.h>
 #include <resolve/random/RandomSketchingCountCpu.hpp> 
 
@@ -25,6 +26,7 @@ namespace ReSolve
   {
     delete [] h_labels_;
     delete [] h_flip_;
+    delete [] h_work_;
   }
 
   /**
@@ -43,12 +45,46 @@ namespace ReSolve
    */
   int RandomSketchingCountCpu::Theta(vector_type* input, vector_type* output)
   {
+    reserveWorkspace();
     cpu::count_sketch_theta(n_,
                             k_rand_,
                             h_labels_,
                             h_flip_,
                             input->getData(memory::HOST),
-                            output->getData(memory::HOST));
+                            output->getData(memory::HOST),
+                            h_work_,
+                            max_threads_);
+    return 0;
+  }
+
+  /**
+   * @brief Count sketch of the first _num_vecs_ vectors of a multivector.
+   * 
+   * Vectors are distributed between host threads, and each thread sweeps
+   * the input in row blocks, so that labels and signs are read from cache
+   * for all of its vectors.
+   * 
+   * @param[in]    input    - multivector with vectors of size _n_
+   * @param[inout] output   - multivector with vectors of size _k_; sketches
+   *                          are added to the existing values
+   * @param[in]    num_vecs - number of vectors to sketch
+   * 
+   * @pre Both multivectors have at least _num_vecs_ vectors allocated.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO).
+   */
+  int RandomSketchingCountCpu::Theta(vector_type* input, vector_type* output, index_type num_vecs)
+  {
+    reserveWorkspace();
+    cpu::count_sketch_theta_block(n_,
+                                  k_rand_,
+                                  num_vecs,
+                                  h_labels_,
+                                  h_flip_,
+                                  input->getData(memory::HOST),
+                                  output->getData(memory::HOST),
+                                  h_work_,
+                                  max_threads_);
     return 0;
   }
 
@@ -71,7 +107,11 @@ namespace ReSolve
   {
     k_rand_ = k;
     n_ = n;
-    srand(static_cast<unsigned>(time(nullptr)));
+    seedGenerator();
+
+    delete [] h_work_;
+    h_work_ = nullptr;
+    reserveWorkspace();
 
     //allocate labeling scheme vector and move to GPU
     h_labels_ = new index_type[n_];
@@ -82,8 +122,8 @@ namespace ReSolve
     //populate labeling scheme (can be done on the gpu really)
     //to be fixed, this can be done on the GPU
     for (int i=0; i<n; ++i) {
-      h_labels_[i] = rand() % k_rand_;
-      int r = rand()%100;
+      h_labels_[i] = randomIndex(k_rand_);
+      int r = randomIndex(100);
       if (r < 50) {
         h_flip_[i] = -1;
       } else { 
@@ -114,9 +154,9 @@ namespace ReSolve
   int RandomSketchingCountCpu::reset()
   {
     for (int i = 0; i < n_; ++i) {
-      h_labels_[i] = rand() % k_rand_;
+      h_labels_[i] = randomIndex(k_rand_);
 
-      int r = rand()%100;
+      int r = randomIndex(100);
       if (r < 50) {
         h_flip_[i] = -1;
       } else { 
@@ -125,4 +165,37 @@ namespace ReSolve
     }
     return 0;
   }
+
+  /**
+   * @brief Sizes the workspace of threaded sketches for the current number
+   * of host threads.
+   * 
+   * The workspace is allocated at setup and reallocated only if the
+   * number of threads has grown since, so sketching does not allocate
+   * memory in steady state.
+   */
+  void RandomSketchingCountCpu::reserveWorkspace()
+  {
+    const int num_threads = threads::getNumThreads();
+    if (h_work_ != nullptr && num_threads <= max_threads_) {
+      return;
+    }
+    delete [] h_work_;
+    max_threads_ = (num_threads > max_threads_) ? num_threads : max_threads_;
+    h_work_ = new real_type[static_cast<size_t>(max_threads_ - 1) * static_cast<size_t>(k_rand_)];
+  }
+
+  /// Bytes held by the labeling and sign arrays and the thread workspace.
+  memory::MemoryUsage RandomSketchingCountCpu::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (h_labels_ != nullptr) {
+      usage.host_bytes += 2 * sizeof(index_type) * static_cast<std::size_t>(n_);
+    }
+    if (h_work_ != nullptr) {
+      usage.host_bytes += sizeof(real_type) * static_cast<std::size_t>(max_threads_ - 1)
+                                            * static_cast<std::size_t>(k_rand_);
+    }
+    return usage;
+  }
 }
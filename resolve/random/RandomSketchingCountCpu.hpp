@@ -36,18 +36,26 @@ namespace ReSolve {
 
       // Actual sketching process
       virtual int Theta(vector_type* input, vector_type* output);
+      virtual int Theta(vector_type* input, vector_type* output, index_type num_vecs);
 
       // Setup the parameters, sampling matrices, permuations, etc
       virtual int setup(index_type n, index_type k);
       virtual int reset(); // if needed can be reset (like when Krylov method restarts)
 
+      virtual memory::MemoryUsage getMemoryUsage() const;
+
     private:
+      void reserveWorkspace();
+
       index_type n_{0};      ///< size of base vector
       index_type k_rand_{0}; ///< size of sketched vector
 
       index_type* h_labels_{nullptr}; ///< label array size _n_, with values from _0_ to _k-1_ assigned by random
       index_type* h_flip_{nullptr};   ///< flip array with values of 1 and -1 assigned by random
 
+      int max_threads_{1};          ///< number of threads the workspace is sized for
+      real_type* h_work_{nullptr};  ///< per-thread partial sketches, (max_threads_ - 1) * _k_
+
       // MemoryHandler mem_; ///< Device memory manager object
   };
 }
@@ -57,6 +57,29 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Sketches the first _num_vecs_ vectors of a multivector.
+   * 
+   * @param[in]  input    - multivector with vectors of size _n_
+   * @param[out] output   - multivector with vectors of size _k_
+   * @param[in]  num_vecs - number of vectors to sketch
+   * 
+   * @pre Both multivectors have at least _num_vecs_ vectors allocated.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO).
+   */
+  int RandomSketchingCountCuda::Theta(vector_type* input, vector_type* output, index_type num_vecs)
+  {
+    vector_type vec_in(n_);
+    vector_type vec_out(k_rand_);
+    for (index_type j = 0; j < num_vecs; ++j) {
+      vec_in.setData(input->getVectorData(j, memory::DEVICE), memory::DEVICE);
+      vec_out.setData(output->getVectorData(j, memory::DEVICE), memory::DEVICE);
+      Theta(&vec_in, &vec_out);
+    }
+    return 0;
+  }
+
   /**
    * @brief Sketching setup method for CountSketch algorithm.
    * 
@@ -77,7 +100,7 @@ namespace ReSolve
   {
     k_rand_ = k;
     n_ = n;
-    srand(static_cast<unsigned>(time(nullptr)));
+    seedGenerator();
     //allocate labeling scheme vector and move to GPU
 
     h_labels_ = new int[n_];
@@ -87,8 +110,8 @@ namespace ReSolve
     //populate labeling scheme (can be done on the gpu really)
     //to be fixed, this can be done on the GPU
     for (int i=0; i<n; ++i) {
-      h_labels_[i] = rand() % k_rand_;
-      int r = rand()%100;
+      h_labels_[i] = randomIndex(k_rand_);
+      int r = randomIndex(100);
       if (r < 50) {
         h_flip_[i] = -1;
       } else { 
@@ -127,9 +150,9 @@ namespace ReSolve
   int RandomSketchingCountCuda::reset() // if needed can be reset (like when Krylov method restarts)
   {
     for (int i = 0; i < n_; ++i) {
-      h_labels_[i] = rand() % k_rand_;
+      h_labels_[i] = randomIndex(k_rand_);
 
-      int r = rand()%100;
+      int r = randomIndex(100);
       if (r < 50) {
         h_flip_[i] = -1;
       } else { 
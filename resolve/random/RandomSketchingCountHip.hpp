@@ -34,6 +34,7 @@ namespace ReSolve {
 
       // Actual sketching process
       virtual int Theta(vector_type* input, vector_type* output);
+      virtual int Theta(vector_type* input, vector_type* output, index_type num_vecs);
 
       // Setup the parameters, sampling matrices, permuations, etc
       virtual int setup(index_type n, index_type k);
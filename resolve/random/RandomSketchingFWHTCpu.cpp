@@ -61,7 +61,7 @@ namespace ReSolve
                        input->getData(memory::HOST),
                        d_aux_);  
 
-    cpu::FWHT(1, log2N_, d_aux_);
+    cpu::FWHT(0, log2N_, d_aux_);
 
     cpu::FWHT_select(k_rand_, 
                      h_perm_, 
@@ -70,6 +70,29 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Sketches the first _num_vecs_ vectors of a multivector.
+   * 
+   * @param[in]  input    - multivector with vectors of size _n_
+   * @param[out] output   - multivector with vectors of size _k_
+   * @param[in]  num_vecs - number of vectors to sketch
+   * 
+   * @pre Both multivectors have at least _num_vecs_ vectors allocated.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO).
+   */
+  int RandomSketchingFWHTCpu::Theta(vector_type* input, vector_type* output, index_type num_vecs)
+  {
+    vector_type vec_in(n_);
+    vector_type vec_out(k_rand_);
+    for (index_type j = 0; j < num_vecs; ++j) {
+      vec_in.setData(input->getVectorData(j, memory::HOST), memory::HOST);
+      vec_out.setData(output->getVectorData(j, memory::HOST), memory::HOST);
+      Theta(&vec_in, &vec_out);
+    }
+    return 0;
+  }
+
   /** 
    * @brief Sketching method setup. 
    * 
@@ -97,7 +120,7 @@ namespace ReSolve
     log2N_ = static_cast<index_type>(std::log2(N_real));
     one_over_k_ = 1.0/std::sqrt(static_cast<real_type>(k_rand_));
 
-    srand(static_cast<unsigned>(time(nullptr)));
+    seedGenerator();
 
     h_seq_  = new index_type[N_];
     h_perm_  = new index_type[k_rand_];
@@ -111,7 +134,7 @@ namespace ReSolve
     } 
     //Fisher-Yates
     for (int i = N_ - 1; i > 0; i--) {
-      r = rand() % i; 
+      r = randomIndex(i); 
       temp = h_seq_[i];
       h_seq_[i] = h_seq_[r];
       h_seq_[r] = temp; 
@@ -122,7 +145,7 @@ namespace ReSolve
 
     // and D
     for (int i = 0; i < n_; ++i){
-      r = rand() % 100;
+      r = randomIndex(100);
       if (r < 50){
         h_D_[i] = -1;
       } else { 
@@ -150,7 +173,6 @@ namespace ReSolve
    */
   int RandomSketchingFWHTCpu::reset()
   {
-    srand(static_cast<unsigned>(time(nullptr)));
 
     int r;
     int temp;
@@ -161,7 +183,7 @@ namespace ReSolve
 
     //Fisher-Yates
     for (int i = N_ - 1; i > 0; i--) {
-      r = rand() % i; 
+      r = randomIndex(i); 
       temp = h_seq_[i];
       h_seq_[i] = h_seq_[r];
       h_seq_[r] = temp; 
@@ -172,7 +194,7 @@ namespace ReSolve
 
     // and D
     for (int i = 0; i < n_; ++i) {
-      r = rand() % 100;
+      r = randomIndex(100);
       if (r < 50) {
         h_D_[i] = -1;
       } else { 
@@ -182,4 +204,15 @@ namespace ReSolve
 
     return 0;
   }
+
+  /// Bytes held by the permutation, diagonal scaling and workspace arrays.
+  memory::MemoryUsage RandomSketchingFWHTCpu::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (h_seq_ != nullptr) {
+      usage.host_bytes += sizeof(index_type) * static_cast<std::size_t>(N_ + k_rand_ + n_);
+      usage.host_bytes += sizeof(real_type) * static_cast<std::size_t>(N_);
+    }
+    return usage;
+  }
 }
@@ -32,11 +32,14 @@ namespace ReSolve {
 
       // Actual sketching process
       virtual int Theta(vector_type* input, vector_type* output);
+      virtual int Theta(vector_type* input, vector_type* output, index_type num_vecs);
 
       // Setup the parameters, sampling matrices, permuations, etc
       virtual int setup(index_type n, index_type k);
       virtual int reset(); // if needed can be reset (like when Krylov method restarts)
 
+      virtual memory::MemoryUsage getMemoryUsage() const;
+
     private:
       index_type n_{0};      ///< size of base vector
       index_type k_rand_{0}; ///< size of sketched vector
@@ -80,6 +80,29 @@ namespace ReSolve
     return 0;
   }
 
+  /**
+   * @brief Sketches the first _num_vecs_ vectors of a multivector.
+   * 
+   * @param[in]  input    - multivector with vectors of size _n_
+   * @param[out] output   - multivector with vectors of size _k_
+   * @param[in]  num_vecs - number of vectors to sketch
+   * 
+   * @pre Both multivectors have at least _num_vecs_ vectors allocated.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO).
+   */
+  int RandomSketchingFWHTHip::Theta(vector_type* input, vector_type* output, index_type num_vecs)
+  {
+    vector_type vec_in(n_);
+    vector_type vec_out(k_rand_);
+    for (index_type j = 0; j < num_vecs; ++j) {
+      vec_in.setData(input->getVectorData(j, memory::DEVICE), memory::DEVICE);
+      vec_out.setData(output->getVectorData(j, memory::DEVICE), memory::DEVICE);
+      Theta(&vec_in, &vec_out);
+    }
+    return 0;
+  }
+
   /** 
    * @brief Sketching method setup. 
    * 
@@ -108,7 +131,7 @@ namespace ReSolve
     log2N_ = static_cast<index_type>(std::log2(N_real));
     one_over_k_ = 1.0/std::sqrt(static_cast<real_type>(k_rand_));
 
-    srand(static_cast<unsigned>(time(nullptr)));
+    seedGenerator();
 
     h_seq_  = new int[N_];
     h_perm_ = new int[k_rand_];
@@ -122,7 +145,7 @@ namespace ReSolve
     } 
     //Fisher-Yates
     for (int i = N_ - 1; i > 0; i--) {
-      r = rand() % i; 
+      r = randomIndex(i); 
       temp = h_seq_[i];
       h_seq_[i] = h_seq_[r];
       h_seq_[r] = temp; 
@@ -133,7 +156,7 @@ namespace ReSolve
 
     // and D
     for (int i = 0; i < n_; ++i){
-      r = rand() % 100;
+      r = randomIndex(100);
       if (r < 50){
         h_D_[i] = -1;
       } else { 
@@ -166,7 +189,6 @@ namespace ReSolve
    */
   int RandomSketchingFWHTHip::reset()
   {
-    srand(static_cast<unsigned>(time(nullptr)));
 
     int r;
     int temp;
@@ -177,7 +199,7 @@ namespace ReSolve
 
     //Fisher-Yates
     for (int i = N_ - 1; i > 0; i--) {
-      r = rand() % i; 
+      r = randomIndex(i); 
       temp = h_seq_[i];
       h_seq_[i] = h_seq_[r];
       h_seq_[r] = temp; 
@@ -188,7 +210,7 @@ namespace ReSolve
 
     // and D
     for (int i = 0; i < n_; ++i) {
-      r = rand() % 100;
+      r = randomIndex(100);
       if (r < 50) {
         h_D_[i] = -1;
       } else { 
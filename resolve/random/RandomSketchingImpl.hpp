@@ -5,7 +5,12 @@
  * 
  */
 #pragma once
+#include <atomic>
+#include <ctime>
+#include <random>
+
 #include <resolve/Common.hpp>
+#include <resolve/utilities/memory/MemoryTracker.hpp>
 
 
 namespace ReSolve
@@ -22,6 +27,13 @@ namespace ReSolve
    * @brief Interface to random sketching implementations.
    * 
    * All sketching methods inherit from this class.
+   * 
+   * Sparse embeddings (count sketch, sparse sign) add the sketch to the
+   * output vector, so the output needs to be zeroed by the caller. Hadamard
+   * transform based sketches overwrite the output.
+   *
+   * Each instance owns its random number generator, so sketches in
+   * different solver instances can be set up concurrently.
    */
   class RandomSketchingImpl
   {
@@ -37,10 +49,61 @@ namespace ReSolve
       // Actual sketching process
       virtual int Theta(vector::Vector* input, vector::Vector* output) = 0;
 
+      // Sketch the first num_vecs vectors of a multivector in one call
+      virtual int Theta(vector::Vector* input, vector::Vector* output, index_type num_vecs) = 0;
+
       // Setup the parameters, sampling matrices, permuations, etc
       virtual int setup(index_type n, index_type k) = 0;
 
       // Needed for iterative methods with restarting
       virtual int reset() = 0;
+
+      /// Bytes held by sampling arrays and workspaces; zero if not reported.
+      virtual memory::MemoryUsage getMemoryUsage() const
+      {
+        return memory::MemoryUsage();
+      }
+
+      /// Sets seed used by the next setup; a nondeterministic seed is used if not set.
+      void setSeed(unsigned seed)
+      {
+        seed_ = seed;
+        has_seed_ = true;
+      }
+
+    protected:
+      /**
+       * @brief Seeds the generator, called at setup.
+       *
+       * Without a user seed, entropy from std::random_device is mixed with
+       * a process-wide counter and the current time, so that sketches set
+       * up at the same time (e.g. in concurrent solvers) are independent
+       * even where std::random_device is deterministic.
+       */
+      void seedGenerator()
+      {
+        if (has_seed_) {
+          generator_.seed(seed_);
+          return;
+        }
+        static std::atomic<unsigned> num_seeded(0);
+        std::random_device device;
+        std::seed_seq sequence{device(),
+                               num_seeded.fetch_add(1u),
+                               static_cast<unsigned>(time(nullptr))};
+        generator_.seed(sequence);
+      }
+
+      /// Random integer uniformly distributed in [0, n).
+      index_type randomIndex(index_type n)
+      {
+        return std::uniform_int_distribution<index_type>(0, n - 1)(generator_);
+      }
+
+      std::mt19937 generator_; ///< random number generator owned by this instance
+
+    private:
+      unsigned seed_{0};
+      bool has_seed_{false};
   };
 } // namespace ReSolve
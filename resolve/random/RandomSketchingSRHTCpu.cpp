@@ -0,0 +1,188 @@
+/**
+ * @file RandomSketchingSRHTCpu.cpp
+ * @brief Definition of RandomSketchingSRHTCpu class.
+ * 
+ */
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/utilities/logger/Logger.hpp>
+#include <resolve/random/cpuSketchingKernels.h>
+#include <resolve/random/RandomSketchingSRHTCpu.hpp> 
+
+namespace ReSolve 
+{
+  using out = io::Logger;
+
+  /**
+   * @brief Default constructor
+   * 
+   * @post All class variables are set to nullptr.
+   */
+  RandomSketchingSRHTCpu::RandomSketchingSRHTCpu()
+  {
+  }
+
+  /**
+   * @brief destructor
+   */
+  RandomSketchingSRHTCpu::~RandomSketchingSRHTCpu()
+  {
+    delete [] h_D_;
+    delete [] h_perm_;
+    delete [] h_aux_;
+  }
+
+  /** 
+   * @brief Sketches a vector.
+   *
+   * @param[in]  input   - input vector, size _n_ 
+   * @param[out] output  - output vector, size _k_, overwritten
+   * 
+   * @pre Setup function from this class has been called.
+   *
+   * @return 0 if successful, !=0 otherwise (TODO). 
+   */
+  int RandomSketchingSRHTCpu::Theta(vector_type* input, vector_type* output)
+  {
+    transform(input->getData(memory::HOST), output->getData(memory::HOST));
+    return 0;
+  }
+
+  /**
+   * @brief Sketches the first _num_vecs_ vectors of a multivector.
+   * 
+   * Vectors are transformed one after another in the transform workspace,
+   * and each transform is threaded over host threads.
+   * 
+   * @param[in]  input    - multivector with vectors of size _n_
+   * @param[out] output   - multivector with vectors of size _k_, overwritten
+   * @param[in]  num_vecs - number of vectors to sketch
+   * 
+   * @pre Both multivectors have at least _num_vecs_ vectors allocated.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO).
+   */
+  int RandomSketchingSRHTCpu::Theta(vector_type* input, vector_type* output, index_type num_vecs)
+  {
+    const real_type* x = input->getData(memory::HOST);
+    real_type* y = output->getData(memory::HOST);
+    for (index_type j = 0; j < num_vecs; ++j) {
+      transform(x + static_cast<size_t>(j) * static_cast<size_t>(n_),
+                y + static_cast<size_t>(j) * static_cast<size_t>(k_rand_));
+    }
+    return 0;
+  }
+
+  /** 
+   * @brief Sketching method setup. 
+   * 
+   * @param[in]  n  - size of base (non-sketched) vector
+   * @param[in]  k  - size of sketched vector
+   * 
+   * @pre _k_ <= _n_
+   * @post Everything is set up so you can call Theta.
+   *
+   * @return 0 if successful, !=0 otherwise. 
+   */
+  int RandomSketchingSRHTCpu::setup(index_type n, index_type k)
+  {
+    k_rand_ = k;
+    n_ = n;
+    // pad to the nearest power of 2
+    real_type N_real = std::pow(2.0, std::ceil(std::log2(static_cast<real_type>(n_))));
+    if (N_real > static_cast<real_type>(std::numeric_limits<index_type>::max())) {
+      out::error() << "Exceeded numerical limits of index_type ...\n";
+      return 1;
+    }
+    N_ = static_cast<index_type>(N_real);
+    log2N_ = static_cast<index_type>(std::log2(N_real));
+    scale_ = 1.0 / std::sqrt(static_cast<real_type>(k_rand_));
+    if (k_rand_ > N_) {
+      out::error() << "Sketch size " << k_rand_ << " exceeds padded vector size " << N_ << "\n";
+      return 1;
+    }
+
+    seedGenerator();
+
+    delete [] h_D_;
+    delete [] h_perm_;
+    delete [] h_aux_;
+    h_D_    = new index_type[n_];
+    h_perm_ = new index_type[k_rand_];
+    h_aux_  = new real_type[N_];
+
+    sample();
+    return 0;
+  }
+
+  /** 
+   * @brief Resample D and P, for example when Krylov solver restarts.
+   *
+   * @return 0 if successful, !=0 otherwise (TODO). 
+   */
+  int RandomSketchingSRHTCpu::reset()
+  {
+    sample();
+    return 0;
+  }
+
+  /**
+   * @brief Samples random signs in D and _k_ distinct rows for P.
+   * 
+   * Rows are selected by partial Fisher-Yates shuffle of 0, ..., N-1.
+   */
+  void RandomSketchingSRHTCpu::sample()
+  {
+    std::vector<index_type> seq(static_cast<size_t>(N_));
+    for (index_type i = 0; i < N_; ++i) {
+      seq[i] = i;
+    }
+    for (index_type i = 0; i < k_rand_; ++i) {
+      std::uniform_int_distribution<index_type> pick(i, N_ - 1);
+      index_type r = pick(generator_);
+      index_type temp = seq[i];
+      seq[i] = seq[r];
+      seq[r] = temp;
+      h_perm_[i] = seq[i];
+    }
+
+    std::bernoulli_distribution coin(0.5);
+    for (index_type i = 0; i < n_; ++i) {
+      h_D_[i] = coin(generator_) ? 1 : -1;
+    }
+  }
+
+  /**
+   * @brief Computes y = sqrt(1/k) P H D x.
+   * 
+   * The Hadamard transform is threaded over host threads.
+   * 
+   * @param[in]  x   - input array of size _n_
+   * @param[out] y   - output array of size _k_
+   */
+  void RandomSketchingSRHTCpu::transform(const real_type* x, real_type* y)
+  {
+    cpu::FWHT_scaleByD(n_, h_D_, x, h_aux_);
+    for (index_type i = n_; i < N_; ++i) {
+      h_aux_[i] = 0.0;
+    }
+    cpu::FWHT(0, log2N_, h_aux_);
+    for (index_type i = 0; i < k_rand_; ++i) {
+      y[i] = scale_ * h_aux_[h_perm_[i]];
+    }
+  }
+
+  /// Bytes held by the diagonal scaling, row selection and workspace arrays.
+  memory::MemoryUsage RandomSketchingSRHTCpu::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (h_D_ != nullptr) {
+      usage.host_bytes += sizeof(index_type) * static_cast<std::size_t>(n_ + k_rand_);
+      usage.host_bytes += sizeof(real_type) * static_cast<std::size_t>(N_);
+    }
+    return usage;
+  }
+}
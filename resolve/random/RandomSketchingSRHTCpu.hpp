@@ -0,0 +1,60 @@
+/**
+ * @file RandomSketchingSRHTCpu.hpp
+ * @brief Declaration of RandomSketchingSRHTCpu class.
+ * 
+ */
+#pragma once
+#include <resolve/Common.hpp>
+#include <resolve/random/RandomSketchingImpl.hpp>
+
+namespace ReSolve {
+
+  // Forward declaration of vector::Vector class
+  namespace vector
+  {
+    class Vector;
+  }
+
+  /**
+   * @brief Subsampled randomized Hadamard transform for CPU.
+   * 
+   * Computes y = sqrt(1/k) P H D x, where D is a random diagonal sign
+   * matrix, H is the (unnormalized) Walsh-Hadamard matrix of the padded
+   * size N, and P selects _k_ distinct rows uniformly at random. Unlike
+   * `RandomSketchingFWHTCpu`, the sketch is scaled so that
+   * E ||y||^2 = ||x||^2, and no scaling is needed by the caller.
+   */
+  class RandomSketchingSRHTCpu : public RandomSketchingImpl
+  {
+    private:
+      using vector_type = vector::Vector;
+
+    public:
+      RandomSketchingSRHTCpu();
+      virtual ~RandomSketchingSRHTCpu();
+
+      // Actual sketching process
+      virtual int Theta(vector_type* input, vector_type* output);
+      virtual int Theta(vector_type* input, vector_type* output, index_type num_vecs);
+
+      // Setup the parameters, sampling matrices, permuations, etc
+      virtual int setup(index_type n, index_type k);
+      virtual int reset(); // if needed can be reset (like when Krylov method restarts)
+
+      virtual memory::MemoryUsage getMemoryUsage() const;
+
+    private:
+      void sample();
+      void transform(const real_type* x, real_type* y);
+
+      index_type n_{0};      ///< size of base vector
+      index_type k_rand_{0}; ///< size of sketched vector
+      index_type N_{0};      ///< padded vector size
+      index_type log2N_{0};  ///< log2 of N_
+      real_type  scale_{0.0}; ///< 1/sqrt(k)
+
+      index_type* h_D_{nullptr};    ///< diagonal of D, values 1 and -1
+      index_type* h_perm_{nullptr}; ///< _k_ distinct rows selected from _N_
+      real_type*  h_aux_{nullptr};  ///< workspace of size _N_
+  };
+}
@@ -0,0 +1,205 @@
+/**
+ * @file RandomSketchingSparseSignCpu.cpp
+ * @brief Definition of RandomSketchingSparseSignCpu class.
+ * 
+ */
+#include <cmath>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include <resolve/random/cpuSketchingKernels.h>
+#include <resolve/random/RandomSketchingSparseSignCpu.hpp> 
+
+namespace ReSolve 
+{
+  /**
+   * @brief Default constructor
+   * 
+   * @post Number of nonzeros per column is set to 8.
+   */
+  RandomSketchingSparseSignCpu::RandomSketchingSparseSignCpu()
+  {
+  }
+
+  /**
+   * @brief Constructor setting number of nonzeros per column.
+   * 
+   * @param[in] s - number of nonzeros per column of the embedding
+   */
+  RandomSketchingSparseSignCpu::RandomSketchingSparseSignCpu(index_type s)
+    : s_(s > 0 ? s : 1)
+  {
+  }
+
+  /// Destructor
+  RandomSketchingSparseSignCpu::~RandomSketchingSparseSignCpu()
+  {
+    delete [] h_labels_;
+    delete [] h_signs_;
+    delete [] h_work_;
+  }
+
+  /**
+   * @brief Sketching method using sparse sign embedding.
+   * 
+   * @param[in]    input  - Vector size _n_
+   * @param[inout] output - Vector size _k_, sketch is added to it
+   *
+   * @pre Both input and output variables are initialized and of correct size.
+   * Setup has been run at least once.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO). 
+   */
+  int RandomSketchingSparseSignCpu::Theta(vector_type* input, vector_type* output)
+  {
+    reserveWorkspace();
+    cpu::sparse_sign_theta(n_,
+                           k_rand_,
+                           s_,
+                           h_labels_,
+                           h_signs_,
+                           input->getData(memory::HOST),
+                           output->getData(memory::HOST),
+                           h_work_,
+                           max_threads_);
+    return 0;
+  }
+
+  /**
+   * @brief Sparse sign embedding of the first _num_vecs_ vectors of a
+   * multivector, computed in a single threaded pass over the input.
+   * 
+   * @param[in]    input    - multivector with vectors of size _n_
+   * @param[inout] output   - multivector with vectors of size _k_; sketches
+   *                          are added to the existing values
+   * @param[in]    num_vecs - number of vectors to sketch
+   * 
+   * @pre Both multivectors have at least _num_vecs_ vectors allocated.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO).
+   */
+  int RandomSketchingSparseSignCpu::Theta(vector_type* input, vector_type* output, index_type num_vecs)
+  {
+    reserveWorkspace();
+    cpu::sparse_sign_theta_block(n_,
+                                 k_rand_,
+                                 s_,
+                                 num_vecs,
+                                 h_labels_,
+                                 h_signs_,
+                                 input->getData(memory::HOST),
+                                 output->getData(memory::HOST),
+                                 h_work_,
+                                 max_threads_);
+    return 0;
+  }
+
+  /**
+   * @brief Sketching setup method for sparse sign embedding.
+   * 
+   * @param[in]  n - Size of base vector
+   * @param[in]  k - Size of sketch 
+   *
+   * @post Row indices and signs of the embedding are sampled. If _k_ is
+   * smaller than the requested number of nonzeros per column, _s_ is
+   * reduced to _k_.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO). 
+   */
+  int RandomSketchingSparseSignCpu::setup(index_type n, index_type k)
+  {
+    k_rand_ = k;
+    n_ = n;
+    if (s_ > k_rand_) {
+      s_ = k_rand_;
+    }
+    seedGenerator();
+
+    delete [] h_labels_;
+    delete [] h_signs_;
+    delete [] h_work_;
+    h_work_ = nullptr;
+    reserveWorkspace();
+    h_labels_ = new index_type[static_cast<size_t>(n_) * static_cast<size_t>(s_)];
+    h_signs_  = new real_type[static_cast<size_t>(n_) * static_cast<size_t>(s_)];
+
+    sample();
+    return 0;
+  }
+
+  /**
+   * @brief Resample the embedding (for intance, if solver restarted).
+   * 
+   * @pre Setup has been called and _k_ did not change since.
+   * 
+   * @return 0 if successful, !=0 otherwise (TODO).
+   */
+  int RandomSketchingSparseSignCpu::reset()
+  {
+    sample();
+    return 0;
+  }
+
+  /**
+   * @brief Samples _s_ distinct rows and signs for each column.
+   */
+  void RandomSketchingSparseSignCpu::sample()
+  {
+    std::uniform_int_distribution<index_type> row(0, k_rand_ - 1);
+    std::bernoulli_distribution coin(0.5);
+    const real_type scale = 1.0 / std::sqrt(static_cast<real_type>(s_));
+
+    for (index_type i = 0; i < n_; ++i) {
+      index_type* labels = &h_labels_[i * s_];
+      for (index_type l = 0; l < s_; ++l) {
+        bool duplicate = true;
+        while (duplicate) {
+          labels[l] = row(generator_);
+          duplicate = false;
+          for (index_type m = 0; m < l; ++m) {
+            if (labels[m] == labels[l]) {
+              duplicate = true;
+              break;
+            }
+          }
+        }
+        h_signs_[i * s_ + l] = coin(generator_) ? scale : -scale;
+      }
+    }
+  }
+
+  /**
+   * @brief Sizes the workspace of threaded sketches for the current number
+   * of host threads.
+   * 
+   * The workspace is allocated at setup and reallocated only if the
+   * number of threads has grown since, so sketching does not allocate
+   * memory in steady state.
+   */
+  void RandomSketchingSparseSignCpu::reserveWorkspace()
+  {
+    const int num_threads = threads::getNumThreads();
+    if (h_work_ != nullptr && num_threads <= max_threads_) {
+      return;
+    }
+    delete [] h_work_;
+    max_threads_ = (num_threads > max_threads_) ? num_threads : max_threads_;
+    h_work_ = new real_type[static_cast<size_t>(max_threads_ - 1) * static_cast<size_t>(k_rand_)];
+  }
+
+  /// Bytes held by the row indices and values of the embedding and the
+  /// thread workspace.
+  memory::MemoryUsage RandomSketchingSparseSignCpu::getMemoryUsage() const
+  {
+    memory::MemoryUsage usage;
+    if (h_labels_ != nullptr) {
+      std::size_t nnz = static_cast<std::size_t>(n_) * static_cast<std::size_t>(s_);
+      usage.host_bytes += (sizeof(index_type) + sizeof(real_type)) * nnz;
+    }
+    if (h_work_ != nullptr) {
+      usage.host_bytes += sizeof(real_type) * static_cast<std::size_t>(max_threads_ - 1)
+                                            * static_cast<std::size_t>(k_rand_);
+    }
+    return usage;
+  }
+}
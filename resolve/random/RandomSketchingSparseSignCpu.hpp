@@ -0,0 +1,61 @@
+/**
+ * @file RandomSketchingSparseSignCpu.hpp
+ * @brief Declaration of RandomSketchingSparseSignCpu class.
+ * 
+ */
+#pragma once
+#include <resolve/Common.hpp>
+#include <resolve/random/RandomSketchingImpl.hpp>
+
+namespace ReSolve {
+
+  // Forward declaration of vector::Vector class
+  namespace vector
+  {
+    class Vector;
+  }
+
+  /**
+   * @brief Sparse sign embedding implementation for CPU.
+   * 
+   * Each column of the _k_ x _n_ embedding matrix has _s_ nonzeros with
+   * values +-1/sqrt(s) placed in distinct, randomly selected rows. For
+   * _s_ = 1 this is the count sketch. A few nonzeros per column give a much
+   * better subspace embedding than count sketch of the same size at a
+   * modest additional cost.
+   */
+  class RandomSketchingSparseSignCpu : public RandomSketchingImpl
+  {
+    private:
+      using vector_type = vector::Vector;
+
+    public: 
+      RandomSketchingSparseSignCpu();
+      RandomSketchingSparseSignCpu(index_type s);
+      virtual ~RandomSketchingSparseSignCpu();
+
+      // Actual sketching process
+      virtual int Theta(vector_type* input, vector_type* output);
+      virtual int Theta(vector_type* input, vector_type* output, index_type num_vecs);
+
+      // Setup the parameters, sampling matrices, permuations, etc
+      virtual int setup(index_type n, index_type k);
+      virtual int reset(); // if needed can be reset (like when Krylov method restarts)
+
+      virtual memory::MemoryUsage getMemoryUsage() const;
+
+    private:
+      void sample();
+      void reserveWorkspace();
+
+      index_type n_{0};      ///< size of base vector
+      index_type k_rand_{0}; ///< size of sketched vector
+      index_type s_{8};      ///< (requested) number of nonzeros per column
+
+      index_type* h_labels_{nullptr}; ///< row indices of nonzeros, _s_ per column
+      real_type*  h_signs_{nullptr};  ///< values of nonzeros, +-1/sqrt(s)
+
+      int max_threads_{1};          ///< number of threads the workspace is sized for
+      real_type* h_work_{nullptr};  ///< per-thread partial sketches, (max_threads_ - 1) * _k_
+  };
+}
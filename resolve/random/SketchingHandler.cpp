@@ -11,6 +11,8 @@
 #include <resolve/random/RandomSketchingFWHTCuda.hpp>
 #include <resolve/random/RandomSketchingFWHTHip.hpp>
 #include <resolve/random/RandomSketchingFWHTCpu.hpp>
+#include <resolve/random/RandomSketchingSparseSignCpu.hpp>
+#include <resolve/random/RandomSketchingSRHTCpu.hpp>
 #include "SketchingHandler.hpp"
 
 namespace ReSolve {
@@ -31,6 +33,12 @@ namespace ReSolve {
         case LinSolverIterativeRandFGMRES::fwht:
           sketching_ = new RandomSketchingFWHTCpu();
           break;
+        case LinSolverIterativeRandFGMRES::sse:
+          sketching_ = new RandomSketchingSparseSignCpu();
+          break;
+        case LinSolverIterativeRandFGMRES::srht:
+          sketching_ = new RandomSketchingSRHTCpu();
+          break;
         default:
           sketching_ = nullptr;
           break;
@@ -86,6 +94,27 @@ namespace ReSolve {
     return sketching_->Theta(input, output);
   }
 
+  /**
+   * @brief Sketches the first `num_vecs` vectors of a multivector.
+   * 
+   * Sketches all vectors in one call, which allows the implementation to
+   * traverse the input only once and to parallelize over the block.
+   * 
+   * @param[in]  input    - multivector with vectors of size _n_
+   * @param[out] output   - multivector with vectors of size _k_
+   * @param[in]  num_vecs - number of vectors to sketch
+   */
+  int SketchingHandler::Theta(vector_type* input, vector_type* output, index_type num_vecs)
+  {
+    return sketching_->Theta(input, output, num_vecs);
+  }
+
+  /// Returns false if the method is not implemented for the device.
+  bool SketchingHandler::isSupported() const
+  {
+    return sketching_ != nullptr;
+  }
+
   /// Calls initial setup.
   int SketchingHandler::setup(index_type n, index_type k)
   {
@@ -98,4 +127,19 @@ namespace ReSolve {
     return sketching_->reset();
   }
 
+  /// Sets seed of the random number generator, takes effect at setup.
+  void SketchingHandler::setSeed(unsigned seed)
+  {
+    sketching_->setSeed(seed);
+  }
+
+  /// Returns memory held by the sketching implementation.
+  memory::MemoryUsage SketchingHandler::getMemoryUsage() const
+  {
+    if (sketching_ == nullptr) {
+      return memory::MemoryUsage();
+    }
+    return sketching_->getMemoryUsage();
+  }
+
 }
@@ -32,12 +32,24 @@ namespace ReSolve
       /// Actual sketching process
       int Theta(vector_type* input, vector_type* output);
 
+      /// Sketch a block of vectors
+      int Theta(vector_type* input, vector_type* output, index_type num_vecs);
+
+      /// Check if the requested method is available on the device
+      bool isSupported() const;
+
       /// Setup the parameters, sampling matrices, permuations, etc.
       int setup(index_type n, index_type k);
 
       /// Needed for iterative methods with restarting
       int reset();
 
+      /// Seed of the random number generator used at setup
+      void setSeed(unsigned seed);
+
+      /// Bytes held by the sketching implementation
+      memory::MemoryUsage getMemoryUsage() const;
+
     private:
       RandomSketchingImpl* sketching_{nullptr}; ///< Pointer to implementation
   };
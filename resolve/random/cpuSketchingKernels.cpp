@@ -4,14 +4,206 @@
  * @brief CPU implementation of random sketching kernels.
  * 
  */
+#include <algorithm>
 #include <cmath>
+#include <vector>
 #include <stdio.h>
+#include <resolve/utilities/threads/Threads.hpp>
 #include "cpuSketchingKernels.h"
 
 namespace ReSolve
 {
   namespace cpu
   {
+    namespace
+    {
+      /// Minimum number of input rows processed by one thread.
+      constexpr index_type SKETCH_ROWS_PER_THREAD = 16384;
+
+      /// Number of input rows kept in cache while sweeping over all vectors.
+      constexpr index_type SKETCH_ROW_BLOCK = 2048;
+
+      /// log2 of the number of entries in an FWHT tile (32 kB of doubles)
+      constexpr index_type FWHT_TILE_LOG2 = 12;
+
+      /// Minimum number of FWHT tiles processed by one thread.
+      constexpr index_type FWHT_MIN_TILES_PER_THREAD = 4;
+
+      /// Minimum number of butterfly groups processed by one thread.
+      constexpr index_type FWHT_MIN_GROUPS_PER_THREAD = 16384;
+
+      /**
+       * @brief One butterfly stage with stride h on x[0 .. 2h), applied to
+       * offsets j0 <= j < j1.
+       */
+      inline void fwhtRadix2(real_type* x, index_type h, index_type j0, index_type j1)
+      {
+        real_type* x0 = x;
+        real_type* x1 = x + h;
+        for (index_type j = j0; j < j1; ++j) {
+          const real_type a = x0[j];
+          const real_type b = x1[j];
+          x0[j] = a + b;
+          x1[j] = a - b;
+        }
+      }
+
+      /**
+       * @brief Two butterfly stages with strides h and 2h on x[0 .. 4h),
+       * applied to offsets j0 <= j < j1.
+       */
+      inline void fwhtRadix4(real_type* x, index_type h, index_type j0, index_type j1)
+      {
+        real_type* x0 = x;
+        real_type* x1 = x + h;
+        real_type* x2 = x + 2 * h;
+        real_type* x3 = x + 3 * h;
+        for (index_type j = j0; j < j1; ++j) {
+          const real_type s0 = x0[j] + x1[j];
+          const real_type d0 = x0[j] - x1[j];
+          const real_type s1 = x2[j] + x3[j];
+          const real_type d1 = x2[j] - x3[j];
+          x0[j] = s0 + s1;
+          x1[j] = d0 + d1;
+          x2[j] = s0 - s1;
+          x3[j] = d0 - d1;
+        }
+      }
+
+      /**
+       * @brief Applies butterfly stages with strides h_begin <= h < h_end
+       * to array x of size len.
+       */
+      void fwhtStages(real_type* x, index_type len, index_type h_begin, index_type h_end)
+      {
+        index_type h = h_begin;
+        // The first two stages have stride 1 and 2; unroll them to avoid
+        // inner loops of length 1 and 2.
+        if ((h == 1) && (4 <= h_end)) {
+          for (index_type i = 0; i < len; i += 4) {
+            const real_type s0 = x[i]     + x[i + 1];
+            const real_type d0 = x[i]     - x[i + 1];
+            const real_type s1 = x[i + 2] + x[i + 3];
+            const real_type d1 = x[i + 2] - x[i + 3];
+            x[i]     = s0 + s1;
+            x[i + 1] = d0 + d1;
+            x[i + 2] = s0 - s1;
+            x[i + 3] = d0 - d1;
+          }
+          h = 4;
+        }
+        while (4 * h <= h_end) {
+          for (index_type i = 0; i < len; i += 4 * h) {
+            fwhtRadix4(x + i, h, 0, h);
+          }
+          h *= 4;
+        }
+        if (h < h_end) {
+          for (index_type i = 0; i < len; i += 2 * h) {
+            fwhtRadix2(x + i, h, 0, h);
+          }
+        }
+      }
+
+      /**
+       * @brief Sketches a vector with a sparse embedding that has `s`
+       * nonzeros per column.
+       * 
+       * Input rows are split between threads. Each thread scatters its rows
+       * into a private copy of the output, and the copies are summed up
+       * afterwards. Thread 0 accumulates directly into the output. Short
+       * vectors are sketched by the calling thread only.
+       * 
+       * @tparam SignType - type of the sign array (integer or real)
+       * 
+       * @param[in] work        - workspace of size (max_threads - 1) * k
+       * @param[in] max_threads - maximum number of threads to use
+       */
+      template <typename SignType>
+      void sparseSketch(index_type n,
+                        index_type k,
+                        index_type s,
+                        const index_type* labels,
+                        const SignType* signs,
+                        const real_type* input,
+                        real_type* output,
+                        real_type* work,
+                        int max_threads)
+      {
+        const size_t size = static_cast<size_t>(k);
+        int num_threads = threads::getNumThreads(n, SKETCH_ROWS_PER_THREAD);
+        num_threads = (num_threads < max_threads) ? num_threads : max_threads;
+
+        threads::parallelFor(num_threads, 0, n, [&](int tid, index_type lo, index_type hi) {
+          real_type* y = output;
+          if (tid > 0) {
+            y = work + static_cast<size_t>(tid - 1) * size;
+            std::fill(y, y + size, 0.0);
+          }
+          for (index_type i = lo; i < hi; ++i) {
+            const real_type xi = input[i];
+            for (index_type l = 0; l < s; ++l) {
+              y[labels[i * s + l]] += static_cast<real_type>(signs[i * s + l]) * xi;
+            }
+          }
+        });
+
+        for (int t = 0; t < num_threads - 1; ++t) {
+          const real_type* w = work + static_cast<size_t>(t) * size;
+          for (size_t e = 0; e < size; ++e) {
+            output[e] += w[e];
+          }
+        }
+      }
+
+      /**
+       * @brief Sketches a block of vectors with a sparse embedding that has
+       * `s` nonzeros per column.
+       * 
+       * Vectors are split between threads, so no private copies of the
+       * output are needed. Rows are processed in blocks, so that labels and
+       * signs stay in cache while the block is applied to all vectors of
+       * the thread. A single vector is split by rows instead.
+       * 
+       * @tparam SignType - type of the sign array (integer or real)
+       */
+      template <typename SignType>
+      void sparseSketchBlock(index_type n,
+                             index_type k,
+                             index_type s,
+                             index_type num_vecs,
+                             const index_type* labels,
+                             const SignType* signs,
+                             const real_type* input,
+                             real_type* output,
+                             real_type* work,
+                             int max_threads)
+      {
+        if (num_vecs == 1) {
+          sparseSketch(n, k, s, labels, signs, input, output, work, max_threads);
+          return;
+        }
+        int num_threads = threads::getNumThreads(n * num_vecs, SKETCH_ROWS_PER_THREAD);
+        num_threads = (num_threads < num_vecs) ? num_threads : static_cast<int>(num_vecs);
+
+        threads::parallelFor(num_threads, 0, num_vecs, [&](int, index_type j0, index_type j1) {
+          for (index_type i0 = 0; i0 < n; i0 += SKETCH_ROW_BLOCK) {
+            const index_type i1 = (i0 + SKETCH_ROW_BLOCK < n) ? (i0 + SKETCH_ROW_BLOCK) : n;
+            for (index_type j = j0; j < j1; ++j) {
+              const real_type* x = input + static_cast<size_t>(j) * static_cast<size_t>(n);
+              real_type* y = output + static_cast<size_t>(j) * static_cast<size_t>(k);
+              for (index_type i = i0; i < i1; ++i) {
+                const real_type xi = x[i];
+                for (index_type l = 0; l < s; ++l) {
+                  y[labels[i * s + l]] += static_cast<real_type>(signs[i * s + l]) * xi;
+                }
+              }
+            }
+          }
+        });
+      }
+    } // anonymous namespace
+
     /**
      * @brief Count sketch theta function.
      * 
@@ -21,24 +213,48 @@ namespace ReSolve
      * @param[in]  flip   - vector of 1s and -1s, length n
      * @param[in]  input  - vector of lenghts n
      * @param[out] output - vector of lenght k
+     * @param[in]  work   - workspace of size (max_threads - 1) * k
+     * @param[in]  max_threads - maximum number of host threads
      * 
      * @todo Decide how to allow user to configure grid and block sizes.
      */
     void count_sketch_theta(index_type n,
-                            index_type /* k */,
+                            index_type k,
                             index_type* labels,
                             index_type* flip,
                             real_type* input,
-                            real_type* output)
+                            real_type* output,
+                            real_type* work,
+                            int max_threads)
     {
-      real_type val;
-      for (index_type i = 0; i < n; ++i) {
-        val = input[i];  
-        if (flip[i] != 1) {
-          val *= -1.0;
-        } 
-        output[labels[i]] += val;
-      }
+      sparseSketch(n, k, 1, labels, flip, input, output, work, max_threads);
+    }
+
+    /**
+     * @brief Count sketch of a block of vectors.
+     * 
+     * @param[in]    n        - input vector size
+     * @param[in]    k        - output vector size
+     * @param[in]    num_vecs - number of vectors in the block
+     * @param[in]    labels   - vector of non-negative ints from 0 to k-1, length n
+     * @param[in]    flip     - vector of 1s and -1s, length n
+     * @param[in]    input    - vectors of length n stored contiguously
+     * @param[inout] output   - vectors of length k stored contiguously; the
+     *                          sketch is added to the existing values
+     * @param[in]    work     - workspace of size (max_threads - 1) * k
+     * @param[in]    max_threads - maximum number of host threads
+     */
+    void count_sketch_theta_block(index_type n,
+                                  index_type k,
+                                  index_type num_vecs,
+                                  const index_type* labels,
+                                  const index_type* flip,
+                                  const real_type* input,
+                                  real_type* output,
+                                  real_type* work,
+                                  int max_threads)
+    {
+      sparseSketchBlock(n, k, 1, num_vecs, labels, flip, input, output, work, max_threads);
     }
 
     /**
@@ -95,32 +311,124 @@ namespace ReSolve
     }
 
     /**
-     * @brief 
+     * @brief In-place unnormalized fast Walsh-Hadamard transform.
+     * 
+     * Stages with butterfly stride smaller than the tile size are applied
+     * tile by tile, so that each tile stays in cache while all of its
+     * stages are computed. Tiles are independent and are distributed
+     * between host threads. The remaining stages are applied in sweeps
+     * over the whole array, two stages (radix-4) per sweep. Inner loops run
+     * over contiguous memory so that the compiler can vectorize them.
      * 
-     * @param[in]  M      - Placeholder for GPU grid size (not used here)
-     * @param[in]  log2N  - 
-     * @param[out] h_Data - 
+     * @param[in]    M      - Maximum number of host threads (on GPU this is
+     *                        the grid size); 0 uses the default thread count
+     * @param[in]    log2N  - log2 of the array size
+     * @param[inout] h_Data - array of size 2^log2N, overwritten with its
+     *                        Walsh-Hadamard transform
+     * 
+     * @note In "normal" FWHT there is also a division by sqrt(2) per stage.
      */
-    void FWHT(index_type /* M */, 
+    void FWHT(index_type M, 
               index_type log2N, 
               real_type* h_Data) 
     {
-      index_type h = 1;
-      index_type N =  static_cast<index_type>(std::pow(2.0,log2N));
-      real_type x, y;
-      
-      while (h < N) {
-        for (index_type i = 0; i < N; i += 2*h) {
-          for (index_type j = i; j < i + h; ++j) {
-            x = h_Data[j];
-            y = h_Data[j + h];
-            h_Data[j] = x + y;
-            h_Data[j + h] = x - y;
-          } 
+      const index_type N = static_cast<index_type>(1) << log2N;
+      const index_type tile = (log2N < FWHT_TILE_LOG2) ? N : (static_cast<index_type>(1) << FWHT_TILE_LOG2);
+      int max_threads = (M > 0) ? static_cast<int>(M) : threads::getNumThreads();
+
+      // Stages within tiles
+      const index_type num_tiles = N / tile;
+      int num_threads = threads::getNumThreads(num_tiles, FWHT_MIN_TILES_PER_THREAD);
+      num_threads = (num_threads < max_threads) ? num_threads : max_threads;
+      threads::parallelFor(num_threads, 0, num_tiles, [&](int, index_type lo, index_type hi) {
+        for (index_type t = lo; t < hi; ++t) {
+          fwhtStages(h_Data + t * tile, tile, 1, tile);
         }
-        // note: in "normal" FWHT there is also a division by sqrt(2) here     
-        h *= 2;
-      } 
+      });
+
+      // Stages across tiles, parallel over butterfly groups
+      index_type h = tile;
+      while (h < N) {
+        const index_type radix = (4 * h <= N) ? 4 : 2;
+        const index_type groups = N / radix;
+        num_threads = threads::getNumThreads(groups, FWHT_MIN_GROUPS_PER_THREAD);
+        num_threads = (num_threads < max_threads) ? num_threads : max_threads;
+        threads::parallelFor(num_threads, 0, groups, [&](int, index_type lo, index_type hi) {
+          // Group q belongs to block q / h and has offset q % h in the block
+          index_type q = lo;
+          while (q < hi) {
+            const index_type block = q / h;
+            const index_type j0 = q - block * h;
+            const index_type j1 = (h < j0 + (hi - q)) ? h : (j0 + (hi - q));
+            real_type* x = h_Data + block * radix * h;
+            if (radix == 4) {
+              fwhtRadix4(x, h, j0, j1);
+            } else {
+              fwhtRadix2(x, h, j0, j1);
+            }
+            q += j1 - j0;
+          }
+        });
+        h *= radix;
+      }
+    }
+
+    /**
+     * @brief Sparse sign embedding theta function.
+     * 
+     * Each input entry is scattered to _s_ distinct output entries.
+     * 
+     * @param[in]    n      - input vector size
+     * @param[in]    k      - output vector size
+     * @param[in]    s      - number of nonzeros per column of the embedding
+     * @param[in]    labels - output row indices, _s_ per input entry, length n*s
+     * @param[in]    signs  - scaled signs +-1/sqrt(s), length n*s
+     * @param[in]    input  - vector of length n
+     * @param[inout] output - vector of length k; the sketch is added to
+     *                        the existing values
+     * @param[in]    work   - workspace of size (max_threads - 1) * k
+     * @param[in]    max_threads - maximum number of host threads
+     */
+    void sparse_sign_theta(index_type n,
+                           index_type k,
+                           index_type s,
+                           const index_type* labels,
+                           const real_type* signs,
+                           const real_type* input,
+                           real_type* output,
+                           real_type* work,
+                           int max_threads)
+    {
+      sparseSketch(n, k, s, labels, signs, input, output, work, max_threads);
+    }
+
+    /**
+     * @brief Sparse sign embedding of a block of vectors.
+     * 
+     * @param[in]    n        - input vector size
+     * @param[in]    k        - output vector size
+     * @param[in]    s        - number of nonzeros per column of the embedding
+     * @param[in]    num_vecs - number of vectors in the block
+     * @param[in]    labels   - output row indices, length n*s
+     * @param[in]    signs    - scaled signs +-1/sqrt(s), length n*s
+     * @param[in]    input    - vectors of length n stored contiguously
+     * @param[inout] output   - vectors of length k stored contiguously; the
+     *                          sketch is added to the existing values
+     * @param[in]    work     - workspace of size (max_threads - 1) * k
+     * @param[in]    max_threads - maximum number of host threads
+     */
+    void sparse_sign_theta_block(index_type n,
+                                 index_type k,
+                                 index_type s,
+                                 index_type num_vecs,
+                                 const index_type* labels,
+                                 const real_type* signs,
+                                 const real_type* input,
+                                 real_type* output,
+                                 real_type* work,
+                                 int max_threads)
+    {
+      sparseSketchBlock(n, k, s, num_vecs, labels, signs, input, output, work, max_threads);
     }
 
   } // namespace cpu
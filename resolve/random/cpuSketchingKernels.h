@@ -15,7 +15,19 @@ namespace ReSolve
                             index_type* labels,
                             index_type* flip,
                             real_type* input,
-                            real_type* output);
+                            real_type* output,
+                            real_type* work,
+                            int max_threads);
+
+    void count_sketch_theta_block(index_type n,
+                                  index_type k,
+                                  index_type num_vecs,
+                                  const index_type* labels,
+                                  const index_type* flip,
+                                  const real_type* input,
+                                  real_type* output,
+                                  real_type* work,
+                                  int max_threads);
 
     void FWHT_scaleByD(index_type n,
                       const index_type* D,
@@ -27,6 +39,27 @@ namespace ReSolve
                     const real_type* input,
                     real_type* output);
     void FWHT(index_type M, index_type log2N, real_type* d_Data);
+
+    void sparse_sign_theta(index_type n,
+                           index_type k,
+                           index_type s,
+                           const index_type* labels,
+                           const real_type* signs,
+                           const real_type* input,
+                           real_type* output,
+                           real_type* work,
+                           int max_threads);
+
+    void sparse_sign_theta_block(index_type n,
+                                 index_type k,
+                                 index_type s,
+                                 index_type num_vecs,
+                                 const index_type* labels,
+                                 const real_type* signs,
+                                 const real_type* input,
+                                 real_type* output,
+                                 real_type* work,
+                                 int max_threads);
   }
 }
 
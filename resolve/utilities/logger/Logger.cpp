@@ -4,6 +4,10 @@
  * @author Slaven Peles <peless@ornl.org>
  */
 
+#include <condition_variable>
+#include <cstdint>
+#include <string>
+#include <thread>
 
 #include <resolve/Common.hpp>
 #include "Logger.hpp"
@@ -12,8 +16,236 @@ namespace ReSolve
 {
   namespace io
   {
+    /**
+     * @brief Stream buffer that passes complete lines to Logger output.
+     * 
+     * Text is collected until a newline is written or the stream is
+     * flushed. Remaining text is written out when the buffer is destroyed,
+     * i.e. when the owning thread exits.
+     */
+    class LineBuffer : public std::streambuf
+    {
+      public:
+        LineBuffer() = default;
+
+        ~LineBuffer()
+        {
+          flushLines(true);
+        }
+
+      protected:
+        int_type overflow(int_type c) override
+        {
+          if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            line_.push_back(traits_type::to_char_type(c));
+            if (traits_type::to_char_type(c) == '\n') {
+              flushLines(false);
+            }
+          }
+          return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+          line_.append(s, static_cast<std::size_t>(n));
+          flushLines(false);
+          return n;
+        }
+
+        int sync() override
+        {
+          flushLines(true);
+          return 0;
+        }
+
+      private:
+        /// Writes complete lines, or all text if `all` is true.
+        void flushLines(bool all)
+        {
+          std::size_t size = all ? line_.size() : line_.rfind('\n') + 1;
+          if (size == 0 || line_.empty()) {
+            return;
+          }
+          Logger::write(line_.data(), size, all);
+          line_.erase(0, size);
+        }
+
+        std::string line_;
+    };
+
+    namespace
+    {
+      /**
+       * @brief Writes lines queued by logging threads to Logger output on
+       * a background thread.
+       *
+       * Logging threads push lines to a lock-free stack. The writer takes
+       * the whole stack at once, reverses it to restore the order in which
+       * lines were pushed, and writes the lines under Logger's lock.
+       */
+      class AsyncWriter
+      {
+        public:
+          using WriteFunction = void (*)(const char* text, std::size_t size, bool flush);
+
+          ~AsyncWriter()
+          {
+            stop();
+          }
+
+          bool isRunning() const
+          {
+            return running_.load(std::memory_order_acquire);
+          }
+
+          /// Starts the writer thread, which passes lines to `write`.
+          void start(WriteFunction write)
+          {
+            if (isRunning()) {
+              return;
+            }
+            write_ = write;
+            stop_.store(false);
+            running_.store(true, std::memory_order_release);
+            thread_ = std::thread([this]() { run(); });
+          }
+
+          /// Writes all queued lines and stops the writer thread.
+          void stop()
+          {
+            if (!isRunning()) {
+              return;
+            }
+            {
+              std::lock_guard<std::mutex> lock(wake_mutex_);
+              stop_.store(true);
+            }
+            wake_.notify_one();
+            thread_.join();
+            {
+              std::lock_guard<std::mutex> lock(done_mutex_);
+              running_.store(false, std::memory_order_release);
+            }
+            done_.notify_all();
+            // Lines pushed while the writer was stopping
+            drain();
+          }
+
+          /// Queues a line. Does not block.
+          void push(const char* text, std::size_t size, bool flush)
+          {
+            Node* node = new Node;
+            node->text.assign(text, size);
+            node->flush = flush;
+            node->next = head_.load(std::memory_order_relaxed);
+            while (!head_.compare_exchange_weak(node->next, node,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+            }
+            num_pushed_.fetch_add(1, std::memory_order_relaxed);
+            // Wake up the writer if it may be waiting for an empty queue.
+            // Taking the mutex orders the push with the writer's check of
+            // the queue, so the notification cannot be missed.
+            if (node->next == nullptr) {
+              {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+              }
+              wake_.notify_one();
+            }
+          }
+
+          /// Waits until all lines queued before this call are written.
+          void flush()
+          {
+            const std::uint64_t target = num_pushed_.load();
+            std::unique_lock<std::mutex> lock(done_mutex_);
+            done_.wait(lock, [this, target]() {
+              return !isRunning() || num_written_.load() >= target;
+            });
+          }
+
+        private:
+          struct Node
+          {
+            std::string text;
+            bool flush{false};
+            Node* next{nullptr};
+          };
+
+          void run()
+          {
+            while (true) {
+              if (drain() == 0) {
+                if (stop_.load()) {
+                  break;
+                }
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                wake_.wait(lock, [this]() {
+                  return stop_.load() || head_.load() != nullptr;
+                });
+              }
+            }
+          }
+
+          /// Writes queued lines oldest first, returns the number written.
+          std::size_t drain()
+          {
+            Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+            Node* ordered = nullptr;
+            while (node != nullptr) {
+              Node* next = node->next;
+              node->next = ordered;
+              ordered = node;
+              node = next;
+            }
+            std::size_t count = 0;
+            while (ordered != nullptr) {
+              Node* next = ordered->next;
+              write_(ordered->text.data(), ordered->text.size(), ordered->flush || next == nullptr);
+              delete ordered;
+              ordered = next;
+              ++count;
+            }
+            if (count > 0) {
+              {
+                std::lock_guard<std::mutex> lock(done_mutex_);
+                num_written_.fetch_add(count);
+              }
+              done_.notify_all();
+            }
+            return count;
+          }
+
+          std::atomic<Node*> head_{nullptr};
+          std::atomic<std::uint64_t> num_pushed_{0};
+          std::atomic<std::uint64_t> num_written_{0};
+          std::atomic<bool> running_{false};
+          std::atomic<bool> stop_{false};
+          std::thread thread_;
+          std::mutex wake_mutex_;
+          std::condition_variable wake_;   ///< signals queued lines or stop
+          std::mutex done_mutex_;
+          std::condition_variable done_;   ///< signals written lines or stop
+          WriteFunction write_{nullptr};
+      };
+
+      /// Output streams owned by a thread
+      struct ThreadStreams
+      {
+        LineBuffer buffer;
+        std::ostream output{&buffer};
+        std::ostream nullstream{nullptr}; ///< stream to null device
+      };
+
+      ThreadStreams& threadStreams()
+      {
+        thread_local ThreadStreams streams;
+        return streams;
+      }
+    }
+
     /// @brief Default verbosity is to print error and warning messages
-    Logger::Verbosity Logger::verbosity_ = Logger::WARNINGS;
+    std::atomic<int> Logger::verbosity_(Logger::WARNINGS);
 
     /// @brief Default output is standard output
     std::ostream* Logger::logger_ = &std::cout;
@@ -21,135 +253,97 @@ namespace ReSolve
     /// @brief User provided output file stream
     std::ofstream Logger::file_;
 
-    /// @brief Stream to null device
-    std::ostream Logger::nullstream_(nullptr);
-
-    /// @brief Auxiliary vector of output streams
-    std::vector<std::ostream*> Logger::tmp_;
+    /// @brief Serializes writes to output and changes of output
+    std::mutex Logger::mutex_;
 
-    /// @brief Vector of different output streams
-    std::vector<std::ostream*> Logger::output_streams_(Logger::init());
+    namespace
+    {
+      /// Background writer, stopped before Logger's output is destroyed
+      AsyncWriter async_writer;
+    }
 
     /**
      * @brief Sets verbosity level
      * 
-     * @pre `output_streams_` vector is allocated 
-     * @post Verbosity level is set to user supplied value `v` and outputs
-     * for `output_streams_` are set accordingly.
+     * @post Verbosity level is set to user supplied value `v`. Messages of
+     * level <= `v` are directed to selected output, all others are sent to
+     * null device.
      */
     void Logger::setVerbosity(Verbosity v)
     {
-      verbosity_ = v;
-      updateVerbosity(output_streams_);
+      verbosity_.store(v);
     }
 
     /// @brief Gets verbosity level
     Logger::Verbosity Logger::verbosity()
     {
-      return verbosity_;
-    }
-
-    /**
-     * @brief Private method to update verbosity.
-     * 
-     * This function directs each output stream <= `verbosity_` to user
-     * selected output and sets all others to null device. Each output stream
-     * corresponds to different verbosity level.
-     * 
-     * @param[in] output_streams - vector of pointers to output streams
-     * 
-     * @pre Vector `output_streams` is allocated and correctly initialized.
-     * @post All streams `output_stream_[i]`, where `i <= verbosity_` are
-     * directed to stream `logger_`. The rest are sent to null device
-     * (not printed).
-     */
-    void Logger::updateVerbosity(std::vector<std::ostream*>& output_streams)
-    {
-      for (std::size_t i = NONE; i <= EVERYTHING; ++i)
-      {
-        output_streams[i] = i > verbosity_ ? &nullstream_ : logger_;
-      }
-    }
-
-    /**
-     * @brief Delivers default values for output streams.
-     */
-    std::vector<std::ostream*>& Logger::init()
-    {
-      tmp_.resize(Logger::EVERYTHING + 1);
-      updateVerbosity(tmp_);
-      return tmp_;
+      return static_cast<Verbosity>(verbosity_.load());
     }
 
     /**
      * @brief Returns reference to output stream for error messages.
      * 
-     * @return Reference to error messages stream in `output_streams_`.
-     * 
-     * @pre `output_streams_` vector is allocated and correctly initialized.
+     * @return Reference to calling thread's stream for error messages.
      */
     std::ostream& Logger::error()
     {
       using namespace colors;
-      *(output_streams_[ERRORS]) << "[" << RED << "ERROR" << CLEAR << "] ";
-      return *(output_streams_[ERRORS]);
+      std::ostream& out = stream(ERRORS);
+      out << "[" << RED << "ERROR" << CLEAR << "] ";
+      return out;
     }
 
     /**
      * @brief Returns reference to output stream for warning messages.
      * 
-     * @return Reference to warning messages stream in `output_streams_`.
-     * 
-     * @pre `output_streams_` vector is allocated and correctly initialized.
+     * @return Reference to calling thread's stream for warning messages.
      */
     std::ostream& Logger::warning()
     {
       using namespace colors;
-      *(output_streams_[WARNINGS]) << "[" << YELLOW << "WARNING" << CLEAR << "] ";
-      return *(output_streams_[WARNINGS]);
+      std::ostream& out = stream(WARNINGS);
+      out << "[" << YELLOW << "WARNING" << CLEAR << "] ";
+      return out;
     }
 
     /**
      * @brief Returns reference to analysis summary messages output stream.
      * 
-     * @return Reference to analysis summary messages stream in `output_streams_`.
-     * 
-     * @pre `output_streams_` vector is allocated and correctly initialized.
+     * @return Reference to calling thread's stream for summary messages.
      */
     std::ostream& Logger::summary()
     {
-      *(output_streams_[SUMMARY]) << "[SUMMARY] ";
-      return *(output_streams_[SUMMARY]);
+      std::ostream& out = stream(SUMMARY);
+      out << "[SUMMARY] ";
+      return out;
     }
 
     /**
      * @brief Returns reference to output stream for all other messages.
      * 
-     * @return Reference to output stream to miscellaneous messages
-     * in `output_streams_`.
-     * 
-     * @pre `output_streams_` vector is allocated and correctly initialized.
+     * @return Reference to calling thread's stream for miscellaneous
+     * messages.
      */
     std::ostream& Logger::misc()
     {
-      *(output_streams_[EVERYTHING]) << "[MESSAGE] ";
-      return *(output_streams_[EVERYTHING]);
+      std::ostream& out = stream(EVERYTHING);
+      out << "[MESSAGE] ";
+      return out;
     }
 
     /**
-     * @brief Open file `filename` and update outputs for different verbosities
-     * streams.
+     * @brief Open file `filename` and direct output to it.
      * 
      * @param[in] filename - The name of the output file.
      * 
-     * @pre `output_streams_` vector is allocated and correctly initialized.
      * @post All active streams are directed to user supplied file `filename`.
      */
     void Logger::openOutputFile(std::string filename)
     {
+      flush();
+      std::lock_guard<std::mutex> lock(mutex_);
       file_.open(filename);
       logger_ = &file_;
-      updateVerbosity(output_streams_);
     }
 
     /**
@@ -160,14 +354,15 @@ namespace ReSolve
      * 
      * @param[in] out - User provided output stream.
      * 
-     * @pre `output_streams_` vector is allocated and correctly initialized.
-     * @post All active streams (`output_streams_[i]` where `i <= verbosity_`)
-     * are set to user provided `out` output stream.
+     * @post Messages of level <= verbosity are written to `out`. Text
+     * logged by the calling thread before this call is written to the
+     * previous output.
      */
     void Logger::setOutput(std::ostream& out)
     {
+      flush();
+      std::lock_guard<std::mutex> lock(mutex_);
       logger_ = &out;
-      updateVerbosity(output_streams_);
     }
 
     /**
@@ -179,9 +374,91 @@ namespace ReSolve
      */
     void Logger::closeOutputFile()
     {
+      flush();
+      std::lock_guard<std::mutex> lock(mutex_);
       file_.close();
       logger_ = &std::cout;
-      updateVerbosity(output_streams_);
+    }
+
+    /**
+     * @brief Turns asynchronous output on or off.
+     * 
+     * In asynchronous mode, a background thread writes complete lines to
+     * the output, so logging does not wait for the output stream. Turning
+     * it off writes all queued lines before returning. Output is
+     * synchronous by default.
+     * 
+     * @pre No other thread logs while the mode is changed.
+     */
+    void Logger::setAsynchronous(bool async)
+    {
+      threadStreams().output.flush();
+      if (async) {
+        async_writer.start(&Logger::writeOutput);
+      } else {
+        async_writer.stop();
+      }
+    }
+
+    bool Logger::isAsynchronous()
+    {
+      return async_writer.isRunning();
+    }
+
+    /**
+     * @brief Writes text logged by the calling thread, and waits until
+     * queued lines are written in asynchronous mode.
+     */
+    void Logger::flush()
+    {
+      threadStreams().output.flush();
+      async_writer.flush();
+    }
+
+    /**
+     * @brief Returns calling thread's stream for messages of given level.
+     * 
+     * Messages above the verbosity level go to the thread's null stream.
+     */
+    std::ostream& Logger::stream(Verbosity level)
+    {
+      ThreadStreams& streams = threadStreams();
+      if (static_cast<int>(level) > verbosity_.load(std::memory_order_relaxed)) {
+        return streams.nullstream;
+      }
+      return streams.output;
+    }
+
+    /**
+     * @brief Writes text to output, or queues it in asynchronous mode.
+     * 
+     * @param[in] text  - text to write, typically complete lines
+     * @param[in] size  - number of characters to write
+     * @param[in] flush - whether to flush the output
+     */
+    void Logger::write(const char* text, std::size_t size, bool flush)
+    {
+      if (async_writer.isRunning()) {
+        async_writer.push(text, size, flush);
+        return;
+      }
+      writeOutput(text, size, flush);
+    }
+
+    /**
+     * @brief Writes text to output under lock.
+     * 
+     * @param[in] text  - text to write, typically complete lines
+     * @param[in] size  - number of characters to write
+     * @param[in] flush - whether to flush the output
+     */
+    void Logger::writeOutput(const char* text, std::size_t size, bool flush)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      logger_->write(text, static_cast<std::streamsize>(size));
+      if (flush) {
+        logger_->flush();
+      }
     }
 
   } // namespace io
@@ -4,19 +4,42 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 #include <vector>
 
 namespace ReSolve
 {
   namespace io
   {
+    class LineBuffer;
+
     /**
      * @brief Class that manages and logs outputs from Re::Solve code.
      * 
      * All methods and data in this class are static.
      * 
+     * Logging is thread-safe. Each thread writes messages to its own
+     * stream, which buffers text until the end of a line or until it is
+     * flushed, and then writes the whole line to the output under a lock.
+     * Lines logged concurrently from different threads therefore do not
+     * interleave. Verbosity and output may be changed while other threads
+     * log; lines that are not yet complete go to the new output.
+     * 
+     * Formatting a message costs time even when the message is discarded,
+     * so messages in performance critical code should be logged with
+     * RESOLVE_LOG_ERROR, RESOLVE_LOG_WARNING, RESOLVE_LOG_SUMMARY or
+     * RESOLVE_LOG_MISC macros, which evaluate the message only if its
+     * level is enabled.
+     * 
+     * In asynchronous mode, complete lines are passed to a background
+     * thread through a lock-free queue, so logging threads do not wait for
+     * the output.
+     * 
+     * @pre Output stream set by setOutput() outlives all logging to it.
      */
     class Logger
     {
@@ -38,19 +61,45 @@ namespace ReSolve
         static void closeOutputFile();
         static void setVerbosity(Verbosity v);
         static Verbosity verbosity();
+        static void setAsynchronous(bool async);
+        static bool isAsynchronous();
+        static void flush();
 
-        static std::vector<std::ostream*>& init();
+        /// True if messages of given level are written to the output.
+        static bool isEnabled(Verbosity level)
+        {
+          return static_cast<int>(level) <= verbosity_.load(std::memory_order_relaxed);
+        }
 
       private:
-        static void updateVerbosity(std::vector<std::ostream*>& output_streams);
+        friend class LineBuffer;
+
+        static std::ostream& stream(Verbosity level);
+        static void write(const char* text, std::size_t size, bool flush);
+        static void writeOutput(const char* text, std::size_t size, bool flush);
 
       private:
-        static std::ostream nullstream_;
+        static std::mutex mutex_;        ///< guards output
         static std::ofstream file_;
         static std::ostream* logger_;
-        static std::vector<std::ostream*> output_streams_;
-        static std::vector<std::ostream*> tmp_;
-        static Verbosity verbosity_;
+        static std::atomic<int> verbosity_;
     };
   } // namespace io
 } //namespace ReSolve
+
+/// Messages above this level are removed at compile time.
+#ifndef RESOLVE_LOG_MAX_VERBOSITY
+#define RESOLVE_LOG_MAX_VERBOSITY 4
+#endif
+
+// Stream to Logger only if the level is enabled, e.g.
+// RESOLVE_LOG_MISC << "residual " << rnorm << "\n";
+// The message is not evaluated otherwise.
+#define RESOLVE_LOG_IF_ENABLED_(level)                               \
+  if (!(RESOLVE_LOG_MAX_VERBOSITY >= ::ReSolve::io::Logger::level && \
+        ::ReSolve::io::Logger::isEnabled(::ReSolve::io::Logger::level))) {} else
+
+#define RESOLVE_LOG_ERROR   RESOLVE_LOG_IF_ENABLED_(ERRORS)     ::ReSolve::io::Logger::error()
+#define RESOLVE_LOG_WARNING RESOLVE_LOG_IF_ENABLED_(WARNINGS)   ::ReSolve::io::Logger::warning()
+#define RESOLVE_LOG_SUMMARY RESOLVE_LOG_IF_ENABLED_(SUMMARY)    ::ReSolve::io::Logger::summary()
+#define RESOLVE_LOG_MISC    RESOLVE_LOG_IF_ENABLED_(EVERYTHING) ::ReSolve::io::Logger::misc()
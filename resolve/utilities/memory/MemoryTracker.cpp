@@ -0,0 +1,159 @@
+/**
+ * @file MemoryTracker.cpp
+ * @brief Implementation of process-wide memory accounting.
+ *
+ */
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include "MemoryTracker.hpp"
+
+namespace ReSolve
+{
+  namespace memory
+  {
+    namespace
+    {
+      /// Current and peak bytes of one memory space
+      struct Counter
+      {
+        std::atomic<std::size_t> bytes{0};
+        std::atomic<std::size_t> peak{0};
+
+        void add(std::size_t n)
+        {
+          std::size_t current = bytes.fetch_add(n) + n;
+          std::size_t previous = peak.load();
+          while (current > previous && !peak.compare_exchange_weak(previous, current)) {
+          }
+        }
+
+        void subtract(std::size_t n)
+        {
+          // Never wrap around, even if a release is counted twice
+          std::size_t previous = bytes.load();
+          while (!bytes.compare_exchange_weak(previous, (previous > n) ? previous - n : 0)) {
+          }
+        }
+      };
+
+      struct Registry
+      {
+        Counter counters[2]; ///< indexed by MemorySpace
+        std::mutex mutex;
+        std::unordered_map<const void*, std::size_t> device_arrays;
+      };
+
+      Registry& registry()
+      {
+        static Registry instance;
+        return instance;
+      }
+    }
+
+    /**
+     * @brief Counts bytes allocated in a memory space.
+     *
+     * @param[in] memspace - HOST or DEVICE
+     * @param[in] bytes    - number of bytes allocated
+     */
+    void MemoryTracker::allocate(MemorySpace memspace, std::size_t bytes)
+    {
+      if (bytes > 0) {
+        registry().counters[memspace].add(bytes);
+      }
+    }
+
+    /**
+     * @brief Counts bytes released in a memory space.
+     *
+     * @param[in] memspace - HOST or DEVICE
+     * @param[in] bytes    - number of bytes released
+     */
+    void MemoryTracker::deallocate(MemorySpace memspace, std::size_t bytes)
+    {
+      if (bytes > 0) {
+        registry().counters[memspace].subtract(bytes);
+      }
+    }
+
+    /**
+     * @brief Records a device array, so that its size is known when it is
+     * deleted.
+     *
+     * @param[in] ptr   - device pointer
+     * @param[in] bytes - size of the array in bytes
+     */
+    void MemoryTracker::addDeviceArray(const void* ptr, std::size_t bytes)
+    {
+      if (ptr == nullptr) {
+        return;
+      }
+      Registry& r = registry();
+      std::size_t replaced = 0;
+      {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::size_t& size = r.device_arrays[ptr];
+        replaced = size;
+        size = bytes;
+      }
+      deallocate(DEVICE, replaced);
+      allocate(DEVICE, bytes);
+    }
+
+    /**
+     * @brief Releases a device array recorded by addDeviceArray. Pointers
+     * that were not recorded are ignored.
+     *
+     * @param[in] ptr - device pointer
+     */
+    void MemoryTracker::removeDeviceArray(const void* ptr)
+    {
+      if (ptr == nullptr) {
+        return;
+      }
+      Registry& r = registry();
+      std::size_t bytes = 0;
+      {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto it = r.device_arrays.find(ptr);
+        if (it == r.device_arrays.end()) {
+          return;
+        }
+        bytes = it->second;
+        r.device_arrays.erase(it);
+      }
+      deallocate(DEVICE, bytes);
+    }
+
+    /// Bytes currently held in host and device memory.
+    MemoryUsage MemoryTracker::getUsage()
+    {
+      Registry& r = registry();
+      MemoryUsage usage;
+      usage.host_bytes   = r.counters[HOST].bytes.load();
+      usage.device_bytes = r.counters[DEVICE].bytes.load();
+      return usage;
+    }
+
+    /// Largest number of bytes held since start or the last reset.
+    MemoryUsage MemoryTracker::getHighWaterMark()
+    {
+      Registry& r = registry();
+      MemoryUsage usage;
+      usage.host_bytes   = r.counters[HOST].peak.load();
+      usage.device_bytes = r.counters[DEVICE].peak.load();
+      return usage;
+    }
+
+    /// Resets high-water marks to the current usage.
+    void MemoryTracker::resetHighWaterMark()
+    {
+      Registry& r = registry();
+      for (Counter& counter : r.counters) {
+        counter.peak.store(counter.bytes.load());
+      }
+    }
+  } // namespace memory
+} // namespace ReSolve
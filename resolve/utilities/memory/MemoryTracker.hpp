@@ -0,0 +1,69 @@
+/**
+ * @file MemoryTracker.hpp
+ * @brief Accounting of host and device memory held by Re::Solve objects.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include <resolve/MemorySpace.hpp>
+
+namespace ReSolve
+{
+  namespace memory
+  {
+    /// Bytes held in host and device memory.
+    struct MemoryUsage
+    {
+      std::size_t host_bytes{0};
+      std::size_t device_bytes{0};
+
+      std::size_t getBytes(MemorySpace memspace) const
+      {
+        return (memspace == HOST) ? host_bytes : device_bytes;
+      }
+
+      MemoryUsage& operator+=(const MemoryUsage& other)
+      {
+        host_bytes   += other.host_bytes;
+        device_bytes += other.device_bytes;
+        return *this;
+      }
+
+      /// Elementwise maximum, used to update high-water marks.
+      void updateMax(const MemoryUsage& other)
+      {
+        host_bytes   = std::max(host_bytes, other.host_bytes);
+        device_bytes = std::max(device_bytes, other.device_bytes);
+      }
+    };
+
+    /**
+     * @brief Process-wide count of bytes held in host and device memory,
+     * with high-water marks.
+     *
+     * Device memory is counted by MemoryHandler, which records the size of
+     * each device allocation and releases it when the array is deleted.
+     * Host memory is counted for data owned by vectors and sparse matrices.
+     * Host workspaces that solvers allocate directly are not counted here;
+     * they are reported by the solvers' getMemoryUsage() methods.
+     *
+     * @note All methods can be called concurrently from any thread.
+     */
+    class MemoryTracker
+    {
+      public:
+        static void allocate(MemorySpace memspace, std::size_t bytes);
+        static void deallocate(MemorySpace memspace, std::size_t bytes);
+
+        static void addDeviceArray(const void* ptr, std::size_t bytes);
+        static void removeDeviceArray(const void* ptr);
+
+        static MemoryUsage getUsage();
+        static MemoryUsage getHighWaterMark();
+        static void resetHighWaterMark();
+    };
+  } // namespace memory
+} // namespace ReSolve
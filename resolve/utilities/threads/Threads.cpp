@@ -0,0 +1,240 @@
+/**
+ * @file Threads.cpp
+ * @brief Implementation of host threading utilities.
+ * 
+ */
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Threads.hpp"
+
+namespace ReSolve
+{
+  namespace threads
+  {
+    namespace
+    {
+      /**
+       * @brief Initial number of threads.
+       * 
+       * Taken from the `RESOLVE_NUM_THREADS` environment variable if set,
+       * otherwise the number of hardware threads is used.
+       */
+      int defaultNumThreads()
+      {
+        const char* env = std::getenv("RESOLVE_NUM_THREADS");
+        if (env != nullptr) {
+          int n = std::atoi(env);
+          if (n > 0) {
+            return n;
+          }
+        }
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw > 0 ? static_cast<int>(hw) : 1;
+      }
+
+      std::atomic<int>& numThreads()
+      {
+        static std::atomic<int> num_threads(defaultNumThreads());
+        return num_threads;
+      }
+
+      /// Completion counter shared by the members of one team.
+      struct TeamState
+      {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int remaining{0};
+      };
+
+      /**
+       * @brief Pool of persistent worker threads.
+       * 
+       * Each worker runs one team member at a time. Idle workers wait on
+       * their own condition variable until a task is assigned to them.
+       * Workers are created on demand and live until the program exits.
+       */
+      class ThreadPool
+      {
+        public:
+          ThreadPool() = default;
+
+          ~ThreadPool()
+          {
+            for (auto& worker : workers_) {
+              {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                worker->stop = true;
+              }
+              worker->cv.notify_one();
+            }
+            for (auto& worker : workers_) {
+              worker->thread.join();
+            }
+          }
+
+          void run(int num_threads, const std::function<void(int)>& task)
+          {
+            TeamState team;
+            team.remaining = num_threads - 1;
+
+            for (int tid = 1; tid < num_threads; ++tid) {
+              Worker* worker = acquire();
+              {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                worker->task = &task;
+                worker->tid  = tid;
+                worker->team = &team;
+              }
+              worker->cv.notify_one();
+            }
+
+            task(0);
+
+            std::unique_lock<std::mutex> lock(team.mutex);
+            team.cv.wait(lock, [&team] { return team.remaining == 0; });
+          }
+
+        private:
+          struct Worker
+          {
+            std::thread thread;
+            std::mutex mutex;
+            std::condition_variable cv;
+            const std::function<void(int)>* task{nullptr};
+            int tid{0};
+            TeamState* team{nullptr};
+            bool stop{false};
+          };
+
+          /// Takes an idle worker, or starts a new one if all are busy.
+          Worker* acquire()
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idle_.empty()) {
+              Worker* worker = idle_.back();
+              idle_.pop_back();
+              return worker;
+            }
+            workers_.emplace_back(new Worker());
+            Worker* worker = workers_.back().get();
+            worker->thread = std::thread(&ThreadPool::loop, this, worker);
+            return worker;
+          }
+
+          void release(Worker* worker)
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.push_back(worker);
+          }
+
+          void loop(Worker* worker)
+          {
+            std::unique_lock<std::mutex> lock(worker->mutex);
+            while (true) {
+              worker->cv.wait(lock, [worker] { return worker->stop || worker->task != nullptr; });
+              if (worker->task == nullptr) {
+                return;
+              }
+              const std::function<void(int)>* task = worker->task;
+              TeamState* team = worker->team;
+              const int tid = worker->tid;
+              worker->task = nullptr;
+              worker->team = nullptr;
+              lock.unlock();
+
+              (*task)(tid);
+
+              // Return to the idle list before signaling completion, so
+              // the next team started by the caller can reuse this worker.
+              release(worker);
+              {
+                std::lock_guard<std::mutex> team_lock(team->mutex);
+                if (--team->remaining == 0) {
+                  team->cv.notify_one();
+                }
+              }
+              lock.lock();
+            }
+          }
+
+          std::mutex mutex_;
+          std::vector<std::unique_ptr<Worker>> workers_;
+          std::vector<Worker*> idle_;
+      };
+
+      ThreadPool& pool()
+      {
+        static ThreadPool thread_pool;
+        return thread_pool;
+      }
+    }
+
+    int getNumThreads()
+    {
+      return numThreads().load();
+    }
+
+    void setNumThreads(int num_threads)
+    {
+      numThreads().store(num_threads > 0 ? num_threads : 1);
+    }
+
+    /**
+     * @brief Number of threads to use for a loop.
+     * 
+     * @param[in] length    - number of loop iterations
+     * @param[in] min_chunk - minimum number of iterations per thread
+     * 
+     * @return int - number of threads, at least 1
+     */
+    int getNumThreads(index_type length, index_type min_chunk)
+    {
+      if (min_chunk < 1) {
+        min_chunk = 1;
+      }
+      index_type max_threads = length / min_chunk;
+      int num_threads = getNumThreads();
+      if (max_threads < num_threads) {
+        num_threads = static_cast<int>(max_threads);
+      }
+      return num_threads > 0 ? num_threads : 1;
+    }
+
+    void runTeam(int num_threads, const std::function<void(int)>& task)
+    {
+      if (num_threads <= 1) {
+        task(0);
+        return;
+      }
+      pool().run(num_threads, task);
+    }
+
+    Barrier::Barrier(int num_threads)
+      : num_threads_(num_threads > 0 ? num_threads : 1)
+    {
+    }
+
+    /**
+     * @brief Blocks until all threads in the team have called `wait`.
+     * 
+     * Writes made by any thread before the barrier are visible to all
+     * threads after it.
+     */
+    void Barrier::wait()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      const unsigned long generation = generation_;
+      if (++count_ == num_threads_) {
+        ++generation_;
+        count_ = 0;
+        cv_.notify_all();
+      } else {
+        cv_.wait(lock, [this, generation] { return generation != generation_; });
+      }
+    }
+  } // namespace threads
+} // namespace ReSolve
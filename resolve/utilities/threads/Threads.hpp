@@ -0,0 +1,112 @@
+/**
+ * @file Threads.hpp
+ * @brief Minimal host threading support for CPU kernels.
+ * 
+ */
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <resolve/Common.hpp>
+
+namespace ReSolve
+{
+  namespace threads
+  {
+    /// Number of host threads used by CPU kernels.
+    int getNumThreads();
+
+    /// Sets number of host threads used by CPU kernels.
+    void setNumThreads(int num_threads);
+
+    /// Number of threads to use for a loop of given length.
+    int getNumThreads(index_type length, index_type min_chunk);
+
+    /**
+     * @brief Reusable barrier for a fixed team of threads.
+     * 
+     * Used by CPU kernels that keep a team of threads alive across several
+     * dependent phases (e.g. level-scheduled factorizations).
+     */
+    class Barrier
+    {
+      public:
+        explicit Barrier(int num_threads);
+        ~Barrier() = default;
+
+        void wait();
+
+      private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        int num_threads_;
+        int count_{0};
+        unsigned long generation_{0};
+    };
+
+    /**
+     * @brief Runs `task(tid)` for tid in [0, num_threads) concurrently.
+     * 
+     * The calling thread runs `task(0)`, the others are run by persistent
+     * worker threads, so no threads are created in steady state. Each team
+     * member gets a thread of its own, so team members may synchronize
+     * with each other (e.g. using `Barrier`). Calls may be nested; the
+     * pool grows if all workers are busy.
+     * 
+     * @param[in] num_threads - team size
+     * @param[in] task        - function called with the thread ID
+     */
+    void runTeam(int num_threads, const std::function<void(int)>& task);
+
+    /**
+     * @brief Splits range [begin, end) into `num_threads` contiguous chunks
+     * and runs them concurrently.
+     * 
+     * The calling thread processes the first chunk. Thread IDs passed to
+     * the function are in the range [0, num_threads), so they can be used
+     * to index per-thread workspaces. With one thread the function is
+     * called inline and the thread pool is not involved.
+     * 
+     * @tparam Function - callable with signature
+     *                    `void(int tid, index_type lo, index_type hi)`
+     * 
+     * @param[in] num_threads - number of threads to use
+     * @param[in] begin       - first index in the range
+     * @param[in] end         - one past the last index in the range
+     * @param[in] f           - function applied to each chunk
+     */
+    template <typename Function>
+    void parallelFor(int num_threads, index_type begin, index_type end, Function f)
+    {
+      if (num_threads <= 1) {
+        f(0, begin, end);
+        return;
+      }
+
+      const index_type chunk = (end - begin + num_threads - 1) / num_threads;
+      runTeam(num_threads, [&](int tid) {
+        const index_type lo = (begin + tid * chunk < end) ? (begin + tid * chunk) : end;
+        const index_type hi = (lo + chunk < end) ? (lo + chunk) : end;
+        f(tid, lo, hi);
+      });
+    }
+
+    /**
+     * @brief Runs loop over [begin, end) concurrently, using at most one
+     * thread per `min_chunk` indices.
+     * 
+     * If the range is shorter than two chunks, the function is called
+     * inline and no threads are created.
+     * 
+     * @return int - number of threads used
+     */
+    template <typename Function>
+    int parallelRange(index_type begin, index_type end, index_type min_chunk, Function f)
+    {
+      const int num_threads = getNumThreads(end - begin, min_chunk);
+      parallelFor(num_threads, begin, end, f);
+      return num_threads;
+    }
+  } // namespace threads
+} // namespace ReSolve
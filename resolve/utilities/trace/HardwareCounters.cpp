@@ -0,0 +1,458 @@
+/**
+ * @file HardwareCounters.cpp
+ * @brief Implementation of hardware performance counters of traced ranges.
+ *
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "HardwareCounters.hpp"
+
+namespace ReSolve
+{
+  namespace trace
+  {
+    namespace
+    {
+      using clock = std::chrono::steady_clock;
+
+      /// Counted hardware events
+      enum Event {cycles = 0, instructions, cache_references, cache_misses, NUM_EVENTS};
+
+      /// Counter values at one point in time
+      struct Sample
+      {
+        clock::time_point time;
+        double values[NUM_EVENTS];
+        double time_enabled{0.0}; ///< nanoseconds the counters were enabled
+        double time_running{0.0}; ///< nanoseconds the counters were counting
+        bool valid{false};
+      };
+
+      /// Open range
+      struct Frame
+      {
+        const char* name;
+        Sample start;
+      };
+
+      /// Totals of one range on one thread
+      struct Accumulator
+      {
+        std::uint64_t num_calls{0};
+        std::uint64_t num_measured{0};
+        double time{0.0};
+        double values[NUM_EVENTS] = {0.0, 0.0, 0.0, 0.0};
+      };
+
+      /// Counters and ranges of one thread
+      struct ThreadCounters
+      {
+        int fds[NUM_EVENTS] = {-1, -1, -1, -1};
+        int index[NUM_EVENTS] = {-1, -1, -1, -1}; ///< position in group read, -1 if not counted
+        int num_open{0};
+        bool opened{false};
+        bool in_use{true};
+        std::vector<Frame> stack;
+        std::map<const char*, Accumulator> regions;
+      };
+
+#ifdef __linux__
+      int openEvent(std::uint64_t config, int group_fd)
+      {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = config;
+        attr.disabled       = (group_fd == -1) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+      }
+#endif
+
+      /**
+       * @brief Opens counters of the calling thread as one group, so they
+       * are read together. Events the CPU does not support are skipped.
+       */
+      void openCounters(ThreadCounters& counters)
+      {
+        counters.opened = true;
+#ifdef __linux__
+        static const std::uint64_t configs[NUM_EVENTS] = {PERF_COUNT_HW_CPU_CYCLES,
+                                                          PERF_COUNT_HW_INSTRUCTIONS,
+                                                          PERF_COUNT_HW_CACHE_REFERENCES,
+                                                          PERF_COUNT_HW_CACHE_MISSES};
+        const int leader = openEvent(configs[cycles], -1);
+        if (leader < 0) {
+          return;
+        }
+        counters.fds[cycles]   = leader;
+        counters.index[cycles] = 0;
+        counters.num_open      = 1;
+        for (int e = cycles + 1; e < NUM_EVENTS; ++e) {
+          const int fd = openEvent(configs[e], leader);
+          if (fd >= 0) {
+            counters.fds[e]   = fd;
+            counters.index[e] = counters.num_open++;
+          }
+        }
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+      }
+
+      void closeCounters(ThreadCounters& counters)
+      {
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+#ifdef __linux__
+          if (counters.fds[e] >= 0) {
+            close(counters.fds[e]);
+          }
+#endif
+          counters.fds[e]   = -1;
+          counters.index[e] = -1;
+        }
+        counters.num_open = 0;
+        counters.opened   = false;
+      }
+
+      Sample readSample(const ThreadCounters& counters)
+      {
+        Sample sample;
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+          sample.values[e] = 0.0;
+        }
+#ifdef __linux__
+        if (counters.num_open > 0) {
+          // Group read format: number of events, time enabled, time running, values
+          std::uint64_t data[3 + NUM_EVENTS];
+          const ssize_t size = read(counters.fds[cycles], data, sizeof(data));
+          if (size >= static_cast<ssize_t>((3 + counters.num_open) * sizeof(std::uint64_t)) &&
+              data[0] == static_cast<std::uint64_t>(counters.num_open)) {
+            sample.time_enabled = static_cast<double>(data[1]);
+            sample.time_running = static_cast<double>(data[2]);
+            for (int e = 0; e < NUM_EVENTS; ++e) {
+              if (counters.index[e] >= 0) {
+                sample.values[e] = static_cast<double>(data[3 + counters.index[e]]);
+              }
+            }
+            sample.valid = true;
+          }
+        }
+#endif
+        sample.time = clock::now();
+        return sample;
+      }
+
+      /// Counters of all threads that entered ranges
+      struct Registry
+      {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadCounters>> threads;
+        std::atomic<bool> enabled{false};
+
+        std::shared_ptr<ThreadCounters> acquire()
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          for (auto& counters : threads) {
+            if (!counters->in_use) {
+              counters->in_use = true;
+              return counters;
+            }
+          }
+          std::shared_ptr<ThreadCounters> counters = std::make_shared<ThreadCounters>();
+          threads.push_back(counters);
+          return counters;
+        }
+
+        /// Counters belong to the exiting thread, so they are closed.
+        /// Accumulated values are kept for the report.
+        void release(const std::shared_ptr<ThreadCounters>& counters)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          closeCounters(*counters);
+          counters->stack.clear();
+          counters->in_use = false;
+        }
+      };
+
+      Registry& registry()
+      {
+        static Registry instance;
+        return instance;
+      }
+
+      /// Thread's handle to its counters, returned to the registry at thread exit
+      struct ThreadHandle
+      {
+        std::shared_ptr<ThreadCounters> counters{registry().acquire()};
+
+        ~ThreadHandle()
+        {
+          registry().release(counters);
+        }
+      };
+
+      ThreadCounters& threadCounters()
+      {
+        static thread_local ThreadHandle handle;
+        ThreadCounters& counters = *handle.counters;
+        if (!counters.opened) {
+          openCounters(counters);
+        }
+        return counters;
+      }
+
+      /// Bytes moved to or from memory per last level cache miss.
+      double cacheLineSize()
+      {
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_LINESIZE)
+        const long size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+        if (size > 0) {
+          return static_cast<double>(size);
+        }
+#endif
+        return 64.0;
+      }
+
+      /**
+       * @brief Enables counters if `RESOLVE_COUNTERS_FILE` is set and writes
+       * the report to that file when the program exits.
+       */
+      struct ExitWriter
+      {
+        ExitWriter()
+        {
+          // Create the registry first, so it is destroyed after the writer.
+          registry();
+          const char* filename = std::getenv("RESOLVE_COUNTERS_FILE");
+          if (filename != nullptr && *filename != '\0') {
+            HardwareCounters::setEnabled(true);
+          }
+        }
+
+        ~ExitWriter()
+        {
+          const char* filename = std::getenv("RESOLVE_COUNTERS_FILE");
+          if (filename != nullptr && *filename != '\0') {
+            HardwareCounters::writeReport(filename);
+          }
+        }
+      };
+
+      ExitWriter exit_writer;
+    }
+
+    /**
+     * @brief Reads counters at the beginning of a range on the calling
+     * thread.
+     *
+     * @param[in] name - range name, must outlive the counters
+     */
+    void HardwareCounters::begin(const char* name)
+    {
+      if (!registry().enabled.load(std::memory_order_relaxed)) {
+        return;
+      }
+      ThreadCounters& counters = threadCounters();
+      Frame frame;
+      frame.name  = name;
+      frame.start = readSample(counters);
+      counters.stack.push_back(frame);
+    }
+
+    /**
+     * @brief Reads counters at the end of the innermost open range on the
+     * calling thread and adds the difference to the range totals.
+     *
+     * @param[in] name - range name, must outlive the counters
+     */
+    void HardwareCounters::end(const char* /* name */)
+    {
+      if (!registry().enabled.load(std::memory_order_relaxed)) {
+        return;
+      }
+      ThreadCounters& counters = threadCounters();
+      if (counters.stack.empty()) {
+        return;
+      }
+      const Sample end = readSample(counters);
+      const Frame& frame = counters.stack.back();
+
+      Accumulator& region = counters.regions[frame.name];
+      region.num_calls++;
+      region.time += std::chrono::duration<double>(end.time - frame.start.time).count();
+      const double running = end.time_running - frame.start.time_running;
+      if (frame.start.valid && end.valid && running > 0.0) {
+        // Scale values if the counters were multiplexed with other events
+        const double scale = (end.time_enabled - frame.start.time_enabled) / running;
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+          region.values[e] += (end.values[e] - frame.start.values[e]) * scale;
+        }
+        region.num_measured++;
+      }
+      counters.stack.pop_back();
+    }
+
+    /**
+     * @brief Turns reading counters on or off. Counters are disabled by
+     * default.
+     *
+     * @pre No thread is in a range.
+     */
+    void HardwareCounters::setEnabled(bool enabled)
+    {
+      registry().enabled.store(enabled);
+    }
+
+    bool HardwareCounters::isEnabled()
+    {
+      return registry().enabled.load();
+    }
+
+    /// True if hardware counters can be read on the calling thread.
+    bool HardwareCounters::isAvailable()
+    {
+      return threadCounters().num_open > 0;
+    }
+
+    /**
+     * @brief Returns totals of all ranges, summed over threads and sorted
+     * by range name.
+     */
+    std::vector<RegionCounters> HardwareCounters::getReport()
+    {
+      Registry& reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+
+      const double line_size = cacheLineSize();
+      std::map<std::string, RegionCounters> totals;
+      for (auto& counters : reg.threads) {
+        for (auto& entry : counters->regions) {
+          const Accumulator& acc = entry.second;
+          RegionCounters& region = totals[entry.first];
+          region.num_calls        += acc.num_calls;
+          region.num_measured     += acc.num_measured;
+          region.time             += acc.time;
+          region.cycles           += acc.values[cycles];
+          region.instructions     += acc.values[instructions];
+          region.cache_references += acc.values[cache_references];
+          region.cache_misses     += acc.values[cache_misses];
+          region.bytes            += acc.values[cache_misses] * line_size;
+        }
+      }
+
+      std::vector<RegionCounters> report;
+      report.reserve(totals.size());
+      for (auto& entry : totals) {
+        entry.second.name = entry.first;
+        report.push_back(entry.second);
+      }
+      return report;
+    }
+
+    /**
+     * @brief Returns totals of the range with given name.
+     *
+     * @return Totals, with zero calls if the range was not entered
+     */
+    RegionCounters HardwareCounters::getRegion(const std::string& name)
+    {
+      for (const RegionCounters& region : getReport()) {
+        if (region.name == name) {
+          return region;
+        }
+      }
+      RegionCounters region;
+      region.name = name;
+      return region;
+    }
+
+    /// Discards all accumulated values.
+    void HardwareCounters::clear()
+    {
+      Registry& reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      for (auto& counters : reg.threads) {
+        counters->regions.clear();
+        counters->stack.clear();
+      }
+    }
+
+    /**
+     * @brief Writes totals of all ranges as a table.
+     *
+     * Counter columns are `n/a` for ranges where hardware counters could
+     * not be read.
+     *
+     * @param[out] out - output stream
+     */
+    void HardwareCounters::writeReport(std::ostream& out)
+    {
+      const std::vector<RegionCounters> report = getReport();
+
+      std::ostringstream table;
+      table << std::left << std::setw(40) << "range"
+            << std::right << std::setw(10) << "calls"
+            << std::setw(13) << "time [s]"
+            << std::setw(14) << "cycles"
+            << std::setw(14) << "instructions"
+            << std::setw(7) << "IPC"
+            << std::setw(14) << "LLC misses"
+            << std::setw(10) << "GB/s" << "\n";
+      for (const RegionCounters& region : report) {
+        table << std::left << std::setw(40) << region.name
+              << std::right << std::setw(10) << region.num_calls
+              << std::setw(13) << std::scientific << std::setprecision(4) << region.time;
+        if (region.num_measured == 0) {
+          table << std::setw(14) << "n/a" << std::setw(14) << "n/a" << std::setw(7) << "n/a"
+                << std::setw(14) << "n/a" << std::setw(10) << "n/a" << "\n";
+          continue;
+        }
+        table << std::setw(14) << std::setprecision(4) << region.cycles
+              << std::setw(14) << region.instructions
+              << std::setw(7) << std::fixed << std::setprecision(2) << region.getIpc()
+              << std::setw(14) << std::scientific << std::setprecision(4) << region.cache_misses
+              << std::setw(10) << std::fixed << std::setprecision(2) << region.getBandwidth() << "\n";
+      }
+      out << table.str();
+    }
+
+    /**
+     * @brief Writes totals of all ranges to a file.
+     *
+     * @param[in] filename - name of the output file
+     *
+     * @return 0 if successful, 1 if the file cannot be written
+     */
+    int HardwareCounters::writeReport(const std::string& filename)
+    {
+      std::ofstream file(filename);
+      if (!file) {
+        return 1;
+      }
+      writeReport(file);
+      return file.good() ? 0 : 1;
+    }
+  } // namespace trace
+} // namespace ReSolve
@@ -0,0 +1,86 @@
+/**
+ * @file HardwareCounters.hpp
+ * @brief Hardware performance counters of profiled code ranges.
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ReSolve
+{
+  namespace trace
+  {
+    /// Counters accumulated over all calls of one range.
+    struct RegionCounters
+    {
+      std::string name;
+      std::uint64_t num_calls{0};
+      std::uint64_t num_measured{0}; ///< calls with hardware counter values
+      double time{0.0};              ///< seconds
+      double cycles{0.0};
+      double instructions{0.0};
+      double cache_references{0.0};
+      double cache_misses{0.0};      ///< last level cache misses
+      double bytes{0.0};             ///< memory traffic estimated from cache misses
+
+      /// Instructions per cycle.
+      double getIpc() const
+      {
+        return (cycles > 0.0) ? instructions / cycles : 0.0;
+      }
+
+      /// Memory bandwidth in GB/s estimated from cache misses.
+      double getBandwidth() const
+      {
+        return (time > 0.0) ? bytes / time * 1e-9 : 0.0;
+      }
+    };
+
+    /**
+     * @brief Reads CPU cycles, instructions and cache misses with Linux
+     * `perf_event_open` at the beginning and end of traced ranges, and
+     * accumulates them per range name.
+     *
+     * Ranges are the ones annotated with RESOLVE_RANGE_PUSH/POP and
+     * RESOLVE_RANGE_SCOPE, so counters are only collected in builds with
+     * host tracer profiling enabled. Counters are off by default. If the
+     * `RESOLVE_COUNTERS_FILE` environment variable is set, counters are
+     * enabled at startup and the report is written to that file when the
+     * program exits.
+     *
+     * Counters count user space events of the calling thread. Values of
+     * nested ranges are inclusive. When the kernel multiplexes counters,
+     * values are scaled by the fraction of time they were counting. Memory
+     * traffic is estimated as last level cache misses times cache line
+     * size, so it does not include prefetched lines.
+     *
+     * When hardware counters are not available, e.g. in virtual machines
+     * or with restrictive `/proc/sys/kernel/perf_event_paranoid`, only
+     * number of calls and time are recorded.
+     *
+     * @note begin() and end() can be called concurrently from any threads.
+     * All other methods must be called while no thread is in a range.
+     */
+    class HardwareCounters
+    {
+      public:
+        static void begin(const char* name);
+        static void end(const char* name);
+
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+        static bool isAvailable();
+
+        static std::vector<RegionCounters> getReport();
+        static RegionCounters getRegion(const std::string& name);
+        static void clear();
+
+        static void writeReport(std::ostream& out);
+        static int writeReport(const std::string& filename);
+    };
+  } // namespace trace
+} // namespace ReSolve
@@ -0,0 +1,345 @@
+/**
+ * @file Tracer.cpp
+ * @brief Implementation of host tracer.
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "HardwareCounters.hpp"
+#include "Tracer.hpp"
+
+namespace ReSolve
+{
+  namespace trace
+  {
+    namespace
+    {
+      using clock = std::chrono::steady_clock;
+
+      /// Begin or end of a range
+      struct Event
+      {
+        const char* name;
+        std::int64_t time; ///< nanoseconds since the tracer was created
+        char phase;        ///< 'B' for begin, 'E' for end
+      };
+
+      /**
+       * @brief Ring buffer of events recorded by one thread.
+       *
+       * Only the owning thread writes events. The event count is atomic, so
+       * it can be read while the thread records. Event storage itself is
+       * read or resized only while no thread records events.
+       */
+      struct ThreadBuffer
+      {
+        std::vector<Event> events;
+        std::atomic<std::uint64_t> count{0}; ///< number of events recorded since last clear
+        int tid{0};
+        bool in_use{true};
+      };
+
+      /// Buffers of all threads that recorded events
+      struct Registry
+      {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::size_t capacity{1 << 16};
+        clock::time_point start{clock::now()};
+        std::atomic<bool> enabled{true};
+
+        std::shared_ptr<ThreadBuffer> acquire()
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          for (auto& buffer : buffers) {
+            if (!buffer->in_use) {
+              buffer->in_use = true;
+              return buffer;
+            }
+          }
+          std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+          buffer->events.resize(capacity);
+          buffer->tid = static_cast<int>(buffers.size());
+          buffers.push_back(buffer);
+          return buffer;
+        }
+
+        void release(const std::shared_ptr<ThreadBuffer>& buffer)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          buffer->in_use = false;
+        }
+      };
+
+      Registry& registry()
+      {
+        static Registry instance;
+        return instance;
+      }
+
+      /// Thread's handle to its buffer, returned to the registry at thread exit
+      struct ThreadHandle
+      {
+        std::shared_ptr<ThreadBuffer> buffer{registry().acquire()};
+
+        ~ThreadHandle()
+        {
+          registry().release(buffer);
+        }
+      };
+
+      void record(const char* name, char phase)
+      {
+        Registry& reg = registry();
+        if (!reg.enabled.load(std::memory_order_relaxed)) {
+          return;
+        }
+        std::int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - reg.start).count();
+
+        static thread_local ThreadHandle handle;
+        ThreadBuffer& buffer = *handle.buffer;
+        if (buffer.events.empty()) {
+          return;
+        }
+        const std::uint64_t count = buffer.count.load(std::memory_order_relaxed);
+        buffer.events[count % buffer.events.size()] = {name, time, phase};
+        buffer.count.store(count + 1, std::memory_order_release);
+      }
+
+      /// Writes string as JSON string literal.
+      void writeString(std::ostream& out, const char* s)
+      {
+        out << '"';
+        for (; *s != '\0'; ++s) {
+          char c = *s;
+          if (c == '"' || c == '\\') {
+            out << '\\' << c;
+          } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+            out << code;
+          } else {
+            out << c;
+          }
+        }
+        out << '"';
+      }
+
+      /**
+       * @brief Writes trace to file named in `RESOLVE_TRACE_FILE` when the
+       * program exits.
+       */
+      struct ExitWriter
+      {
+        ExitWriter()
+        {
+          // Create the registry first, so it is destroyed after the writer.
+          registry();
+        }
+
+        ~ExitWriter()
+        {
+          const char* filename = std::getenv("RESOLVE_TRACE_FILE");
+          if (filename != nullptr && *filename != '\0') {
+            Tracer::write(filename);
+          }
+        }
+      };
+
+      ExitWriter exit_writer;
+    }
+
+    /**
+     * @brief Records the beginning of a range on the calling thread.
+     *
+     * @param[in] name - range name, must outlive the tracer
+     */
+    void Tracer::begin(const char* name)
+    {
+      HardwareCounters::begin(name);
+      record(name, 'B');
+    }
+
+    /**
+     * @brief Records the end of the innermost open range on the calling
+     * thread.
+     *
+     * @param[in] name - range name, must outlive the tracer
+     */
+    void Tracer::end(const char* name)
+    {
+      record(name, 'E');
+      HardwareCounters::end(name);
+    }
+
+    /// Turns recording of events on or off. Tracer is enabled by default.
+    void Tracer::setEnabled(bool enabled)
+    {
+      registry().enabled.store(enabled);
+    }
+
+    bool Tracer::isEnabled()
+    {
+      return registry().enabled.load();
+    }
+
+    /**
+     * @brief Sets number of events kept per thread. Recorded events are
+     * discarded.
+     *
+     * @pre No thread records events, since thread buffers are reallocated.
+     */
+    void Tracer::setBufferCapacity(std::size_t num_events)
+    {
+      Registry& reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      reg.capacity = num_events;
+      for (auto& buffer : reg.buffers) {
+        buffer->events.assign(num_events, Event());
+        buffer->count.store(0);
+      }
+    }
+
+    std::size_t Tracer::getBufferCapacity()
+    {
+      Registry& reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      return reg.capacity;
+    }
+
+    /// Number of events kept in all thread buffers.
+    std::size_t Tracer::getNumEvents()
+    {
+      Registry& reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      std::size_t num_events = 0;
+      for (auto& buffer : reg.buffers) {
+        num_events += static_cast<std::size_t>(std::min<std::uint64_t>(buffer->count.load(), buffer->events.size()));
+      }
+      return num_events;
+    }
+
+    /// Number of events overwritten because thread buffers were full.
+    std::size_t Tracer::getNumDropped()
+    {
+      Registry& reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      std::size_t num_dropped = 0;
+      for (auto& buffer : reg.buffers) {
+        const std::uint64_t count = buffer->count.load();
+        if (count > buffer->events.size()) {
+          num_dropped += static_cast<std::size_t>(count - buffer->events.size());
+        }
+      }
+      return num_dropped;
+    }
+
+    /**
+     * @brief Discards all recorded events.
+     *
+     * @pre No thread records events.
+     */
+    void Tracer::clear()
+    {
+      Registry& reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      for (auto& buffer : reg.buffers) {
+        buffer->count.store(0);
+      }
+    }
+
+    /**
+     * @brief Writes recorded events as Chrome trace event JSON.
+     *
+     * Events are written per thread, oldest first. End events whose begin
+     * event was overwritten are skipped, so the ranges in the output are
+     * properly nested. Ranges still open are closed with end events at
+     * the time of the write.
+     *
+     * @param[out] out - output stream
+     *
+     * @pre No thread records events. Ranges may be left open.
+     */
+    void Tracer::write(std::ostream& out)
+    {
+      Registry& reg = registry();
+      std::lock_guard<std::mutex> lock(reg.mutex);
+      const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - reg.start).count();
+
+      auto writeEvent = [&out](const char* name, char phase, std::int64_t time, int tid) {
+        char ts[32];
+        std::snprintf(ts, sizeof(ts), "%.3f", static_cast<double>(time) * 1e-3);
+        out << ",\n{\"name\":";
+        writeString(out, name);
+        out << ",\"cat\":\"resolve\",\"ph\":\"" << phase
+            << "\",\"ts\":" << ts
+            << ",\"pid\":1,\"tid\":" << tid << "}";
+      };
+
+      std::uint64_t num_dropped = 0;
+      bool first = true;
+      out << "{\"traceEvents\":[";
+      for (auto& buffer : reg.buffers) {
+        const std::uint64_t capacity = buffer->events.size();
+        const std::uint64_t count = buffer->count.load(std::memory_order_acquire);
+        if (count == 0 || capacity == 0) {
+          continue;
+        }
+        const std::uint64_t begin = (count > capacity) ? count - capacity : 0;
+        num_dropped += begin;
+
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+
+        std::vector<const char*> open_ranges;
+        for (std::uint64_t k = begin; k < count; ++k) {
+          const Event& event = buffer->events[k % capacity];
+          if (event.phase == 'E') {
+            if (open_ranges.empty()) {
+              continue;
+            }
+            open_ranges.pop_back();
+          } else {
+            open_ranges.push_back(event.name);
+          }
+          writeEvent(event.name, event.phase, event.time, buffer->tid);
+        }
+        while (!open_ranges.empty()) {
+          writeEvent(open_ranges.back(), 'E', now, buffer->tid);
+          open_ranges.pop_back();
+        }
+      }
+      out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":"
+          << num_dropped << "}}\n";
+    }
+
+    /**
+     * @brief Writes recorded events as Chrome trace event JSON file.
+     *
+     * @param[in] filename - name of the output file
+     *
+     * @return 0 if successful, 1 if the file cannot be written
+     */
+    int Tracer::write(const std::string& filename)
+    {
+      std::ofstream file(filename);
+      if (!file) {
+        return 1;
+      }
+      write(file);
+      return file.good() ? 0 : 1;
+    }
+  } // namespace trace
+} // namespace ReSolve
@@ -0,0 +1,57 @@
+/**
+ * @file Tracer.hpp
+ * @brief Host tracer recording timed ranges for Chrome trace viewers.
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace ReSolve
+{
+  namespace trace
+  {
+    /**
+     * @brief Records begin and end events of named code ranges on host
+     * threads and exports them in Chrome trace event format, which can be
+     * viewed in Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+     *
+     * Each thread records events into its own ring buffer, so recording
+     * takes no locks. When a buffer is full, the oldest events of that
+     * thread are overwritten. Buffers of threads that have exited are
+     * reused by new threads, so memory use is bounded by the number of
+     * concurrently running threads.
+     *
+     * If the `RESOLVE_TRACE_FILE` environment variable is set, the trace
+     * is written to that file when the program exits.
+     *
+     * Range names are stored as pointers, so they must be string literals
+     * or other strings that live until the trace is written.
+     *
+     * @note begin() and end() can be called concurrently from any threads,
+     * and so can the event counters getNumEvents() and getNumDropped().
+     * Methods that read or reset event storage, i.e. write(), clear() and
+     * setBufferCapacity(), must be called while no thread records events.
+     */
+    class Tracer
+    {
+      public:
+        static void begin(const char* name);
+        static void end(const char* name);
+
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+        static void setBufferCapacity(std::size_t num_events);
+        static std::size_t getBufferCapacity();
+
+        static std::size_t getNumEvents();
+        static std::size_t getNumDropped();
+        static void clear();
+
+        static void write(std::ostream& out);
+        static int write(const std::string& filename);
+    };
+  } // namespace trace
+} // namespace ReSolve
@@ -51,6 +51,7 @@ namespace ReSolve { namespace vector {
   {
     if (owns_cpu_data_) delete [] h_data_;
     if (owns_gpu_data_) mem_.deleteOnDevice(d_data_);
+    memory::MemoryTracker::deallocate(memory::HOST, host_bytes_);
   }
 
 
@@ -183,6 +184,7 @@ namespace ReSolve { namespace vector {
       //allocate first
       h_data_ = new real_type[n_ * k_]; 
       owns_cpu_data_ = true;
+      updateMemoryUsage();
     }
     if ((memspaceOut == memory::DEVICE) && (d_data_ == nullptr)) {
       //allocate first
@@ -288,6 +290,7 @@ namespace ReSolve { namespace vector {
       //allocate first
       h_data_ = new real_type[n_ * k_];
       owns_cpu_data_ = true;
+      updateMemoryUsage();
     }
     if ((memspaceOut == memory::DEVICE) && (d_data_ == nullptr)) {
       //allocate first
@@ -323,6 +326,7 @@ namespace ReSolve { namespace vector {
         delete [] h_data_;
         h_data_ = new real_type[n_ * k_]; 
         owns_cpu_data_ = true;
+        updateMemoryUsage();
         break;
       case DEVICE:
         mem_.deleteOnDevice(d_data_);
@@ -346,6 +350,7 @@ namespace ReSolve { namespace vector {
         if (h_data_ == nullptr) {
           h_data_ = new real_type[n_ * k_]; 
           owns_cpu_data_ = true;
+          updateMemoryUsage();
         }
         mem_.setZeroArrayOnHost(h_data_, n_ * k_);
         break;
@@ -375,6 +380,7 @@ namespace ReSolve { namespace vector {
         if (h_data_ == nullptr) {
           h_data_ = new real_type[n_ * k_]; 
           owns_cpu_data_ = true;
+          updateMemoryUsage();
         }
         mem_.setZeroArrayOnHost(&h_data_[j * n_current_], n_current_);
         break;
@@ -406,6 +412,7 @@ namespace ReSolve { namespace vector {
         if (h_data_ == nullptr) {
           h_data_ = new real_type[n_ * k_]; 
           owns_cpu_data_ = true;
+          updateMemoryUsage();
         }
         mem_.setArrayToConstOnHost(h_data_, C, n_ * k_);
         break;
@@ -436,6 +443,7 @@ namespace ReSolve { namespace vector {
         if (h_data_ == nullptr) {
           h_data_ = new real_type[n_ * k_]; 
           owns_cpu_data_ = true;
+          updateMemoryUsage();
         }
         mem_.setArrayToConstOnHost(&h_data_[n_current_ * j], C, n_current_);
         break;
@@ -550,4 +558,32 @@ namespace ReSolve { namespace vector {
     return 0;
   }
 
+  /**
+   * @brief Bytes of host and device data owned by the vector.
+   */
+  memory::MemoryUsage Vector::getMemoryUsage() const
+  {
+    std::size_t bytes = sizeof(real_type) * static_cast<std::size_t>(n_) * static_cast<std::size_t>(k_);
+    memory::MemoryUsage usage;
+    usage.host_bytes   = (owns_cpu_data_ && h_data_ != nullptr) ? bytes : 0;
+    usage.device_bytes = (owns_gpu_data_ && d_data_ != nullptr) ? bytes : 0;
+    return usage;
+  }
+
+  /**
+   * @brief Reports change of owned host data to the MemoryTracker.
+   *
+   * Device data is counted by the memory handler.
+   */
+  void Vector::updateMemoryUsage()
+  {
+    std::size_t bytes = getMemoryUsage().host_bytes;
+    if (bytes > host_bytes_) {
+      memory::MemoryTracker::allocate(memory::HOST, bytes - host_bytes_);
+    } else {
+      memory::MemoryTracker::deallocate(memory::HOST, host_bytes_ - bytes);
+    }
+    host_bytes_ = bytes;
+  }
+
 }} // namespace ReSolve::vector
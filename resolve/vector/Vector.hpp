@@ -2,6 +2,7 @@
 #include <string>
 #include <resolve/Common.hpp>
 #include <resolve/MemoryUtils.hpp>
+#include <resolve/utilities/memory/MemoryTracker.hpp>
 
 namespace ReSolve { namespace vector {
   /**
@@ -51,8 +52,11 @@ namespace ReSolve { namespace vector {
       real_type* getVectorData(index_type i, memory::MemorySpace memspace); // get ith vector data out of multivector   
       int deepCopyVectorData(real_type* dest, index_type i, memory::MemorySpace memspace);  
       int deepCopyVectorData(real_type* dest, memory::MemorySpace memspace);  //copy FULL multivector 
+      memory::MemoryUsage getMemoryUsage() const;
     
     private:
+      void updateMemoryUsage();
+
       index_type n_{0}; ///< size
       index_type k_{0}; ///< k_ = 1 for vectors and k_>1 for multivectors (multivectors are accessed column-wise). 
       index_type n_current_; ///< if vectors dynamically changes size, "current n_" keeps track of this. Needed for some solver implementations. 
@@ -63,6 +67,7 @@ namespace ReSolve { namespace vector {
 
       bool owns_gpu_data_{false}; ///< data owneship flag for DEVICE data
       bool owns_cpu_data_{false}; ///< data ownership flag for HOST data
+      std::size_t host_bytes_{0}; ///< owned HOST bytes reported to MemoryTracker
 
       MemoryHandler mem_; ///< Device memory manager object
   };
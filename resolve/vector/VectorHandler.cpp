@@ -6,6 +6,7 @@
 #include <resolve/workspace/LinAlgWorkspace.hpp>
 #include <resolve/vector/VectorHandlerImpl.hpp>
 #include <resolve/vector/VectorHandlerCpu.hpp>
+#include <resolve/Profiling.hpp>
 #include "VectorHandler.hpp"
 
 #ifdef RESOLVE_USE_CUDA
@@ -198,6 +199,7 @@ namespace ReSolve {
                            vector::Vector* x,
                            memory::MemorySpace memspace)
   {
+    RESOLVE_RANGE_SCOPE("VectorHandler::gemv");
     using namespace ReSolve::memory;
     switch (memspace) {
       case HOST:
@@ -223,6 +225,7 @@ namespace ReSolve {
    */
   void VectorHandler::massAxpy(index_type size, vector::Vector* alpha, index_type k, vector::Vector* x, vector::Vector* y, memory::MemorySpace memspace)
   {
+    RESOLVE_RANGE_SCOPE("VectorHandler::massAxpy");
     using namespace ReSolve::memory;
     switch (memspace) {
       case HOST:
@@ -250,6 +253,7 @@ namespace ReSolve {
    */
   void VectorHandler::massDot2Vec(index_type size, vector::Vector* V, index_type k, vector::Vector* x, vector::Vector* res, memory::MemorySpace memspace)
   {
+    RESOLVE_RANGE_SCOPE("VectorHandler::massDot2Vec");
     using namespace ReSolve::memory;
     switch (memspace) {
       case HOST:
@@ -15,6 +15,12 @@ namespace ReSolve
 
 
 namespace ReSolve { //namespace vector {
+  /**
+   * @brief Vector operations on CPU and GPU devices.
+   * 
+   * A handler is not thread-safe. Independent handlers with separate
+   * workspaces can be used concurrently from different threads.
+   */
   class VectorHandler { 
     public:
       VectorHandler();
@@ -0,0 +1,174 @@
+/**
+ * @file testKLU_BTF.cpp
+ * @brief Functionality test for KLU with block triangular form.
+ *
+ * Solves two consecutive systems with the same sparsity pattern using KLU
+ * without BTF, with BTF where KLU factorizes blocks, and with BTF where
+ * diagonal blocks are factorized concurrently. The second system is solved
+ * after refactorization.
+ *
+ */
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/matrix/io.hpp>
+#include <resolve/matrix/Coo.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/matrix/MatrixHandler.hpp>
+#include <resolve/vector/VectorHandler.hpp>
+#include <resolve/LinSolverDirectKLU.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+
+using namespace ReSolve::constants;
+using namespace ReSolve::colors;
+
+// Use ReSolve data types.
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+
+static int solveSystems(ReSolve::LinSolverDirectKLU::BtfMode mode,
+                        const std::string& name,
+                        const std::string& data_path);
+
+static real_type relativeResidual(ReSolve::matrix::Csr* A, vector_type* rhs, vector_type* x);
+
+int main(int argc, char *argv[])
+{
+  // Error sum needs to be 0 at the end for test to PASS.
+  // It is a FAIL otheriwse.
+  int error_sum = 0;
+
+  // Input to this code is location of `data` directory where matrix files are stored
+  const std::string data_path = (argc == 2) ? argv[1] : "./";
+
+  error_sum += solveSystems(ReSolve::LinSolverDirectKLU::btf_none,     "none",     data_path);
+  error_sum += solveSystems(ReSolve::LinSolverDirectKLU::btf_serial,   "serial",   data_path);
+  error_sum += solveSystems(ReSolve::LinSolverDirectKLU::btf_parallel, "parallel", data_path);
+
+  if (error_sum == 0) {
+    std::cout << "Test " << GREEN << "PASSED" << CLEAR << "\n\n";
+  } else {
+    std::cout << "Test " << RED << "FAILED" << CLEAR << ", error sum: " << error_sum << "\n\n";
+  }
+
+  return error_sum;
+}
+
+/**
+ * @brief Factorizes the first system and refactorizes the second one with
+ * KLU in selected BTF mode.
+ *
+ * @return int - number of errors detected
+ */
+int solveSystems(ReSolve::LinSolverDirectKLU::BtfMode mode,
+                 const std::string& name,
+                 const std::string& data_path)
+{
+  int error_sum = 0;
+
+  std::string matrixFileName1 = data_path + "data/matrix_ACTIVSg200_AC_10.mtx";
+  std::string matrixFileName2 = data_path + "data/matrix_ACTIVSg200_AC_11.mtx";
+  std::string rhsFileName1    = data_path + "data/rhs_ACTIVSg200_AC_10.mtx.ones";
+  std::string rhsFileName2    = data_path + "data/rhs_ACTIVSg200_AC_11.mtx.ones";
+
+  std::ifstream mat1(matrixFileName1);
+  std::ifstream rhs1_file(rhsFileName1);
+  if (!mat1.is_open() || !rhs1_file.is_open()) {
+    std::cout << "Failed to open file " << matrixFileName1 << " or " << rhsFileName1 << "\n";
+    return 1;
+  }
+  ReSolve::matrix::Coo* A_coo = ReSolve::io::readMatrixFromFile(mat1);
+  ReSolve::matrix::Csr* A = new ReSolve::matrix::Csr(A_coo, ReSolve::memory::HOST);
+  real_type* rhs = ReSolve::io::readRhsFromFile(rhs1_file);
+  mat1.close();
+  rhs1_file.close();
+
+  vector_type vec_rhs(A->getNumRows());
+  vector_type vec_x(A->getNumRows());
+  vec_x.allocate(ReSolve::memory::HOST);
+  vec_rhs.update(rhs, ReSolve::memory::HOST, ReSolve::memory::HOST);
+
+  ReSolve::LinSolverDirectKLU KLU;
+  error_sum += KLU.setBtfMode(mode);
+  error_sum += KLU.setup(A);
+  error_sum += KLU.analyze();
+  error_sum += KLU.factorize();
+  error_sum += KLU.solve(&vec_rhs, &vec_x);
+  real_type rel_res1 = relativeResidual(A, &vec_rhs, &vec_x);
+
+  // Load the second system and refactorize
+  std::ifstream mat2(matrixFileName2);
+  std::ifstream rhs2_file(rhsFileName2);
+  if (!mat2.is_open() || !rhs2_file.is_open()) {
+    std::cout << "Failed to open file " << matrixFileName2 << " or " << rhsFileName2 << "\n";
+    return 1;
+  }
+  ReSolve::io::readAndUpdateMatrix(mat2, A_coo);
+  ReSolve::io::readAndUpdateRhs(rhs2_file, &rhs);
+  mat2.close();
+  rhs2_file.close();
+
+  A->updateFromCoo(A_coo, ReSolve::memory::HOST);
+  vec_rhs.update(rhs, ReSolve::memory::HOST, ReSolve::memory::HOST);
+
+  error_sum += KLU.refactorize();
+  error_sum += KLU.solve(&vec_rhs, &vec_x);
+  real_type rel_res2 = relativeResidual(A, &vec_rhs, &vec_x);
+
+  const ReSolve::LinSolverDirectKLU::BlockStats& stats = KLU.getBlockStats();
+  std::cout << "KLU with BTF mode " << name << ":\n"
+            << "\t Number of diagonal blocks          : " << stats.num_blocks << "\n"
+            << "\t Number of singletons               : " << stats.num_singletons << "\n"
+            << "\t Largest block size                 : " << stats.max_block_size << "\n"
+            << "\t Off-diagonal nonzeros              : " << stats.num_offdiag << "\n"
+            << std::scientific << std::setprecision(16)
+            << "\t ||b-A*x||_2/||b||_2 (factorize)    : " << rel_res1 << "\n"
+            << "\t ||b-A*x||_2/||b||_2 (refactorize)  : " << rel_res2 << "\n";
+
+  if ((stats.num_blocks < 1) || (stats.max_block_size > A->getNumRows())) {
+    std::cout << "Inconsistent block statistics!\n";
+    error_sum++;
+  }
+  if ((mode == ReSolve::LinSolverDirectKLU::btf_none) && (stats.num_blocks != 1)) {
+    std::cout << "Matrix should be a single block when BTF is not used!\n";
+    error_sum++;
+  }
+  if (!std::isfinite(rel_res1) || !std::isfinite(rel_res2)) {
+    std::cout << "Result is not a finite number!\n";
+    error_sum++;
+  }
+  if ((rel_res1 > 1e-14) || (rel_res2 > 1e-14)) {
+    std::cout << "Result inaccurate!\n";
+    error_sum++;
+  }
+
+  delete A_coo;
+  delete A;
+  delete [] rhs;
+
+  return error_sum;
+}
+
+/**
+ * @brief Computes ||b - A x||_2 / ||b||_2 on the host.
+ */
+real_type relativeResidual(ReSolve::matrix::Csr* A, vector_type* rhs, vector_type* x)
+{
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  ReSolve::MatrixHandler matrix_handler(&workspace);
+  ReSolve::VectorHandler vector_handler(&workspace);
+
+  vector_type vec_r(A->getNumRows());
+  vec_r.update(rhs->getData(ReSolve::memory::HOST), ReSolve::memory::HOST, ReSolve::memory::HOST);
+  matrix_handler.setValuesChanged(true, ReSolve::memory::HOST);
+  matrix_handler.matvec(A, x, &vec_r, &ONE, &MINUSONE, "csr", ReSolve::memory::HOST);
+
+  real_type norm_r = std::sqrt(vector_handler.dot(&vec_r, &vec_r, ReSolve::memory::HOST));
+  real_type norm_b = std::sqrt(vector_handler.dot(rhs, rhs, ReSolve::memory::HOST));
+  return norm_r / norm_b;
+}
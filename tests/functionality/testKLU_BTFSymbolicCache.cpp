@@ -0,0 +1,229 @@
+/**
+ * @file testKLU_BTFSymbolicCache.cpp
+ * @brief Functionality test for KLU block triangular form analysis stored
+ * in symbolic analysis cache.
+ *
+ * A block lower triangular matrix is analyzed by KLU with BTF and the
+ * analysis is saved to disk. Another solver restores the analysis from the
+ * file and must find the same block structure. Finally, cached entries are
+ * corrupted before they are restored, in which case KLU must drop them and
+ * analyze the matrix again.
+ *
+ */
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/matrix/MatrixHandler.hpp>
+#include <resolve/vector/VectorHandler.hpp>
+#include <resolve/LinSolverDirectKLU.hpp>
+#include <resolve/SymbolicCache.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+
+using namespace ReSolve::constants;
+using namespace ReSolve::colors;
+
+// Use ReSolve data types.
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+
+// COLAMD ordering
+static const int ordering = 1;
+
+static ReSolve::matrix::Csr* createBlockTriangularMatrix(const std::vector<index_type>& block_sizes);
+static int solveSystem(ReSolve::SymbolicCache* cache,
+                       ReSolve::matrix::Csr* A,
+                       index_type expected_blocks,
+                       const std::string& name);
+static real_type relativeResidual(ReSolve::matrix::Csr* A, vector_type* rhs, vector_type* x);
+
+int main(int, char**)
+{
+  // Error sum needs to be 0 at the end for test to PASS.
+  // It is a FAIL otheriwse.
+  int error_sum = 0;
+
+  const std::string cache_file = "klu_btf_symbolic_cache_test.bin";
+  const std::vector<index_type> block_sizes = {1, 3, 2, 4};
+  const index_type num_blocks = static_cast<index_type>(block_sizes.size());
+
+  ReSolve::matrix::Csr* A = createBlockTriangularMatrix(block_sizes);
+  const index_type  n  = A->getNumRows();
+  const index_type* Ap = A->getRowData(ReSolve::memory::HOST);
+  const index_type* Ai = A->getColData(ReSolve::memory::HOST);
+
+  // Analyze the matrix and save the analysis to disk
+  ReSolve::SymbolicCache cache(4);
+  error_sum += solveSystem(&cache, A, num_blocks, "analyzed");
+  if (cache.size() != 1) {
+    std::cout << "Expected 1 cache entry, got " << cache.size() << "\n";
+    error_sum++;
+  }
+  error_sum += cache.save(cache_file);
+
+  // Another solver restores the analysis from the saved cache
+  ReSolve::SymbolicCache restored(4);
+  error_sum += restored.load(cache_file);
+  error_sum += solveSystem(&restored, A, num_blocks, "analysis from disk");
+  if (restored.getNumHits() != 1) {
+    std::cout << "Analysis loaded from disk was not used\n";
+    error_sum++;
+  }
+
+  // KLU tags cache entries with 2 * ordering + btf
+  const index_type tag = 2 * ordering + 1;
+  const size_t num_scalars = 8;
+  const std::vector<std::string> corruptions = {"duplicate in P",
+                                                "last block past n",
+                                                "negative Lnz"};
+  for (const std::string& corruption : corruptions) {
+    ReSolve::SymbolicCache corrupted(4);
+    error_sum += corrupted.load(cache_file);
+    ReSolve::SymbolicCache::Entry* entry = corrupted.find(tag, n, Ap, Ai);
+    if (entry == nullptr) {
+      std::cout << "Cache entry loaded from disk not found\n";
+      error_sum++;
+      continue;
+    }
+    const std::vector<index_type> ints = entry->ints;
+    const std::vector<real_type> reals = entry->reals;
+    if (corruption == "duplicate in P") {
+      entry->ints[num_scalars + 1] = entry->ints[num_scalars];
+    } else if (corruption == "last block past n") {
+      entry->ints[num_scalars + 2 * n + num_blocks] = n + 1;
+    } else {
+      entry->reals[4] = -1.0;
+    }
+
+    error_sum += solveSystem(&corrupted, A, num_blocks, corruption);
+
+    // The corrupted entry is replaced by a fresh analysis
+    entry = corrupted.find(tag, n, Ap, Ai);
+    if ((corrupted.size() != 1) || (entry == nullptr) ||
+        (entry->ints != ints) || (entry->reals != reals)) {
+      std::cout << "Corrupted cache entry (" << corruption << ") was not replaced\n";
+      error_sum++;
+    }
+  }
+  std::remove(cache_file.c_str());
+
+  if (error_sum == 0) {
+    std::cout << "Test " << GREEN << "PASSED" << CLEAR << "\n\n";
+  } else {
+    std::cout << "Test " << RED << "FAILED" << CLEAR << ", error sum: " << error_sum << "\n\n";
+  }
+
+  delete A;
+
+  return error_sum;
+}
+
+/**
+ * @brief Creates block lower triangular matrix with tridiagonal diagonal
+ * blocks. Each block is coupled to the last row of the previous block.
+ */
+ReSolve::matrix::Csr* createBlockTriangularMatrix(const std::vector<index_type>& block_sizes)
+{
+  std::vector<index_type> rows(1, 0);
+  std::vector<index_type> cols;
+  std::vector<real_type>  vals;
+  index_type begin = 0;
+  for (index_type size : block_sizes) {
+    const index_type end = begin + size;
+    for (index_type i = begin; i < end; ++i) {
+      if (begin > 0) {
+        cols.push_back(begin - 1);
+        vals.push_back(-1.0);
+      }
+      for (index_type j = i - 1; j <= i + 1; ++j) {
+        if (j >= begin && j < end) {
+          cols.push_back(j);
+          vals.push_back(i == j ? 4.0 : -1.0);
+        }
+      }
+      rows.push_back(static_cast<index_type>(cols.size()));
+    }
+    begin = end;
+  }
+
+  ReSolve::matrix::Csr* A = new ReSolve::matrix::Csr(begin, begin, static_cast<index_type>(cols.size()));
+  A->allocateMatrixData(ReSolve::memory::HOST);
+  A->updateData(rows.data(), cols.data(), vals.data(), ReSolve::memory::HOST, ReSolve::memory::HOST);
+  return A;
+}
+
+/**
+ * @brief Analyzes, factorizes and solves the system with KLU in serial BTF
+ * mode using the given symbolic cache.
+ *
+ * @return int - number of errors detected
+ */
+int solveSystem(ReSolve::SymbolicCache* cache,
+                ReSolve::matrix::Csr* A,
+                index_type expected_blocks,
+                const std::string& name)
+{
+  int error_sum = 0;
+
+  vector_type vec_rhs(A->getNumRows());
+  vec_rhs.allocate(ReSolve::memory::HOST);
+  vec_rhs.setToConst(1.0, ReSolve::memory::HOST);
+  vector_type vec_x(A->getNumRows());
+  vec_x.allocate(ReSolve::memory::HOST);
+
+  ReSolve::LinSolverDirectKLU KLU;
+  KLU.setOrdering(ordering);
+  error_sum += KLU.setBtfMode(ReSolve::LinSolverDirectKLU::btf_serial);
+  KLU.setSymbolicCache(cache);
+  error_sum += KLU.setup(A);
+  error_sum += KLU.analyze();
+  error_sum += KLU.factorize();
+  error_sum += KLU.solve(&vec_rhs, &vec_x);
+  real_type rel_res = relativeResidual(A, &vec_rhs, &vec_x);
+
+  const ReSolve::LinSolverDirectKLU::BlockStats& stats = KLU.getBlockStats();
+  std::cout << "KLU with BTF (" << name << "):\n"
+            << "\t Number of diagonal blocks : " << stats.num_blocks << "\n"
+            << std::scientific << std::setprecision(16)
+            << "\t ||b-A*x||_2/||b||_2       : " << rel_res << "\n";
+
+  if (stats.num_blocks != expected_blocks) {
+    std::cout << "Expected " << expected_blocks << " diagonal blocks!\n";
+    error_sum++;
+  }
+  if (!std::isfinite(rel_res)) {
+    std::cout << "Result is not a finite number!\n";
+    error_sum++;
+  }
+  if (rel_res > 1e-14) {
+    std::cout << "Result inaccurate!\n";
+    error_sum++;
+  }
+
+  return error_sum;
+}
+
+/**
+ * @brief Computes ||b - A x||_2 / ||b||_2 on the host.
+ */
+real_type relativeResidual(ReSolve::matrix::Csr* A, vector_type* rhs, vector_type* x)
+{
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  ReSolve::MatrixHandler matrix_handler(&workspace);
+  ReSolve::VectorHandler vector_handler(&workspace);
+
+  vector_type vec_r(A->getNumRows());
+  vec_r.update(rhs->getData(ReSolve::memory::HOST), ReSolve::memory::HOST, ReSolve::memory::HOST);
+  matrix_handler.setValuesChanged(true, ReSolve::memory::HOST);
+  matrix_handler.matvec(A, x, &vec_r, &ONE, &MINUSONE, "csr", ReSolve::memory::HOST);
+
+  real_type norm_r = std::sqrt(vector_handler.dot(&vec_r, &vec_r, ReSolve::memory::HOST));
+  real_type norm_b = std::sqrt(vector_handler.dot(rhs, rhs, ReSolve::memory::HOST));
+  return norm_r / norm_b;
+}
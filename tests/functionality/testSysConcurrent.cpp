@@ -0,0 +1,216 @@
+/**
+ * @file testSysConcurrent.cpp
+ * @brief Stress test for independent SystemSolver instances running
+ * concurrently on host threads.
+ *
+ * Each configuration of a randomized or standard FGMRES solver with ILU0
+ * preconditioner is first run serially. Then several copies of every
+ * configuration run at the same time, each on its own thread with its own
+ * workspace and solver, while another thread logs messages. Sketching
+ * matrices are sampled with a fixed seed, so concurrent runs must
+ * reproduce serial results exactly.
+ *
+ */
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+#include <resolve/SystemSolver.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/utilities/logger/Logger.hpp>
+
+using namespace ReSolve::constants;
+using namespace ReSolve::colors;
+
+// Use ReSolve data types.
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+
+/// Solver configuration and results of a run
+struct Run
+{
+  std::string method;
+  std::string sketch;
+  int status{0};
+  index_type num_iter{0};
+  std::vector<real_type> x;
+};
+
+static void solveSystem(Run& run, index_type N);
+static ReSolve::matrix::Csr* generateMatrix(const index_type N);
+
+int main(int, char**)
+{
+  // Error sum needs to be 0 at the end for test to PASS.
+  // It is a FAIL otheriwse.
+  int error_sum = 0;
+
+  const index_type N = 2000;
+  const int copies = 3;
+  const std::vector<std::pair<std::string, std::string>> configurations = {
+    {"randgmres", "count"},
+    {"randgmres", "fwht"},
+    {"randgmres", "sparse_sign"},
+    {"randgmres", "srht"},
+    {"fgmres",    "none"}
+  };
+
+  // Reference results computed serially
+  std::vector<Run> serial;
+  for (const auto& conf : configurations) {
+    Run run;
+    run.method = conf.first;
+    run.sketch = conf.second;
+    solveSystem(run, N);
+    serial.push_back(run);
+  }
+
+  // Copies of all configurations solved concurrently
+  std::vector<Run> concurrent;
+  for (int c = 0; c < copies; ++c) {
+    for (const Run& ref : serial) {
+      Run run;
+      run.method = ref.method;
+      run.sketch = ref.sketch;
+      concurrent.push_back(run);
+    }
+  }
+
+  // Logging from another thread while solvers run
+  std::ostringstream log;
+  ReSolve::io::Logger::setOutput(log);
+  ReSolve::io::Logger::setVerbosity(ReSolve::io::Logger::WARNINGS);
+  std::atomic<bool> done(false);
+  int num_logged = 0;
+  std::thread logger([&done, &num_logged]() {
+    while (!done.load()) {
+      ReSolve::io::Logger::warning() << "Logging from thread " << num_logged << "\n";
+      ++num_logged;
+    }
+  });
+
+  std::vector<std::thread> workers;
+  for (Run& run : concurrent) {
+    workers.emplace_back(solveSystem, std::ref(run), N);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  done.store(true);
+  logger.join();
+  ReSolve::io::Logger::setOutput(std::cout);
+
+  // Each logged message must be a complete line
+  std::istringstream lines(log.str());
+  std::string line;
+  int num_lines = 0;
+  while (std::getline(lines, line)) {
+    if (line.find("Logging from thread") == std::string::npos &&
+        line.find("Sketching") == std::string::npos) {
+      std::cout << "Garbled log line: " << line << "\n";
+      error_sum++;
+    }
+    ++num_lines;
+  }
+  if (num_lines < num_logged) {
+    std::cout << "Lost log messages: " << num_logged << " logged, "
+              << num_lines << " written\n";
+    error_sum++;
+  }
+
+  // Compare concurrent results with serial results
+  for (size_t i = 0; i < concurrent.size(); ++i) {
+    const Run& run = concurrent[i];
+    const Run& ref = serial[i % serial.size()];
+    error_sum += run.status + ref.status;
+    bool same = (run.num_iter == ref.num_iter) && (run.x == ref.x);
+    std::cout << "\t " << std::setw(10) << run.method << " " << std::setw(12) << run.sketch
+              << ": " << run.num_iter << " iterations, serial " << ref.num_iter
+              << (same ? "" : " -- results differ!") << "\n";
+    if (!same) {
+      error_sum++;
+    }
+  }
+
+  if (error_sum == 0) {
+    std::cout << "Test " << GREEN << "PASSED" << CLEAR << "\n\n";
+  } else {
+    std::cout << "Test " << RED << "FAILED" << CLEAR << ", error sum: " << error_sum << "\n\n";
+  }
+
+  return error_sum;
+}
+
+/// @brief Solves test system with the run configuration in a new solver
+void solveSystem(Run& run, index_type N)
+{
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  workspace.initializeHandles();
+
+  ReSolve::SystemSolver solver(&workspace, "none", "none", run.method, "ilu0", "none");
+  if (run.method == "randgmres") {
+    run.status += solver.setSketchingMethod(run.sketch);
+    run.status += solver.setSketchingSeed(12345);
+  }
+
+  ReSolve::matrix::Csr* A = generateMatrix(N);
+  vector_type vec_rhs(N);
+  vec_rhs.allocate(ReSolve::memory::HOST);
+  real_type* rhs = vec_rhs.getData(ReSolve::memory::HOST);
+  for (index_type i = 0; i < N; ++i) {
+    rhs[i] = (i % 2) ? 1.0 : -111.0;
+  }
+  vec_rhs.setDataUpdated(ReSolve::memory::HOST);
+
+  vector_type vec_x(N);
+  vec_x.allocate(ReSolve::memory::HOST);
+  vec_x.setToZero(ReSolve::memory::HOST);
+
+  solver.getIterativeSolver().setMaxit(2500);
+  solver.getIterativeSolver().setTol(1e-12);
+  run.status += solver.setMatrix(A);
+  solver.getIterativeSolver().setRestart(200);
+  run.status += solver.preconditionerSetup();
+  run.status += solver.solve(&vec_rhs, &vec_x);
+
+  run.num_iter = solver.getIterativeSolver().getNumIter();
+  const real_type* x = vec_x.getData(ReSolve::memory::HOST);
+  run.x.assign(x, x + N);
+
+  delete A;
+}
+
+/// @brief Generates diagonally dominant nonsymmetric N x N test matrix
+ReSolve::matrix::Csr* generateMatrix(const index_type N)
+{
+  const std::vector<index_type> offsets = {-7, -3, -1, 0, 1, 2, 5, 11};
+  const std::vector<real_type>  values  = {1., 3., 2., 30., 5., 7., 2., 4.};
+
+  std::vector<index_type> rows(1, 0);
+  std::vector<index_type> cols;
+  std::vector<real_type>  vals;
+  for (index_type i = 0; i < N; ++i) {
+    for (size_t k = 0; k < offsets.size(); ++k) {
+      const index_type j = i + offsets[k];
+      if (j >= 0 && j < N) {
+        cols.push_back(j);
+        vals.push_back(values[k]);
+      }
+    }
+    rows.push_back(static_cast<index_type>(cols.size()));
+  }
+
+  const index_type NNZ = static_cast<index_type>(cols.size());
+  ReSolve::matrix::Csr* A = new ReSolve::matrix::Csr(N, N, NNZ);
+  A->allocateMatrixData(ReSolve::memory::HOST);
+  A->updateData(rows.data(), cols.data(), vals.data(), ReSolve::memory::HOST, ReSolve::memory::HOST);
+  return A;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file testSysCpuRf.cpp
+ * @brief Functionality test for CPU refactorization in SystemSolver.
+ *
+ * The first system is factorized by KLU. Factors and permutations are then
+ * passed to the level-scheduled CPU refactorization solver, which is used
+ * to refactorize and solve the second system with the same sparsity
+ * pattern.
+ *
+ */
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/matrix/io.hpp>
+#include <resolve/matrix/Coo.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+#include <resolve/SystemSolver.hpp>
+
+using namespace ReSolve::constants;
+using namespace ReSolve::colors;
+
+// Use ReSolve data types.
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+
+int main(int argc, char *argv[])
+{
+  // Error sum needs to be 0 at the end for test to PASS.
+  // It is a FAIL otheriwse.
+  int error_sum = 0;
+
+  // Input to this code is location of `data` directory where matrix files are stored
+  const std::string data_path = (argc == 2) ? argv[1] : "./";
+
+  std::string matrixFileName1 = data_path + "data/matrix_ACTIVSg200_AC_10.mtx";
+  std::string matrixFileName2 = data_path + "data/matrix_ACTIVSg200_AC_11.mtx";
+  std::string rhsFileName1    = data_path + "data/rhs_ACTIVSg200_AC_10.mtx.ones";
+  std::string rhsFileName2    = data_path + "data/rhs_ACTIVSg200_AC_11.mtx.ones";
+
+  // Read first matrix
+  std::ifstream mat1(matrixFileName1);
+  if(!mat1.is_open())
+  {
+    std::cout << "Failed to open file " << matrixFileName1 << "\n";
+    return -1;
+  }
+  ReSolve::matrix::Coo* A_coo = ReSolve::io::readMatrixFromFile(mat1);
+  ReSolve::matrix::Csr* A = new ReSolve::matrix::Csr(A_coo, ReSolve::memory::HOST);
+  mat1.close();
+
+  // Read first rhs vector
+  std::ifstream rhs1_file(rhsFileName1);
+  if(!rhs1_file.is_open())
+  {
+    std::cout << "Failed to open file " << rhsFileName1 << "\n";
+    return -1;
+  }
+  real_type* rhs = ReSolve::io::readRhsFromFile(rhs1_file);
+  rhs1_file.close();
+
+  vector_type vec_rhs(A->getNumRows());
+  vector_type vec_x(A->getNumRows());
+  vec_x.allocate(ReSolve::memory::HOST);
+  vec_rhs.update(rhs, ReSolve::memory::HOST, ReSolve::memory::HOST);
+  vec_rhs.setDataUpdated(ReSolve::memory::HOST);
+
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  workspace.initializeHandles();
+  ReSolve::SystemSolver solver(&workspace, "klu", "cpurf", "cpurf");
+
+  // Solve the first system using KLU
+  error_sum += solver.setMatrix(A);
+  error_sum += solver.analyze();
+  error_sum += solver.factorize();
+  error_sum += solver.solve(&vec_rhs, &vec_x);
+  real_type rel_res1 = solver.getResidualNorm(&vec_rhs, &vec_x);
+
+  // Set up CPU refactorization from KLU factors
+  error_sum += solver.refactorizationSetup();
+
+  // Load the second matrix and rhs
+  std::ifstream mat2(matrixFileName2);
+  if(!mat2.is_open())
+  {
+    std::cout << "Failed to open file " << matrixFileName2 << "\n";
+    return -1;
+  }
+  ReSolve::io::readAndUpdateMatrix(mat2, A_coo);
+  mat2.close();
+
+  std::ifstream rhs2_file(rhsFileName2);
+  if(!rhs2_file.is_open())
+  {
+    std::cout << "Failed to open file " << rhsFileName2 << "\n";
+    return -1;
+  }
+  ReSolve::io::readAndUpdateRhs(rhs2_file, &rhs);
+  rhs2_file.close();
+
+  A->updateFromCoo(A_coo, ReSolve::memory::HOST);
+  vec_rhs.update(rhs, ReSolve::memory::HOST, ReSolve::memory::HOST);
+
+  // Refactorize and solve the second system on CPU
+  error_sum += solver.refactorize();
+  error_sum += solver.solve(&vec_rhs, &vec_x);
+  real_type rel_res2 = solver.getResidualNorm(&vec_rhs, &vec_x);
+
+  std::cout << "Results: \n"
+            << std::scientific << std::setprecision(16)
+            << "\t ||b-A*x||_2/||b||_2 (KLU factorization)  : " << rel_res1 << "\n"
+            << "\t ||b-A*x||_2/||b||_2 (CPU refactorization): " << rel_res2 << "\n";
+
+  if (!std::isfinite(rel_res1) || !std::isfinite(rel_res2)) {
+    std::cout << "Result is not a finite number!\n";
+    error_sum++;
+  }
+  if ((rel_res1 > 1e-14) || (rel_res2 > 1e-14)) {
+    std::cout << "Result inaccurate!\n";
+    error_sum++;
+  }
+
+  if (error_sum == 0) {
+    std::cout << "Test " << GREEN << "PASSED" << CLEAR << "\n\n";
+  } else {
+    std::cout << "Test " << RED << "FAILED" << CLEAR << ", error sum: " << error_sum << "\n\n";
+  }
+
+  delete A_coo;
+  delete A;
+  delete [] rhs;
+
+  return error_sum;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file testSysMixedPrecision.cpp
+ * @brief Functionality test for mixed precision mode of SystemSolver.
+ *
+ * ILU0 preconditioner is computed and applied in single precision, while
+ * FGMRES recovers double precision accuracy of the solution. The result is
+ * compared against the run with the double precision preconditioner.
+ *
+ */
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/vector/VectorHandler.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+#include <resolve/SystemSolver.hpp>
+
+using namespace ReSolve::constants;
+using namespace ReSolve::colors;
+
+// Use ReSolve data types.
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+
+static ReSolve::matrix::Csr* createConvectionDiffusionMatrix(index_type grid);
+static int solveSystem(ReSolve::matrix::Csr* A,
+                       vector_type* vec_rhs,
+                       const std::string& precision,
+                       real_type tol,
+                       index_type& num_iter);
+
+int main(int, char**)
+{
+  // Error sum needs to be 0 at the end for test to PASS.
+  // It is a FAIL otheriwse.
+  int error_sum = 0;
+
+  // Small nonsymmetric system, so the test runs quickly
+  const index_type grid = 40;
+  ReSolve::matrix::Csr* A = createConvectionDiffusionMatrix(grid);
+
+  vector_type vec_rhs(A->getNumRows());
+  vec_rhs.allocate(ReSolve::memory::HOST);
+  vec_rhs.setToConst(ONE, ReSolve::memory::HOST);
+
+  const real_type tol = 1e-12;
+  index_type iter_double = 0;
+  index_type iter_single = 0;
+
+  std::cout << "Mixed precision test (ILU0 preconditioned FGMRES):\n";
+  error_sum += solveSystem(A, &vec_rhs, "double", tol, iter_double);
+  error_sum += solveSystem(A, &vec_rhs, "single", tol, iter_single);
+
+  // Single precision preconditioner should not slow down convergence much
+  if (static_cast<real_type>(iter_single) > 1.5 * static_cast<real_type>(iter_double)) {
+    std::cout << "Single precision preconditioner needs " << iter_single
+              << " iterations, double precision needs " << iter_double << "!\n";
+    error_sum++;
+  }
+
+  if (error_sum == 0) {
+    std::cout << "Test " << GREEN << "PASSED" << CLEAR << "\n\n";
+  } else {
+    std::cout << "Test " << RED << "FAILED" << CLEAR << ", error sum: " << error_sum << "\n\n";
+  }
+
+  delete A;
+
+  return error_sum;
+}
+
+/**
+ * @brief Solves the system with FGMRES and ILU0 of given precision.
+ *
+ * @return int - number of errors detected
+ */
+int solveSystem(ReSolve::matrix::Csr* A,
+                vector_type* vec_rhs,
+                const std::string& precision,
+                real_type tol,
+                index_type& num_iter)
+{
+  int error_sum = 0;
+
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  workspace.initializeHandles();
+  ReSolve::VectorHandler vector_handler(&workspace);
+
+  ReSolve::SystemSolver solver(&workspace, "none", "none", "fgmres", "ilu0", "none");
+  error_sum += solver.setPreconditionerPrecision(precision);
+
+  vector_type vec_x(A->getNumRows());
+  vec_x.allocate(ReSolve::memory::HOST);
+  vec_x.setToZero(ReSolve::memory::HOST);
+
+  solver.getIterativeSolver().setMaxit(2500);
+  solver.getIterativeSolver().setTol(tol);
+
+  error_sum += solver.setMatrix(A);
+  solver.getIterativeSolver().setRestart(60);
+  error_sum += solver.preconditionerSetup();
+  error_sum += solver.solve(vec_rhs, &vec_x);
+
+  real_type norm_b = std::sqrt(vector_handler.dot(vec_rhs, vec_rhs, ReSolve::memory::HOST));
+  real_type final_norm = solver.getIterativeSolver().getFinalResidualNorm();
+  real_type rel_res = solver.getResidualNorm(vec_rhs, &vec_x);
+  num_iter = solver.getIterativeSolver().getNumIter();
+
+  std::cout << "\t Preconditioner precision:             " << precision << "\n"
+            << std::scientific << std::setprecision(16)
+            << "\t Final relative residual norm:   ||b-Ax||_2/||b||_2   : "
+            << final_norm/norm_b << " \n"
+            << "\t Recomputed relative residual norm                    : "
+            << rel_res << " \n"
+            << "\t Number of iterations                                 : "
+            << num_iter << "\n";
+
+  if (!std::isfinite(rel_res)) {
+    std::cout << "Result is not a finite number!\n";
+    error_sum++;
+  }
+  if (rel_res > (10.0 * tol)) {
+    std::cout << "Result inaccurate!\n";
+    error_sum++;
+  }
+
+  return error_sum;
+}
+
+/**
+ * @brief Creates 5-point upwind discretization of a convection-diffusion
+ * operator on grid x grid mesh.
+ *
+ * The matrix is nonsymmetric and diagonally dominant.
+ */
+ReSolve::matrix::Csr* createConvectionDiffusionMatrix(index_type grid)
+{
+  const index_type n = grid * grid;
+  const real_type convection = 0.5;
+  std::vector<index_type> rows(1, 0);
+  std::vector<index_type> cols;
+  std::vector<real_type>  vals;
+  for (index_type i = 0; i < n; ++i) {
+    const index_type row = i / grid;
+    const index_type col = i % grid;
+    if (row > 0) {
+      cols.push_back(i - grid);
+      vals.push_back(-1.0 - convection);
+    }
+    if (col > 0) {
+      cols.push_back(i - 1);
+      vals.push_back(-1.0 - convection);
+    }
+    cols.push_back(i);
+    vals.push_back(4.0 + 2.0 * convection);
+    if (col < grid - 1) {
+      cols.push_back(i + 1);
+      vals.push_back(-1.0);
+    }
+    if (row < grid - 1) {
+      cols.push_back(i + grid);
+      vals.push_back(-1.0);
+    }
+    rows.push_back(static_cast<index_type>(cols.size()));
+  }
+
+  ReSolve::matrix::Csr* A = new ReSolve::matrix::Csr(n, n, static_cast<index_type>(cols.size()));
+  A->allocateMatrixData(ReSolve::memory::HOST);
+  A->updateData(rows.data(), cols.data(), vals.data(), ReSolve::memory::HOST, ReSolve::memory::HOST);
+  return A;
+}
@@ -196,7 +196,7 @@ int test(int argc, char *argv[])
 void processInputs(std::string& method, std::string& gs, std::string& sketch)
 {
   if (method == "randgmres") {
-    if ((sketch != "count") && (sketch != "fwht")) {
+    if ((sketch != "count") && (sketch != "fwht") && (sketch != "sparse_sign") && (sketch != "srht")) {
       std::cout << "Sketching method " << sketch << " not recognized.\n";
       std::cout << "Setting sketch to the default (count).\n\n";
       sketch = "count";
@@ -209,7 +209,8 @@ void processInputs(std::string& method, std::string& gs, std::string& sketch)
     method = "fgmres";
   }
 
-  if (gs != "cgs1" && gs != "cgs2" && gs != "mgs" && gs != "mgs_two_sync" && gs != "mgs_pm") {
+  if (gs != "cgs1" && gs != "cgs2" && gs != "mgs" && gs != "mgs_two_sync" && gs != "mgs_pm" &&
+      gs != "mgs_one_sync" && gs != "cgs2_two_sync" && gs != "rgs" && gs != "dcgs2") {
     std::cout << "Unknown orthogonalization " << gs << "\n";
     std::cout << "Setting orthogonalization to the default (CGS2).\n\n";
     gs = "cgs2";
@@ -228,6 +229,10 @@ std::string headerInfo(const std::string& method, const std::string& gs, const s
       header += "count sketching\n";
     } else if (sketch == "fwht") {
       header += "fast Walsh-Hadamard transform\n";
+    } else if (sketch == "sparse_sign") {
+      header += "sparse sign embedding\n";
+    } else if (sketch == "srht") {
+      header += "subsampled randomized Hadamard transform\n";
     }
   } else if (method == "fgmres") {
     header += flexible ? "FGMRES" : "GMRES";
@@ -247,6 +252,14 @@ std::string headerInfo(const std::string& method, const std::string& gs, const s
     header += (withgs + "modified Gram-Schmidt 2-sync\n");    
   } else if (gs == "mgs_pm") {
     header += (withgs + "post-modern modified Gram-Schmidt\n");    
+  } else if (gs == "mgs_one_sync") {
+    header += (withgs + "modified Gram-Schmidt 1-sync\n");
+  } else if (gs == "cgs2_two_sync") {
+    header += (withgs + "reorthogonalized classical Gram-Schmidt 2-sync\n");
+  } else if (gs == "rgs") {
+    header += (withgs + "randomized Gram-Schmidt\n");
+  } else if (gs == "dcgs2") {
+    header += (withgs + "delayed reorthogonalized classical Gram-Schmidt\n");
   } else if (gs == "mgs") {
     header += (withgs + "modified Gram-Schmidt\n");    
   } else {
@@ -0,0 +1,151 @@
+/**
+ * @file testSysStaleFactor.cpp
+ * @brief Functionality test for stale-factor preconditioning in SystemSolver.
+ *
+ * The first system is factorized by KLU. The second system has the same
+ * sparsity pattern and slightly different values. It is solved by FGMRES
+ * preconditioned with the factors of the first system, so it must not be
+ * factorized again. The test is run with KLU and with CPU refactorization
+ * solver providing the factors.
+ *
+ */
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/matrix/io.hpp>
+#include <resolve/matrix/Coo.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+#include <resolve/SystemSolver.hpp>
+
+using namespace ReSolve::constants;
+using namespace ReSolve::colors;
+
+// Use ReSolve data types.
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+
+int main(int argc, char *argv[])
+{
+  // Error sum needs to be 0 at the end for test to PASS.
+  // It is a FAIL otheriwse.
+  int error_sum = 0;
+
+  // Input to this code is location of `data` directory where matrix files are stored
+  const std::string data_path = (argc == 2) ? argv[1] : "./";
+
+  std::string matrixFileName1 = data_path + "data/matrix_ACTIVSg200_AC_10.mtx";
+  std::string matrixFileName2 = data_path + "data/matrix_ACTIVSg200_AC_11.mtx";
+  std::string rhsFileName1    = data_path + "data/rhs_ACTIVSg200_AC_10.mtx.ones";
+  std::string rhsFileName2    = data_path + "data/rhs_ACTIVSg200_AC_11.mtx.ones";
+
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  workspace.initializeHandles();
+
+  const std::string refactorization_methods[] = {"klu", "cpurf"};
+  for (const std::string& method : refactorization_methods) {
+    // Read first matrix
+    std::ifstream mat1(matrixFileName1);
+    if(!mat1.is_open())
+    {
+      std::cout << "Failed to open file " << matrixFileName1 << "\n";
+      return -1;
+    }
+    ReSolve::matrix::Coo* A_coo = ReSolve::io::readMatrixFromFile(mat1);
+    ReSolve::matrix::Csr* A = new ReSolve::matrix::Csr(A_coo, ReSolve::memory::HOST);
+    mat1.close();
+
+    // Read first rhs vector
+    std::ifstream rhs1_file(rhsFileName1);
+    if(!rhs1_file.is_open())
+    {
+      std::cout << "Failed to open file " << rhsFileName1 << "\n";
+      return -1;
+    }
+    real_type* rhs = ReSolve::io::readRhsFromFile(rhs1_file);
+    rhs1_file.close();
+
+    vector_type vec_rhs(A->getNumRows());
+    vector_type vec_x(A->getNumRows());
+    vec_x.allocate(ReSolve::memory::HOST);
+    vec_rhs.update(rhs, ReSolve::memory::HOST, ReSolve::memory::HOST);
+    vec_rhs.setDataUpdated(ReSolve::memory::HOST);
+
+    ReSolve::SystemSolver solver(&workspace, "klu", method, method, "none", "fgmres");
+    error_sum += solver.setStaleFactorPreconditioning(true, 20);
+
+    // First system is factorized
+    error_sum += solver.setMatrix(A);
+    error_sum += solver.solveAdaptive(&vec_rhs, &vec_x);
+    real_type res1 = solver.getNormOfScaledResiduals(&vec_rhs, &vec_x);
+
+    // Load the second matrix and rhs
+    std::ifstream mat2(matrixFileName2);
+    if(!mat2.is_open())
+    {
+      std::cout << "Failed to open file " << matrixFileName2 << "\n";
+      return -1;
+    }
+    ReSolve::io::readAndUpdateMatrix(mat2, A_coo);
+    mat2.close();
+
+    std::ifstream rhs2_file(rhsFileName2);
+    if(!rhs2_file.is_open())
+    {
+      std::cout << "Failed to open file " << rhsFileName2 << "\n";
+      return -1;
+    }
+    ReSolve::io::readAndUpdateRhs(rhs2_file, &rhs);
+    rhs2_file.close();
+
+    A->updateFromCoo(A_coo, ReSolve::memory::HOST);
+    vec_rhs.update(rhs, ReSolve::memory::HOST, ReSolve::memory::HOST);
+
+    // Second system is solved with factors of the first one
+    error_sum += solver.solveAdaptive(&vec_rhs, &vec_x);
+    real_type res2 = solver.getNormOfScaledResiduals(&vec_rhs, &vec_x);
+    index_type num_iter = solver.getIterativeSolver().getNumIter();
+
+    const ReSolve::RefactorizationPolicy::Statistics& stats =
+      solver.getRefactorizationPolicy().getStatistics();
+    if (stats.num_factorizations != 1 || stats.num_reuses != 1) {
+      std::cout << "Expected 1 factorization and 1 reuse of factors, got "
+                << stats.num_factorizations << " and " << stats.num_reuses << "\n";
+      error_sum++;
+    }
+
+    std::cout << "Results (" << method << " factors): \n"
+              << std::scientific << std::setprecision(16)
+              << "\t Scaled residual norm (factorized)   : " << res1 << "\n"
+              << "\t Scaled residual norm (stale factors): " << res2 << "\n"
+              << "\t FGMRES iterations (stale factors)   : " << num_iter << "\n";
+
+    real_type tol = solver.getRefactorizationPolicy().getResidualTolerance();
+    if (!std::isfinite(res1) || !std::isfinite(res2)) {
+      std::cout << "Result is not a finite number!\n";
+      error_sum++;
+    }
+    if ((res1 > tol) || (res2 > tol)) {
+      std::cout << "Result inaccurate!\n";
+      error_sum++;
+    }
+
+    delete A_coo;
+    delete A;
+    delete [] rhs;
+  }
+
+  if (error_sum == 0) {
+    std::cout << "Test " << GREEN << "PASSED" << CLEAR << "\n\n";
+  } else {
+    std::cout << "Test " << RED << "FAILED" << CLEAR << ", error sum: " << error_sum << "\n\n";
+  }
+
+  return error_sum;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file testSysSymbolicCache.cpp
+ * @brief Functionality test for symbolic analysis cache in SystemSolver.
+ *
+ * The first system is analyzed and factorized by KLU with the symbolic
+ * cache enabled. The second system has the same sparsity pattern, so its
+ * analysis must be found in the cache. The cache is then saved to disk and
+ * loaded by another solver, which reconstructs the symbolic analysis from
+ * the file and solves the second system again.
+ *
+ */
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+
+#include <resolve/vector/Vector.hpp>
+#include <resolve/matrix/io.hpp>
+#include <resolve/matrix/Coo.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/SymbolicCache.hpp>
+#include <resolve/workspace/LinAlgWorkspace.hpp>
+#include <resolve/SystemSolver.hpp>
+
+using namespace ReSolve::constants;
+using namespace ReSolve::colors;
+
+// Use ReSolve data types.
+using real_type   = ReSolve::real_type;
+using index_type  = ReSolve::index_type;
+using vector_type = ReSolve::vector::Vector;
+
+int main(int argc, char *argv[])
+{
+  // Error sum needs to be 0 at the end for test to PASS.
+  // It is a FAIL otheriwse.
+  int error_sum = 0;
+
+  // Input to this code is location of `data` directory where matrix files are stored
+  const std::string data_path = (argc == 2) ? argv[1] : "./";
+  const std::string cache_file = "sys_symbolic_cache_test.bin";
+
+  std::string matrixFileName1 = data_path + "data/matrix_ACTIVSg200_AC_10.mtx";
+  std::string matrixFileName2 = data_path + "data/matrix_ACTIVSg200_AC_11.mtx";
+  std::string rhsFileName1    = data_path + "data/rhs_ACTIVSg200_AC_10.mtx.ones";
+  std::string rhsFileName2    = data_path + "data/rhs_ACTIVSg200_AC_11.mtx.ones";
+
+  // Read first matrix
+  std::ifstream mat1(matrixFileName1);
+  if(!mat1.is_open())
+  {
+    std::cout << "Failed to open file " << matrixFileName1 << "\n";
+    return -1;
+  }
+  ReSolve::matrix::Coo* A_coo = ReSolve::io::readMatrixFromFile(mat1);
+  ReSolve::matrix::Csr* A = new ReSolve::matrix::Csr(A_coo, ReSolve::memory::HOST);
+  mat1.close();
+
+  // Read first rhs vector
+  std::ifstream rhs1_file(rhsFileName1);
+  if(!rhs1_file.is_open())
+  {
+    std::cout << "Failed to open file " << rhsFileName1 << "\n";
+    return -1;
+  }
+  real_type* rhs = ReSolve::io::readRhsFromFile(rhs1_file);
+  rhs1_file.close();
+
+  vector_type vec_rhs(A->getNumRows());
+  vector_type vec_x(A->getNumRows());
+  vec_x.allocate(ReSolve::memory::HOST);
+  vec_rhs.update(rhs, ReSolve::memory::HOST, ReSolve::memory::HOST);
+  vec_rhs.setDataUpdated(ReSolve::memory::HOST);
+
+  ReSolve::LinAlgWorkspaceCpu workspace;
+  workspace.initializeHandles();
+  ReSolve::SystemSolver solver(&workspace);
+  error_sum += solver.setSymbolicCacheCapacity(4);
+
+  // Solve the first system, its analysis is stored in the cache
+  error_sum += solver.setMatrix(A);
+  error_sum += solver.analyze();
+  error_sum += solver.factorize();
+  error_sum += solver.solve(&vec_rhs, &vec_x);
+  real_type rel_res1 = solver.getResidualNorm(&vec_rhs, &vec_x);
+
+  // Load the second matrix and rhs
+  std::ifstream mat2(matrixFileName2);
+  if(!mat2.is_open())
+  {
+    std::cout << "Failed to open file " << matrixFileName2 << "\n";
+    return -1;
+  }
+  ReSolve::io::readAndUpdateMatrix(mat2, A_coo);
+  mat2.close();
+
+  std::ifstream rhs2_file(rhsFileName2);
+  if(!rhs2_file.is_open())
+  {
+    std::cout << "Failed to open file " << rhsFileName2 << "\n";
+    return -1;
+  }
+  ReSolve::io::readAndUpdateRhs(rhs2_file, &rhs);
+  rhs2_file.close();
+
+  A->updateFromCoo(A_coo, ReSolve::memory::HOST);
+  vec_rhs.update(rhs, ReSolve::memory::HOST, ReSolve::memory::HOST);
+
+  // Analysis of the second system is found in the cache
+  error_sum += solver.analyze();
+  error_sum += solver.factorize();
+  error_sum += solver.solve(&vec_rhs, &vec_x);
+  real_type rel_res2 = solver.getResidualNorm(&vec_rhs, &vec_x);
+
+  ReSolve::SymbolicCache* cache = solver.getSymbolicCache();
+  if (cache->getNumHits() != 1 || cache->getNumMisses() != 1) {
+    std::cout << "Expected 1 cache hit and 1 miss, got " << cache->getNumHits()
+              << " hits and " << cache->getNumMisses() << " misses\n";
+    error_sum++;
+  }
+  error_sum += cache->save(cache_file);
+
+  // Another solver restores the analysis from the saved cache
+  ReSolve::SystemSolver solver_restored(&workspace);
+  error_sum += solver_restored.setSymbolicCacheCapacity(4);
+  error_sum += solver_restored.getSymbolicCache()->load(cache_file);
+  std::remove(cache_file.c_str());
+
+  error_sum += solver_restored.setMatrix(A);
+  error_sum += solver_restored.analyze();
+  error_sum += solver_restored.factorize();
+  error_sum += solver_restored.solve(&vec_rhs, &vec_x);
+  real_type rel_res3 = solver_restored.getResidualNorm(&vec_rhs, &vec_x);
+
+  if (solver_restored.getSymbolicCache()->getNumHits() != 1) {
+    std::cout << "Analysis loaded from disk was not used\n";
+    error_sum++;
+  }
+
+  std::cout << "Results: \n"
+            << std::scientific << std::setprecision(16)
+            << "\t ||b-A*x||_2/||b||_2 (analyzed)           : " << rel_res1 << "\n"
+            << "\t ||b-A*x||_2/||b||_2 (cached analysis)    : " << rel_res2 << "\n"
+            << "\t ||b-A*x||_2/||b||_2 (analysis from disk) : " << rel_res3 << "\n";
+
+  if (!std::isfinite(rel_res1) || !std::isfinite(rel_res2) || !std::isfinite(rel_res3)) {
+    std::cout << "Result is not a finite number!\n";
+    error_sum++;
+  }
+  if ((rel_res1 > 1e-14) || (rel_res2 > 1e-14) || (rel_res3 > 1e-14)) {
+    std::cout << "Result inaccurate!\n";
+    error_sum++;
+  }
+
+  if (error_sum == 0) {
+    std::cout << "Test " << GREEN << "PASSED" << CLEAR << "\n\n";
+  } else {
+    std::cout << "Test " << RED << "FAILED" << CLEAR << ", error sum: " << error_sum << "\n\n";
+  }
+
+  delete A_coo;
+  delete A;
+  delete [] rhs;
+
+  return error_sum;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file TestMatrices.hpp
+ * @brief Small CSR matrices shared by unit tests.
+ *
+ */
+#pragma once
+
+#include <vector>
+
+#include <resolve/Common.hpp>
+#include <resolve/matrix/Csr.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @brief Creates n x n CSR matrix on the host from CSR arrays.
+     *
+     * The caller owns the returned matrix.
+     */
+    inline matrix::Csr* createCsrMatrix(index_type n,
+                                        std::vector<index_type>& rows,
+                                        std::vector<index_type>& cols,
+                                        std::vector<real_type>& vals)
+    {
+      matrix::Csr* A = new matrix::Csr(n, n, static_cast<index_type>(cols.size()));
+      A->allocateMatrixData(memory::HOST);
+      A->updateData(rows.data(), cols.data(), vals.data(), memory::HOST, memory::HOST);
+      return A;
+    }
+
+    /// @brief Creates diagonally dominant n x n tridiagonal matrix
+    inline matrix::Csr* createTridiagonalCsrMatrix(index_type n)
+    {
+      std::vector<index_type> rows(1, 0);
+      std::vector<index_type> cols;
+      std::vector<real_type>  vals;
+      for (index_type i = 0; i < n; ++i) {
+        for (index_type j = i - 1; j <= i + 1; ++j) {
+          if (j >= 0 && j < n) {
+            cols.push_back(j);
+            vals.push_back(i == j ? 4.0 : -1.0);
+          }
+        }
+        rows.push_back(static_cast<index_type>(cols.size()));
+      }
+      return createCsrMatrix(n, rows, cols, vals);
+    }
+
+    /// @brief Creates 5-point Laplacian on grid x grid mesh
+    inline matrix::Csr* createLaplacianCsrMatrix(index_type grid)
+    {
+      const index_type n = grid * grid;
+      std::vector<index_type> rows(1, 0);
+      std::vector<index_type> cols;
+      std::vector<real_type>  vals;
+      for (index_type i = 0; i < n; ++i) {
+        const index_type neighbors[] = {i - grid, i - 1, i, i + 1, i + grid};
+        for (index_type j : neighbors) {
+          const bool same_row = (j / grid == i / grid);
+          if (j >= 0 && j < n && (j == i - grid || j == i + grid || same_row)) {
+            cols.push_back(j);
+            vals.push_back(i == j ? 4.0 : -1.0);
+          }
+        }
+        rows.push_back(static_cast<index_type>(cols.size()));
+      }
+      return createCsrMatrix(n, rows, cols, vals);
+    }
+  } // namespace tests
+} // namespace ReSolve
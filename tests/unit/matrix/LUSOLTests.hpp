@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <sstream>
 #include <string>
@@ -74,6 +75,218 @@ namespace ReSolve
           return status.report(__func__);
         }
 
+        TestOutcome replaceColumn()
+        {
+          TestStatus status;
+
+          LinSolverDirectLUSOL solver;
+          matrix::Coo* A = createMatrix();
+          std::vector<real_type> A_dense = createDenseMatrix();
+
+          vector::Vector rhs(A->getNumRows());
+          rhs.setToConst(constants::ONE, memory::HOST);
+
+          vector::Vector x(A->getNumColumns());
+          x.allocate(memory::HOST);
+
+          status *= (solver.setup(A) == 0);
+          status *= (solver.analyze() == 0);
+          status *= (solver.factorize() == 0);
+
+          // Replace column 4 of A with a vector with a different pattern.
+          const index_type j = 4;
+          std::vector<real_type> new_column = {0., 3., 0., 1., 2., 0., 0., 6., 0.};
+          vector::Vector column(A->getNumRows());
+          column.update(new_column.data(), memory::HOST, memory::HOST);
+
+          // Out-of-range column indices are rejected without an update.
+          status *= (solver.replaceColumn(-1, &column) != 0);
+          status *= (solver.replaceColumn(A->getNumColumns(), &column) != 0);
+          status *= (solver.getNumUpdates() == 0);
+
+          status *= (solver.replaceColumn(j, &column) == 0);
+          status *= (solver.getNumUpdates() == 1);
+
+          for (index_type i = 0; i < A->getNumRows(); ++i) {
+            A_dense[static_cast<size_t>(i * A->getNumColumns() + j)] = new_column[static_cast<size_t>(i)];
+          }
+
+          status *= (solver.solve(&rhs, &x) == 0);
+
+          // LUSOL overwrites the right-hand side in the solve.
+          rhs.setToConst(constants::ONE, memory::HOST);
+          status *= verifyResidual(A_dense, rhs, x);
+
+          delete A;
+
+          return status.report(__func__);
+        }
+
+        TestOutcome rankOneUpdate()
+        {
+          TestStatus status;
+
+          LinSolverDirectLUSOL solver;
+          matrix::Coo* A = createMatrix();
+          std::vector<real_type> A_dense = createDenseMatrix();
+
+          vector::Vector rhs(A->getNumRows());
+          rhs.setToConst(constants::ONE, memory::HOST);
+
+          vector::Vector x(A->getNumColumns());
+          x.allocate(memory::HOST);
+
+          status *= (solver.setup(A) == 0);
+          status *= (solver.analyze() == 0);
+          status *= (solver.factorize() == 0);
+
+          // Update with a branch-like term alpha * (e_1 - e_3) * (e_1 - e_3)^T
+          // twice, so that the second update builds upon replaced columns.
+          const real_type alpha = -0.5;
+          std::vector<real_type> branch = {0., 1., 0., -1., 0., 0., 0., 0., 0.};
+          vector::Vector u(A->getNumRows());
+          u.update(branch.data(), memory::HOST, memory::HOST);
+
+          for (int k = 0; k < 2; ++k) {
+            status *= (solver.updateRankOne(alpha, &u, &u) == 0);
+            for (index_type i = 0; i < A->getNumRows(); ++i) {
+              for (index_type jj = 0; jj < A->getNumColumns(); ++jj) {
+                A_dense[static_cast<size_t>(i * A->getNumColumns() + jj)] +=
+                  alpha * branch[static_cast<size_t>(i)] * branch[static_cast<size_t>(jj)];
+              }
+            }
+          }
+          status *= (solver.getNumUpdates() == 4);
+
+          status *= (solver.solve(&rhs, &x) == 0);
+
+          // LUSOL overwrites the right-hand side in the solve.
+          rhs.setToConst(constants::ONE, memory::HOST);
+          status *= verifyResidual(A_dense, rhs, x);
+
+          // Factorizing again discards the updates.
+          status *= (solver.analyze() == 0);
+          status *= (solver.factorize() == 0);
+          status *= (solver.getNumUpdates() == 0);
+          rhs.setToConst(constants::ONE, memory::HOST);
+          status *= (solver.solve(&rhs, &x) == 0);
+          status *= verifyAnswer(x, solX_);
+
+          delete A;
+
+          return status.report(__func__);
+        }
+
+        TestOutcome workspaceGrowth()
+        {
+          TestStatus status;
+
+          LinSolverDirectLUSOL solver;
+          std::vector<real_type> A_dense;
+          matrix::Coo* A = createLaplacianMatrix(15, A_dense);
+
+          vector::Vector rhs(A->getNumRows());
+          vector::Vector x(A->getNumColumns());
+          x.allocate(memory::HOST);
+
+          // Start with the smallest workspace that fits the input matrix,
+          // which is too small for the factors of a 2D Laplacian.
+          index_type minlen = A->getNnz() + 2 * (A->getNumRows() + A->getNumColumns());
+          solver.setInitialWorkspaceSize(minlen);
+
+          status *= (solver.setup(A) == 0);
+          status *= (solver.analyze() == 0);
+          status *= (solver.getWorkspaceSize() == minlen);
+          status *= (solver.factorize() == 0);
+
+          index_type lena = solver.getWorkspaceSize();
+          if (lena <= minlen) {
+            std::cout << "Workspace size " << lena << " did not grow\n";
+            status *= false;
+          }
+
+          // Workspace footprint includes arrays of size lena for values
+          // and row and column indices.
+          std::size_t arena_bytes = static_cast<std::size_t>(lena) * (sizeof(real_type) + 2 * sizeof(index_type));
+          status *= (solver.getMemoryUsage().host_bytes >= arena_bytes);
+          status *= (solver.getMemoryUsage().device_bytes == 0);
+
+          rhs.setToConst(constants::ONE, memory::HOST);
+          status *= (solver.solve(&rhs, &x) == 0);
+          rhs.setToConst(constants::ONE, memory::HOST);
+          status *= verifyResidual(A_dense, rhs, x);
+
+          // Grown workspace is kept for a matrix with the same pattern.
+          status *= (solver.analyze() == 0);
+          status *= (solver.getWorkspaceSize() == lena);
+          status *= (solver.factorize() == 0);
+          status *= (solver.getWorkspaceSize() == lena);
+
+          rhs.setToConst(constants::ONE, memory::HOST);
+          status *= (solver.solve(&rhs, &x) == 0);
+          rhs.setToConst(constants::ONE, memory::HOST);
+          status *= verifyResidual(A_dense, rhs, x);
+
+          delete A;
+
+          return status.report(__func__);
+        }
+
+        /**
+         * @brief Solve is refused unless the last factorization succeeded.
+         *
+         * A singular matrix is factorized after a successful factorization,
+         * so that the workspace holds stale factors when solve is called.
+         */
+        TestOutcome solveAfterFailedFactorization()
+        {
+          TestStatus status;
+
+          LinSolverDirectLUSOL solver;
+          matrix::Coo* A = createMatrix();
+
+          vector::Vector rhs(A->getNumRows());
+          rhs.setToConst(constants::ONE, memory::HOST);
+          vector::Vector x(A->getNumColumns());
+          x.allocate(memory::HOST);
+
+          // Solve before the matrix is factorized
+          status *= (solver.setup(A) == 0);
+          status *= (solver.analyze() == 0);
+          status *= (solver.solve(&rhs, &x) != 0);
+
+          status *= (solver.factorize() == 0);
+          status *= (solver.solve(&rhs, &x) == 0);
+          status *= verifyAnswer(x, solX_);
+
+          //     [ 1  1  0 ]
+          // S = [ 1  1  0 ]
+          //     [ 0  0  1 ]
+          std::vector<index_type> rows = {0, 0, 1, 1, 2};
+          std::vector<index_type> cols = {0, 1, 0, 1, 2};
+          std::vector<real_type>  vals = {1., 1., 1., 1., 1.};
+          matrix::Coo S(3, 3, 5, true, true);
+          S.updateData(rows.data(), cols.data(), vals.data(), memory::HOST, memory::HOST);
+
+          vector::Vector rhs_s(3);
+          rhs_s.setToConst(constants::ONE, memory::HOST);
+          vector::Vector x_s(3);
+          x_s.allocate(memory::HOST);
+
+          status *= (solver.setup(&S) == 0);
+          status *= (solver.analyze() == 0);
+          status *= (solver.factorize() != 0);
+          status *= (solver.solve(&rhs_s, &x_s) != 0);
+
+          vector::Vector column(3);
+          column.setToConst(constants::ONE, memory::HOST);
+          status *= (solver.replaceColumn(0, &column) != 0);
+
+          delete A;
+
+          return status.report(__func__);
+        }
+
       private:
         ReSolve::MatrixHandler* createMatrixHandler()
         {
@@ -186,6 +399,91 @@ namespace ReSolve
           return status;
         }
 
+        /// @brief Creates the test matrix in dense row-major format
+        std::vector<real_type> createDenseMatrix()
+        {
+          std::vector<real_type> A_dense(9 * 9, 0.0);
+          for (size_t k = 0; k < valsA_.size(); ++k) {
+            A_dense[static_cast<size_t>(rowsA_[k] * 9 + colsA_[k])] = valsA_[k];
+          }
+          return A_dense;
+        }
+
+        /**
+         * @brief Creates 5-point Laplacian on a k x k grid.
+         *
+         * @param[in]  k       - number of grid points in each direction
+         * @param[out] A_dense - the same matrix in dense row-major format
+         * @return matrix::Coo* - the matrix in COO format
+         */
+        matrix::Coo* createLaplacianMatrix(index_type k, std::vector<real_type>& A_dense)
+        {
+          index_type n = k * k;
+          std::vector<index_type> rows;
+          std::vector<index_type> cols;
+          std::vector<real_type> vals;
+          A_dense.assign(static_cast<size_t>(n * n), 0.0);
+
+          auto add = [&](index_type i, index_type j, real_type v) {
+            rows.push_back(i);
+            cols.push_back(j);
+            vals.push_back(v);
+            A_dense[static_cast<size_t>(i * n + j)] = v;
+          };
+
+          for (index_type gi = 0; gi < k; ++gi) {
+            for (index_type gj = 0; gj < k; ++gj) {
+              index_type i = gi * k + gj;
+              add(i, i, 4.0);
+              if (gi > 0)     add(i, i - k, -1.0);
+              if (gi < k - 1) add(i, i + k, -1.0);
+              if (gj > 0)     add(i, i - 1, -1.0);
+              if (gj < k - 1) add(i, i + 1, -1.0);
+            }
+          }
+
+          index_type nnz = static_cast<index_type>(vals.size());
+          matrix::Coo* A = new matrix::Coo(n, n, nnz, true, true);
+          A->updateData(rows.data(), cols.data(), vals.data(), memory::HOST, memory::HOST);
+
+          return A;
+        }
+
+        /**
+         * @brief Checks that x solves the dense system A_dense x = rhs.
+         *
+         * @param A_dense - dense row-major square matrix
+         * @param rhs     - right-hand side
+         * @param x       - computed solution
+         * @return true  - if the relative residual is within tolerance
+         * @return false - otherwise
+         */
+        bool verifyResidual(const std::vector<real_type>& A_dense,
+                            vector::Vector& rhs,
+                            vector::Vector& x)
+        {
+          index_type n = rhs.getSize();
+          const real_type* b = rhs.getData(memory::HOST);
+          const real_type* xd = x.getData(memory::HOST);
+
+          real_type norm_r = 0.0;
+          real_type norm_b = 0.0;
+          for (index_type i = 0; i < n; ++i) {
+            real_type r = b[i];
+            for (index_type j = 0; j < n; ++j) {
+              r -= A_dense[static_cast<size_t>(i * n + j)] * xd[j];
+            }
+            norm_r = std::max(norm_r, std::abs(r));
+            norm_b = std::max(norm_b, std::abs(b[i]));
+          }
+
+          if (!(norm_r <= 1e-12 * norm_b)) {
+            std::cout << "Residual norm " << norm_r << " exceeds tolerance\n";
+            return false;
+          }
+          return true;
+        }
+
         /// @brief Reference solution to Ax = rhs
         std::vector<real_type> solX_ = {1,
                                         -2.7715806930261,
@@ -11,11 +11,15 @@
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <cmath>
 #include <resolve/matrix/Csr.hpp>
+#include <resolve/matrix/Csc.hpp>
 #include <resolve/workspace/LinAlgWorkspace.hpp>
 #include <resolve/matrix/MatrixHandler.hpp>
 #include <resolve/vector/Vector.hpp>
 #include <resolve/LinSolverDirectCpuILU0.hpp>
+#include <resolve/LinSolverDirectCpuRf.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
 #include <tests/unit/TestBase.hpp>
 
 namespace ReSolve { namespace tests {
@@ -83,9 +87,292 @@ public:
     return status.report(__func__);
   }
 
+  /**
+   * @brief Test single precision ILU0 set up again for a matrix with a
+   * larger sparsity pattern.
+   * 
+   * Buffers holding single precision factors have to be resized when the
+   * sparsity pattern changes. Results are compared with double precision
+   * ILU0 of the same matrix.
+   * 
+   * @return TestOutcome 
+   */
+  TestOutcome matrixILU0SinglePrecisionResetup()
+  {
+    TestStatus status;
+
+    ReSolve::LinSolverDirectCpuILU0 solver;
+    solver.setZeroDiagonal(0.1);
+    solver.setSinglePrecision(true);
+
+    ReSolve::LinSolverDirectCpuILU0 reference;
+    reference.setZeroDiagonal(0.1);
+
+    ReSolve::matrix::Csr* A = createCsrMatrix(0, "cpu");
+    ReSolve::matrix::Csr* B = createBlockDiagonalCsrMatrix(3);
+
+    status *= (solver.setup(A) == 0);
+    status *= (solver.setup(B) == 0);
+    status *= (reference.setup(B) == 0);
+    status *= (solver.getLFactor()->getNnz() == reference.getLFactor()->getNnz());
+    status *= (solver.getUFactor()->getNnz() == reference.getUFactor()->getNnz());
+
+    const index_type n = B->getNumRows();
+    ReSolve::vector::Vector rhs(n);
+    rhs.setToConst(constants::ONE, memory::HOST);
+    ReSolve::vector::Vector x(n);
+    x.allocate(memory::HOST);
+    ReSolve::vector::Vector x_ref(n);
+    x_ref.allocate(memory::HOST);
+
+    status *= (solver.solve(&rhs, &x) == 0);
+    status *= (reference.solve(&rhs, &x_ref) == 0);
+
+    real_type max_error = 0.0;
+    for (index_type i = 0; i < n; ++i) {
+      const real_type xi  = x.getData(memory::HOST)[i];
+      const real_type xri = x_ref.getData(memory::HOST)[i];
+      max_error = std::max(max_error, std::abs(xi - xri) / std::max(std::abs(xri), constants::ONE));
+    }
+    if (max_error > 1e-4) {
+      std::cout << "Single precision ILU0 differs from double by " << max_error << "\n";
+      status *= false;
+    }
+
+    delete A;
+    delete B;
+
+    return status.report(__func__);
+  }
+
+  /**
+   * @brief Test changing ILU0 precision between factorization and solve.
+   * 
+   * Solves have to apply factors in the precision they were computed in,
+   * and the new precision is used only after the next factorization.
+   * 
+   * @return TestOutcome 
+   */
+  TestOutcome matrixILU0PrecisionChange()
+  {
+    TestStatus status;
+
+    ReSolve::LinSolverDirectCpuILU0 solver;
+    solver.setZeroDiagonal(0.1);
+    ReSolve::matrix::Csr* A = createCsrMatrix(0, "cpu");
+
+    ReSolve::vector::Vector rhs(A->getNumRows());
+    rhs.setToConst(constants::ONE, memory::HOST);
+    ReSolve::vector::Vector x(A->getNumRows());
+    x.allocate(memory::HOST);
+
+    // Factorized in double precision, solved after switching to single
+    status *= (solver.setup(A) == 0);
+    status *= (solver.setSinglePrecision(true) == 0);
+    status *= (solver.solve(&rhs, &x) == 0);
+    status *= verifyAnswer(x, solX_, "cpu");
+
+    // Factorized in single precision, solved after switching to double
+    status *= (solver.reset(A) == 0);
+    status *= (solver.setSinglePrecision(false) == 0);
+    status *= (solver.solve(&rhs, &x) == 0);
+    real_type max_error = 0.0;
+    for (index_type i = 0; i < A->getNumRows(); ++i) {
+      const real_type xi = x.getData(memory::HOST)[i];
+      const real_type si = solX_[static_cast<size_t>(i)];
+      max_error = std::max(max_error, std::abs(xi - si) / std::max(std::abs(si), constants::ONE));
+    }
+    if (max_error > 1e-4) {
+      std::cout << "Single precision ILU0 differs from double by " << max_error << "\n";
+      status *= false;
+    }
+
+    delete A;
+
+    return status.report(__func__);
+  }
+
+  /**
+   * @brief Test level-scheduled refactorization on CPU.
+   * 
+   * Factors are computed by a reference dense LU with partial pivoting
+   * using KLU conventions, i.e. CSR arrays of A are interpreted as CSC
+   * arrays of matrix B, and B(P, Q) = L U. Refactorization is then tested
+   * with new matrix values and with different numbers of threads.
+   * 
+   * @return TestOutcome 
+   */
+  TestOutcome matrixCpuRf()
+  {
+    TestStatus status;
+
+    const index_type num_blocks = 24;
+    ReSolve::matrix::Csr* A = createBlockDiagonalCsrMatrix(num_blocks);
+    const index_type n = A->getNumRows();
+
+    ReSolve::matrix::Csc* L = nullptr;
+    ReSolve::matrix::Csc* U = nullptr;
+    std::vector<index_type> P(static_cast<size_t>(n));
+    std::vector<index_type> Q(static_cast<size_t>(n));
+    for (index_type k = 0; k < n; ++k) {
+      Q[static_cast<size_t>(k)] = n - 1 - k;
+    }
+    if (!computeReferenceLU(A, Q, P, &L, &U)) {
+      std::cout << "Reference LU factorization failed!\n";
+      status *= false;
+      delete A;
+      return status.report(__func__);
+    }
+
+    ReSolve::vector::Vector rhs(n);
+    rhs.allocate(memory::HOST);
+    rhs.setToConst(constants::ONE, memory::HOST);
+    ReSolve::vector::Vector x(n);
+    x.allocate(memory::HOST);
+
+    const int num_threads = threads::getNumThreads();
+    threads::setNumThreads(1);
+
+    // Setup refactorizes the original matrix
+    ReSolve::LinSolverDirectCpuRf solver;
+    status *= (solver.setup(A, L, U, &P[0], &Q[0]) == 0);
+    status *= (solver.getNumLevels() < n);
+    status *= (solver.solve(&rhs, &x) == 0);
+    status *= (transposeResidual(A, rhs, x) < 1e-12);
+
+    // Change matrix values and refactorize
+    real_type* vals = A->getValues(memory::HOST);
+    for (index_type p = 0; p < A->getNnz(); ++p) {
+      vals[p] *= (1.0 + 0.1 * std::sin(static_cast<real_type>(p)));
+    }
+    status *= (solver.refactorize() == 0);
+    status *= (solver.solve(&rhs, &x) == 0);
+    status *= (transposeResidual(A, rhs, x) < 1e-12);
+
+    // Multithreaded refactorization must reproduce serial results exactly
+    std::vector<real_type> valsL(solver.getLFactor()->getValues(memory::HOST),
+                                 solver.getLFactor()->getValues(memory::HOST) + L->getNnz());
+    std::vector<real_type> valsU(solver.getUFactor()->getValues(memory::HOST),
+                                 solver.getUFactor()->getValues(memory::HOST) + U->getNnz());
+    threads::setNumThreads(4);
+    status *= (solver.refactorize() == 0);
+    for (index_type p = 0; p < L->getNnz(); ++p) {
+      status *= (solver.getLFactor()->getValues(memory::HOST)[p] == valsL[static_cast<size_t>(p)]);
+    }
+    for (index_type p = 0; p < U->getNnz(); ++p) {
+      status *= (solver.getUFactor()->getValues(memory::HOST)[p] == valsU[static_cast<size_t>(p)]);
+    }
+
+    // Test in-place solve
+    ReSolve::vector::Vector y(n);
+    y.allocate(memory::HOST);
+    y.setToConst(constants::ONE, memory::HOST);
+    status *= (solver.solve(&y) == 0);
+    status *= (transposeResidual(A, rhs, y) < 1e-12);
+
+    threads::setNumThreads(num_threads);
+
+    delete L;
+    delete U;
+    delete A;
+
+    return status.report(__func__);
+  }
+
+  /**
+   * @brief Test sparse right-hand side solves against full solves.
+   * 
+   * @return TestOutcome 
+   */
+  TestOutcome matrixSparseRhsSolve()
+  {
+    TestStatus status;
+
+    // ILU0 factors are stored in CSR format without permutations
+    ReSolve::LinSolverDirectCpuILU0 ilu;
+    ReSolve::matrix::Csr* A = createCsrMatrix(0, "cpu");
+    ilu.setZeroDiagonal(0.1);
+    ilu.setup(A);
+    status *= compareSparseSolve(ilu, A->getNumRows(), {{4, 1.0}}, {0, 3, 8});
+    status *= compareSparseSolve(ilu, A->getNumRows(), {{0, 2.0}, {7, -1.0}}, {2, 5});
+    delete A;
+
+    // CPU refactorization factors are stored in CSC format with permutations
+    ReSolve::matrix::Csr* B = createBlockDiagonalCsrMatrix(8);
+    const index_type n = B->getNumRows();
+    ReSolve::matrix::Csc* L = nullptr;
+    ReSolve::matrix::Csc* U = nullptr;
+    std::vector<index_type> P(static_cast<size_t>(n));
+    std::vector<index_type> Q(static_cast<size_t>(n));
+    for (index_type k = 0; k < n; ++k) {
+      Q[static_cast<size_t>(k)] = (5 * k + 3) % n;
+    }
+    status *= computeReferenceLU(B, Q, P, &L, &U);
+    ReSolve::LinSolverDirectCpuRf rf;
+    status *= (rf.setup(B, L, U, &P[0], &Q[0]) == 0);
+    status *= compareSparseSolve(rf, n, {{10, 1.0}}, {9, 10, 11, 17});
+    status *= compareSparseSolve(rf, n, {{1, 1.0}, {40, 3.0}, {71, -2.0}}, {0, 40, 45, 70});
+    // Right-hand side entries that do not affect requested solution entries
+    status *= compareSparseSolve(rf, n, {{1, 1.0}, {40, 3.0}}, {50});
+    delete L;
+    delete U;
+    delete B;
+
+    return status.report(__func__);
+  }
+
 private:
   std::string memspace_{"cpu"};
 
+  /**
+   * @brief Compares sparse right-hand side solve with the full solve.
+   */
+  bool compareSparseSolve(LinSolverDirect& solver,
+                          index_type n,
+                          const std::vector<std::pair<index_type, real_type> >& rhs_entries,
+                          const std::vector<index_type>& sol_idx)
+  {
+    bool status = true;
+
+    ReSolve::vector::Vector rhs(n);
+    ReSolve::vector::Vector x(n);
+    rhs.allocate(memory::HOST);
+    x.allocate(memory::HOST);
+    rhs.setToZero(memory::HOST);
+    std::vector<index_type> rhs_idx;
+    std::vector<real_type>  rhs_val;
+    for (const auto& entry : rhs_entries) {
+      rhs.getData(memory::HOST)[entry.first] = entry.second;
+      rhs_idx.push_back(entry.first);
+      rhs_val.push_back(entry.second);
+    }
+    solver.solve(&rhs, &x);
+
+    // Solve twice to check that the work space is restored
+    std::vector<real_type> sol_val(sol_idx.size());
+    for (int pass = 0; pass < 2; ++pass) {
+      std::fill(sol_val.begin(), sol_val.end(), -999.0);
+      int err = solver.solveSparse(static_cast<index_type>(rhs_idx.size()),
+                                   rhs_idx.data(),
+                                   rhs_val.data(),
+                                   static_cast<index_type>(sol_idx.size()),
+                                   sol_idx.data(),
+                                   sol_val.data());
+      if (err != 0) {
+        std::cout << "Sparse solve failed with error " << err << "\n";
+        status = false;
+      }
+      for (size_t k = 0; k < sol_idx.size(); ++k) {
+        if (!isEqual(sol_val[k], x.getData(memory::HOST)[sol_idx[k]])) {
+          std::cout << "Sparse solve x[" << sol_idx[k] << "] = " << sol_val[k]
+                    << ", expected: " << x.getData(memory::HOST)[sol_idx[k]] << "\n";
+          status = false;
+        }
+      }
+    }
+    return status;
+  }
+
   ReSolve::MatrixHandler* createMatrixHandler()
   {
     if (memspace_ == "cpu") {
@@ -173,6 +460,193 @@ private:
     return A;
   }
 
+  /**
+   * @brief Create block diagonal matrix with `k` copies of the 9x9 test
+   * matrix, each scaled by a different factor.
+   */
+  matrix::Csr* createBlockDiagonalCsrMatrix(const index_type k)
+  {
+    const index_type N   = static_cast<index_type>(rowsA_.size() - 1);
+    const index_type NNZ = static_cast<index_type>(colsA_.size());
+
+    matrix::Csr* A = new matrix::Csr(k * N, k * N, k * NNZ);
+    A->allocateMatrixData(memory::HOST);
+    index_type* rows = A->getRowData(memory::HOST);
+    index_type* cols = A->getColData(memory::HOST);
+    real_type*  vals = A->getValues( memory::HOST);
+
+    rows[0] = 0;
+    for (index_type b = 0; b < k; ++b) {
+      const real_type scale = 1.0 + 0.05 * static_cast<real_type>(b);
+      for (index_type i = 0; i < N; ++i) {
+        rows[b * N + i + 1] = b * NNZ + rowsA_[static_cast<size_t>(i + 1)];
+      }
+      for (index_type p = 0; p < NNZ; ++p) {
+        cols[b * NNZ + p] = b * N + colsA_[static_cast<size_t>(p)];
+        vals[b * NNZ + p] = scale * valsA_[static_cast<size_t>(p)];
+      }
+    }
+    A->setUpdated(memory::HOST);
+
+    return A;
+  }
+
+  /**
+   * @brief Dense LU factorization with partial pivoting following KLU
+   * conventions.
+   * 
+   * Factors B(P, Q) = L U, where B is CSC matrix with the same arrays as
+   * CSR matrix A. Sparsity pattern of the factors is computed symbolically,
+   * so that it does not depend on accidental numerical cancellations.
+   * L is stored with unit diagonal.
+   * 
+   * @return true if factorization succeeded, false if matrix is singular
+   */
+  bool computeReferenceLU(matrix::Csr* A,
+                          const std::vector<index_type>& Q,
+                          std::vector<index_type>& P,
+                          matrix::Csc** L,
+                          matrix::Csc** U)
+  {
+    const index_type n = A->getNumRows();
+    const size_t nn = static_cast<size_t>(n);
+    const index_type* Bp = A->getRowData(memory::HOST);
+    const index_type* Bi = A->getColData(memory::HOST);
+    const real_type*  Bx = A->getValues( memory::HOST);
+
+    // Dense C(:, k) = B(:, Q[k]) and its sparsity pattern
+    std::vector<real_type> C(nn * nn, 0.0);
+    std::vector<char> S(nn * nn, 0);
+    for (size_t k = 0; k < nn; ++k) {
+      const index_type col = Q[k];
+      for (index_type p = Bp[col]; p < Bp[col + 1]; ++p) {
+        C[static_cast<size_t>(Bi[p]) * nn + k] = Bx[p];
+        S[static_cast<size_t>(Bi[p]) * nn + k] = 1;
+      }
+    }
+    for (size_t i = 0; i < nn; ++i) {
+      P[i] = static_cast<index_type>(i);
+    }
+
+    for (size_t k = 0; k < nn; ++k) {
+      size_t piv = k;
+      for (size_t i = k + 1; i < nn; ++i) {
+        if (std::abs(C[i * nn + k]) > std::abs(C[piv * nn + k])) {
+          piv = i;
+        }
+      }
+      if (C[piv * nn + k] == 0.0) {
+        return false;
+      }
+      if (piv != k) {
+        std::swap(P[k], P[piv]);
+        for (size_t j = 0; j < nn; ++j) {
+          std::swap(C[k * nn + j], C[piv * nn + j]);
+          std::swap(S[k * nn + j], S[piv * nn + j]);
+        }
+      }
+      for (size_t i = k + 1; i < nn; ++i) {
+        if (!S[i * nn + k]) {
+          continue;
+        }
+        C[i * nn + k] /= C[k * nn + k];
+        for (size_t j = k + 1; j < nn; ++j) {
+          if (S[k * nn + j]) {
+            C[i * nn + j] -= C[i * nn + k] * C[k * nn + j];
+            S[i * nn + j] = 1;
+          }
+        }
+      }
+    }
+
+    index_type nnzL = 0;
+    index_type nnzU = 0;
+    for (size_t i = 0; i < nn; ++i) {
+      for (size_t j = 0; j < nn; ++j) {
+        if (i > j && S[i * nn + j]) {
+          ++nnzL;
+        }
+        if (i <= j && S[i * nn + j]) {
+          ++nnzU;
+        }
+      }
+    }
+    nnzL += n;
+
+    *L = new matrix::Csc(n, n, nnzL);
+    *U = new matrix::Csc(n, n, nnzU);
+    (*L)->allocateMatrixData(memory::HOST);
+    (*U)->allocateMatrixData(memory::HOST);
+    index_type* Lp = (*L)->getColData(memory::HOST);
+    index_type* Li = (*L)->getRowData(memory::HOST);
+    real_type*  Lx = (*L)->getValues( memory::HOST);
+    index_type* Up = (*U)->getColData(memory::HOST);
+    index_type* Ui = (*U)->getRowData(memory::HOST);
+    real_type*  Ux = (*U)->getValues( memory::HOST);
+
+    // Store diagonal of L last and U entries in reverse order to test
+    // that the solver does not rely on sorted row indices.
+    index_type lnz = 0;
+    index_type unz = 0;
+    Lp[0] = 0;
+    Up[0] = 0;
+    for (size_t j = 0; j < nn; ++j) {
+      for (size_t i = j + 1; i < nn; ++i) {
+        if (S[i * nn + j]) {
+          Li[lnz] = static_cast<index_type>(i);
+          Lx[lnz] = C[i * nn + j];
+          ++lnz;
+        }
+      }
+      Li[lnz] = static_cast<index_type>(j);
+      Lx[lnz] = 1.0;
+      ++lnz;
+      for (size_t i = j + 1; i-- > 0; ) {
+        if (S[i * nn + j]) {
+          Ui[unz] = static_cast<index_type>(i);
+          Ux[unz] = C[i * nn + j];
+          ++unz;
+        }
+      }
+      Lp[j + 1] = lnz;
+      Up[j + 1] = unz;
+    }
+    (*L)->setUpdated(memory::HOST);
+    (*U)->setUpdated(memory::HOST);
+
+    return true;
+  }
+
+  /**
+   * @brief Computes ||b - A^T x||_2 / ||b||_2.
+   * 
+   * KLU convention is that CSR arrays of A are CSC arrays of the factored
+   * matrix, so the computed solution solves the transposed system.
+   */
+  real_type transposeResidual(matrix::Csr* A, vector::Vector& b, vector::Vector& x)
+  {
+    const index_type n = A->getNumRows();
+    const index_type* rows = A->getRowData(memory::HOST);
+    const index_type* cols = A->getColData(memory::HOST);
+    const real_type*  vals = A->getValues( memory::HOST);
+    const real_type*  xd   = x.getData(memory::HOST);
+    const real_type*  bd   = b.getData(memory::HOST);
+
+    std::vector<real_type> r(bd, bd + n);
+    for (index_type i = 0; i < n; ++i) {
+      for (index_type p = rows[i]; p < rows[i + 1]; ++p) {
+        r[static_cast<size_t>(cols[p])] -= vals[p] * xd[i];
+      }
+    }
+    real_type norm_r = 0.0;
+    real_type norm_b = 0.0;
+    for (index_type i = 0; i < n; ++i) {
+      norm_r += r[static_cast<size_t>(i)] * r[static_cast<size_t>(i)];
+      norm_b += bd[i] * bd[i];
+    }
+    return std::sqrt(norm_r / norm_b);
+  }
+
   // Lower triangular part of the test matrix A:
   //
   //            [                                                              ]
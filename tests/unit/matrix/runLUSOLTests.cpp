@@ -12,6 +12,10 @@ int main(int, char**)
 
     result += test.lusolConstructor();
     result += test.simpleSolve();
+    result += test.replaceColumn();
+    result += test.rankOneUpdate();
+    result += test.workspaceGrowth();
+    result += test.solveAfterFailedFactorization();
 
     std::cout << "\n";
   }
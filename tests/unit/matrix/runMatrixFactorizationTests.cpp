@@ -15,6 +15,10 @@ int main(int, char**)
       
     result += test.matrixFactorizationConstructor();
     result += test.matrixILU0();
+    result += test.matrixILU0SinglePrecisionResetup();
+    result += test.matrixILU0PrecisionChange();
+    result += test.matrixCpuRf();
+    result += test.matrixSparseRhsSolve();
 
     std::cout << "\n";
   }
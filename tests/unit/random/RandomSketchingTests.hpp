@@ -0,0 +1,295 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cmath>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/random/SketchingHandler.hpp>
+#include <resolve/random/cpuSketchingKernels.h>
+#include <resolve/utilities/threads/Threads.hpp>
+#include <tests/unit/TestBase.hpp>
+
+namespace ReSolve
+{ 
+  namespace tests
+  {
+    /**
+     * @brief Tests for random sketching methods on the host.
+     * 
+     */
+    class RandomSketchingTests : TestBase
+    {
+      using SketchingMethod = LinSolverIterativeRandFGMRES::SketchingMethod;
+
+      public:       
+        RandomSketchingTests()
+        {
+        }
+
+        virtual ~RandomSketchingTests()
+        {
+        }
+
+        /**
+         * @brief Block sketch matches vector-by-vector sketch.
+         * 
+         * The test runs with several host threads, so that the vectors of
+         * the block are split between threads.
+         */
+        TestOutcome blockTheta(SketchingMethod method, index_type n, index_type k, index_type num_vecs)
+        {
+          TestStatus status;
+          std::string testname = std::string(__func__) + " (" + methodName(method) + ")";
+
+          SketchingHandler sketch(method, memory::NONE);
+          status *= (sketch.setup(n, k) == 0);
+
+          vector::Vector V(n, num_vecs);
+          V.allocate(memory::HOST);
+          fillVectors(V.getData(memory::HOST), n, num_vecs);
+          V.setDataUpdated(memory::HOST);
+
+          vector::Vector S_block(k, num_vecs);
+          S_block.allocate(memory::HOST);
+          S_block.setToZero(memory::HOST);
+          vector::Vector S_loop(k, num_vecs);
+          S_loop.allocate(memory::HOST);
+          S_loop.setToZero(memory::HOST);
+
+          const int num_threads = threads::getNumThreads();
+          threads::setNumThreads(4);
+          status *= (sketch.Theta(&V, &S_block, num_vecs) == 0);
+          threads::setNumThreads(num_threads);
+
+          vector::Vector vec_v(n);
+          vector::Vector vec_s(k);
+          for (index_type j = 0; j < num_vecs; ++j) {
+            vec_v.setData(V.getVectorData(j, memory::HOST), memory::HOST);
+            vec_s.setData(S_loop.getVectorData(j, memory::HOST), memory::HOST);
+            status *= (sketch.Theta(&vec_v, &vec_s) == 0);
+          }
+
+          const real_type* block = S_block.getData(memory::HOST);
+          const real_type* loop  = S_loop.getData(memory::HOST);
+          real_type max_diff = 0.0;
+          real_type max_val  = 0.0;
+          for (index_type i = 0; i < k * num_vecs; ++i) {
+            max_diff = std::max(max_diff, std::abs(block[i] - loop[i]));
+            max_val  = std::max(max_val, std::abs(loop[i]));
+          }
+          if (max_diff > 1e-12 * max_val) {
+            std::cout << "Block sketch differs from single vector sketch by " << max_diff << "\n";
+            status *= false;
+          }
+
+          return status.report(testname.c_str());
+        }
+
+        /**
+         * @brief Threaded sketch matches single-threaded sketch.
+         * 
+         * The vector is long enough for the sketch to be split between
+         * several host threads, so that the threaded scatter-reduction path
+         * is exercised. Sketching is repeated to reuse pooled threads.
+         */
+        TestOutcome threadedTheta(SketchingMethod method, index_type n, index_type k)
+        {
+          TestStatus status;
+          std::string testname = std::string(__func__) + " (" + methodName(method) + ")";
+
+          SketchingHandler sketch(method, memory::NONE);
+          status *= (sketch.setup(n, k) == 0);
+
+          vector::Vector vec_v(n);
+          vec_v.allocate(memory::HOST);
+          fillVectors(vec_v.getData(memory::HOST), n, 1);
+          vec_v.setDataUpdated(memory::HOST);
+
+          vector::Vector vec_serial(k);
+          vec_serial.allocate(memory::HOST);
+          vec_serial.setToZero(memory::HOST);
+          vector::Vector vec_threaded(k);
+          vec_threaded.allocate(memory::HOST);
+
+          const int num_threads = threads::getNumThreads();
+          threads::setNumThreads(1);
+          status *= (sketch.Theta(&vec_v, &vec_serial) == 0);
+          threads::setNumThreads(4);
+          for (int rep = 0; rep < 3; ++rep) {
+            vec_threaded.setToZero(memory::HOST);
+            status *= (sketch.Theta(&vec_v, &vec_threaded) == 0);
+          }
+          threads::setNumThreads(num_threads);
+
+          const real_type* threaded = vec_threaded.getData(memory::HOST);
+          const real_type* serial   = vec_serial.getData(memory::HOST);
+          real_type max_diff = 0.0;
+          real_type max_val  = 0.0;
+          for (index_type i = 0; i < k; ++i) {
+            max_diff = std::max(max_diff, std::abs(threaded[i] - serial[i]));
+            max_val  = std::max(max_val, std::abs(serial[i]));
+          }
+          if (max_diff > 1e-12 * max_val) {
+            std::cout << "Threaded sketch differs from serial sketch by " << max_diff << "\n";
+            status *= false;
+          }
+
+          return status.report(testname.c_str());
+        }
+
+        /**
+         * @brief Sketch approximately preserves the norm of a vector.
+         * 
+         * Norm of the sketched vector is expected to be within 50% of the
+         * norm of the original vector with overwhelming probability.
+         */
+        TestOutcome normPreservation(SketchingMethod method, index_type n, index_type k)
+        {
+          TestStatus status;
+          std::string testname = std::string(__func__) + " (" + methodName(method) + ")";
+
+          SketchingHandler sketch(method, memory::NONE);
+          status *= (sketch.setup(n, k) == 0);
+
+          vector::Vector vec_v(n);
+          vec_v.allocate(memory::HOST);
+          fillVectors(vec_v.getData(memory::HOST), n, 1);
+          vec_v.setDataUpdated(memory::HOST);
+
+          vector::Vector vec_s(k);
+          vec_s.allocate(memory::HOST);
+          vec_s.setToZero(memory::HOST);
+          status *= (sketch.Theta(&vec_v, &vec_s) == 0);
+
+          real_type nrm_v = norm(vec_v.getData(memory::HOST), n);
+          real_type nrm_s = norm(vec_s.getData(memory::HOST), k);
+          if (std::abs(nrm_s / nrm_v - 1.0) > 0.5) {
+            std::cout << "Sketched norm " << nrm_s << ", original norm " << nrm_v << "\n";
+            status *= false;
+          }
+
+          return status.report(testname.c_str());
+        }
+
+        /**
+         * @brief Sketches set up with the same seed are identical, while
+         * sketches set up without a seed differ even when set up at the
+         * same time.
+         */
+        TestOutcome seeding(SketchingMethod method, index_type n, index_type k)
+        {
+          TestStatus status;
+          std::string testname = std::string(__func__) + " (" + methodName(method) + ")";
+
+          vector::Vector vec_v(n);
+          vec_v.allocate(memory::HOST);
+          fillVectors(vec_v.getData(memory::HOST), n, 1);
+          vec_v.setDataUpdated(memory::HOST);
+
+          std::vector<std::vector<real_type>> sketches;
+          for (int i = 0; i < 4; ++i) {
+            SketchingHandler sketch(method, memory::NONE);
+            if (i < 2) {
+              sketch.setSeed(42);
+            }
+            status *= (sketch.setup(n, k) == 0);
+
+            vector::Vector vec_s(k);
+            vec_s.allocate(memory::HOST);
+            vec_s.setToZero(memory::HOST);
+            status *= (sketch.Theta(&vec_v, &vec_s) == 0);
+            const real_type* s = vec_s.getData(memory::HOST);
+            sketches.push_back(std::vector<real_type>(s, s + k));
+          }
+
+          if (sketches[0] != sketches[1]) {
+            std::cout << "Sketches with the same seed differ\n";
+            status *= false;
+          }
+          if (sketches[2] == sketches[3]) {
+            std::cout << "Sketches without seed are identical\n";
+            status *= false;
+          }
+
+          return status.report(testname.c_str());
+        }
+
+        /**
+         * @brief Tiled, threaded FWHT kernel matches textbook radix-2
+         * transform.
+         */
+        TestOutcome fwhtKernel(index_type log2N)
+        {
+          TestStatus status;
+          std::string testname = std::string(__func__) + " (N = 2^" + std::to_string(log2N) + ")";
+
+          const index_type N = static_cast<index_type>(1) << log2N;
+          std::vector<real_type> x(static_cast<size_t>(N));
+          fillVectors(x.data(), N, 1);
+          std::vector<real_type> y(x);
+
+          const int num_threads = threads::getNumThreads();
+          threads::setNumThreads(4);
+          cpu::FWHT(0, log2N, x.data());
+          threads::setNumThreads(num_threads);
+
+          for (index_type h = 1; h < N; h *= 2) {
+            for (index_type i = 0; i < N; i += 2 * h) {
+              for (index_type j = i; j < i + h; ++j) {
+                real_type a = y[j];
+                real_type b = y[j + h];
+                y[j] = a + b;
+                y[j + h] = a - b;
+              }
+            }
+          }
+
+          real_type max_diff = 0.0;
+          real_type max_val  = 0.0;
+          for (index_type i = 0; i < N; ++i) {
+            max_diff = std::max(max_diff, std::abs(x[i] - y[i]));
+            max_val  = std::max(max_val, std::abs(y[i]));
+          }
+          if (max_diff > 1e-12 * max_val) {
+            std::cout << "FWHT differs from reference by " << max_diff << "\n";
+            status *= false;
+          }
+
+          return status.report(testname.c_str());
+        }
+
+      private:
+        static std::string methodName(SketchingMethod method)
+        {
+          switch (method) {
+            case LinSolverIterativeRandFGMRES::cs:
+              return "count sketch";
+            case LinSolverIterativeRandFGMRES::fwht:
+              return "FWHT";
+            case LinSolverIterativeRandFGMRES::sse:
+              return "sparse sign";
+            case LinSolverIterativeRandFGMRES::srht:
+              return "SRHT";
+          }
+          return "unknown";
+        }
+
+        static void fillVectors(real_type* data, index_type n, index_type num_vecs)
+        {
+          for (index_type j = 0; j < num_vecs; ++j) {
+            for (index_type i = 0; i < n; ++i) {
+              data[j * n + i] = std::sin(0.37 * static_cast<real_type>(i + 1) * static_cast<real_type>(j + 1)) + 0.05 * static_cast<real_type>(j);
+            }
+          }
+        }
+
+        static real_type norm(const real_type* x, index_type n)
+        {
+          real_type sum = 0.0;
+          for (index_type i = 0; i < n; ++i) {
+            sum += x[i] * x[i];
+          }
+          return std::sqrt(sum);
+        }
+    }; // class RandomSketchingTests
+  }
+}
@@ -0,0 +1,36 @@
+#include <string>
+#include <iostream>
+#include "RandomSketchingTests.hpp"
+
+int main(int, char**)
+{
+  using ReSolve::LinSolverIterativeRandFGMRES;
+
+  ReSolve::tests::TestingResults result; 
+
+  {
+    std::cout << "Running tests on the CPU:\n";
+
+    ReSolve::tests::RandomSketchingTests test;
+    for (ReSolve::index_type log2N : {0, 1, 2, 3, 5, 12, 13, 14, 17}) {
+      result += test.fwhtKernel(log2N);
+    }
+    result += test.blockTheta(LinSolverIterativeRandFGMRES::cs,   50000, 300, 7);
+    result += test.blockTheta(LinSolverIterativeRandFGMRES::fwht, 50000, 300, 7);
+    result += test.blockTheta(LinSolverIterativeRandFGMRES::sse,  50000, 300, 7);
+    result += test.blockTheta(LinSolverIterativeRandFGMRES::srht, 50000, 300, 7);
+    result += test.threadedTheta(LinSolverIterativeRandFGMRES::cs,   100000, 300);
+    result += test.threadedTheta(LinSolverIterativeRandFGMRES::fwht, 100000, 300);
+    result += test.threadedTheta(LinSolverIterativeRandFGMRES::sse,  100000, 300);
+    result += test.threadedTheta(LinSolverIterativeRandFGMRES::srht, 100000, 300);
+    result += test.normPreservation(LinSolverIterativeRandFGMRES::cs,   10000, 500);
+    result += test.normPreservation(LinSolverIterativeRandFGMRES::sse,  10000, 500);
+    result += test.normPreservation(LinSolverIterativeRandFGMRES::srht, 10000, 500);
+    result += test.seeding(LinSolverIterativeRandFGMRES::cs,   10000, 500);
+    result += test.seeding(LinSolverIterativeRandFGMRES::sse,  10000, 500);
+    result += test.seeding(LinSolverIterativeRandFGMRES::srht, 10000, 500);
+    std::cout << "\n";
+  }
+
+  return result.summary();
+}
@@ -0,0 +1,237 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <resolve/BatchedSystemSolver.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include <tests/unit/TestBase.hpp>
+#include <tests/unit/TestMatrices.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @class Unit tests for batched solver of systems with the same pattern
+     */
+    class BatchedSystemSolverTests : TestBase
+    {
+      public:
+        BatchedSystemSolverTests()
+        {
+        }
+
+        virtual ~BatchedSystemSolverTests()
+        {
+        }
+
+        TestOutcome solveBatch()
+        {
+          TestStatus status;
+
+          const int num_threads = threads::getNumThreads();
+          threads::setNumThreads(4);
+
+          // Batch size is not a multiple of the storage block size.
+          const index_type batch_size = 13;
+          matrix::Csr* A = createArrowMatrix(6);
+          Batch batch = createBatch(A, batch_size);
+
+          BatchedSystemSolver solver;
+          status *= (solver.analyze(A) == 0);
+          // Dense first row and column fill in the whole matrix.
+          status *= (solver.getNnzFactors() == 36);
+          status *= (solver.factorize(batch_size, batch.values()) == 0);
+          status *= (solver.getNumFailed() == 0);
+          status *= (solver.solve(batch.rhs(), batch.x()) == 0);
+
+          for (index_type s = 0; s < batch_size; ++s) {
+            status *= verifyResidual(A, batch, s);
+          }
+
+          threads::setNumThreads(num_threads);
+          delete A;
+
+          return status.report(__func__);
+        }
+
+        TestOutcome permutedAnalysis()
+        {
+          TestStatus status;
+
+          const index_type n = 6;
+          const index_type batch_size = 5;
+          matrix::Csr* A = createArrowMatrix(n);
+          Batch batch = createBatch(A, batch_size);
+
+          // Reversing rows and columns moves the dense row and column last,
+          // so there is no fill-in.
+          std::vector<index_type> perm(n);
+          for (index_type i = 0; i < n; ++i) {
+            perm[i] = n - 1 - i;
+          }
+
+          BatchedSystemSolver solver;
+          status *= (solver.analyze(A, perm.data(), perm.data()) == 0);
+          status *= (solver.getNnzFactors() == A->getNnz());
+          status *= (solver.factorize(batch_size, batch.values()) == 0);
+          status *= (solver.solve(batch.rhs(), batch.x()) == 0);
+
+          for (index_type s = 0; s < batch_size; ++s) {
+            status *= verifyResidual(A, batch, s);
+          }
+
+          // Invalid permutation is rejected.
+          perm[0] = perm[1];
+          status *= (solver.analyze(A, perm.data(), nullptr) != 0);
+
+          delete A;
+
+          return status.report(__func__);
+        }
+
+        TestOutcome zeroPivot()
+        {
+          TestStatus status;
+
+          const index_type batch_size = 10;
+          const index_type failed = 3;
+          matrix::Csr* A = createArrowMatrix(6);
+          Batch batch = createBatch(A, batch_size);
+
+          // First value in CSR order is the (0, 0) entry.
+          batch.vals[failed][0] = 0.0;
+
+          BatchedSystemSolver solver;
+          status *= (solver.factorize(batch_size, batch.values()) != 0);
+          status *= (solver.analyze(A) == 0);
+          status *= (solver.factorize(batch_size, batch.values()) != 0);
+          status *= (solver.getNumFailed() == 1);
+          status *= (solver.getStatus(failed) == 1);
+          status *= (solver.solve(batch.rhs(), batch.x()) == 0);
+
+          // Other systems in the same storage block are not affected.
+          for (index_type s = 0; s < batch_size; ++s) {
+            if (s != failed) {
+              status *= (solver.getStatus(s) == 0);
+              status *= verifyResidual(A, batch, s);
+            }
+          }
+
+          delete A;
+
+          return status.report(__func__);
+        }
+
+      private:
+        /// Values, right-hand sides and solutions of a batch of systems
+        struct Batch
+        {
+          std::vector<std::vector<real_type>> vals;
+          std::vector<std::vector<real_type>> b;
+          std::vector<std::vector<real_type>> sol;
+          std::vector<const real_type*> val_ptrs;
+          std::vector<const real_type*> b_ptrs;
+          std::vector<real_type*> sol_ptrs;
+
+          const real_type* const* values()
+          {
+            val_ptrs.clear();
+            for (auto& v : vals) {
+              val_ptrs.push_back(v.data());
+            }
+            return val_ptrs.data();
+          }
+
+          const real_type* const* rhs()
+          {
+            b_ptrs.clear();
+            for (auto& v : b) {
+              b_ptrs.push_back(v.data());
+            }
+            return b_ptrs.data();
+          }
+
+          real_type* const* x()
+          {
+            sol_ptrs.clear();
+            for (auto& v : sol) {
+              sol_ptrs.push_back(v.data());
+            }
+            return sol_ptrs.data();
+          }
+        };
+
+        /**
+         * @brief Creates pattern of n x n matrix with dense first row and
+         * column, diagonal and superdiagonal.
+         */
+        matrix::Csr* createArrowMatrix(index_type n)
+        {
+          std::vector<index_type> rows(1, 0);
+          std::vector<index_type> cols;
+          for (index_type i = 0; i < n; ++i) {
+            for (index_type j = 0; j < n; ++j) {
+              if (i == 0 || j == 0 || j == i || j == i + 1) {
+                cols.push_back(j);
+              }
+            }
+            rows.push_back(static_cast<index_type>(cols.size()));
+          }
+          std::vector<real_type> vals(cols.size(), 1.0);
+          return createCsrMatrix(n, rows, cols, vals);
+        }
+
+        /// @brief Creates diagonally dominant systems with pattern of A
+        Batch createBatch(matrix::Csr* A, index_type batch_size)
+        {
+          const index_type n = A->getNumRows();
+          const index_type* rows = A->getRowData(memory::HOST);
+          const index_type* cols = A->getColData(memory::HOST);
+
+          Batch batch;
+          for (index_type s = 0; s < batch_size; ++s) {
+            std::vector<real_type> vals;
+            std::vector<real_type> b;
+            for (index_type i = 0; i < n; ++i) {
+              for (index_type p = rows[i]; p < rows[i + 1]; ++p) {
+                const index_type j = cols[p];
+                vals.push_back((i == j) ? 20.0 + s : 0.5 * ((i + 2 * j + s) % 5) - 1.1);
+              }
+              b.push_back(1.0 + 0.1 * (i + s));
+            }
+            batch.vals.push_back(vals);
+            batch.b.push_back(b);
+            batch.sol.push_back(std::vector<real_type>(static_cast<size_t>(n), 0.0));
+          }
+          return batch;
+        }
+
+        /// @brief Checks residual of system s in the batch in max norm
+        bool verifyResidual(matrix::Csr* A, const Batch& batch, index_type s)
+        {
+          const index_type n = A->getNumRows();
+          const index_type* rows = A->getRowData(memory::HOST);
+          const index_type* cols = A->getColData(memory::HOST);
+
+          real_type max_res = 0.0;
+          for (index_type i = 0; i < n; ++i) {
+            real_type r = batch.b[s][i];
+            for (index_type p = rows[i]; p < rows[i + 1]; ++p) {
+              r -= batch.vals[s][p] * batch.sol[s][cols[p]];
+            }
+            max_res = std::max(max_res, std::abs(r));
+          }
+
+          if (!(max_res < 1e-12)) {
+            std::cout << "Residual of system " << s << " is " << max_res << "\n";
+            return false;
+          }
+          return true;
+        }
+    }; // class BatchedSystemSolverTests
+  }    // namespace tests
+} // namespace ReSolve
@@ -0,0 +1,104 @@
+#pragma once
+#include <string>
+
+#include <resolve/ConvergenceHistory.hpp>
+#include <resolve/SystemSolver.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/workspace/LinAlgWorkspaceCpu.hpp>
+#include <tests/unit/TestBase.hpp>
+#include <tests/unit/TestMatrices.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @class Unit tests for convergence history of iterative solvers
+     */
+    class ConvergenceHistoryTests : TestBase
+    {
+      public:
+        ConvergenceHistoryTests()
+        {
+        }
+
+        virtual ~ConvergenceHistoryTests()
+        {
+        }
+
+        TestOutcome convergenceHistory()
+        {
+          TestStatus status;
+
+          const index_type grid = 10;
+          const index_type n = grid * grid;
+          const index_type restart = 5;
+          matrix::Csr* A = createLaplacianCsrMatrix(grid);
+
+          LinAlgWorkspaceCpu workspace;
+          workspace.initializeHandles();
+
+          const std::string methods[] = {"fgmres", "randgmres"};
+          for (const std::string& method : methods) {
+            SystemSolver solver(&workspace, "none", "none", method, "ilu0", "none");
+            LinSolverIterative& krylov = solver.getIterativeSolver();
+            krylov.setTol(1e-12);
+            status *= (solver.setMatrix(A) == 0);
+            krylov.setRestart(restart);
+            status *= (solver.preconditionerSetup() == 0);
+
+            vector::Vector rhs(n);
+            rhs.allocate(memory::HOST);
+            rhs.setToConst(1.0, memory::HOST);
+            vector::Vector x(n);
+            x.allocate(memory::HOST);
+
+            // Recording is disabled by default
+            x.setToZero(memory::HOST);
+            status *= (solver.solve(&rhs, &x) == 0);
+            status *= (krylov.getConvergenceHistory().getSize() == 0);
+
+            ConvergenceHistory& history = krylov.getConvergenceHistory();
+            history.setCapacity(krylov.getMaxit());
+            history.setOrthogonalityTracking(true);
+            x.setToZero(memory::HOST);
+            status *= (solver.solve(&rhs, &x) == 0);
+
+            const index_type num_iter = krylov.getNumIter();
+            status *= (num_iter > restart);
+            status *= (history.getSize() == num_iter);
+            status *= (history.getNumDropped() == 0);
+            for (index_type k = 0; k < history.getSize(); ++k) {
+              const ConvergenceHistory::Record& record = history.get(k);
+              status *= (record.iteration == k + 1);
+              status *= (record.cycle == k / restart);
+              status *= (record.cycle_iteration == k % restart);
+              status *= (record.residual_norm >= 0.0);
+              status *= (record.orthogonality_loss >= 0.0) && (record.orthogonality_loss < 1e-6);
+              status *= (record.time_matvec >= 0.0) && (record.time_orthogonalize >= 0.0);
+              // Cycles end on restart and after the last iteration
+              const bool end_of_cycle = ((k + 1) % restart == 0) || (k + 1 == num_iter);
+              status *= (record.end_of_cycle == end_of_cycle);
+              status *= ((record.computed_residual_norm >= 0.0) == end_of_cycle);
+            }
+            const ConvergenceHistory::Record& last = history.get(history.getSize() - 1);
+            status *= (last.computed_residual_norm == krylov.getFinalResidualNorm());
+
+            // Iterations beyond capacity are counted, but not stored
+            history.setCapacity(2);
+            history.setOrthogonalityTracking(false);
+            x.setToZero(memory::HOST);
+            status *= (solver.solve(&rhs, &x) == 0);
+            status *= (history.getSize() == 2);
+            status *= (history.getNumDropped() == krylov.getNumIter() - 2);
+            status *= (history.get(1).orthogonality_loss < 0.0);
+            status *= (!history.get(1).end_of_cycle);
+          }
+
+          delete A;
+          return status.report(__func__);
+        }
+    }; // class ConvergenceHistoryTests
+  }    // namespace tests
+} // namespace ReSolve
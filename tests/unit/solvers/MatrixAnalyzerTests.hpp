@@ -0,0 +1,214 @@
+#pragma once
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <resolve/Autotuner.hpp>
+#include <resolve/MatrixAnalyzer.hpp>
+#include <resolve/SystemSolver.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/utilities/threads/Threads.hpp>
+#include <resolve/workspace/LinAlgWorkspaceCpu.hpp>
+#include <tests/unit/TestBase.hpp>
+#include <tests/unit/TestMatrices.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @class Unit tests for matrix structure analysis and autotuning
+     */
+    class MatrixAnalyzerTests : TestBase
+    {
+      public:
+        MatrixAnalyzerTests()
+        {
+        }
+
+        virtual ~MatrixAnalyzerTests()
+        {
+        }
+
+        TestOutcome laplacianStructure()
+        {
+          TestStatus status;
+
+          const index_type grid = 4;
+          matrix::Csr* A = createLaplacianCsrMatrix(grid);
+
+          MatrixAnalyzer analyzer;
+          status *= (analyzer.analyze(A) == 0);
+          const MatrixStructure& s = analyzer.getStructure();
+
+          status *= (s.num_rows == 16) && (s.num_columns == 16) && (s.nnz == 64);
+          status *= (s.min_row_length == 3) && (s.max_row_length == 5);
+          status *= isEqual(s.mean_row_length, 4.0);
+          // 4 corner rows of length 3, 8 edge and 4 interior rows of length 4 and 5
+          status *= (s.row_length_histogram == std::vector<index_type>({0, 0, 4, 12}));
+          status *= (s.lower_bandwidth == grid) && (s.upper_bandwidth == grid);
+          status *= (s.profile == 51);
+          status *= (s.block_size == 1);
+          status *= isEqual(s.pattern_symmetry, 1.0);
+          status *= s.structurally_symmetric && s.numerically_symmetric;
+          status *= (s.num_zero_diagonal == 0);
+          // Wavefronts of the natural ordering are the grid antidiagonals
+          status *= (s.lower_levels == 2 * grid - 1) && (s.upper_levels == 2 * grid - 1);
+
+          delete A;
+          return status.report(__func__);
+        }
+
+        TestOutcome blockAndTriangularStructure()
+        {
+          TestStatus status;
+          MatrixAnalyzer analyzer;
+
+          // Block diagonal matrix with dense 4 x 4 blocks
+          const index_type n = 16;
+          std::vector<index_type> rows(1, 0);
+          std::vector<index_type> cols;
+          std::vector<real_type>  vals;
+          for (index_type i = 0; i < n; ++i) {
+            for (index_type j = (i / 4) * 4; j < (i / 4) * 4 + 4; ++j) {
+              cols.push_back(j);
+              vals.push_back(i == j ? 4.0 : static_cast<real_type>(i + j));
+            }
+            rows.push_back(static_cast<index_type>(cols.size()));
+          }
+          matrix::Csr* B = createCsrMatrix(n, rows, cols, vals);
+          status *= (analyzer.analyze(B) == 0);
+          status *= (analyzer.getStructure().block_size == 4);
+          status *= isEqual(analyzer.getStructure().block_fill, 1.0);
+          status *= analyzer.getStructure().numerically_symmetric;
+          delete B;
+
+          // Lower bidiagonal matrix without diagonal in the first row
+          rows.assign(1, 0);
+          cols.clear();
+          vals.clear();
+          for (index_type i = 0; i < n; ++i) {
+            if (i > 0) {
+              cols.push_back(i - 1);
+              vals.push_back(-1.0);
+              cols.push_back(i);
+              vals.push_back(2.0);
+            }
+            rows.push_back(static_cast<index_type>(cols.size()));
+          }
+          matrix::Csr* L = createCsrMatrix(n, rows, cols, vals);
+          status *= (analyzer.analyze(L) == 0);
+          const MatrixStructure& s = analyzer.getStructure();
+          status *= (s.min_row_length == 0) && (s.row_length_histogram[0] == 1);
+          status *= (s.lower_bandwidth == 1) && (s.upper_bandwidth == 0);
+          status *= isEqual(s.pattern_symmetry, 0.0);
+          status *= !s.structurally_symmetric && !s.numerically_symmetric;
+          status *= (s.num_zero_diagonal == 1);
+          status *= (s.lower_levels == n) && (s.upper_levels == 1);
+          delete L;
+
+          status *= (analyzer.analyze(nullptr) != 0);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome autotunerCachesDecision()
+        {
+          TestStatus status;
+
+          const int num_threads = threads::getNumThreads();
+          const index_type grid = 10;
+          const index_type n = grid * grid;
+          matrix::Csr* A = createLaplacianCsrMatrix(grid);
+
+          LinAlgWorkspaceCpu workspace;
+          workspace.initializeHandles();
+          SystemSolver solver(&workspace, "none", "none", "fgmres", "ilu0", "none");
+          solver.getIterativeSolver().setTol(1e-12);
+          status *= (solver.setMatrix(A) == 0);
+
+          vector::Vector rhs(n);
+          rhs.allocate(memory::HOST);
+          rhs.setToConst(1.0, memory::HOST);
+          vector::Vector x(n);
+          x.allocate(memory::HOST);
+
+          Autotuner tuner;
+          status *= (tuner.setThreadCandidates({1, 2}) == 0);
+          status *= (tuner.setOrthogonalizationCandidates({"cgs2", "mgs"}) == 0);
+          status *= (tuner.setOrthogonalizationCandidates({"unknown"}) != 0);
+          status *= (tuner.setNumTrials(1) == 0);
+          tuner.setMinNnzPerThread(0);
+
+          status *= (tuner.tune(solver, A, &rhs, &x, memory::HOST) == 0);
+          Autotuner::Decision decision = tuner.getDecision();
+          status *= !decision.from_cache;
+          status *= (decision.time > 0.0);
+          status *= (decision.num_threads == 1 || decision.num_threads == 2);
+          status *= (decision.orthogonalization == "cgs2" || decision.orthogonalization == "mgs");
+          status *= (tuner.getStructure().nnz == A->getNnz());
+          status *= (solver.getResidualNorm(&rhs, &x) < 1e-8);
+
+          // Settings are applied to the solver
+          status *= (threads::getNumThreads() == decision.num_threads);
+          status *= (solver.getOrthogonalizationMethod() == decision.orthogonalization);
+          status *= (solver.getPreconditionerPrecision() == decision.precision);
+
+          // Same pattern is not tuned again
+          status *= (tuner.tune(solver, A, &rhs, &x, memory::HOST) == 0);
+          status *= tuner.getDecision().from_cache;
+          status *= (tuner.getDecision().num_threads == decision.num_threads);
+          status *= (tuner.getDecision().orthogonalization == decision.orthogonalization);
+
+          // Decisions survive saving and loading the cache
+          const std::string filename = "autotuner_cache_test.bin";
+          status *= (tuner.getCache().save(filename) == 0);
+          Autotuner loaded;
+          loaded.setThreadCandidates({1, 2});
+          loaded.setOrthogonalizationCandidates({"cgs2", "mgs"});
+          loaded.setMinNnzPerThread(0);
+          status *= (loaded.getCache().load(filename) == 0);
+          std::remove(filename.c_str());
+          status *= (loaded.tune(solver, A, &rhs, &x, memory::HOST) == 0);
+          status *= loaded.getDecision().from_cache;
+          status *= (loaded.getDecision().precision == decision.precision);
+
+          threads::setNumThreads(num_threads);
+          delete A;
+          return status.report(__func__);
+        }
+
+        /// Solver settings read by the autotuner report what was selected
+        TestOutcome solverMethodGetters()
+        {
+          TestStatus status;
+
+          LinAlgWorkspaceCpu workspace;
+          workspace.initializeHandles();
+          SystemSolver solver(&workspace, "none", "none", "fgmres", "ilu0", "none");
+          status *= (solver.getRefactorizationMethod() == "none");
+          status *= (solver.getSolveMethod() == "fgmres");
+          status *= (solver.getRefinementMethod() == "none");
+          status *= (solver.getPreconditionerMethod() == "ilu0");
+          status *= (solver.getPreconditionerPrecision() == "double");
+          status *= (solver.getOrthogonalizationMethod() == "cgs2");
+
+          status *= (solver.setGramSchmidtMethod("mgs") == 0);
+          status *= (solver.getOrthogonalizationMethod() == "mgs");
+          // Unknown variant falls back to cgs2
+          solver.setGramSchmidtMethod("unknown");
+          status *= (solver.getOrthogonalizationMethod() == "cgs2");
+
+          status *= (solver.setPreconditionerPrecision("single") == 0);
+          status *= (solver.getPreconditionerPrecision() == "single");
+          status *= (solver.setPreconditionerPrecision("half") != 0);
+          status *= (solver.getPreconditionerPrecision() == "single");
+
+          return status.report(__func__);
+        }
+    }; // class MatrixAnalyzerTests
+  }    // namespace tests
+} // namespace ReSolve
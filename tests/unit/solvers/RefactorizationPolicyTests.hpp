@@ -0,0 +1,244 @@
+#pragma once
+#include <iostream>
+#include <limits>
+
+#include <resolve/RefactorizationPolicy.hpp>
+#include <resolve/SystemSolver.hpp>
+#include <resolve/workspace/LinAlgWorkspaceCpu.hpp>
+#include <tests/unit/TestBase.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @class Unit tests for refactorization policy
+     */
+    class RefactorizationPolicyTests : TestBase
+    {
+      public:
+        using Policy = RefactorizationPolicy;
+
+        RefactorizationPolicyTests()
+        {
+        }
+
+        virtual ~RefactorizationPolicyTests()
+        {
+        }
+
+        TestOutcome directSequence()
+        {
+          TestStatus status;
+
+          Policy policy;
+          status *= (policy.nextAction() == Policy::factorize);
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+
+          // Without reuse, factors are always refactorized.
+          for (int i = 0; i < 3; ++i) {
+            status *= (policy.nextAction() == Policy::refactorize);
+            status *= policy.update(Policy::refactorize, 1e-14, 0, 1e-2, 0.2, 0.1);
+          }
+
+          // Refactorization with inaccurate solution falls back to factorization.
+          status *= !policy.update(Policy::refactorize, 1e-3, 0, 1e-2, 0.2, 0.1);
+          status *= (policy.nextAction() == Policy::factorize);
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+
+          const Policy::Statistics& stats = policy.getStatistics();
+          status *= (stats.num_factorizations == 2);
+          status *= (stats.num_refactorizations == 4);
+          status *= (stats.num_reuses == 0);
+          status *= (stats.num_escalations == 1);
+
+          // Reset forgets factors but keeps statistics.
+          policy.reset();
+          status *= (policy.nextAction() == Policy::factorize);
+          status *= (policy.getStatistics().num_factorizations == 2);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome reuseAndEscalation()
+        {
+          TestStatus status;
+
+          Policy policy;
+          policy.setReuseAllowed(true);
+          policy.setMaxIterations(5);
+          policy.setMaxReuses(3);
+
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+          status *= (policy.nextAction() == Policy::reuse);
+
+          // Failed reuse escalates to refactorization, then to factorization.
+          status *= !policy.update(Policy::reuse, 1e-6, 10, -1.0, 0.0, 0.05);
+          status *= (policy.nextAction() == Policy::refactorize);
+          status *= !policy.update(Policy::refactorize, 1e-6, 0, 1e-2, 0.2, 0.1);
+          status *= (policy.nextAction() == Policy::factorize);
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+
+          // Accepted reuse with too many iterations triggers refactorization.
+          status *= (policy.nextAction() == Policy::reuse);
+          status *= policy.update(Policy::reuse, 1e-12, 8, -1.0, 0.0, 0.05);
+          status *= (policy.nextAction() == Policy::refactorize);
+          status *= policy.update(Policy::refactorize, 1e-14, 0, 1e-2, 0.2, 0.1);
+
+          // Number of consecutive reuses is limited.
+          for (int i = 0; i < 3; ++i) {
+            status *= (policy.nextAction() == Policy::reuse);
+            status *= policy.update(Policy::reuse, 1e-12, 2, -1.0, 0.0, 0.05);
+          }
+          status *= (policy.nextAction() == Policy::refactorize);
+
+          const Policy::Statistics& stats = policy.getStatistics();
+          status *= (stats.num_reuses == 5);
+          status *= (stats.num_escalations == 2);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome costModel()
+        {
+          TestStatus status;
+
+          Policy policy;
+          policy.setReuseAllowed(true);
+          policy.setMaxIterations(100);
+
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+          status *= policy.update(Policy::refactorize, 1e-14, 0, 1e-2, 0.2, 0.1);
+
+          // Reuse solve slower than refactorization with direct solve
+          status *= (policy.nextAction() == Policy::reuse);
+          status *= policy.update(Policy::reuse, 1e-12, 50, -1.0, 0.0, 0.5);
+          status *= (policy.nextAction() == Policy::refactorize);
+
+          // Reuse solve faster than refactorization with direct solve
+          status *= policy.update(Policy::refactorize, 1e-14, 0, 1e-2, 0.2, 0.1);
+          status *= policy.update(Policy::reuse, 1e-12, 3, -1.0, 0.0, 0.05);
+          status *= (policy.nextAction() == Policy::reuse);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome costModelDisabled()
+        {
+          TestStatus status;
+
+          Policy policy;
+          policy.setReuseAllowed(true);
+          policy.setCostModelEnabled(false);
+          policy.setMaxIterations(10);
+          policy.setMaxReuses(100);
+
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+
+          // Factors are reused even when reuse is slower than refactorization.
+          for (int i = 0; i < 5; ++i) {
+            status *= (policy.nextAction() == Policy::reuse);
+            status *= policy.update(Policy::reuse, 1e-12, 10, -1.0, 0.0, 5.0);
+          }
+
+          // Only the iteration count triggers refactorization.
+          status *= policy.update(Policy::reuse, 1e-12, 11, -1.0, 0.0, 0.05);
+          status *= (policy.nextAction() == Policy::refactorize);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome conditionGrowth()
+        {
+          TestStatus status;
+
+          Policy policy;
+          policy.setConditionGrowthLimit(100.0);
+
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+
+          // Moderate decrease of rcond is tolerated.
+          status *= policy.update(Policy::refactorize, 1e-14, 0, 1e-3, 0.2, 0.1);
+          status *= (policy.nextAction() == Policy::refactorize);
+
+          // Large decrease of rcond requires pivoting, even if solution is accurate.
+          status *= policy.update(Policy::refactorize, 1e-14, 0, 1e-5, 0.2, 0.1);
+          status *= (policy.nextAction() == Policy::factorize);
+
+          // Unknown rcond is ignored.
+          status *= policy.update(Policy::factorize, 1e-14, 0, -1.0, 1.0, 0.1);
+          status *= policy.update(Policy::refactorize, 1e-14, 0, 1e-12, 0.2, 0.1);
+          status *= (policy.nextAction() == Policy::refactorize);
+
+          return status.report(__func__);
+        }
+
+        /**
+         * @brief Stale-factor mode set by SystemSolver keeps factors until
+         * the iteration limit is exceeded or a solve fails.
+         *
+         * Drives the policy owned by the system solver with recorded step
+         * outcomes, so no factorization solver is needed.
+         */
+        TestOutcome staleFactorPreconditioning()
+        {
+          TestStatus status;
+
+          LinAlgWorkspaceCpu workspace;
+          workspace.initializeHandles();
+
+          // Stale factors precondition FGMRES refinement only.
+          SystemSolver direct(&workspace, "none", "none", "none", "none", "none");
+          status *= (direct.setStaleFactorPreconditioning(true, 7) != 0);
+
+          SystemSolver solver(&workspace, "none", "none", "none", "none", "fgmres");
+          status *= (solver.setStaleFactorPreconditioning(true, 7) == 0);
+
+          Policy& policy = solver.getRefactorizationPolicy();
+          status *= !policy.isCostModelEnabled();
+          status *= (policy.getMaxIterations() == 7);
+          status *= (policy.getMaxReuses() == std::numeric_limits<index_type>::max());
+
+          // solveAdaptive() allows reuse once the LU preconditioner is set up.
+          policy.setReuseAllowed(true);
+          status *= (policy.nextAction() == Policy::factorize);
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+
+          // Slow reuse solves within the iteration limit keep stale factors.
+          for (int i = 0; i < 20; ++i) {
+            status *= (policy.nextAction() == Policy::reuse);
+            status *= policy.update(Policy::reuse, 1e-12, 7, -1.0, 0.0, 10.0);
+          }
+
+          // Exceeding the iteration limit refreshes the factors.
+          status *= policy.update(Policy::reuse, 1e-12, 8, -1.0, 0.0, 0.05);
+          status *= (policy.nextAction() == Policy::refactorize);
+          status *= policy.update(Policy::refactorize, 1e-14, 0, 1e-2, 0.2, 0.1);
+          status *= (policy.nextAction() == Policy::reuse);
+
+          // Inaccurate reuse escalates to refactorization, then factorization.
+          status *= !policy.update(Policy::reuse, 1e-6, 3, -1.0, 0.0, 0.05);
+          status *= (policy.nextAction() == Policy::refactorize);
+          status *= !policy.update(Policy::refactorize, 1e-6, 0, 1e-2, 0.2, 0.1);
+          status *= (policy.nextAction() == Policy::factorize);
+          status *= policy.update(Policy::factorize, 1e-14, 0, 1e-2, 1.0, 0.1);
+          status *= (policy.nextAction() == Policy::reuse);
+
+          const Policy::Statistics& stats = policy.getStatistics();
+          status *= (stats.num_factorizations == 2);
+          status *= (stats.num_refactorizations == 2);
+          status *= (stats.num_reuses == 22);
+          status *= (stats.num_escalations == 2);
+
+          // Disabling the mode restores the cost-based defaults.
+          status *= (solver.setStaleFactorPreconditioning(false, 7) == 0);
+          Policy defaults;
+          status *= policy.isCostModelEnabled();
+          status *= (policy.getMaxIterations() == defaults.getMaxIterations());
+          status *= (policy.getMaxReuses() == defaults.getMaxReuses());
+
+          return status.report(__func__);
+        }
+    }; // class RefactorizationPolicyTests
+  }    // namespace tests
+} // namespace ReSolve
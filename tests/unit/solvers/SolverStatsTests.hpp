@@ -0,0 +1,112 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <resolve/SolverStats.hpp>
+#include <resolve/SystemSolver.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/workspace/LinAlgWorkspaceCpu.hpp>
+#include <tests/unit/TestBase.hpp>
+#include <tests/unit/TestMatrices.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @class Unit tests for solver performance counters
+     */
+    class SolverStatsTests : TestBase
+    {
+      public:
+        SolverStatsTests()
+        {
+        }
+
+        virtual ~SolverStatsTests()
+        {
+        }
+
+        TestOutcome timerAndReset()
+        {
+          TestStatus status;
+
+          SolverStats stats;
+          for (int k = 0; k < 2; ++k) {
+            SolverStats::Timer timer(stats, SolverStats::matvec);
+            timer.addWork(10.0, 80.0);
+          }
+          stats.add(SolverStats::solve, 0.5, 1.0, 2.0);
+
+          status *= (stats.getNumCalls(SolverStats::matvec) == 2);
+          status *= (stats.getFlops(SolverStats::matvec) == 20.0);
+          status *= (stats.getBytes(SolverStats::matvec) == 160.0);
+          status *= (stats.getTime(SolverStats::matvec) >= 0.0);
+          status *= (stats.getNumCalls(SolverStats::solve) == 1);
+          status *= (stats.getTime(SolverStats::solve) == 0.5);
+          status *= (stats.getNumCalls(SolverStats::factorize) == 0);
+          status *= (std::string(SolverStats::getPhaseName(SolverStats::orthogonalize)) == "orthogonalize");
+
+          stats.reset();
+          for (int phase = 0; phase < SolverStats::NUM_PHASES; ++phase) {
+            const SolverStats::Counters& counters = stats.get(static_cast<SolverStats::Phase>(phase));
+            status *= (counters.num_calls == 0) && (counters.time == 0.0) &&
+                      (counters.flops == 0.0) && (counters.bytes == 0.0);
+          }
+
+          return status.report(__func__);
+        }
+
+        TestOutcome iterativeSolverCounters()
+        {
+          TestStatus status;
+
+          const index_type n = 100;
+          matrix::Csr* A = createTridiagonalCsrMatrix(n);
+
+          LinAlgWorkspaceCpu workspace;
+          workspace.initializeHandles();
+          SystemSolver solver(&workspace, "none", "none", "fgmres", "ilu0", "none");
+          solver.getIterativeSolver().setTol(1e-12);
+
+          vector::Vector rhs(n);
+          rhs.allocate(memory::HOST);
+          rhs.setToConst(1.0, memory::HOST);
+          vector::Vector x(n);
+          x.allocate(memory::HOST);
+          x.setToZero(memory::HOST);
+
+          status *= (solver.setMatrix(A) == 0);
+          status *= (solver.preconditionerSetup() == 0);
+          status *= (solver.solve(&rhs, &x) == 0);
+
+          const SolverStats& system = solver.getStats();
+          status *= (system.getNumCalls(SolverStats::factorize) == 1);
+          status *= (system.getNumCalls(SolverStats::solve) == 1);
+
+          // Every iteration applies preconditioner, multiplies by matrix
+          // and orthogonalizes. Residuals add matrix-vector products.
+          const std::uint64_t num_iter = static_cast<std::uint64_t>(solver.getIterativeSolver().getNumIter());
+          const SolverStats& krylov = solver.getIterativeSolver().getStats();
+          status *= (num_iter > 0);
+          status *= (krylov.getNumCalls(SolverStats::solve) == 1);
+          status *= (krylov.getNumCalls(SolverStats::orthogonalize) == num_iter);
+          status *= (krylov.getNumCalls(SolverStats::precondition) >= num_iter);
+          status *= (krylov.getNumCalls(SolverStats::matvec) >= num_iter + 1);
+          status *= (krylov.getFlops(SolverStats::matvec) ==
+                     2.0 * A->getNnz() * static_cast<real_type>(krylov.getNumCalls(SolverStats::matvec)));
+          status *= (krylov.getBytes(SolverStats::orthogonalize) > 0.0);
+          status *= (krylov.getTime(SolverStats::solve) >= krylov.getTime(SolverStats::matvec));
+
+          solver.resetStats();
+          status *= (solver.getStats().getNumCalls(SolverStats::solve) == 0);
+          status *= (solver.getIterativeSolver().getStats().getNumCalls(SolverStats::matvec) == 0);
+
+          delete A;
+          return status.report(__func__);
+        }
+    }; // class SolverStatsTests
+  }    // namespace tests
+} // namespace ReSolve
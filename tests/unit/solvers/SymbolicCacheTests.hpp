@@ -0,0 +1,173 @@
+#pragma once
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <resolve/SymbolicCache.hpp>
+#include <tests/unit/TestBase.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @class Unit tests for symbolic analysis cache
+     */
+    class SymbolicCacheTests : TestBase
+    {
+      public:
+        SymbolicCacheTests()
+        {
+        }
+
+        virtual ~SymbolicCacheTests()
+        {
+        }
+
+        TestOutcome hitsAndMisses()
+        {
+          TestStatus status;
+
+          SymbolicCache cache(4);
+          Pattern A = createTridiagonalPattern(5);
+          Pattern B = createTridiagonalPattern(5);
+          B.idx[1] = 2; // same sizes, different pattern
+
+          status *= (cache.find(0, A.n, A.ptr.data(), A.idx.data()) == nullptr);
+
+          SymbolicCache::Entry* entry = cache.insert(0, A.n, A.ptr.data(), A.idx.data());
+          status *= (entry != nullptr);
+          entry->ints = {1, 2, 3};
+
+          entry = cache.find(0, A.n, A.ptr.data(), A.idx.data());
+          status *= (entry != nullptr) && (entry->ints == std::vector<index_type>({1, 2, 3}));
+
+          // Different pattern or different tag is a miss.
+          status *= (cache.find(0, B.n, B.ptr.data(), B.idx.data()) == nullptr);
+          status *= (cache.find(1, A.n, A.ptr.data(), A.idx.data()) == nullptr);
+
+          if (cache.getNumHits() != 1 || cache.getNumMisses() != 3) {
+            std::cout << "Cache reports " << cache.getNumHits() << " hits and "
+                      << cache.getNumMisses() << " misses, expected 1 and 3\n";
+            status *= false;
+          }
+
+          // Inserting the same pattern again replaces the entry.
+          entry = cache.insert(0, A.n, A.ptr.data(), A.idx.data());
+          status *= (entry != nullptr) && entry->ints.empty();
+          status *= (cache.size() == 1);
+
+          // Removed entry is no longer found.
+          status *= !cache.remove(1, A.n, A.ptr.data(), A.idx.data());
+          status *= cache.remove(0, A.n, A.ptr.data(), A.idx.data());
+          status *= (cache.size() == 0);
+          status *= (cache.find(0, A.n, A.ptr.data(), A.idx.data()) == nullptr);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome leastRecentlyUsedEviction()
+        {
+          TestStatus status;
+
+          SymbolicCache cache(2);
+          Pattern A = createTridiagonalPattern(4);
+          Pattern B = createTridiagonalPattern(5);
+          Pattern C = createTridiagonalPattern(6);
+
+          cache.insert(0, A.n, A.ptr.data(), A.idx.data());
+          cache.insert(0, B.n, B.ptr.data(), B.idx.data());
+
+          // Use A so that B becomes least recently used.
+          status *= (cache.find(0, A.n, A.ptr.data(), A.idx.data()) != nullptr);
+          cache.insert(0, C.n, C.ptr.data(), C.idx.data());
+
+          status *= (cache.size() == 2);
+          status *= (cache.getNumEvictions() == 1);
+          status *= (cache.find(0, A.n, A.ptr.data(), A.idx.data()) != nullptr);
+          status *= (cache.find(0, B.n, B.ptr.data(), B.idx.data()) == nullptr);
+          status *= (cache.find(0, C.n, C.ptr.data(), C.idx.data()) != nullptr);
+
+          // Shrinking the cache evicts least recently used entries.
+          cache.setCapacity(1);
+          status *= (cache.size() == 1);
+          status *= (cache.find(0, C.n, C.ptr.data(), C.idx.data()) != nullptr);
+
+          // Cache with zero capacity stores nothing.
+          cache.setCapacity(0);
+          status *= (cache.size() == 0);
+          status *= (cache.insert(0, A.n, A.ptr.data(), A.idx.data()) == nullptr);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome saveAndLoad()
+        {
+          TestStatus status;
+
+          const std::string filename = "symbolic_cache_test.bin";
+          Pattern A = createTridiagonalPattern(4);
+          Pattern B = createTridiagonalPattern(7);
+
+          SymbolicCache cache(4);
+          SymbolicCache::Entry* entry = cache.insert(3, A.n, A.ptr.data(), A.idx.data());
+          entry->ints  = {4, 3, 2, 1};
+          entry->reals = {0.5, 1.5};
+          entry->object = std::make_shared<int>(42);
+          entry = cache.insert(1, B.n, B.ptr.data(), B.idx.data());
+          entry->ints  = {7};
+
+          status *= (cache.save(filename) == 0);
+
+          SymbolicCache loaded(4);
+          status *= (loaded.load(filename) == 0);
+          std::remove(filename.c_str());
+
+          status *= (loaded.size() == 2);
+          entry = loaded.find(3, A.n, A.ptr.data(), A.idx.data());
+          status *= (entry != nullptr);
+          if (entry != nullptr) {
+            status *= (entry->ints == std::vector<index_type>({4, 3, 2, 1}));
+            status *= (entry->reals == std::vector<real_type>({0.5, 1.5}));
+            // In-memory objects are not saved.
+            status *= !entry->object;
+          }
+          entry = loaded.find(1, B.n, B.ptr.data(), B.idx.data());
+          status *= (entry != nullptr) && (entry->ints == std::vector<index_type>({7}));
+
+          // Loading a file that is not a cache fails.
+          status *= (loaded.load(filename) != 0);
+
+          return status.report(__func__);
+        }
+
+      private:
+        /// Sparsity pattern in compressed format
+        struct Pattern
+        {
+          index_type n;
+          std::vector<index_type> ptr;
+          std::vector<index_type> idx;
+        };
+
+        /// @brief Creates pattern of n x n tridiagonal matrix
+        Pattern createTridiagonalPattern(index_type n)
+        {
+          Pattern pattern;
+          pattern.n = n;
+          pattern.ptr.push_back(0);
+          for (index_type i = 0; i < n; ++i) {
+            for (index_type j = i - 1; j <= i + 1; ++j) {
+              if (j >= 0 && j < n) {
+                pattern.idx.push_back(j);
+              }
+            }
+            pattern.ptr.push_back(static_cast<index_type>(pattern.idx.size()));
+          }
+          return pattern;
+        }
+    }; // class SymbolicCacheTests
+  }    // namespace tests
+} // namespace ReSolve
@@ -0,0 +1,21 @@
+#include <iostream>
+
+#include "BatchedSystemSolverTests.hpp"
+
+int main(int, char**)
+{
+  ReSolve::tests::TestingResults result;
+
+  {
+    std::cout << "Running batched system solver tests:\n";
+    ReSolve::tests::BatchedSystemSolverTests test;
+
+    result += test.solveBatch();
+    result += test.permutedAnalysis();
+    result += test.zeroPivot();
+
+    std::cout << "\n";
+  }
+
+  return result.summary();
+}
@@ -0,0 +1,19 @@
+#include <iostream>
+
+#include "ConvergenceHistoryTests.hpp"
+
+int main(int, char**)
+{
+  ReSolve::tests::TestingResults result;
+
+  {
+    std::cout << "Running convergence history tests:\n";
+    ReSolve::tests::ConvergenceHistoryTests test;
+
+    result += test.convergenceHistory();
+
+    std::cout << "\n";
+  }
+
+  return result.summary();
+}
@@ -0,0 +1,22 @@
+#include <iostream>
+
+#include "MatrixAnalyzerTests.hpp"
+
+int main(int, char**)
+{
+  ReSolve::tests::TestingResults result;
+
+  {
+    std::cout << "Running matrix analyzer tests:\n";
+    ReSolve::tests::MatrixAnalyzerTests test;
+
+    result += test.laplacianStructure();
+    result += test.blockAndTriangularStructure();
+    result += test.autotunerCachesDecision();
+    result += test.solverMethodGetters();
+
+    std::cout << "\n";
+  }
+
+  return result.summary();
+}
@@ -0,0 +1,24 @@
+#include <iostream>
+
+#include "RefactorizationPolicyTests.hpp"
+
+int main(int, char**)
+{
+  ReSolve::tests::TestingResults result;
+
+  {
+    std::cout << "Running refactorization policy tests:\n";
+    ReSolve::tests::RefactorizationPolicyTests test;
+
+    result += test.directSequence();
+    result += test.reuseAndEscalation();
+    result += test.costModel();
+    result += test.costModelDisabled();
+    result += test.conditionGrowth();
+    result += test.staleFactorPreconditioning();
+
+    std::cout << "\n";
+  }
+
+  return result.summary();
+}
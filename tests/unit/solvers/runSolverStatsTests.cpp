@@ -0,0 +1,20 @@
+#include <iostream>
+
+#include "SolverStatsTests.hpp"
+
+int main(int, char**)
+{
+  ReSolve::tests::TestingResults result;
+
+  {
+    std::cout << "Running solver performance counter tests:\n";
+    ReSolve::tests::SolverStatsTests test;
+
+    result += test.timerAndReset();
+    result += test.iterativeSolverCounters();
+
+    std::cout << "\n";
+  }
+
+  return result.summary();
+}
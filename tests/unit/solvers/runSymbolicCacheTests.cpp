@@ -0,0 +1,21 @@
+#include <iostream>
+
+#include "SymbolicCacheTests.hpp"
+
+int main(int, char**)
+{
+  ReSolve::tests::TestingResults result;
+
+  {
+    std::cout << "Running symbolic cache tests:\n";
+    ReSolve::tests::SymbolicCacheTests test;
+
+    result += test.hitsAndMisses();
+    result += test.leastRecentlyUsedEviction();
+    result += test.saveAndLoad();
+
+    std::cout << "\n";
+  }
+
+  return result.summary();
+}
@@ -5,10 +5,12 @@
  */
 
 #pragma once
+#include <cstdio>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <iterator>
+#include <thread>
 #include <tests/unit/TestBase.hpp>
 
 namespace ReSolve { namespace tests {
@@ -165,6 +167,239 @@ namespace ReSolve { namespace tests {
       return status.report(__func__);
     }
 
+    /**
+     * @brief Test logging from several threads at the same time.
+     * 
+     * Each thread builds its messages from several pieces. Messages from
+     * different threads must not interleave within a line.
+     */
+    TestOutcome concurrentOutput()
+    {
+      using out = ReSolve::io::Logger;
+      const int num_threads = 4;
+      const int num_messages = 200;
+
+      TestStatus status;
+
+      std::ostringstream file;
+
+      out::setOutput(file);
+      out::setVerbosity(out::WARNINGS);
+
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([t, num_messages]() {
+          for (int i = 0; i < num_messages; ++i) {
+            out::warning() << "thread " << t << " message " << i << " of " << num_messages << "\n";
+            out::misc() << "this message is not logged\n";
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+
+      // Every line is a complete message and every message is logged once.
+      std::vector<int> count(num_threads, 0);
+      const std::string prefix = warning_text() + "thread ";
+      std::istringstream lines(file.str());
+      std::string line;
+      while (std::getline(lines, line)) {
+        int t = -1;
+        int i = -1;
+        if (line.compare(0, prefix.size(), prefix) != 0 ||
+            std::sscanf(line.c_str() + prefix.size(), "%d message %d of", &t, &i) != 2 ||
+            t < 0 || t >= num_threads || i != count[t] ||
+            line != prefix + std::to_string(t) + " message " + std::to_string(i)
+                    + " of " + std::to_string(num_messages)) {
+          std::cout << "Unexpected log line: " << line << "\n";
+          status = false;
+          break;
+        }
+        ++count[t];
+      }
+      for (int t = 0; t < num_threads; ++t) {
+        status *= (count[t] == num_messages);
+      }
+
+      out::setOutput(std::cout);
+
+      return status.report(__func__);
+    }
+
+    /**
+     * @brief Test that macros do not evaluate messages of disabled levels.
+     */
+    TestOutcome lazyOutput()
+    {
+      using out = ReSolve::io::Logger;
+      std::string s1("Test warning output ...\n");
+      std::string answer = warning_text() + s1;
+
+      TestStatus status;
+
+      std::ostringstream file;
+
+      out::setOutput(file);
+      out::setVerbosity(out::WARNINGS);
+      status *= out::isEnabled(out::ERRORS) && out::isEnabled(out::WARNINGS);
+      status *= !out::isEnabled(out::SUMMARY) && !out::isEnabled(out::EVERYTHING);
+
+      int num_evaluated = 0;
+      auto message = [&num_evaluated](const std::string& s) {
+        ++num_evaluated;
+        return s;
+      };
+      RESOLVE_LOG_WARNING << message(s1);
+      RESOLVE_LOG_SUMMARY << message(s1);
+      RESOLVE_LOG_MISC    << message(s1);
+      status *= (num_evaluated == 1);
+
+      // Macros can be used as statements in if-else without braces.
+      if (num_evaluated == 0)
+        RESOLVE_LOG_ERROR << message(s1);
+      else
+        ++num_evaluated;
+      status *= (num_evaluated == 2);
+
+      status *= (answer == file.str());
+
+      out::setOutput(std::cout);
+
+      return status.report(__func__);
+    }
+
+    /**
+     * @brief Test logging from several threads in asynchronous mode.
+     * 
+     * All lines must be written once, in order within each thread, by the
+     * time flush() returns.
+     */
+    TestOutcome asynchronousOutput()
+    {
+      using out = ReSolve::io::Logger;
+      const int num_threads = 4;
+      const int num_messages = 200;
+
+      TestStatus status;
+
+      std::ostringstream file;
+
+      out::setOutput(file);
+      out::setVerbosity(out::WARNINGS);
+      out::setAsynchronous(true);
+      status *= out::isAsynchronous();
+
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([t, num_messages]() {
+          for (int i = 0; i < num_messages; ++i) {
+            RESOLVE_LOG_WARNING << "thread " << t << " message " << i << "\n";
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      out::flush();
+
+      std::vector<int> count(num_threads, 0);
+      const std::string prefix = warning_text() + "thread ";
+      std::istringstream lines(file.str());
+      std::string line;
+      while (std::getline(lines, line)) {
+        int t = -1;
+        int i = -1;
+        if (line.compare(0, prefix.size(), prefix) != 0 ||
+            std::sscanf(line.c_str() + prefix.size(), "%d message %d", &t, &i) != 2 ||
+            t < 0 || t >= num_threads || i != count[t]) {
+          std::cout << "Unexpected log line: " << line << "\n";
+          status = false;
+          break;
+        }
+        ++count[t];
+      }
+      for (int t = 0; t < num_threads; ++t) {
+        status *= (count[t] == num_messages);
+      }
+
+      // Lines queued before the output changes go to the old output.
+      std::ostringstream other;
+      out::warning() << "last line\n";
+      out::setOutput(other);
+      status *= (file.str().find("last line") != std::string::npos);
+      status *= other.str().empty();
+
+      out::setAsynchronous(false);
+      status *= !out::isAsynchronous();
+      out::warning() << "synchronous line\n";
+      status *= (other.str() == warning_text() + "synchronous line\n");
+
+      out::setOutput(std::cout);
+
+      return status.report(__func__);
+    }
+
+    /**
+     * @brief Test flushing asynchronous output while other threads log.
+     * 
+     * Each thread flushes after every line, so flush() waits while lines
+     * are still being queued. Every flush must return and all lines must
+     * be written.
+     */
+    TestOutcome asynchronousFlush()
+    {
+      using out = ReSolve::io::Logger;
+      const int num_threads = 4;
+      const int num_messages = 100;
+
+      TestStatus status;
+
+      std::ostringstream file;
+
+      out::setOutput(file);
+      out::setVerbosity(out::WARNINGS);
+      out::setAsynchronous(true);
+
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([t, num_messages]() {
+          for (int i = 0; i < num_messages; ++i) {
+            RESOLVE_LOG_WARNING << "thread " << t << " message " << i << "\n";
+            out::flush();
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      out::setAsynchronous(false);
+
+      std::vector<int> count(num_threads, 0);
+      const std::string prefix = warning_text() + "thread ";
+      std::istringstream lines(file.str());
+      std::string line;
+      while (std::getline(lines, line)) {
+        int t = -1;
+        int i = -1;
+        if (line.compare(0, prefix.size(), prefix) != 0 ||
+            std::sscanf(line.c_str() + prefix.size(), "%d message %d", &t, &i) != 2 ||
+            t < 0 || t >= num_threads || i != count[t]) {
+          std::cout << "Unexpected log line: " << line << "\n";
+          status = false;
+          break;
+        }
+        ++count[t];
+      }
+      for (int t = 0; t < num_threads; ++t) {
+        status *= (count[t] == num_messages);
+      }
+
+      out::setOutput(std::cout);
+
+      return status.report(__func__);
+    }
+
   private:
     /// Private method to return the string preceding error output
     std::string error_text()
@@ -26,6 +26,10 @@ int main()
   result += test.warningOutput();
   result += test.summaryOutput();
   result += test.miscOutput();
+  result += test.concurrentOutput();
+  result += test.lazyOutput();
+  result += test.asynchronousOutput();
+  result += test.asynchronousFlush();
 
   // Return tests summary
   return result.summary();
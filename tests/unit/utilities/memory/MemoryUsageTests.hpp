@@ -0,0 +1,117 @@
+#pragma once
+#include <iostream>
+#include <vector>
+
+#include <resolve/SystemSolver.hpp>
+#include <resolve/LinSolver.hpp>
+#include <resolve/matrix/Csr.hpp>
+#include <resolve/vector/Vector.hpp>
+#include <resolve/utilities/memory/MemoryTracker.hpp>
+#include <resolve/workspace/LinAlgWorkspaceCpu.hpp>
+#include <tests/unit/TestBase.hpp>
+#include <tests/unit/TestMatrices.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @class Unit tests for memory footprint accounting
+     */
+    class MemoryUsageTests : TestBase
+    {
+      public:
+        MemoryUsageTests()
+        {
+        }
+
+        virtual ~MemoryUsageTests()
+        {
+        }
+
+        TestOutcome vectorAndMatrixUsage()
+        {
+          TestStatus status;
+          using memory::MemoryTracker;
+
+          const std::size_t baseline = MemoryTracker::getUsage().host_bytes;
+
+          vector::Vector* x = new vector::Vector(100, 3);
+          status *= (x->getMemoryUsage().host_bytes == 0);
+          x->allocate(memory::HOST);
+          const std::size_t vector_bytes = 300 * sizeof(real_type);
+          status *= (x->getMemoryUsage().host_bytes == vector_bytes);
+          status *= (x->getMemoryUsage().device_bytes == 0);
+          status *= (MemoryTracker::getUsage().host_bytes == baseline + vector_bytes);
+
+          // Matrix of size n x n with nnz nonzeros
+          const index_type n = 10;
+          const index_type nnz = 28;
+          matrix::Csr* A = createTridiagonalCsrMatrix(n);
+          const std::size_t matrix_bytes = (n + 1 + nnz) * sizeof(index_type) + nnz * sizeof(real_type);
+          status *= (A->getMemoryUsage().host_bytes == matrix_bytes);
+          status *= (MemoryTracker::getUsage().host_bytes == baseline + vector_bytes + matrix_bytes);
+          status *= (MemoryTracker::getHighWaterMark().host_bytes >= baseline + vector_bytes + matrix_bytes);
+
+          delete x;
+          delete A;
+          status *= (MemoryTracker::getUsage().host_bytes == baseline);
+
+          // High-water mark is kept until reset
+          status *= (MemoryTracker::getHighWaterMark().host_bytes >= baseline + vector_bytes + matrix_bytes);
+          MemoryTracker::resetHighWaterMark();
+          status *= (MemoryTracker::getHighWaterMark().host_bytes == baseline);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome systemSolverUsage()
+        {
+          TestStatus status;
+
+          const index_type n = 100;
+          const index_type restart = 20;
+          matrix::Csr* A = createTridiagonalCsrMatrix(n);
+
+          LinAlgWorkspaceCpu workspace;
+          workspace.initializeHandles();
+          SystemSolver solver(&workspace, "none", "none", "fgmres", "ilu0", "none");
+          status *= (solver.getMemoryHighWaterMark().host_bytes == 0);
+
+          status *= (solver.setMatrix(A) == 0);
+          solver.getIterativeSolver().setRestart(restart);
+          solver.getIterativeSolver().setTol(1e-12);
+          status *= (solver.preconditionerSetup() == 0);
+
+          vector::Vector rhs(n);
+          rhs.allocate(memory::HOST);
+          rhs.setToConst(1.0, memory::HOST);
+          vector::Vector x(n);
+          x.allocate(memory::HOST);
+          x.setToZero(memory::HOST);
+          status *= (solver.solve(&rhs, &x) == 0);
+
+          // Krylov bases V and Z, each n x (restart + 1)
+          const std::size_t basis_bytes = 2 * n * (restart + 1) * sizeof(real_type);
+          const std::size_t krylov_bytes = solver.getIterativeSolver().getMemoryUsage().host_bytes;
+          status *= (krylov_bytes >= basis_bytes);
+
+          // ILU0 factors hold at least as many values as A
+          memory::MemoryUsage usage = solver.getMemoryUsage();
+          status *= (usage.host_bytes >= krylov_bytes + static_cast<std::size_t>(A->getNnz()) * sizeof(real_type));
+          status *= (usage.device_bytes == 0);
+          status *= (solver.getMemoryHighWaterMark().host_bytes >= usage.host_bytes);
+
+          // Shrinking the restart lowers the footprint, but not the peak
+          solver.getIterativeSolver().setRestart(restart / 2);
+          status *= (solver.getMemoryUsage().host_bytes < usage.host_bytes);
+          status *= (solver.getMemoryHighWaterMark().host_bytes >= usage.host_bytes);
+          solver.resetMemoryHighWaterMark();
+          status *= (solver.getMemoryHighWaterMark().host_bytes == solver.getMemoryUsage().host_bytes);
+
+          delete A;
+          return status.report(__func__);
+        }
+    }; // class MemoryUsageTests
+  }    // namespace tests
+} // namespace ReSolve
@@ -0,0 +1,20 @@
+#include <iostream>
+
+#include "MemoryUsageTests.hpp"
+
+int main(int, char**)
+{
+  ReSolve::tests::TestingResults result;
+
+  {
+    std::cout << "Running memory usage tests:\n";
+    ReSolve::tests::MemoryUsageTests test;
+
+    result += test.vectorAndMatrixUsage();
+    result += test.systemSolverUsage();
+
+    std::cout << "\n";
+  }
+
+  return result.summary();
+}
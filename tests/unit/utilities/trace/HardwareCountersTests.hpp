@@ -0,0 +1,160 @@
+/**
+ * @file HardwareCountersTests.hpp
+ * @brief Contains definition of HardwareCountersTests class.
+ *
+ */
+
+#pragma once
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <resolve/utilities/trace/HardwareCounters.hpp>
+#include <resolve/utilities/trace/Tracer.hpp>
+#include <tests/unit/TestBase.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @brief Unit tests for hardware counters of traced ranges.
+     *
+     * Hardware counters are often not available, e.g. in virtual machines,
+     * so counter values are only checked when they can be read. Number of
+     * calls and times are checked always.
+     */
+    class HardwareCountersTests : TestBase
+    {
+      public:
+        HardwareCountersTests()
+        {
+        }
+
+        virtual ~HardwareCountersTests()
+        {
+        }
+
+        TestOutcome disabledByDefault()
+        {
+          TestStatus status;
+          using trace::HardwareCounters;
+
+          status *= !HardwareCounters::isEnabled();
+          HardwareCounters::begin("ignored");
+          HardwareCounters::end("ignored");
+          status *= HardwareCounters::getReport().empty();
+
+          return status.report(__func__);
+        }
+
+        TestOutcome nestedRanges()
+        {
+          TestStatus status;
+          using trace::HardwareCounters;
+          using trace::RegionCounters;
+
+          HardwareCounters::clear();
+          HardwareCounters::setEnabled(true);
+          const int num_calls = 3;
+          for (int k = 0; k < num_calls; ++k) {
+            HardwareCounters::begin("outer");
+            HardwareCounters::begin("inner");
+            work();
+            HardwareCounters::end("inner");
+            HardwareCounters::end("outer");
+          }
+
+          const RegionCounters outer = HardwareCounters::getRegion("outer");
+          const RegionCounters inner = HardwareCounters::getRegion("inner");
+          status *= (HardwareCounters::getReport().size() == 2);
+          status *= (outer.num_calls == num_calls) && (inner.num_calls == num_calls);
+          status *= (inner.time > 0.0) && (outer.time >= inner.time);
+          status *= (HardwareCounters::getRegion("missing").num_calls == 0);
+
+          if (HardwareCounters::isAvailable()) {
+            // Counts of nested ranges are inclusive.
+            status *= (inner.num_measured == num_calls);
+            status *= (inner.instructions > 0.0) && (inner.cycles > 0.0);
+            status *= (outer.instructions >= inner.instructions);
+            status *= (inner.getIpc() > 0.0);
+          } else {
+            status *= (inner.num_measured == 0) && (inner.instructions == 0.0);
+          }
+
+          std::ostringstream out;
+          HardwareCounters::writeReport(out);
+          status *= (out.str().find("outer") != std::string::npos);
+          status *= (out.str().find("inner") != std::string::npos);
+
+          HardwareCounters::clear();
+          status *= HardwareCounters::getReport().empty();
+          HardwareCounters::setEnabled(false);
+          return status.report(__func__);
+        }
+
+        TestOutcome tracedRanges()
+        {
+          TestStatus status;
+          using trace::HardwareCounters;
+
+          // Ranges recorded by the tracer are also counted.
+          HardwareCounters::clear();
+          HardwareCounters::setEnabled(true);
+          trace::Tracer::begin("traced");
+          work();
+          trace::Tracer::end("traced");
+          status *= (HardwareCounters::getRegion("traced").num_calls == 1);
+
+          HardwareCounters::clear();
+          HardwareCounters::setEnabled(false);
+          trace::Tracer::clear();
+          return status.report(__func__);
+        }
+
+        TestOutcome concurrentThreads()
+        {
+          TestStatus status;
+          using trace::HardwareCounters;
+
+          const int num_threads = 3;
+          const int num_ranges  = 10;
+          HardwareCounters::clear();
+          HardwareCounters::setEnabled(true);
+
+          std::vector<std::thread> threads;
+          for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&]() {
+              for (int k = 0; k < num_ranges; ++k) {
+                HardwareCounters::begin("range");
+                work();
+                HardwareCounters::end("range");
+              }
+            });
+          }
+          for (auto& thread : threads) {
+            thread.join();
+          }
+
+          // Totals of finished threads are kept.
+          status *= (HardwareCounters::getRegion("range").num_calls == num_threads * num_ranges);
+
+          HardwareCounters::clear();
+          HardwareCounters::setEnabled(false);
+          return status.report(__func__);
+        }
+
+      private:
+        /// Some floating point work that is not optimized away
+        void work()
+        {
+          std::vector<double> x(1000, 1.0);
+          volatile double sum = 0.0;
+          for (double v : x) {
+            sum = sum + v * v;
+          }
+        }
+    }; // class HardwareCountersTests
+  }    // namespace tests
+} // namespace ReSolve
@@ -0,0 +1,214 @@
+/**
+ * @file TracerTests.hpp
+ * @brief Contains definition of TracerTests class.
+ *
+ */
+
+#pragma once
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <resolve/utilities/trace/Tracer.hpp>
+#include <tests/unit/TestBase.hpp>
+
+namespace ReSolve
+{
+  namespace tests
+  {
+    /**
+     * @brief Unit tests for host tracer.
+     *
+     * Tracer state is global, so each test clears recorded events first.
+     */
+    class TracerTests : TestBase
+    {
+      public:
+        TracerTests()
+        {
+        }
+
+        virtual ~TracerTests()
+        {
+        }
+
+        TestOutcome nestedRanges()
+        {
+          TestStatus status;
+          using trace::Tracer;
+
+          Tracer::setBufferCapacity(64);
+          Tracer::begin("outer");
+          Tracer::begin("inner \"quoted\"");
+          Tracer::end("inner \"quoted\"");
+          Tracer::end("outer");
+
+          status *= (Tracer::getNumEvents() == 4);
+          status *= (Tracer::getNumDropped() == 0);
+
+          std::string json = writeTrace();
+          status *= (json.compare(0, 15, "{\"traceEvents\":") == 0);
+          status *= (count(json, "\"ph\":\"B\"") == 2);
+          status *= (count(json, "\"ph\":\"E\"") == 2);
+          // Names are escaped in JSON output.
+          status *= (count(json, "\"name\":\"inner \\\"quoted\\\"\"") == 2);
+
+          // Events are written in the order they were recorded.
+          std::size_t outer_begin = json.find("\"name\":\"outer\"");
+          std::size_t inner_begin = json.find("\"name\":\"inner");
+          std::size_t outer_end   = json.rfind("\"name\":\"outer\"");
+          status *= (outer_begin < inner_begin) && (inner_begin < outer_end);
+
+          Tracer::clear();
+          status *= (Tracer::getNumEvents() == 0);
+
+          return status.report(__func__);
+        }
+
+        TestOutcome ringBufferOverflow()
+        {
+          TestStatus status;
+          using trace::Tracer;
+
+          Tracer::setBufferCapacity(4);
+          Tracer::begin("A");
+          Tracer::begin("B");
+          Tracer::end("B");
+          Tracer::begin("C");
+          Tracer::end("C");
+          Tracer::end("A");
+
+          // Only the last four events are kept.
+          status *= (Tracer::getNumEvents() == 4);
+          status *= (Tracer::getNumDropped() == 2);
+
+          // End events of overwritten ranges are skipped.
+          std::string json = writeTrace();
+          status *= (count(json, "\"name\":\"A\"") == 0);
+          status *= (count(json, "\"name\":\"B\"") == 0);
+          status *= (count(json, "\"name\":\"C\"") == 2);
+          status *= (count(json, "\"dropped_events\":2") == 1);
+
+          Tracer::setBufferCapacity(1024);
+          return status.report(__func__);
+        }
+
+        TestOutcome concurrentThreads()
+        {
+          TestStatus status;
+          using trace::Tracer;
+
+          const int num_threads = 3;
+          const int num_ranges  = 100;
+          Tracer::clear();
+
+          auto run = [&]() {
+            std::atomic<int> started(0);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < num_threads; ++t) {
+              threads.emplace_back([&]() {
+                // Keep a range open until all threads have recorded an
+                // event, so each thread needs its own buffer.
+                Tracer::begin("range");
+                started++;
+                while (started.load() < num_threads) {
+                  std::this_thread::yield();
+                }
+                Tracer::end("range");
+                for (int k = 1; k < num_ranges; ++k) {
+                  Tracer::begin("range");
+                  Tracer::end("range");
+                }
+              });
+            }
+            for (auto& thread : threads) {
+              thread.join();
+            }
+          };
+
+          run();
+          std::string json = writeTrace();
+          status *= (Tracer::getNumEvents() == static_cast<std::size_t>(2 * num_threads * num_ranges));
+          status *= (count(json, "\"thread_name\"") == num_threads);
+
+          // Buffers of finished threads are reused by new threads.
+          run();
+          json = writeTrace();
+          status *= (Tracer::getNumEvents() == static_cast<std::size_t>(4 * num_threads * num_ranges));
+          status *= (count(json, "\"thread_name\"") == num_threads);
+
+          Tracer::clear();
+          return status.report(__func__);
+        }
+
+        TestOutcome openRanges()
+        {
+          TestStatus status;
+          using trace::Tracer;
+
+          Tracer::clear();
+          Tracer::begin("closed");
+          Tracer::end("closed");
+          Tracer::begin("open outer");
+          Tracer::begin("open inner");
+
+          // Open ranges are closed in the output, innermost first.
+          std::string json = writeTrace();
+          status *= (count(json, "\"ph\":\"B\"") == 3);
+          status *= (count(json, "\"ph\":\"E\"") == 3);
+          status *= (count(json, "\"name\":\"open outer\"") == 2);
+          status *= (count(json, "\"name\":\"open inner\"") == 2);
+          status *= (json.find("\"open inner\",\"cat\":\"resolve\",\"ph\":\"E\"") <
+                     json.find("\"open outer\",\"cat\":\"resolve\",\"ph\":\"E\""));
+          status *= (Tracer::getNumEvents() == 4);
+
+          Tracer::end("open inner");
+          Tracer::end("open outer");
+          Tracer::clear();
+          return status.report(__func__);
+        }
+
+        TestOutcome disabledTracer()
+        {
+          TestStatus status;
+          using trace::Tracer;
+
+          Tracer::clear();
+          Tracer::setEnabled(false);
+          status *= !Tracer::isEnabled();
+          Tracer::begin("ignored");
+          Tracer::end("ignored");
+          status *= (Tracer::getNumEvents() == 0);
+
+          Tracer::setEnabled(true);
+          Tracer::begin("recorded");
+          Tracer::end("recorded");
+          status *= (Tracer::getNumEvents() == 2);
+
+          Tracer::clear();
+          return status.report(__func__);
+        }
+
+      private:
+        std::string writeTrace()
+        {
+          std::ostringstream out;
+          trace::Tracer::write(out);
+          return out.str();
+        }
+
+        /// Number of occurrences of `pattern` in `text`
+        int count(const std::string& text, const std::string& pattern)
+        {
+          int n = 0;
+          for (std::size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            ++n;
+          }
+          return n;
+        }
+    }; // class TracerTests
+  }    // namespace tests
+} // namespace ReSolve
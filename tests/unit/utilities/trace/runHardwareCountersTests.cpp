@@ -0,0 +1,32 @@
+/**
+ * @file runHardwareCountersTests.cpp
+ * @brief Driver for hardware counter tests.
+ *
+ */
+
+#include <iostream>
+
+#include <resolve/utilities/trace/HardwareCounters.hpp>
+#include "HardwareCountersTests.hpp"
+
+int main()
+{
+  // Create HardwareCountersTests object
+  ReSolve::tests::HardwareCountersTests test;
+
+  // Create test results accounting object
+  ReSolve::tests::TestingResults result;
+
+  std::cout << "Hardware counters are "
+            << (ReSolve::trace::HardwareCounters::isAvailable() ? "" : "not ")
+            << "available.\n";
+
+  // Run tests
+  result += test.disabledByDefault();
+  result += test.nestedRanges();
+  result += test.tracedRanges();
+  result += test.concurrentThreads();
+
+  // Return tests summary
+  return result.summary();
+}
@@ -0,0 +1,27 @@
+/**
+ * @file runTracerTests.cpp
+ * @brief Driver for host tracer tests.
+ *
+ */
+
+#include <resolve/utilities/trace/Tracer.hpp>
+#include "TracerTests.hpp"
+
+int main()
+{
+  // Create TracerTests object
+  ReSolve::tests::TracerTests test;
+
+  // Create test results accounting object
+  ReSolve::tests::TestingResults result;
+
+  // Run tests
+  result += test.nestedRanges();
+  result += test.ringBufferOverflow();
+  result += test.concurrentThreads();
+  result += test.openRanges();
+  result += test.disabledTracer();
+
+  // Return tests summary
+  return result.summary();
+}
@@ -64,6 +64,18 @@ namespace ReSolve
             case GramSchmidt::cgs2:
               testname += " (Reorthogonalized Classical Gram-Schmidt)";
               break;
+            case GramSchmidt::mgs_one_sync:
+              testname += " (Modified Gram-Schmidt 1-Sync)";
+              break;
+            case GramSchmidt::cgs2_two_sync:
+              testname += " (Reorthogonalized Classical Gram-Schmidt 2-Sync)";
+              break;
+            case GramSchmidt::rgs:
+              testname += " (Randomized Gram-Schmidt)";
+              break;
+            case GramSchmidt::dcgs2:
+              testname += " (Delayed Reorthogonalized Classical Gram-Schmidt)";
+              break;
           }
 
           vector::Vector V(N, 3); // we will be using a space of 3 vectors
@@ -100,14 +112,34 @@ namespace ReSolve
 
           //set the first vector to all 1s, normalize 
           V.setToConst(0, 1.0, memspace_);
-          real_type nrm = handler_.dot(&V, &V, memspace_);
-          nrm = sqrt(nrm);
+          real_type nrm = 0.0;
+          if (var == GramSchmidt::rgs) {
+            // Randomized Gram-Schmidt orthonormalizes in the sketched
+            // inner product, so the first vector is normalized in that norm
+            nrm = sketchedNorm(GS, V, 0);
+          } else {
+            nrm = handler_.dot(&V, &V, memspace_);
+            nrm = sqrt(nrm);
+          }
           nrm = 1.0 / nrm;
           handler_.scal(&nrm, &V, memspace_);
 
           GS.orthogonalize(N, &V, H, 0); 
           GS.orthogonalize(N, &V, H, 1); 
-          status *= verifyAnswer(V, 3);
+          // Delayed variants complete the last vector separately
+          GS.completeDelayed(N, &V, H, 1);
+          if (var == GramSchmidt::rgs) {
+            // Basis is orthonormal in <Theta x, Theta y>, check Theta V
+            vector::Vector S(GS.getSketchSize(), 3);
+            S.allocate(memspace_);
+            if (memspace_ == memory::DEVICE) {
+              S.allocate(memory::HOST);
+            }
+            sketchBasis(GS, V, S, 3);
+            status *= verifyAnswer(S, 3);
+          } else {
+            status *= verifyAnswer(V, 3);
+          }
 
           delete [] H;
           
@@ -118,6 +150,30 @@ namespace ReSolve
         ReSolve::VectorHandler& handler_;
         ReSolve::memory::MemorySpace memspace_;
 
+        // Sketches first K vectors of V into columns of S
+        void sketchBasis(GramSchmidt& GS, vector::Vector& V, vector::Vector& S, index_type K)
+        {
+          for (index_type i = 0; i < K; ++i) {
+            vector::Vector v(V.getSize());
+            vector::Vector s(S.getSize());
+            v.setData(V.getVectorData(i, memspace_), memspace_);
+            s.setData(S.getVectorData(i, memspace_), memspace_);
+            GS.sketch(&v, &s);
+          }
+          S.setDataUpdated(memspace_);
+        }
+
+        // Norm of i-th vector of V in the sketched inner product
+        real_type sketchedNorm(GramSchmidt& GS, vector::Vector& V, index_type i)
+        {
+          vector::Vector v(V.getSize());
+          vector::Vector s(GS.getSketchSize());
+          s.allocate(memspace_);
+          v.setData(V.getVectorData(i, memspace_), memspace_);
+          GS.sketch(&v, &s);
+          return sqrt(handler_.dot(&s, &s, memspace_));
+        }
+
         // x is a multivector containing K vectors 
         bool verifyAnswer(vector::Vector& x, index_type K)
         {
@@ -21,6 +21,10 @@ int main(int, char**)
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_two_sync);
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_pm);
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::cgs1);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_one_sync);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::cgs2_two_sync);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::rgs);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::dcgs2);
     std::cout << "\n";
   }
 
@@ -39,6 +43,10 @@ int main(int, char**)
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_two_sync);
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_pm);
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::cgs1);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_one_sync);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::cgs2_two_sync);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::rgs);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::dcgs2);
     std::cout << "\n";
   }
 #endif
@@ -58,6 +66,10 @@ int main(int, char**)
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_two_sync);
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_pm);
     result += test.orthogonalize(5000, ReSolve::GramSchmidt::cgs1);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::mgs_one_sync);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::cgs2_two_sync);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::rgs);
+    result += test.orthogonalize(5000, ReSolve::GramSchmidt::dcgs2);
     std::cout << "\n";
   }
 #endif